@@ -11,6 +11,7 @@
 
 #include "AviSynthEnvironmentBase.h"
 #include <system_error>
+#include <mutex>
 
 // See http://www.avisynth.nl/index.php/Filter_SDK/AVS_Linkage
 const AVS_Linkage* AVS_linkage = nullptr;
@@ -19,6 +20,14 @@ namespace VideoScriptEditor::Unmanaged
 {
     using namespace std;
 
+    namespace
+    {
+        // AVS_linkage is process-wide but multiple script environments may be alive at once (e.g. on thumbnail decoding threads),
+        // so it is only cleared once the last script environment is deleted.
+        mutex s_scriptEnvironmentCountMutex;
+        int s_scriptEnvironmentCount = 0;
+    }
+
     AviSynthEnvironmentBase::AviSynthEnvironmentBase()
         : _aviSynthDllHandle(LoadLibraryW(L"avisynth.dll"))
     {
@@ -48,12 +57,15 @@ namespace VideoScriptEditor::Unmanaged
 
     bool AviSynthEnvironmentBase::CreateScriptEnvironment()
     {
+        lock_guard<mutex> scriptEnvironmentCountLock(s_scriptEnvironmentCountMutex);
+
         _scriptEnvironment = _AviSynthCreateScriptEnvironment(AVISYNTH_INTERFACE_VERSION);
         if (_scriptEnvironment == nullptr)
         {
             return false;
         }
 
+        ++s_scriptEnvironmentCount;
         AVS_linkage = _scriptEnvironment->GetAVSLinkage();
         return true;
     }
@@ -62,15 +74,21 @@ namespace VideoScriptEditor::Unmanaged
     {
         // Unload the current environment
         _clip = nullptr;
-        AVS_linkage = nullptr;
 
         if (_scriptEnvironment != nullptr)
         {
+            lock_guard<mutex> scriptEnvironmentCountLock(s_scriptEnvironmentCountMutex);
+
             // Calling DeleteScriptEnvironment on an IScriptEnvironment instance results in a dangling instance pointer.
             _scriptEnvironment->DeleteScriptEnvironment();
 
             // Explicitly setting the instance pointer to null here so it doesn't point to freed memory.
             _scriptEnvironment = nullptr;
+
+            if (--s_scriptEnvironmentCount == 0)
+            {
+                AVS_linkage = nullptr;
+            }
         }
 
         ZeroMemory(&_clip, sizeof(PClip));
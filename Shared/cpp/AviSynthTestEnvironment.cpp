@@ -1,4 +1,14 @@
-#include "pch.h"
+#if !defined(WIN32_LEAN_AND_MEAN)
+#define WIN32_LEAN_AND_MEAN         // Exclude rarely-used stuff from Windows headers
+#endif
+
+#include <windows.h>
+
+#pragma warning(push)
+#pragma warning(disable : 26495)    // C26495: Variable '%variable%' is uninitialized. Always initialize a member variable.
+#include <avisynth.h>
+#pragma warning(pop)
+
 #include "AviSynthTestEnvironment.h"
 
 using namespace VideoScriptEditor::Unmanaged;
@@ -1,5 +1,6 @@
 #pragma once
-#include "..\..\Shared\cpp\AviSynthEnvironmentBase.h"
+#include "AviSynthEnvironmentBase.h"
+#include <string>
 
 /// <summary>
 /// A simple AviSynth runtime environment for testing AviSynth filters/plugins.
@@ -28,15 +28,17 @@
 #include "D2DRendererBase.h"
 #include <cmath>
 #include <cassert>
+#include <cfloat>
 
 namespace VideoScriptEditor::Unmanaged
 {
     using Microsoft::WRL::ComPtr;   // See https://github.com/Microsoft/DirectXTK/wiki/ComPtr
     using namespace std;
 
-    D2DRendererBase::D2DRendererBase(std::map<int, std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, std::map<int, CropSegmentFrameDataItem>& croppingSegmentFrames)
-        : _maskingGeometriesRef(maskingGeometries), _croppingSegmentFramesRef(croppingSegmentFrames)
+    D2DRendererBase::D2DRendererBase(TrackIndexedTable<std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, TrackIndexedTable<CropSegmentFrameDataItem>& croppingSegmentFrames, const bool tracksMaskingDirtyRect)
+        : _tracksMaskingDirtyRect(tracksMaskingDirtyRect), _blurStandardDeviation(DefaultBlurStandardDeviation), _maskingGeometriesRef(maskingGeometries), _croppingSegmentFramesRef(croppingSegmentFrames)
     {
+        ResetMaskingDirtyRect();
     }
 
     void D2DRendererBase::UpdateMaskingGeometry(std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>& maskingDataGeometryPair)
@@ -44,6 +46,9 @@ namespace VideoScriptEditor::Unmanaged
         const std::shared_ptr<MaskSegmentFrameDataItemBase>& maskingFrameDataItem = maskingDataGeometryPair.first;
         ID2D1GeometryPtr& maskingGeometry = maskingDataGeometryPair.second;
 
+        // The area masked by the old geometry needs redrawing as well as the area masked by the new one.
+        InvalidateMaskingGeometryBounds(maskingGeometry);
+
         shared_ptr<MaskPolygonSegmentFrameDataItem> polygonDataItem;
         shared_ptr<MaskRectangleSegmentFrameDataItem> rectangleDataItem;
         shared_ptr<MaskEllipseSegmentFrameDataItem> ellipseDataItem;
@@ -97,6 +102,49 @@ namespace VideoScriptEditor::Unmanaged
         {
             _com_raise_error(HRESULT_FROM_WIN32(ERROR_BAD_ARGUMENTS));
         }
+
+        InvalidateMaskingGeometryBounds(maskingGeometry);
+    }
+
+    void D2DRendererBase::SetBlurStandardDeviation(const float standardDeviation)
+    {
+        _blurStandardDeviation = standardDeviation;
+
+        if (_gaussianBlurEffect != nullptr)
+        {
+            HR::ThrowIfFailed(
+                _gaussianBlurEffect->SetValue(D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, _blurStandardDeviation)
+            );
+        }
+    }
+
+    void D2DRendererBase::InvalidateMaskingGeometryBounds(const ID2D1GeometryPtr& maskingGeometry)
+    {
+        if (!_tracksMaskingDirtyRect || maskingGeometry == nullptr)
+        {
+            return;
+        }
+
+        D2D1_RECT_F geometryBounds;
+        HR::ThrowIfFailed(
+            maskingGeometry->GetBounds(nullptr, &geometryBounds)
+        );
+
+        if (geometryBounds.left > geometryBounds.right || geometryBounds.top > geometryBounds.bottom)
+        {
+            // Empty geometry
+            return;
+        }
+
+        _maskingDirtyRect.left = min(_maskingDirtyRect.left, geometryBounds.left);
+        _maskingDirtyRect.top = min(_maskingDirtyRect.top, geometryBounds.top);
+        _maskingDirtyRect.right = max(_maskingDirtyRect.right, geometryBounds.right);
+        _maskingDirtyRect.bottom = max(_maskingDirtyRect.bottom, geometryBounds.bottom);
+    }
+
+    void D2DRendererBase::ResetMaskingDirtyRect()
+    {
+        _maskingDirtyRect = D2D1::RectF(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
     }
 
     void D2DRendererBase::CreateDeviceIndependentResources()
@@ -124,7 +172,7 @@ namespace VideoScriptEditor::Unmanaged
         );
 
         HR::ThrowIfFailed(
-            _gaussianBlurEffect->SetValue(D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, 72.0f)
+            _gaussianBlurEffect->SetValue(D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, _blurStandardDeviation)
         );
 
         HR::ThrowIfFailed(
@@ -283,34 +331,95 @@ namespace VideoScriptEditor::Unmanaged
         geometryCollection.push_back(std::move(insertedOrCombinedGeometry));
     }
 
-    void D2DRendererBase::RenderBlurMask(ID2D1Bitmap1* sourceFrameBitmap, ID2D1Bitmap1* renderTargetBitmap)
+    D2D1_RECT_U D2DRendererBase::RenderBlurMask(ID2D1Bitmap1* sourceFrameBitmap, ID2D1Bitmap1* renderTargetBitmap, const D2D1_RECT_F* dirtyRect, ID2D1Image* blurredSourceFrameImage)
     {
+        const D2D1_SIZE_U srcPixelSize = sourceFrameBitmap->GetPixelSize();
+        D2D1_RECT_U redrawRect = D2D1::RectU(0U, 0U, srcPixelSize.width, srcPixelSize.height);
+
+        if (dirtyRect != nullptr)
+        {
+            // The blur is of the entire (unmasked) source frame, so a masking geometry change only affects pixels within its old and new bounds.
+            // Round out to whole pixels, allowing an extra pixel for antialiased geometry edges, and clip to the frame.
+            redrawRect.left = static_cast<UINT32>(max(0.f, floor(dirtyRect->left) - 1.f));
+            redrawRect.top = static_cast<UINT32>(max(0.f, floor(dirtyRect->top) - 1.f));
+            redrawRect.right = static_cast<UINT32>(max(0.f, min(static_cast<float>(srcPixelSize.width), ceil(dirtyRect->right) + 1.f)));
+            redrawRect.bottom = static_cast<UINT32>(max(0.f, min(static_cast<float>(srcPixelSize.height), ceil(dirtyRect->bottom) + 1.f)));
+
+            if (redrawRect.left >= redrawRect.right || redrawRect.top >= redrawRect.bottom)
+            {
+                // Nothing to redraw
+                return D2D1::RectU();
+            }
+        }
+
         // Layer 0 (source frame bitmap)
+        const D2D1_POINT_2U copyDestPoint = D2D1::Point2U(redrawRect.left, redrawRect.top);
         HR::ThrowIfFailed(
-            CopyD2DBitmap(sourceFrameBitmap, renderTargetBitmap)
+            renderTargetBitmap->CopyFromBitmap(&copyDestPoint, sourceFrameBitmap, &redrawRect)
         );
 
         _d2dContext->SetTarget(renderTargetBitmap);
         _d2dContext->BeginDraw();
 
+        if (dirtyRect != nullptr)
+        {
+            // Direct2D only evaluates the blur effect for the clipped output area (plus the input area the kernel reads).
+            _d2dContext->PushAxisAlignedClip(
+                D2D1::RectF(
+                    static_cast<FLOAT>(redrawRect.left),
+                    static_cast<FLOAT>(redrawRect.top),
+                    static_cast<FLOAT>(redrawRect.right),
+                    static_cast<FLOAT>(redrawRect.bottom)
+                ),
+                D2D1_ANTIALIAS_MODE_ALIASED
+            );
+        }
+
         // Draw layer 1 (blur mask)
         _d2dContext->PushLayer(
             D2D1::LayerParameters(D2D1::InfiniteRect(), _maskingGeometryGroup.Get()),
             nullptr // No need to CreateLayer on Windows 8+
         );
 
-        _gaussianBlurEffect->SetInput(0, sourceFrameBitmap);
-        _d2dContext->DrawImage(_gaussianBlurEffect.Get());
+        if (blurredSourceFrameImage != nullptr)
+        {
+            _d2dContext->DrawImage(blurredSourceFrameImage);
+        }
+        else
+        {
+            _gaussianBlurEffect->SetInput(0, sourceFrameBitmap);
+            _d2dContext->DrawImage(_gaussianBlurEffect.Get());
+        }
 
         // Flatten layers
         _d2dContext->PopLayer();
 
+        if (dirtyRect != nullptr)
+        {
+            _d2dContext->PopAxisAlignedClip();
+        }
+
         HR::ThrowIfFailed(
             _d2dContext->EndDraw()
         );
+
+        return redrawRect;
     }
 
-    void D2DRendererBase::RenderCroppedFrameInternal(ID2D1Bitmap* sourceFrameBitmap)
+    void D2DRendererBase::RenderBlurredFrame(ID2D1Bitmap1* sourceFrameBitmap, ID2D1Bitmap1* renderTargetBitmap)
+    {
+        _d2dContext->SetTarget(renderTargetBitmap);
+        _d2dContext->BeginDraw();
+
+        _gaussianBlurEffect->SetInput(0, sourceFrameBitmap);
+        _d2dContext->DrawImage(_gaussianBlurEffect.Get());
+
+        HR::ThrowIfFailed(
+            _d2dContext->EndDraw()
+        );
+    }
+
+    void D2DRendererBase::RenderCroppedFrameInternal(ID2D1Bitmap* sourceFrameBitmap, const bool applyBlurMask)
     {
         LtwhRectD renderBoundingBox = GetCroppingSegmentFramesRenderBounds();
         SizeD renderBoundingSize(renderBoundingBox.Width, renderBoundingBox.Height);
@@ -376,17 +485,26 @@ namespace VideoScriptEditor::Unmanaged
                 D2D1_MATRIX_3X2_F scaleMatrix = D2D1::Matrix3x2F::Scale(cropSegmentFrameRenderItem->ScaleFactor, cropSegmentFrameRenderItem->ScaleFactor);
                 D2D1_MATRIX_3X2_F translationMatrix = D2D1::Matrix3x2F::Translation(cropSegmentFrameRenderItem->TranslationOffsetX, cropSegmentFrameRenderItem->TranslationOffsetY);
 
+                D2D1_MATRIX_3X2_F sourceToTargetTransform;
                 if (abs(cropSegmentFrameRenderItem->RotationAngle) != 0.f)
                 {
                     D2D1_MATRIX_3X2_F rotationMatrix = D2D1::Matrix3x2F::Rotation(cropSegmentFrameRenderItem->RotationAngle, cropSegmentFrameRenderItem->RotationCenter);
-                    _d2dContext->SetTransform(rotationMatrix * scaleMatrix * translationMatrix);
+                    sourceToTargetTransform = rotationMatrix * scaleMatrix * translationMatrix;
                 }
                 else
                 {
-                    _d2dContext->SetTransform(scaleMatrix * translationMatrix);
+                    sourceToTargetTransform = scaleMatrix * translationMatrix;
                 }
 
-                _d2dContext->DrawBitmap(sourceFrameBitmap);
+                _d2dContext->SetTransform(sourceToTargetTransform);
+
+                // Only the top-left ScaledSize area of the segment render bitmap is composited
+                DrawCropSourceFrame(
+                    sourceFrameBitmap,
+                    sourceToTargetTransform,
+                    D2D1::RectF(0.f, 0.f, cropSegmentFrameRenderItem->ScaledSize.width, cropSegmentFrameRenderItem->ScaledSize.height),
+                    applyBlurMask
+                );
 
                 // Reset Transform to default
                 _d2dContext->SetTransform(D2D1::Matrix3x2F::Identity());
@@ -464,17 +582,20 @@ namespace VideoScriptEditor::Unmanaged
             D2D1_MATRIX_3X2_F scaleMatrix = D2D1::Matrix3x2F::Scale(cropSegmentFrameRenderItem.ScaleFactor, cropSegmentFrameRenderItem.ScaleFactor);
             D2D1_MATRIX_3X2_F translationMatrix = D2D1::Matrix3x2F::Translation(cropSegmentFrameRenderItem.TranslationOffsetX, cropSegmentFrameRenderItem.TranslationOffsetY);
 
+            D2D1_MATRIX_3X2_F sourceToTargetTransform;
             if (abs(cropSegmentFrameRenderItem.RotationAngle) != 0.f)
             {
                 D2D1_MATRIX_3X2_F rotationMatrix = D2D1::Matrix3x2F::Rotation(cropSegmentFrameRenderItem.RotationAngle, cropSegmentFrameRenderItem.RotationCenter);
-                _d2dContext->SetTransform(rotationMatrix * scaleMatrix * translationMatrix);
+                sourceToTargetTransform = rotationMatrix * scaleMatrix * translationMatrix;
             }
             else
             {
-                _d2dContext->SetTransform(scaleMatrix * translationMatrix);
+                sourceToTargetTransform = scaleMatrix * translationMatrix;
             }
 
-            _d2dContext->DrawBitmap(sourceFrameBitmap);
+            _d2dContext->SetTransform(sourceToTargetTransform);
+
+            DrawCropSourceFrame(sourceFrameBitmap, sourceToTargetTransform, clipBoundsRect, applyBlurMask);
 
             _d2dContext->PopAxisAlignedClip();
 
@@ -487,6 +608,72 @@ namespace VideoScriptEditor::Unmanaged
         }
     }
 
+    void D2DRendererBase::DrawCropSourceFrame(ID2D1Bitmap* sourceFrameBitmap, const D2D1_MATRIX_3X2_F& sourceToTargetTransform, const D2D1_RECT_F& viewportRect, const bool applyBlurMask)
+    {
+        _d2dContext->DrawBitmap(sourceFrameBitmap);
+
+        if (!applyBlurMask)
+        {
+            return;
+        }
+
+        // Map the viewport back to source frame coordinates, bounding its corners as it may be rotated
+        D2D1_MATRIX_3X2_F targetToSourceMatrix = sourceToTargetTransform;
+        if (!D2D1InvertMatrix(&targetToSourceMatrix))
+        {
+            return;
+        }
+
+        const D2D1::Matrix3x2F* targetToSourceTransform = D2D1::Matrix3x2F::ReinterpretBaseType(&targetToSourceMatrix);
+        const D2D1_POINT_2F viewportCorners[] = {
+            targetToSourceTransform->TransformPoint(D2D1::Point2F(viewportRect.left, viewportRect.top)),
+            targetToSourceTransform->TransformPoint(D2D1::Point2F(viewportRect.right, viewportRect.top)),
+            targetToSourceTransform->TransformPoint(D2D1::Point2F(viewportRect.left, viewportRect.bottom)),
+            targetToSourceTransform->TransformPoint(D2D1::Point2F(viewportRect.right, viewportRect.bottom))
+        };
+
+        D2D1_RECT_F blurRect = D2D1::RectF(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (const D2D1_POINT_2F& viewportCorner : viewportCorners)
+        {
+            blurRect.left = min(blurRect.left, viewportCorner.x);
+            blurRect.top = min(blurRect.top, viewportCorner.y);
+            blurRect.right = max(blurRect.right, viewportCorner.x);
+            blurRect.bottom = max(blurRect.bottom, viewportCorner.y);
+        }
+
+        // Intersect with the masked area, allowing an extra pixel for antialiased geometry edges and bilinear resampling
+        D2D1_RECT_F maskingBounds;
+        HR::ThrowIfFailed(
+            _maskingGeometryGroup->GetBounds(nullptr, &maskingBounds)
+        );
+
+        const D2D1_SIZE_U srcPixelSize = sourceFrameBitmap->GetPixelSize();
+        blurRect.left = max(max(blurRect.left, maskingBounds.left) - 1.f, 0.f);
+        blurRect.top = max(max(blurRect.top, maskingBounds.top) - 1.f, 0.f);
+        blurRect.right = min(min(blurRect.right, maskingBounds.right) + 1.f, static_cast<FLOAT>(srcPixelSize.width));
+        blurRect.bottom = min(min(blurRect.bottom, maskingBounds.bottom) + 1.f, static_cast<FLOAT>(srcPixelSize.height));
+
+        if (blurRect.left >= blurRect.right || blurRect.top >= blurRect.bottom)
+        {
+            // No masked area is visible through the viewport
+            return;
+        }
+
+        // The mask layer and blur are drawn with the same transform as the source frame, so each target pixel is
+        // sampled, masked and resampled in one pass, and Direct2D only evaluates the blur for the image rectangle.
+        _d2dContext->PushLayer(
+            D2D1::LayerParameters(D2D1::InfiniteRect(), _maskingGeometryGroup.Get()),
+            nullptr // No need to CreateLayer on Windows 8+
+        );
+
+        _gaussianBlurEffect->SetInput(0, sourceFrameBitmap);
+
+        const D2D1_POINT_2F blurRectOrigin = D2D1::Point2F(blurRect.left, blurRect.top);
+        _d2dContext->DrawImage(_gaussianBlurEffect.Get(), &blurRectOrigin, &blurRect, D2D1_INTERPOLATION_MODE_LINEAR);
+
+        _d2dContext->PopLayer();
+    }
+
     LtwhRectD D2DRendererBase::GetCroppingSegmentFramesRenderBounds()
     {
         //
@@ -1,4 +1,5 @@
 #pragma once
+#include "TrackIndexedTable.h"
 
 namespace VideoScriptEditor::Unmanaged
 {
@@ -7,6 +8,12 @@ namespace VideoScriptEditor::Unmanaged
     /// </summary>
     class D2DRendererBase
     {
+    public:
+        /// <summary>
+        /// The default standard deviation of the Gaussian blur applied to masked areas.
+        /// </summary>
+        static constexpr float DefaultBlurStandardDeviation = 72.0f;
+
     protected:
         /* Direct2D drawing components. */
 
@@ -19,31 +26,50 @@ namespace VideoScriptEditor::Unmanaged
         /// </summary>
         Microsoft::WRL::ComPtr<ID2D1GeometryGroup> _maskingGeometryGroup;
 
+        /// <summary>
+        /// The union of the old and new bounds of masking geometries changed since the dirty rectangle was last reset.
+        /// Empty (left greater than right) when no masking geometry has changed.
+        /// </summary>
+        D2D1_RECT_F _maskingDirtyRect;
+
+        /// <summary>
+        /// Whether changed masking geometry bounds are accumulated in <see cref="_maskingDirtyRect"/>.
+        /// Only renderers that redraw the dirty rectangle alone need to pay for the geometry bounds calculations.
+        /// </summary>
+        const bool _tracksMaskingDirtyRect;
+
+        /// <summary>
+        /// The standard deviation of the Gaussian blur applied to masked areas.
+        /// Kept outside <see cref="_gaussianBlurEffect"/> so that it survives the effect being recreated with the device.
+        /// </summary>
+        float _blurStandardDeviation;
+
         /* Data References */
 
         /// <summary>
-        /// A reference to a masking geometries <see cref="std::map"/> keyed by masking segment track number
+        /// A reference to a masking geometries <see cref="TrackIndexedTable"/> indexed by masking segment track number
         /// and providing a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
         /// </summary>
         /// <seealso cref="VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase"/>
-        std::map<int, std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& _maskingGeometriesRef;
+        TrackIndexedTable<std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& _maskingGeometriesRef;
 
         /// <summary>
-        /// A reference to a cropping segment frame data <see cref="std::map"/> keyed by the cropping segment's track number.
+        /// A reference to a cropping segment frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.
         /// </summary>
         /// <seealso cref="CropSegmentFrameDataItem"/>
-        std::map<int, CropSegmentFrameDataItem>& _croppingSegmentFramesRef;
+        TrackIndexedTable<CropSegmentFrameDataItem>& _croppingSegmentFramesRef;
 
     protected:
         /// <summary>
         /// Base constructor for classes derived from the <see cref="D2DRendererBase"/> class.
         /// </summary>
         /// <param name="maskingGeometries">
-        /// A reference to a masking geometries <see cref="std::map"/>, keyed by masking segment track number,
+        /// A reference to a masking geometries <see cref="TrackIndexedTable"/>, indexed by masking segment track number,
         /// which provides a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
         /// </param>
-        /// <param name="croppingSegmentFrames">A reference to a cropping segment frame data <see cref="std::map"/> keyed by the cropping segment's track number.</param>
-        D2DRendererBase(std::map<int, std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, std::map<int, CropSegmentFrameDataItem>& croppingSegmentFrames);
+        /// <param name="croppingSegmentFrames">A reference to a cropping segment frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.</param>
+        /// <param name="tracksMaskingDirtyRect">Whether to accumulate the bounds of changed masking geometries in <see cref="_maskingDirtyRect"/>. Defaults to false.</param>
+        D2DRendererBase(TrackIndexedTable<std::pair<std::shared_ptr<MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, TrackIndexedTable<CropSegmentFrameDataItem>& croppingSegmentFrames, const bool tracksMaskingDirtyRect = false);
 
     public:
         /// <summary>
@@ -63,6 +89,20 @@ namespace VideoScriptEditor::Unmanaged
         /// </summary>
         void UpdateMaskingGeometryGroup();
 
+        /// <summary>
+        /// Adds the bounds of a masking <see cref="ID2D1Geometry"/> to the masking dirty rectangle.
+        /// Called for geometries that are about to be removed, so that the area they masked is redrawn.
+        /// Does nothing unless the renderer tracks the masking dirty rectangle.
+        /// </summary>
+        /// <param name="maskingGeometry">(IN) A reference to a smart pointer to the masking <see cref="ID2D1Geometry"/>. Ignored if null.</param>
+        void InvalidateMaskingGeometryBounds(const ID2D1GeometryPtr& maskingGeometry);
+
+        /// <summary>
+        /// Sets the standard deviation of the Gaussian blur applied to masked areas.
+        /// </summary>
+        /// <param name="standardDeviation">(IN) The blur standard deviation. Defaults to <see cref="DefaultBlurStandardDeviation"/>.</param>
+        void SetBlurStandardDeviation(const float standardDeviation);
+
     protected:
 
         /// <summary>
@@ -75,6 +115,17 @@ namespace VideoScriptEditor::Unmanaged
         /// </summary>
         void CreateGaussianBlurEffect();
 
+        /// <summary>
+        /// Gets whether any masking geometry has changed since the masking dirty rectangle was last reset.
+        /// </summary>
+        /// <returns>True if the masking dirty rectangle isn't empty, False otherwise.</returns>
+        bool HasMaskingDirtyRect() const { return _maskingDirtyRect.left < _maskingDirtyRect.right && _maskingDirtyRect.top < _maskingDirtyRect.bottom; }
+
+        /// <summary>
+        /// Resets the masking dirty rectangle to empty. Done once the changed masking geometry has been rendered.
+        /// </summary>
+        void ResetMaskingDirtyRect();
+
         /// <summary>
         /// Creates a compatible render target bitmap for intermediate drawing.
         /// </summary>
@@ -116,14 +167,50 @@ namespace VideoScriptEditor::Unmanaged
         /// </summary>
         /// <param name="sourceFrameBitmap">(IN) The <see cref="ID2D1Bitmap"/> containing the content to draw and blur.</param>
         /// <param name="renderTargetBitmap">(IN/OUT) The <see cref="ID2D1Bitmap"/> target to render to.</param>
-        void RenderBlurMask(ID2D1Bitmap1* sourceFrameBitmap, ID2D1Bitmap1* renderTargetBitmap);
+        /// <param name="dirtyRect">
+        /// (IN) An optional pointer to a rectangle limiting the area that is redrawn, when <paramref name="renderTargetBitmap"/> already contains
+        /// a blur masked render of <paramref name="sourceFrameBitmap"/> that is only out of date within that area. Defaults to null, redrawing the entire frame.
+        /// </param>
+        /// <param name="blurredSourceFrameImage">
+        /// (IN) An optional pointer to a previously rendered Gaussian blur of <paramref name="sourceFrameBitmap"/> to draw within the mask
+        /// instead of evaluating <see cref="_gaussianBlurEffect"/>. Defaults to null, evaluating the blur effect.
+        /// </param>
+        /// <returns>The pixel aligned area of <paramref name="renderTargetBitmap"/> that was redrawn.</returns>
+        D2D1_RECT_U RenderBlurMask(ID2D1Bitmap1* sourceFrameBitmap, ID2D1Bitmap1* renderTargetBitmap, const D2D1_RECT_F* dirtyRect = nullptr, ID2D1Image* blurredSourceFrameImage = nullptr);
+
+        /// <summary>
+        /// Renders an unmasked Gaussian blur of a frame using <see cref="_gaussianBlurEffect"/>.
+        /// </summary>
+        /// <param name="sourceFrameBitmap">(IN) The <see cref="ID2D1Bitmap"/> containing the content to blur.</param>
+        /// <param name="renderTargetBitmap">(OUT) The <see cref="ID2D1Bitmap"/> target to render the blurred frame to.</param>
+        void RenderBlurredFrame(ID2D1Bitmap1* sourceFrameBitmap, ID2D1Bitmap1* renderTargetBitmap);
+
+        /// <summary>
+        /// Gets the standard deviation of the Gaussian blur rendered by <see cref="_gaussianBlurEffect"/>.
+        /// </summary>
+        /// <returns>The blur standard deviation.</returns>
+        float GetBlurStandardDeviation() const { return _blurStandardDeviation; }
 
         /// <summary>
         /// Renders a single or multi-segment crop of a source frame <see cref="ID2D1Bitmap"/>.
         /// In the case of a multi-segment crop, the segments are scaled to best fit height and drawn horizontally from left to right.
         /// </summary>
         /// <param name="sourceFrameBitmap">(IN) The source <see cref="ID2D1Bitmap"/> containing the content to crop.</param>
-        void RenderCroppedFrameInternal(ID2D1Bitmap* sourceFrameBitmap);
+        /// <param name="applyBlurMask">
+        /// (IN) Whether to blur the masked areas of <paramref name="sourceFrameBitmap"/> while cropping, in the same pass.
+        /// Only the masked area visible through each crop viewport is blurred. Defaults to false.
+        /// </param>
+        void RenderCroppedFrameInternal(ID2D1Bitmap* sourceFrameBitmap, const bool applyBlurMask = false);
+
+        /// <summary>
+        /// Draws a source frame <see cref="ID2D1Bitmap"/> into a crop viewport with the current transform,
+        /// optionally blurring its masked areas on top.
+        /// </summary>
+        /// <param name="sourceFrameBitmap">(IN) The source <see cref="ID2D1Bitmap"/> containing the content to draw.</param>
+        /// <param name="sourceToTargetTransform">(IN) The transform from source frame to render target coordinates, which must be the current transform.</param>
+        /// <param name="viewportRect">(IN) The area of the render target the crop is visible within.</param>
+        /// <param name="applyBlurMask">(IN) Whether to blur the masked areas of <paramref name="sourceFrameBitmap"/> visible within <paramref name="viewportRect"/>.</param>
+        void DrawCropSourceFrame(ID2D1Bitmap* sourceFrameBitmap, const D2D1_MATRIX_3X2_F& sourceToTargetTransform, const D2D1_RECT_F& viewportRect, const bool applyBlurMask);
 
         /// <summary>
         /// Calculates the scaled bounds for rendering a single or multi-segment crop.
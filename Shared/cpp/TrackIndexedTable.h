@@ -0,0 +1,240 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace VideoScriptEditor::Unmanaged
+{
+    /// <summary>
+    /// A table of active segment items indexed by zero-based track number.
+    /// </summary>
+    /// <remarks>
+    /// Track numbers are small dense integers, so items are stored in a flat <see cref="std::vector"/> indexed by track number,
+    /// with a bitset recording which tracks are active. Insertion and lookup are O(1)
+    /// and the active set is compared a 64-bit word at a time when removing inactive items.
+    /// Iteration visits active items in track number order, like a <see cref="std::map"/> keyed by track number.
+    /// Inserting a track number above any previously inserted invalidates references to items, as with a <see cref="std::vector"/>.
+    /// </remarks>
+    /// <typeparam name="T">The default constructible item data type.</typeparam>
+    template<class T>
+    class TrackIndexedTable
+    {
+    public:
+        /// <summary>A track number and item pair, as stored in the table.</summary>
+        using value_type = std::pair<const int, T>;
+
+        /// <summary>The type of item counts.</summary>
+        using size_type = size_t;
+
+    private:
+        /// <summary>The number of track bits in each word of <see cref="_activeTrackBits"/>.</summary>
+        static constexpr size_t TrackBitsPerWord = 64;
+
+        /// <summary>Track number and item pairs, indexed by track number. Items of inactive tracks are default constructed.</summary>
+        std::vector<value_type> _slots;
+
+        /// <summary>A bitset of active track numbers. Bit (trackNumber % 64) of word (trackNumber / 64) is set if the track is active.</summary>
+        std::vector<uint64_t> _activeTrackBits;
+
+        /// <summary>The number of active tracks.</summary>
+        size_type _activeCount = 0;
+
+        /// <summary>
+        /// Scratch bitset of the track numbers to keep active, reused by <see cref="RemoveInactive"/> so that it doesn't allocate on each call.
+        /// Only meaningful during a call.
+        /// </summary>
+        std::vector<uint64_t> _keepTrackBits;
+
+        /// <summary>
+        /// Iterates the active track number and item pairs of a <see cref="TrackIndexedTable"/> in track number order.
+        /// </summary>
+        template<class Table, class Value>
+        class IteratorBase
+        {
+            Table* _table;
+            size_t _trackNumber;
+
+            void SkipInactiveTracks()
+            {
+                while (_trackNumber < _table->_slots.size() && !_table->IsActive(static_cast<int>(_trackNumber)))
+                {
+                    _trackNumber++;
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Value;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value*;
+            using reference = Value&;
+
+            IteratorBase() : _table(nullptr), _trackNumber(0) {}
+
+            IteratorBase(Table* table, const size_t trackNumber) : _table(table), _trackNumber(trackNumber)
+            {
+                SkipInactiveTracks();
+            }
+
+            reference operator*() const { return _table->_slots[_trackNumber]; }
+            pointer operator->() const { return &_table->_slots[_trackNumber]; }
+
+            IteratorBase& operator++()
+            {
+                _trackNumber++;
+                SkipInactiveTracks();
+                return *this;
+            }
+
+            IteratorBase operator++(int)
+            {
+                IteratorBase previous = *this;
+                ++(*this);
+                return previous;
+            }
+
+            bool operator==(const IteratorBase& other) const { return _trackNumber == other._trackNumber; }
+            bool operator!=(const IteratorBase& other) const { return _trackNumber != other._trackNumber; }
+        };
+
+    public:
+        using iterator = IteratorBase<TrackIndexedTable, value_type>;
+        using const_iterator = IteratorBase<const TrackIndexedTable, const value_type>;
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, _slots.size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, _slots.size()); }
+
+        /// <summary>Gets whether no tracks are active.</summary>
+        bool empty() const { return _activeCount == 0; }
+
+        /// <summary>Gets the number of active tracks.</summary>
+        size_type size() const { return _activeCount; }
+
+        /// <summary>
+        /// Gets whether a track is active.
+        /// </summary>
+        /// <param name="trackNumber">(IN) The zero-based track number.</param>
+        /// <returns>True if the track is active, False otherwise.</returns>
+        bool IsActive(const int trackNumber) const
+        {
+            const size_t wordIndex = static_cast<size_t>(trackNumber) / TrackBitsPerWord;
+            return wordIndex < _activeTrackBits.size() && (_activeTrackBits[wordIndex] & (1ULL << (trackNumber % TrackBitsPerWord))) != 0;
+        }
+
+        /// <summary>
+        /// Reserves storage for tracks up to a track number, so that inserting them doesn't invalidate item references.
+        /// </summary>
+        /// <param name="maxTrackNumber">(IN) The highest zero-based track number to reserve storage for.</param>
+        void Reserve(const int maxTrackNumber)
+        {
+            _slots.reserve(static_cast<size_t>(maxTrackNumber) + 1);
+        }
+
+        /// <summary>
+        /// Gets the item of a track, activating the track with a default constructed item if it isn't active.
+        /// </summary>
+        /// <param name="trackNumber">(IN) The zero-based track number.</param>
+        /// <returns>A reference to the track's item.</returns>
+        T& operator[](const int trackNumber)
+        {
+            assert(trackNumber >= 0);
+
+            const size_t slotIndex = static_cast<size_t>(trackNumber);
+            while (_slots.size() <= slotIndex)
+            {
+                _slots.emplace_back(static_cast<int>(_slots.size()), T());
+            }
+
+            const size_t wordIndex = slotIndex / TrackBitsPerWord;
+            if (_activeTrackBits.size() <= wordIndex)
+            {
+                _activeTrackBits.resize(wordIndex + 1, 0);
+            }
+
+            const uint64_t trackBit = 1ULL << (slotIndex % TrackBitsPerWord);
+            if ((_activeTrackBits[wordIndex] & trackBit) == 0)
+            {
+                _activeTrackBits[wordIndex] |= trackBit;
+                _activeCount++;
+            }
+
+            return _slots[slotIndex].second;
+        }
+
+        /// <summary>
+        /// Deactivates all tracks, releasing their items.
+        /// </summary>
+        void clear()
+        {
+            RemoveInactive(std::vector<int>());
+        }
+
+        /// <summary>
+        /// Deactivates all tracks whose track numbers aren't in a collection, releasing their items.
+        /// </summary>
+        /// <param name="activeTrackNumbers">(IN) The zero-based track numbers to keep active.</param>
+        /// <param name="onRemoving">
+        /// (IN) A function called with the track number and item of each track being deactivated, before its item is released.
+        /// </param>
+        /// <returns>The number of deactivated tracks.</returns>
+        template<class OnRemoving>
+        size_type RemoveInactive(const std::vector<int>& activeTrackNumbers, OnRemoving&& onRemoving)
+        {
+            if (_activeCount == 0)
+            {
+                return 0;
+            }
+
+            // Clears the scratch bitset, only reallocating if the table has grown since the last call
+            _keepTrackBits.assign(_activeTrackBits.size(), 0);
+            for (const int trackNumber : activeTrackNumbers)
+            {
+                const size_t wordIndex = static_cast<size_t>(trackNumber) / TrackBitsPerWord;
+                if (wordIndex < _keepTrackBits.size())
+                {
+                    _keepTrackBits[wordIndex] |= 1ULL << (trackNumber % TrackBitsPerWord);
+                }
+            }
+
+            size_type removedCount = 0;
+            for (size_t wordIndex = 0; wordIndex < _activeTrackBits.size(); wordIndex++)
+            {
+                uint64_t removedTrackBits = _activeTrackBits[wordIndex] & ~_keepTrackBits[wordIndex];
+                if (removedTrackBits == 0)
+                {
+                    continue;
+                }
+
+                _activeTrackBits[wordIndex] &= _keepTrackBits[wordIndex];
+
+                for (size_t bitIndex = 0; removedTrackBits != 0; bitIndex++, removedTrackBits >>= 1)
+                {
+                    if ((removedTrackBits & 1) != 0)
+                    {
+                        value_type& slot = _slots[(wordIndex * TrackBitsPerWord) + bitIndex];
+                        onRemoving(slot.first, slot.second);
+                        slot.second = T();
+                        removedCount++;
+                    }
+                }
+            }
+
+            _activeCount -= removedCount;
+            return removedCount;
+        }
+
+        /// <summary>
+        /// Deactivates all tracks whose track numbers aren't in a collection, releasing their items.
+        /// </summary>
+        /// <param name="activeTrackNumbers">(IN) The zero-based track numbers to keep active.</param>
+        /// <returns>The number of deactivated tracks.</returns>
+        size_type RemoveInactive(const std::vector<int>& activeTrackNumbers)
+        {
+            return RemoveInactive(activeTrackNumbers, [](const int, const T&) {});
+        }
+    };
+}
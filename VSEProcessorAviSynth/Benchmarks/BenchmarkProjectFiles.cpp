@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "BenchmarkProjectFiles.h"
+
+using namespace ProjectGenerator;
+
+namespace Benchmarks
+{
+    using namespace std;
+
+    namespace
+    {
+        /// <summary>
+        /// The seed for all benchmark scenario projects, so that runs are comparable.
+        /// </summary>
+        constexpr uint32_t BenchmarkProjectSeed = 1;
+
+        constexpr const char* GetScenarioName(const BenchmarkScenario scenario)
+        {
+            switch (scenario)
+            {
+            case BenchmarkScenario::CropOnly:
+                return "CropOnly";
+            case BenchmarkScenario::RotatedCrop:
+                return "RotatedCrop";
+            case BenchmarkScenario::MultiSegmentCrop:
+                return "MultiSegmentCrop";
+            case BenchmarkScenario::EllipseMask:
+                return "EllipseMask";
+            case BenchmarkScenario::PolygonMask:
+                return "PolygonMask";
+            default:
+                return "Combined";
+            }
+        }
+    }
+
+    SyntheticProjectOptions GetScenarioProjectOptions(const BenchmarkScenario scenario, const int frameWidth, const int frameHeight, const int frameCount)
+    {
+        SyntheticProjectOptions options;
+        options.Seed = BenchmarkProjectSeed;
+        options.FrameWidth = frameWidth;
+        options.FrameHeight = frameHeight;
+        options.FrameCount = frameCount;
+        options.KeyFramesPerSegment = (frameCount - 1) / BenchmarkKeyFrameInterval + 2;
+        options.CropTrackCount = 0;
+        options.MaskTrackCount = 0;
+
+        switch (scenario)
+        {
+        case BenchmarkScenario::CropOnly:
+            options.CropTrackCount = 1;
+            break;
+        case BenchmarkScenario::RotatedCrop:
+            options.CropTrackCount = 1;
+            options.MaxCropAngle = 15.0;
+            break;
+        case BenchmarkScenario::MultiSegmentCrop:
+            options.CropTrackCount = 3;
+            break;
+        case BenchmarkScenario::EllipseMask:
+            options.MaskTrackCount = 1;
+            options.MaskShapes = MaskShape::Ellipse;
+            break;
+        case BenchmarkScenario::PolygonMask:
+            options.MaskTrackCount = 1;
+            options.MaskShapes = MaskShape::Polygon;
+            options.PolygonVertexCount = 8;
+            break;
+        case BenchmarkScenario::Combined:
+            options.CropTrackCount = 2;
+            options.MaxCropAngle = 10.0;
+            options.MaskTrackCount = 3;
+            options.MaskShapes = MaskShape::Mixed;
+            options.Letterbox = LetterboxMode::ToSize;
+            break;
+        }
+
+        return options;
+    }
+
+    std::string WriteBenchmarkProjectFile(const SyntheticProjectOptions& options, const std::string_view& projectName)
+    {
+        const filesystem::path projectFilePath = filesystem::temp_directory_path() / fmt::format("VSEProcessorAviSynth.Benchmark.{:s}.vseproj", projectName);
+
+        SyntheticProjectGenerator projectGenerator(options);
+        projectGenerator.WriteProjectFile(projectFilePath);
+
+        return projectFilePath.string();
+    }
+
+    std::string WriteBenchmarkProjectFile(const BenchmarkScenario scenario, const int frameWidth, const int frameHeight, const int frameCount)
+    {
+        return WriteBenchmarkProjectFile(GetScenarioProjectOptions(scenario, frameWidth, frameHeight, frameCount),
+                                         fmt::format("{:s}.{:d}x{:d}", GetScenarioName(scenario), frameWidth, frameHeight));
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "..\ProjectGenerator\SyntheticProjectGenerator.h"
+
+namespace Benchmarks
+{
+    /// <summary>
+    /// Describes the segments contained in a synthetic benchmark project.
+    /// Every segment spans the whole clip and is key framed at a regular interval, so each frame interpolates new segment data.
+    /// </summary>
+    enum class BenchmarkScenario
+    {
+        /// <summary>A single axis-aligned crop, processed through AviSynth filters.</summary>
+        CropOnly,
+
+        /// <summary>A single rotated crop, processed through Direct2D.</summary>
+        RotatedCrop,
+
+        /// <summary>Three axis-aligned crop tracks, processed through Direct2D.</summary>
+        MultiSegmentCrop,
+
+        /// <summary>A single moving ellipse blur mask.</summary>
+        EllipseMask,
+
+        /// <summary>A single moving octagon polygon blur mask.</summary>
+        PolygonMask,
+
+        /// <summary>Rectangle, ellipse and polygon blur masks with two rotated crop tracks, letterboxed to a taller size.</summary>
+        Combined
+    };
+
+    /// <summary>
+    /// The number of frames between segment key frames in benchmark scenario projects.
+    /// </summary>
+    constexpr int BenchmarkKeyFrameInterval = 48;
+
+    /// <summary>
+    /// Gets the synthetic project generator options for a benchmark scenario.
+    /// </summary>
+    /// <param name="scenario">(IN) The <see cref="BenchmarkScenario"/> describing the segments to generate.</param>
+    /// <param name="frameWidth">(IN) The width of the source clip in pixels.</param>
+    /// <param name="frameHeight">(IN) The height of the source clip in pixels.</param>
+    /// <param name="frameCount">(IN) The number of frames in the source clip.</param>
+    /// <returns>The <see cref="ProjectGenerator::SyntheticProjectOptions"/> for the scenario.</returns>
+    ProjectGenerator::SyntheticProjectOptions GetScenarioProjectOptions(const BenchmarkScenario scenario, const int frameWidth, const int frameHeight, const int frameCount);
+
+    /// <summary>
+    /// Writes a synthetic Video Script Editor project file to the temporary directory.
+    /// </summary>
+    /// <param name="options">(IN) The <see cref="ProjectGenerator::SyntheticProjectOptions"/> controlling the project content.</param>
+    /// <param name="projectName">(IN) A name distinguishing the project file from those of other benchmarks.</param>
+    /// <returns>The absolute path of the written project file.</returns>
+    std::string WriteBenchmarkProjectFile(const ProjectGenerator::SyntheticProjectOptions& options, const std::string_view& projectName);
+
+    /// <summary>
+    /// Writes a synthetic Video Script Editor project file for a benchmark scenario to the temporary directory,
+    /// with segment coordinates scaled to the frame size.
+    /// </summary>
+    /// <param name="scenario">(IN) The <see cref="BenchmarkScenario"/> describing the segments to write.</param>
+    /// <param name="frameWidth">(IN) The width of the source clip in pixels.</param>
+    /// <param name="frameHeight">(IN) The height of the source clip in pixels.</param>
+    /// <param name="frameCount">(IN) The number of frames in the source clip.</param>
+    /// <returns>The absolute path of the written project file.</returns>
+    std::string WriteBenchmarkProjectFile(const BenchmarkScenario scenario, const int frameWidth, const int frameHeight, const int frameCount);
+}
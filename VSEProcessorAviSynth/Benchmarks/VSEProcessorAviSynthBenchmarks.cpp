@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "BenchmarkProjectFiles.h"
+#include "..\..\Shared\cpp\AviSynthTestEnvironment.h"
+
+namespace Benchmarks
+{
+    using namespace std;
+
+    /// <summary>
+    /// The number of frames in the stand-in source clip.
+    /// Frames are requested in order, so AviSynth's frame cache never serves a repeated request within a benchmark run.
+    /// </summary>
+    constexpr int BenchmarkClipFrameCount = 100000;
+
+    /// <summary>
+    /// A script which processes a synthetic project over a static color bars clip,
+    /// so that benchmarks measure the plugin rather than source decoding.
+    /// </summary>
+    constexpr auto BENCHMARK_SCRIPT =
+R"(LoadPlugin("VSEProcessorAviSynth.dll")
+ColorBars({0:d}, {1:d}, "YV12").AssumeFPS("ntsc_film").KillAudio()
+Trim(0, {2:d})
+VSEProcessorAviSynth("{3:s}")
+)";
+
+    /// <summary>
+    /// Reports per-frame latency percentiles and the processing frame rate as benchmark counters.
+    /// </summary>
+    /// <param name="state">(IN/OUT) The benchmark state to report counters to.</param>
+    /// <param name="frameLatenciesMs">(IN/OUT) The latency of each frame request in milliseconds. Sorted in place.</param>
+    void ReportFrameLatencyCounters(benchmark::State& state, vector<double>& frameLatenciesMs)
+    {
+        if (frameLatenciesMs.empty())
+        {
+            return;
+        }
+
+        sort(frameLatenciesMs.begin(), frameLatenciesMs.end());
+
+        auto percentile = [&frameLatenciesMs](const double fraction) {
+            const size_t index = static_cast<size_t>(fraction * (frameLatenciesMs.size() - 1) + 0.5);
+            return frameLatenciesMs[index];
+        };
+
+        state.counters["p50_ms"] = percentile(0.50);
+        state.counters["p90_ms"] = percentile(0.90);
+        state.counters["p99_ms"] = percentile(0.99);
+        state.counters["max_ms"] = frameLatenciesMs.back();
+        state.counters["fps"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    /// <summary>
+    /// Benchmarks VSEProcessorAviSynth frame requests for a project file.
+    /// </summary>
+    /// <param name="state">(IN/OUT) The benchmark state.</param>
+    /// <param name="projectFilePath">(IN) The path of the project file to process. Deleted when the benchmark completes.</param>
+    /// <param name="frameWidth">(IN) The width of the source clip in pixels.</param>
+    /// <param name="frameHeight">(IN) The height of the source clip in pixels.</param>
+    void RunGetFrameBenchmark(benchmark::State& state, const string& projectFilePath, const int frameWidth, const int frameHeight)
+    {
+        AviSynthTestEnvironment aviSynthEnv;
+        if (!aviSynthEnv.CreateScriptEnvironment()
+            || !aviSynthEnv.LoadScriptFromString(fmt::format(BENCHMARK_SCRIPT, frameWidth, frameHeight, BenchmarkClipFrameCount - 1, projectFilePath)))
+        {
+            state.SkipWithError("Failed to load the benchmark script.");
+            filesystem::remove(projectFilePath);
+            return;
+        }
+
+        vector<double> frameLatenciesMs;
+        int frameNumber = 0;
+
+        for (auto _ : state)
+        {
+            const auto requestStartTime = chrono::steady_clock::now();
+
+            PVideoFrame videoFrame = aviSynthEnv.GetVideoFrame(frameNumber);
+            benchmark::DoNotOptimize(videoFrame);
+
+            frameLatenciesMs.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - requestStartTime).count());
+            frameNumber = (frameNumber + 1) % BenchmarkClipFrameCount;
+        }
+
+        ReportFrameLatencyCounters(state, frameLatenciesMs);
+
+        aviSynthEnv.DeleteScriptEnvironment();
+        filesystem::remove(projectFilePath);
+    }
+
+    /// <summary>
+    /// Benchmarks VSEProcessorAviSynth frame requests for a synthetic project scenario.
+    /// </summary>
+    /// <param name="state">(IN/OUT) The benchmark state. Range arguments 0 and 1 are the frame width and height.</param>
+    /// <param name="scenario">(IN) The <see cref="BenchmarkScenario"/> describing the project segments.</param>
+    void BM_GetFrame(benchmark::State& state, const BenchmarkScenario scenario)
+    {
+        const int frameWidth = static_cast<int>(state.range(0));
+        const int frameHeight = static_cast<int>(state.range(1));
+
+        RunGetFrameBenchmark(state, WriteBenchmarkProjectFile(scenario, frameWidth, frameHeight, BenchmarkClipFrameCount), frameWidth, frameHeight);
+    }
+
+    /// <summary>
+    /// Benchmarks VSEProcessorAviSynth frame requests at 1920x1080 as the number of masking tracks grows.
+    /// </summary>
+    /// <param name="state">(IN/OUT) The benchmark state. Range argument 0 is the number of masking tracks.</param>
+    void BM_GetFrameMaskTrackScaling(benchmark::State& state)
+    {
+        const int maskTrackCount = static_cast<int>(state.range(0));
+
+        ProjectGenerator::SyntheticProjectOptions options = GetScenarioProjectOptions(BenchmarkScenario::Combined, 1920, 1080, BenchmarkClipFrameCount);
+        options.CropTrackCount = 0;
+        options.MaskTrackCount = maskTrackCount;
+        options.Letterbox = ProjectGenerator::LetterboxMode::None;
+
+        RunGetFrameBenchmark(state, WriteBenchmarkProjectFile(options, fmt::format("MaskTracks{:d}", maskTrackCount)), 1920, 1080);
+    }
+
+#define VSE_FRAME_SIZE_ARGS Args({ 854, 480 })->Args({ 1920, 1080 })->Args({ 3840, 2160 })->ArgNames({ "width", "height" })->Unit(benchmark::kMillisecond)
+
+    BENCHMARK_CAPTURE(BM_GetFrame, CropOnly, BenchmarkScenario::CropOnly)->VSE_FRAME_SIZE_ARGS;
+    BENCHMARK_CAPTURE(BM_GetFrame, RotatedCrop, BenchmarkScenario::RotatedCrop)->VSE_FRAME_SIZE_ARGS;
+    BENCHMARK_CAPTURE(BM_GetFrame, MultiSegmentCrop, BenchmarkScenario::MultiSegmentCrop)->VSE_FRAME_SIZE_ARGS;
+    BENCHMARK_CAPTURE(BM_GetFrame, EllipseMask, BenchmarkScenario::EllipseMask)->VSE_FRAME_SIZE_ARGS;
+    BENCHMARK_CAPTURE(BM_GetFrame, PolygonMask, BenchmarkScenario::PolygonMask)->VSE_FRAME_SIZE_ARGS;
+    BENCHMARK_CAPTURE(BM_GetFrame, Combined, BenchmarkScenario::Combined)->VSE_FRAME_SIZE_ARGS;
+
+    BENCHMARK(BM_GetFrameMaskTrackScaling)->RangeMultiplier(4)->Range(1, 64)->ArgName("mask_tracks")->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,47 @@
+#include "pch.h"
+#include "BenchmarkProjectFiles.h"
+#include "..\VSEProcessorAviSynth\VSEProjectFileParser.h"
+
+namespace Benchmarks
+{
+    using namespace std;
+
+    /// <summary>
+    /// Benchmarks parsing synthetic project files of increasing size.
+    /// </summary>
+    /// <param name="state">
+    /// (IN/OUT) The benchmark state. Range arguments 0, 1 and 2 are the number of cropping and masking tracks each,
+    /// the number of segments per track and the number of key frames per segment.
+    /// </param>
+    void BM_ParseProject(benchmark::State& state)
+    {
+        ProjectGenerator::SyntheticProjectOptions options;
+        options.CropTrackCount = static_cast<int>(state.range(0));
+        options.MaskTrackCount = static_cast<int>(state.range(0));
+        options.SegmentsPerTrack = static_cast<int>(state.range(1));
+        options.KeyFramesPerSegment = static_cast<int>(state.range(2));
+        options.MaxCropAngle = 15.0;
+
+        const string projectFilePath = WriteBenchmarkProjectFile(options, fmt::format("Parse.{:d}.{:d}.{:d}", state.range(0), state.range(1), state.range(2)));
+        const int64_t projectFileSize = static_cast<int64_t>(filesystem::file_size(projectFilePath));
+
+        for (auto _ : state)
+        {
+            VSEProject project;
+            VSEProjectFileParser projectFileParser(project);
+            projectFileParser.Parse(projectFilePath.c_str());
+
+            benchmark::DoNotOptimize(project.SegmentModels.data());
+        }
+
+        const double keyFrameCount = static_cast<double>(options.CropTrackCount + options.MaskTrackCount) * options.SegmentsPerTrack * options.KeyFramesPerSegment;
+
+        state.SetBytesProcessed(state.iterations() * projectFileSize);
+        state.counters["key_frames"] = keyFrameCount;
+        state.counters["key_frames_per_second"] = benchmark::Counter(keyFrameCount * state.iterations(), benchmark::Counter::kIsRate);
+
+        filesystem::remove(projectFilePath);
+    }
+
+    BENCHMARK(BM_ParseProject)->ArgsProduct({ { 1, 8, 32 }, { 1, 16 }, { 2, 32, 128 } })->ArgNames({ "tracks", "segments", "key_frames" })->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,183 @@
+// ProjectGenerator.cpp : Generates synthetic Video Script Editor project files for stress testing and benchmarking.
+
+#include "pch.h"
+#include "SyntheticProjectGenerator.h"
+#include <iostream>
+
+using namespace ProjectGenerator;
+using namespace std;
+
+namespace
+{
+    constexpr auto USAGE_TEXT =
+R"(Usage: ProjectGenerator <output file> [options]
+
+Options:
+  --seed <n>                  Pseudo-random seed (default 1)
+  --frame-size <w>x<h>        Source video frame size (default 1920x1080)
+  --frame-count <n>           Source video frame count (default 10000)
+  --crop-tracks <n>           Number of cropping tracks (default 1)
+  --mask-tracks <n>           Number of masking tracks (default 1)
+  --segments-per-track <n>    Number of segments on each track (default 1)
+  --keyframes-per-segment <n> Number of key frames in each segment (default 2)
+  --polygon-vertices <n>      Number of vertices in each polygon mask (default 8)
+  --max-crop-angle <degrees>  Maximum crop rotation angle, 0 for no rotation (default 0)
+  --mask-shape <shape>        mixed, rectangle, ellipse or polygon (default mixed)
+  --letterbox <mode>          none, size or aspect-ratio (default none)
+)";
+
+    int ParseIntArgument(const string_view& optionName, const char* value)
+    {
+        try
+        {
+            return stoi(value);
+        }
+        catch (const logic_error&)
+        {
+            throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+        }
+    }
+
+    double ParseDoubleArgument(const string_view& optionName, const char* value)
+    {
+        try
+        {
+            return stod(value);
+        }
+        catch (const logic_error&)
+        {
+            throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+        }
+    }
+
+    SyntheticProjectOptions ParseOptions(const int argc, char* argv[])
+    {
+        SyntheticProjectOptions options;
+
+        for (int argIndex = 2; argIndex < argc; argIndex += 2)
+        {
+            const string_view optionName(argv[argIndex]);
+            if (argIndex + 1 >= argc)
+            {
+                throw invalid_argument(fmt::format("Missing value for option {:s}.", optionName));
+            }
+
+            const char* value = argv[argIndex + 1];
+            const string_view valueView(value);
+
+            if (optionName == "--seed")
+            {
+                options.Seed = static_cast<uint32_t>(ParseIntArgument(optionName, value));
+            }
+            else if (optionName == "--frame-size")
+            {
+                const size_t separatorPosition = valueView.find('x');
+                if (separatorPosition == string_view::npos)
+                {
+                    throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+                }
+
+                options.FrameWidth = ParseIntArgument(optionName, string(valueView.substr(0, separatorPosition)).c_str());
+                options.FrameHeight = ParseIntArgument(optionName, value + separatorPosition + 1);
+            }
+            else if (optionName == "--frame-count")
+            {
+                options.FrameCount = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--crop-tracks")
+            {
+                options.CropTrackCount = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--mask-tracks")
+            {
+                options.MaskTrackCount = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--segments-per-track")
+            {
+                options.SegmentsPerTrack = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--keyframes-per-segment")
+            {
+                options.KeyFramesPerSegment = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--polygon-vertices")
+            {
+                options.PolygonVertexCount = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--max-crop-angle")
+            {
+                options.MaxCropAngle = ParseDoubleArgument(optionName, value);
+            }
+            else if (optionName == "--mask-shape")
+            {
+                if (valueView == "mixed")
+                {
+                    options.MaskShapes = MaskShape::Mixed;
+                }
+                else if (valueView == "rectangle")
+                {
+                    options.MaskShapes = MaskShape::Rectangle;
+                }
+                else if (valueView == "ellipse")
+                {
+                    options.MaskShapes = MaskShape::Ellipse;
+                }
+                else if (valueView == "polygon")
+                {
+                    options.MaskShapes = MaskShape::Polygon;
+                }
+                else
+                {
+                    throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+                }
+            }
+            else if (optionName == "--letterbox")
+            {
+                if (valueView == "none")
+                {
+                    options.Letterbox = LetterboxMode::None;
+                }
+                else if (valueView == "size")
+                {
+                    options.Letterbox = LetterboxMode::ToSize;
+                }
+                else if (valueView == "aspect-ratio")
+                {
+                    options.Letterbox = LetterboxMode::ToAspectRatio;
+                }
+                else
+                {
+                    throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+                }
+            }
+            else
+            {
+                throw invalid_argument(fmt::format("Unknown option {:s}.", optionName));
+            }
+        }
+
+        return options;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        cerr << USAGE_TEXT;
+        return 1;
+    }
+
+    try
+    {
+        SyntheticProjectGenerator projectGenerator(ParseOptions(argc, argv));
+        projectGenerator.WriteProjectFile(argv[1]);
+    }
+    catch (const exception& ex)
+    {
+        cerr << ex.what() << endl << endl << USAGE_TEXT;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+#include "pch.h"
+#include "SyntheticProjectGenerator.h"
+#include "..\VSEProcessorAviSynth\VSEProjectFileElementNames.h"
+#include <fstream>
+#include <numbers>
+
+using namespace tinyxml2;
+
+namespace ProjectGenerator
+{
+    using namespace std;
+
+    namespace
+    {
+        constexpr auto XsiNamespace = "http://www.w3.org/2001/XMLSchema-instance";
+        constexpr auto PrimitivesNamespace = "http://schemas.datacontract.org/2004/07/VideoScriptEditor.Models.Primitives";
+        constexpr auto SystemDrawingNamespace = "http://schemas.datacontract.org/2004/07/System.Drawing";
+
+        template<typename T>
+        void PushTextElement(XMLPrinter& printer, const char* elementName, const T value)
+        {
+            printer.OpenElement(elementName);
+            printer.PushText(value);
+            printer.CloseElement(true);
+        }
+
+        void PushPointElement(XMLPrinter& printer, const char* elementName, const double x, const double y, const bool declareNamespace)
+        {
+            printer.OpenElement(elementName);
+            if (declareNamespace)
+            {
+                printer.PushAttribute("xmlns:a", PrimitivesNamespace);
+            }
+
+            PushTextElement(printer, "a:x", x);
+            PushTextElement(printer, "a:y", y);
+            printer.CloseElement();
+        }
+
+        void PushNilElement(XMLPrinter& printer, const char* elementName)
+        {
+            printer.OpenElement(elementName);
+            printer.PushAttribute("i:nil", "true");
+            printer.CloseElement();
+        }
+    }
+
+    SyntheticProjectGenerator::SyntheticProjectGenerator(const SyntheticProjectOptions& options)
+        : _options(options), _randomEngine(options.Seed)
+    {
+        if (_options.FrameWidth < 16 || _options.FrameHeight < 16)
+        {
+            throw invalid_argument("The frame size must be at least 16x16 pixels.");
+        }
+
+        if (_options.CropTrackCount < 0 || _options.MaskTrackCount < 0 || _options.SegmentsPerTrack < 1)
+        {
+            throw invalid_argument("The track and segment counts must not be negative and there must be at least one segment per track.");
+        }
+
+        if (_options.FrameCount < _options.SegmentsPerTrack)
+        {
+            throw invalid_argument("The frame count must be at least the number of segments per track.");
+        }
+
+        _options.KeyFramesPerSegment = max(_options.KeyFramesPerSegment, 1);
+        _options.PolygonVertexCount = max(_options.PolygonVertexCount, 3);
+        _options.MaxCropAngle = abs(_options.MaxCropAngle);
+    }
+
+    std::string SyntheticProjectGenerator::Generate()
+    {
+        // Restart the sequence so that repeated calls generate identical projects.
+        _randomEngine.seed(_options.Seed);
+
+        XMLPrinter printer;
+        printer.OpenElement("Project");
+        printer.PushAttribute("xmlns:i", XsiNamespace);
+
+        printer.OpenElement(ElementNames::Cropping);
+        printer.OpenElement(ElementNames::CropSegments);
+        for (int trackNumber = 0; trackNumber < _options.CropTrackCount; trackNumber++)
+        {
+            WriteTrackSegments(printer, SegmentTypeAttributeValues::Crop, trackNumber);
+        }
+        printer.CloseElement();
+        printer.CloseElement();
+
+        printer.OpenElement(ElementNames::Masking);
+        printer.OpenElement(ElementNames::MaskingShapes);
+        for (int trackNumber = 0; trackNumber < _options.MaskTrackCount; trackNumber++)
+        {
+            WriteTrackSegments(printer, GetMaskSegmentType(trackNumber), trackNumber);
+        }
+        printer.CloseElement();
+        printer.CloseElement();
+
+        PushTextElement(printer, "ScriptFileSource", "Synthetic.avs");
+
+        WriteVideoProcessingOptions(printer);
+
+        printer.CloseElement();
+
+        return string(printer.CStr(), printer.CStrSize() - 1);  // CStrSize includes the null terminator
+    }
+
+    void SyntheticProjectGenerator::WriteProjectFile(const std::filesystem::path& projectFilePath)
+    {
+        const string projectXml = Generate();
+
+        ofstream projectFileStream(projectFilePath, ios::binary | ios::trunc);
+        projectFileStream.write(projectXml.data(), projectXml.size());
+        if (!projectFileStream)
+        {
+            throw runtime_error(fmt::format("Failed to write the project file '{:s}'.", projectFilePath.string()));
+        }
+    }
+
+    double SyntheticProjectGenerator::NextDouble(const double minValue, const double maxValue)
+    {
+        // mt19937 output is fully specified by the standard, unlike uniform_real_distribution.
+        const double unitValue = static_cast<double>(_randomEngine()) / 4294967296.0;
+        return minValue + (maxValue - minValue) * unitValue;
+    }
+
+    SyntheticProjectGenerator::RectD SyntheticProjectGenerator::NextFrameRect(const double minSizeFraction, const double maxSizeFraction)
+    {
+        const double width = NextDouble(minSizeFraction, maxSizeFraction) * _options.FrameWidth;
+        const double height = NextDouble(minSizeFraction, maxSizeFraction) * _options.FrameHeight;
+        const double left = NextDouble(0.0, _options.FrameWidth - width);
+        const double top = NextDouble(0.0, _options.FrameHeight - height);
+
+        return { left, top, width, height };
+    }
+
+    void SyntheticProjectGenerator::WriteTrackSegments(XMLPrinter& printer, const char* segmentType, const int trackNumber)
+    {
+        const int segmentFrameCount = _options.FrameCount / _options.SegmentsPerTrack;
+
+        for (int segmentIndex = 0; segmentIndex < _options.SegmentsPerTrack; segmentIndex++)
+        {
+            const int startFrame = segmentIndex * segmentFrameCount;
+            const int endFrame = (segmentIndex == _options.SegmentsPerTrack - 1) ? _options.FrameCount - 1 : startFrame + segmentFrameCount - 1;
+
+            // Key frame numbers must be unique, so short segments get fewer key frames.
+            const int keyFrameCount = min(_options.KeyFramesPerSegment, endFrame - startFrame + 1);
+
+            printer.OpenElement(ElementNames::Segment);
+            printer.PushAttribute("i:type", segmentType);
+
+            PushTextElement(printer, ElementNames::EndFrame, endFrame);
+
+            printer.OpenElement(ElementNames::KeyFrames);
+            for (int keyFrameIndex = 0; keyFrameIndex < keyFrameCount; keyFrameIndex++)
+            {
+                const int frameNumber = (keyFrameCount == 1)
+                                        ? startFrame
+                                        : startFrame + static_cast<int>((static_cast<int64_t>(endFrame - startFrame) * keyFrameIndex) / (keyFrameCount - 1));
+
+                printer.OpenElement(ElementNames::KeyFrame);
+                printer.PushAttribute("i:type", segmentType);
+                PushTextElement(printer, ElementNames::FrameNumber, frameNumber);
+                WriteKeyFrameValues(printer, segmentType);
+                printer.CloseElement();
+            }
+            printer.CloseElement();
+
+            PushTextElement(printer, "Name", fmt::format("{:s} {:d}.{:d}", segmentType, trackNumber, segmentIndex).c_str());
+            PushTextElement(printer, ElementNames::StartFrame, startFrame);
+            PushTextElement(printer, ElementNames::TrackNumber, trackNumber);
+
+            printer.CloseElement();
+        }
+    }
+
+    void SyntheticProjectGenerator::WriteKeyFrameValues(XMLPrinter& printer, const std::string_view segmentType)
+    {
+        if (segmentType == SegmentTypeAttributeValues::Crop)
+        {
+            const double angle = (_options.MaxCropAngle > 0.0) ? NextDouble(-_options.MaxCropAngle, _options.MaxCropAngle) : 0.0;
+            const RectD cropRect = NextFrameRect(0.2, 0.5);
+
+            PushTextElement(printer, ElementNames::Angle, angle);
+            PushTextElement(printer, ElementNames::Height, cropRect.Height);
+            PushTextElement(printer, ElementNames::Left, cropRect.Left);
+            PushTextElement(printer, ElementNames::Top, cropRect.Top);
+            PushTextElement(printer, ElementNames::Width, cropRect.Width);
+        }
+        else if (segmentType == SegmentTypeAttributeValues::MaskRectangle)
+        {
+            const RectD maskRect = NextFrameRect(0.1, 0.4);
+
+            PushTextElement(printer, ElementNames::Height, maskRect.Height);
+            PushTextElement(printer, ElementNames::Left, maskRect.Left);
+            PushTextElement(printer, ElementNames::Top, maskRect.Top);
+            PushTextElement(printer, ElementNames::Width, maskRect.Width);
+        }
+        else if (segmentType == SegmentTypeAttributeValues::MaskEllipse)
+        {
+            const RectD boundingRect = NextFrameRect(0.1, 0.4);
+            const double radiusX = boundingRect.Width / 2.0;
+            const double radiusY = boundingRect.Height / 2.0;
+
+            PushPointElement(printer, ElementNames::CenterPoint, boundingRect.Left + radiusX, boundingRect.Top + radiusY, true);
+            PushTextElement(printer, ElementNames::RadiusX, radiusX);
+            PushTextElement(printer, ElementNames::RadiusY, radiusY);
+        }
+        else
+        {
+            // A star-shaped polygon around the center of a random rectangle, which never self-intersects.
+            const RectD boundingRect = NextFrameRect(0.1, 0.4);
+            const double radiusX = boundingRect.Width / 2.0;
+            const double radiusY = boundingRect.Height / 2.0;
+            const double centerX = boundingRect.Left + radiusX;
+            const double centerY = boundingRect.Top + radiusY;
+
+            printer.OpenElement(ElementNames::Points);
+            printer.PushAttribute("xmlns:a", PrimitivesNamespace);
+            for (int vertexIndex = 0; vertexIndex < _options.PolygonVertexCount; vertexIndex++)
+            {
+                const double vertexAngle = (2.0 * numbers::pi * vertexIndex) / _options.PolygonVertexCount;
+                const double vertexRadiusScale = NextDouble(0.5, 1.0);
+                PushPointElement(printer, "a:PointD",
+                                 centerX + radiusX * vertexRadiusScale * cos(vertexAngle),
+                                 centerY + radiusY * vertexRadiusScale * sin(vertexAngle),
+                                 false);
+            }
+            printer.CloseElement();
+        }
+    }
+
+    void SyntheticProjectGenerator::WriteVideoProcessingOptions(XMLPrinter& printer)
+    {
+        printer.OpenElement(ElementNames::VideoProcessingOptions);
+
+        if (_options.Letterbox == LetterboxMode::ToAspectRatio)
+        {
+            printer.OpenElement(ElementNames::OutputVideoAspectRatio);
+            printer.PushAttribute("xmlns:a", PrimitivesNamespace);
+            PushTextElement(printer, "a:Denominator", 3);
+            PushTextElement(printer, "a:Numerator", 4);
+            printer.CloseElement();
+
+            PushTextElement(printer, ElementNames::OutputVideoResizeMode, OutputVideoResizeModeElementValues::LetterboxToAspectRatio);
+            PushNilElement(printer, ElementNames::OutputVideoSize);
+        }
+        else if (_options.Letterbox == LetterboxMode::ToSize)
+        {
+            PushNilElement(printer, ElementNames::OutputVideoAspectRatio);
+            PushTextElement(printer, ElementNames::OutputVideoResizeMode, OutputVideoResizeModeElementValues::LetterboxToSize);
+
+            // Keep the letterbox borders mod2 and never smaller than the source video.
+            const int outputHeight = max<int>(MathHelpers::RoundToNearestEvenIntegral(_options.FrameWidth * 3.0 / 4.0), _options.FrameHeight);
+
+            printer.OpenElement(ElementNames::OutputVideoSize);
+            printer.PushAttribute("xmlns:a", SystemDrawingNamespace);
+            PushTextElement(printer, "a:height", outputHeight);
+            PushTextElement(printer, "a:width", _options.FrameWidth);
+            printer.CloseElement();
+        }
+        else
+        {
+            PushNilElement(printer, ElementNames::OutputVideoAspectRatio);
+            PushTextElement(printer, ElementNames::OutputVideoResizeMode, OutputVideoResizeModeElementValues::None);
+            PushNilElement(printer, ElementNames::OutputVideoSize);
+        }
+
+        printer.CloseElement();
+    }
+
+    const char* SyntheticProjectGenerator::GetMaskSegmentType(const int trackNumber)
+    {
+        MaskShape maskShape = _options.MaskShapes;
+        if (maskShape == MaskShape::Mixed)
+        {
+            constexpr MaskShape MixedMaskShapes[] = { MaskShape::Rectangle, MaskShape::Ellipse, MaskShape::Polygon };
+            maskShape = MixedMaskShapes[trackNumber % size(MixedMaskShapes)];
+        }
+
+        switch (maskShape)
+        {
+        case MaskShape::Rectangle:
+            return SegmentTypeAttributeValues::MaskRectangle;
+        case MaskShape::Ellipse:
+            return SegmentTypeAttributeValues::MaskEllipse;
+        default:
+            return SegmentTypeAttributeValues::MaskPolygon;
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace tinyxml2
+{
+    class XMLPrinter;
+}
+
+namespace ProjectGenerator
+{
+    /// <summary>
+    /// Describes the shape of generated masking segments.
+    /// </summary>
+    enum class MaskShape
+    {
+        /// <summary>Masking tracks cycle through rectangle, ellipse and polygon shapes.</summary>
+        Mixed,
+        Rectangle,
+        Ellipse,
+        Polygon
+    };
+
+    /// <summary>
+    /// Describes the output video resizing of a generated project.
+    /// </summary>
+    enum class LetterboxMode
+    {
+        /// <summary>The output video is the same size as the source video.</summary>
+        None,
+
+        /// <summary>The output video is letterboxed to a 4:3 frame size with the same width as the source video.</summary>
+        ToSize,
+
+        /// <summary>The output video is letterboxed to a 4:3 aspect ratio.</summary>
+        ToAspectRatio
+    };
+
+    /// <summary>
+    /// Options controlling the content of a generated synthetic project.
+    /// </summary>
+    struct SyntheticProjectOptions
+    {
+        /// <summary>The seed for the pseudo-random segment geometry. Equal options always generate identical projects.</summary>
+        uint32_t Seed = 1;
+
+        /// <summary>The width of the source video in pixels.</summary>
+        int FrameWidth = 1920;
+
+        /// <summary>The height of the source video in pixels.</summary>
+        int FrameHeight = 1080;
+
+        /// <summary>The number of frames in the source video. Segments on each track span all frames.</summary>
+        int FrameCount = 10000;
+
+        /// <summary>The number of cropping timeline tracks.</summary>
+        int CropTrackCount = 1;
+
+        /// <summary>The number of masking timeline tracks.</summary>
+        int MaskTrackCount = 1;
+
+        /// <summary>The number of contiguous segments on each track.</summary>
+        int SegmentsPerTrack = 1;
+
+        /// <summary>The number of key frames in each segment, including the start and end frames. Values below 1 are treated as 1.</summary>
+        int KeyFramesPerSegment = 2;
+
+        /// <summary>The number of vertices in each polygon masking key frame. Values below 3 are treated as 3.</summary>
+        int PolygonVertexCount = 8;
+
+        /// <summary>The maximum absolute crop rotation angle in degrees. Zero generates axis-aligned crops only.</summary>
+        double MaxCropAngle = 0.0;
+
+        /// <summary>The shape of generated masking segments.</summary>
+        MaskShape MaskShapes = MaskShape::Mixed;
+
+        /// <summary>The output video resizing of the generated project.</summary>
+        LetterboxMode Letterbox = LetterboxMode::None;
+    };
+
+    /// <summary>
+    /// Generates schema-valid Video Script Editor project files with pseudo-random segment geometry,
+    /// for stress testing and benchmarking project parsing and frame processing at scale.
+    /// </summary>
+    /// <remarks>
+    /// Random values are derived directly from <see cref="std::mt19937"/> output rather than the standard library distributions,
+    /// whose results are implementation-defined, so the same seed generates the same project with every compiler.
+    /// </remarks>
+    class SyntheticProjectGenerator
+    {
+    private:
+        /// <summary>
+        /// Describes an axis-aligned rectangle in pixels.
+        /// </summary>
+        struct RectD
+        {
+            double Left;
+            double Top;
+            double Width;
+            double Height;
+        };
+
+        SyntheticProjectOptions _options;
+        std::mt19937 _randomEngine;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="SyntheticProjectGenerator"/> class.
+        /// </summary>
+        /// <param name="options">(IN) The <see cref="SyntheticProjectOptions"/> controlling the generated project content.</param>
+        SyntheticProjectGenerator(const SyntheticProjectOptions& options);
+
+        /// <summary>
+        /// Generates the XML content of a project file.
+        /// </summary>
+        /// <returns>The project file XML.</returns>
+        std::string Generate();
+
+        /// <summary>
+        /// Generates a project and writes it to a file, replacing any existing file.
+        /// </summary>
+        /// <param name="projectFilePath">(IN) The path of the project file to write.</param>
+        void WriteProjectFile(const std::filesystem::path& projectFilePath);
+
+    private:
+        /// <summary>
+        /// Gets a pseudo-random value in a range.
+        /// </summary>
+        /// <param name="minValue">(IN) The inclusive lower bound of the range.</param>
+        /// <param name="maxValue">(IN) The exclusive upper bound of the range.</param>
+        /// <returns>A pseudo-random value between <paramref name="minValue"/> and <paramref name="maxValue"/>.</returns>
+        double NextDouble(const double minValue, const double maxValue);
+
+        /// <summary>
+        /// Gets a pseudo-random rectangle lying entirely inside the source video frame.
+        /// </summary>
+        /// <param name="minSizeFraction">(IN) The minimum width and height as a fraction of the frame size.</param>
+        /// <param name="maxSizeFraction">(IN) The maximum width and height as a fraction of the frame size.</param>
+        /// <returns>A <see cref="RectD"/> in pixels.</returns>
+        RectD NextFrameRect(const double minSizeFraction, const double maxSizeFraction);
+
+        /// <summary>
+        /// Writes all segments of a given type for a timeline track.
+        /// The source video frame range is divided evenly between the segments.
+        /// </summary>
+        /// <param name="printer">(IN/OUT) The <see cref="tinyxml2::XMLPrinter"/> to write to.</param>
+        /// <param name="segmentType">(IN) The segment and key frame xsi:type attribute value.</param>
+        /// <param name="trackNumber">(IN) The zero-based timeline track number.</param>
+        void WriteTrackSegments(tinyxml2::XMLPrinter& printer, const char* segmentType, const int trackNumber);
+
+        /// <summary>
+        /// Writes the type specific child elements of a key frame.
+        /// </summary>
+        /// <param name="printer">(IN/OUT) The <see cref="tinyxml2::XMLPrinter"/> to write to.</param>
+        /// <param name="segmentType">(IN) The segment and key frame xsi:type attribute value.</param>
+        void WriteKeyFrameValues(tinyxml2::XMLPrinter& printer, const std::string_view segmentType);
+
+        /// <summary>
+        /// Writes the VideoProcessingOptions element.
+        /// </summary>
+        /// <param name="printer">(IN/OUT) The <see cref="tinyxml2::XMLPrinter"/> to write to.</param>
+        void WriteVideoProcessingOptions(tinyxml2::XMLPrinter& printer);
+
+        /// <summary>
+        /// Gets the xsi:type attribute value of the masking segments on a timeline track.
+        /// </summary>
+        /// <param name="trackNumber">(IN) The zero-based masking timeline track number.</param>
+        /// <returns>The masking segment type attribute value.</returns>
+        const char* GetMaskSegmentType(const int trackNumber);
+    };
+}
@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "..\VSEProcessorAviSynth\CompiledProjectCache.h"
+#include <filesystem>
+#include <fstream>
+
+namespace UnitTests
+{
+    constexpr auto PROJECT_FILE_PATH = R"(TestFiles\MultiCropMaskingNoRotation.vseproj)";
+
+    TEST(CompiledProjectCacheTest, SharesProjectBetweenInstances)
+    {
+        std::shared_ptr<const VSEProject> firstProject = CompiledProjectCache::GetOrParse(PROJECT_FILE_PATH);
+        std::shared_ptr<const VSEProject> secondProject = CompiledProjectCache::GetOrParse(PROJECT_FILE_PATH);
+
+        ASSERT_NE(firstProject, nullptr);
+        EXPECT_EQ(firstProject, secondProject);
+        EXPECT_FALSE(firstProject->SegmentModels.empty());
+    }
+
+    TEST(CompiledProjectCacheTest, ParsesEditedProjectAgain)
+    {
+        const std::filesystem::path projectFilePath = std::filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.Cached.vseproj";
+        std::filesystem::copy_file(PROJECT_FILE_PATH, projectFilePath, std::filesystem::copy_options::overwrite_existing);
+
+        std::shared_ptr<const VSEProject> originalProject = CompiledProjectCache::GetOrParse(projectFilePath.string().c_str());
+
+        {
+            std::ofstream projectFileStream(projectFilePath, std::ios::app);
+            projectFileStream << "\n<!-- Edited -->\n";
+        }
+
+        std::shared_ptr<const VSEProject> editedProject = CompiledProjectCache::GetOrParse(projectFilePath.string().c_str());
+        std::filesystem::remove(projectFilePath);
+
+        EXPECT_NE(originalProject, editedProject);
+        EXPECT_EQ(originalProject->SegmentModels.size(), editedProject->SegmentModels.size());
+    }
+
+    TEST(CompiledProjectCacheTest, HashContent)
+    {
+        // FNV-1a 64-bit test vectors
+        EXPECT_EQ(CompiledProjectCache::HashContent(""), 0xcbf29ce484222325ULL);
+        EXPECT_EQ(CompiledProjectCache::HashContent("a"), 0xaf63dc4c8601ec8cULL);
+        EXPECT_EQ(CompiledProjectCache::HashContent("foobar"), 0x85944171f73967e8ULL);
+    }
+}
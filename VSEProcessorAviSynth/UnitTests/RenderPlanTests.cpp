@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "..\VSEProcessorAviSynth\RenderPlan.h"
+
+namespace UnitTests
+{
+    using namespace std;
+    using namespace VideoScriptEditor::Unmanaged;
+
+    /// <summary>
+    /// Creates a project with:
+    /// an unrotated crop segment on track 0 from frame 10 to 29,
+    /// a crop segment on track 0 from frame 30 to 50 rotating from 0 degrees at frame 30 to 45 degrees at frame 40 and back at frame 50,
+    /// and a rectangle masking segment on track 1 from frame 20 to 60.
+    /// </summary>
+    VSEProject CreateRenderPlanTestProject()
+    {
+        VSEProject project;
+
+        SegmentModel& unrotatedCropSegment = project.SegmentModels.emplace_back(SegmentType::Crop, 10, 29, 0);
+        unrotatedCropSegment.KeyFrames[10] = make_shared<CropKeyFrameModel>(10, 10.0, 20.0, 320.0, 240.0, 0.0);
+
+        SegmentModel& rotatedCropSegment = project.SegmentModels.emplace_back(SegmentType::Crop, 30, 50, 0);
+        rotatedCropSegment.KeyFrames[30] = make_shared<CropKeyFrameModel>(30, 10.0, 20.0, 320.0, 240.0, 0.0);
+        rotatedCropSegment.KeyFrames[40] = make_shared<CropKeyFrameModel>(40, 10.0, 20.0, 320.0, 240.0, 45.0);
+        rotatedCropSegment.KeyFrames[50] = make_shared<CropKeyFrameModel>(50, 10.0, 20.0, 320.0, 240.0, 0.0);
+
+        SegmentModel& maskSegment = project.SegmentModels.emplace_back(SegmentType::MaskRectangle, 20, 60, 1);
+        maskSegment.KeyFrames[20] = make_shared<MaskRectangleKeyFrameModel>(20, 100.0, 100.0, 50.0, 50.0);
+
+        return project;
+    }
+
+    TEST(RenderPlanTest, SelectsPipelinePerRange)
+    {
+        const RenderPlan renderPlan(CreateRenderPlanTestProject(), 0, 99);
+        const vector<RenderPlanRange>& ranges = renderPlan.get_Ranges();
+
+        const vector<tuple<int, int, RenderPipeline, vector<size_t>>> expectedRanges = {
+            { 0, 9, RenderPipeline::PassThrough, {} },
+            { 10, 19, RenderPipeline::AxisAlignedCrop, { 0 } },
+            { 20, 29, RenderPipeline::BlurMaskAndAxisAlignedCrop, { 0, 2 } },
+            { 30, 30, RenderPipeline::BlurMaskAndAxisAlignedCrop, { 1, 2 } },    // Zero angle key frame
+            { 31, 49, RenderPipeline::Direct2D, { 1, 2 } },
+            { 50, 50, RenderPipeline::BlurMaskAndAxisAlignedCrop, { 1, 2 } },    // Zero angle key frame
+            { 51, 60, RenderPipeline::BlurMask, { 2 } },
+            { 61, 99, RenderPipeline::PassThrough, {} }
+        };
+
+        ASSERT_EQ(ranges.size(), expectedRanges.size());
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            const auto& [startFrame, endFrame, pipeline, segmentIndices] = expectedRanges[i];
+            EXPECT_EQ(ranges[i].StartFrame, startFrame);
+            EXPECT_EQ(ranges[i].EndFrame, endFrame);
+            EXPECT_EQ(ranges[i].Pipeline, pipeline);
+            EXPECT_EQ(ranges[i].SegmentIndices, segmentIndices);
+        }
+    }
+
+    TEST(RenderPlanTest, GetRange)
+    {
+        const RenderPlan renderPlan(CreateRenderPlanTestProject(), 0, 99);
+
+        EXPECT_EQ(renderPlan.GetRange(0).StartFrame, 0);
+        EXPECT_EQ(renderPlan.GetRange(19).StartFrame, 10);
+        EXPECT_EQ(renderPlan.GetRange(45).Pipeline, RenderPipeline::Direct2D);
+        EXPECT_EQ(renderPlan.GetRange(99).EndFrame, 99);
+    }
+
+    TEST(RenderPlanTest, GetRangeOutsidePlannedFramesPassesThrough)
+    {
+        const RenderPlan renderPlan(CreateRenderPlanTestProject(), 15, 35);
+
+        EXPECT_EQ(renderPlan.GetRange(14).Pipeline, RenderPipeline::PassThrough);
+        EXPECT_TRUE(renderPlan.GetRange(14).SegmentIndices.empty());
+        EXPECT_EQ(renderPlan.GetRange(36).Pipeline, RenderPipeline::PassThrough);
+        EXPECT_TRUE(RenderPlan().GetRange(0).SegmentIndices.empty());
+    }
+
+    TEST(RenderPlanTest, PlansOnlyRequestedFrames)
+    {
+        const RenderPlan renderPlan(CreateRenderPlanTestProject(), 15, 35);
+        const vector<RenderPlanRange>& ranges = renderPlan.get_Ranges();
+
+        ASSERT_FALSE(ranges.empty());
+        EXPECT_EQ(ranges.front().StartFrame, 15);
+        EXPECT_EQ(ranges.back().EndFrame, 35);
+        EXPECT_EQ(ranges.back().Pipeline, RenderPipeline::Direct2D);
+    }
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+
+namespace UnitTests
+{
+    using namespace std;
+    using namespace VideoScriptEditor::Unmanaged;
+
+    TEST(TrackIndexedTableTest, InsertAndIterateInTrackOrder)
+    {
+        TrackIndexedTable<CropSegmentFrameDataItem> table;
+        EXPECT_TRUE(table.empty());
+
+        table[3] = CropSegmentFrameDataItem(3.0, 0.0, 10.0, 10.0, 0.0);
+        table[0] = CropSegmentFrameDataItem(0.0, 0.0, 10.0, 10.0, 0.0);
+        table[70] = CropSegmentFrameDataItem(70.0, 0.0, 10.0, 10.0, 0.0);
+
+        // Existing tracks aren't inserted again
+        table[3].Top = 5.0;
+
+        EXPECT_EQ(table.size(), 3);
+        EXPECT_TRUE(table.IsActive(70));
+        EXPECT_FALSE(table.IsActive(1));
+        EXPECT_FALSE(table.IsActive(200));
+
+        vector<int> trackNumbers;
+        for (const auto& [trackNumber, cropItem] : table)
+        {
+            EXPECT_EQ(cropItem.Left, static_cast<double>(trackNumber));
+            trackNumbers.push_back(trackNumber);
+        }
+
+        EXPECT_EQ(trackNumbers, vector<int>({ 0, 3, 70 }));
+        EXPECT_EQ(table.begin()->second.Left, 0.0);
+        EXPECT_EQ(table[3].Top, 5.0);
+    }
+
+    TEST(TrackIndexedTableTest, RemoveInactive)
+    {
+        TrackIndexedTable<shared_ptr<int>> table;
+        for (const int trackNumber : { 1, 2, 65, 66 })
+        {
+            table[trackNumber] = make_shared<int>(trackNumber);
+        }
+
+        vector<int> removedTrackNumbers;
+        EXPECT_EQ(table.RemoveInactive({ 2, 65 }, [&](const int trackNumber, const shared_ptr<int>& item) {
+            EXPECT_EQ(*item, trackNumber);
+            removedTrackNumbers.push_back(trackNumber);
+        }), 2);
+
+        EXPECT_EQ(removedTrackNumbers, vector<int>({ 1, 66 }));
+        EXPECT_EQ(table.size(), 2);
+        EXPECT_FALSE(table.IsActive(1));
+
+        // Reactivated tracks start with a default constructed item
+        EXPECT_EQ(table[1], nullptr);
+
+        // Tracks kept active by an earlier call aren't kept by the next
+        EXPECT_EQ(table.RemoveInactive({ 1 }), 2);
+        EXPECT_EQ(table.size(), 1);
+        EXPECT_FALSE(table.IsActive(2));
+        EXPECT_FALSE(table.IsActive(65));
+
+        table.clear();
+        EXPECT_TRUE(table.empty());
+        EXPECT_EQ(table.begin(), table.end());
+    }
+}
@@ -1,12 +1,17 @@
 #include "pch.h"
-#include "AviSynthTestEnvironment.h"
+#include "..\..\Shared\cpp\AviSynthTestEnvironment.h"
 #include <fmt/format.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
 
 namespace UnitTests
 {
     using namespace std;
 
     constexpr auto PROJECT_FILE_PATH = R"(TestFiles\MultiCropMaskingNoRotation.vseproj)";
+    constexpr auto LETTERBOX_CROP_PROJECT_FILE_PATH = R"(TestFiles\LetterboxCropNoResize.vseproj)";
 
     constexpr auto TEST_SCRIPT =
 R"(LoadPlugin("VSEProcessorAviSynth.dll")
@@ -16,6 +21,64 @@ Info()
 VSEProcessorAviSynth("{:s}")
 )";
 
+    constexpr auto STAGE_TIMING_TEST_SCRIPT =
+R"(LoadPlugin("VSEProcessorAviSynth.dll")
+ColorBars(640, 480, "YV12").AssumeFPS("ntsc_video").KillAudio()
+Trim(0, 400)
+VSEProcessorAviSynth("{:s}", stage_timing="{:s}")
+)";
+
+    constexpr auto TRACE_TEST_SCRIPT =
+R"(LoadPlugin("VSEProcessorAviSynth.dll")
+ColorBars(640, 480, "YV12").AssumeFPS("ntsc_video").KillAudio()
+Trim(0, 400)
+VSEProcessorAviSynth("{:s}", trace_file="{:s}")
+)";
+
+    constexpr auto WATCH_PROJECT_TEST_SCRIPT =
+R"(LoadPlugin("VSEProcessorAviSynth.dll")
+ColorBars(640, 480, "YV12").AssumeFPS("ntsc_video").KillAudio()
+Trim(0, 400)
+VSEProcessorAviSynth("{:s}", watch_project=true)
+)";
+
+    constexpr auto LETTERBOX_CROP_TEST_SCRIPT =
+R"(LoadPlugin("VSEProcessorAviSynth.dll")
+ColorBars(640, 480, "YV12").AssumeFPS("ntsc_video").KillAudio()
+Trim(0, 400)
+VSEProcessorAviSynth("{:s}")
+)";
+
+    // The letterbox crop project's full frame crop rendering - resampling the whole frame then blacking out 60 pixel borders -
+    // from the crop's source rectangle of (0, 40.25, 640, 480)
+    constexpr auto LETTERBOX_CROP_BASELINE_SCRIPT =
+R"(ColorBars(640, 480, "YV12").AssumeFPS("ntsc_video").KillAudio()
+Trim(0, 400)
+Spline64Resize(640, 480, 0, 40.25, 640, 480)
+LetterBox(60, 60)
+)";
+
+    // Allows for rounding differences between resampling the picture area alone and the full frame
+    constexpr int LETTERBOX_CROP_LUMA_TOLERANCE = 1;
+
+    /// <summary>
+    /// Copies the luma plane of a video frame, for comparing frame content after the frame is released.
+    /// </summary>
+    vector<uint8_t> CopyLumaPlane(const PVideoFrame& videoFrame)
+    {
+        const int rowSize = videoFrame->GetRowSize(PLANAR_Y);
+        const int height = videoFrame->GetHeight(PLANAR_Y);
+        const BYTE* lumaReadPtr = videoFrame->GetReadPtr(PLANAR_Y);
+
+        vector<uint8_t> lumaPlane(static_cast<size_t>(rowSize) * height);
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(lumaPlane.data() + (static_cast<size_t>(y) * rowSize), lumaReadPtr + (static_cast<size_t>(y) * videoFrame->GetPitch(PLANAR_Y)), rowSize);
+        }
+
+        return lumaPlane;
+    }
+
     class VSEProcessorAviSynthTestFixture : public ::testing::Test
     {
     protected:
@@ -88,4 +151,130 @@ VSEProcessorAviSynth("{:s}")
         ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(269));
         ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(350));
     }
+
+    TEST_F(VSEProcessorAviSynthTestFixture, LetterboxCropMatchesFullFrameResample)
+    {
+        ASSERT_TRUE(
+            s_aviSynthTestEnv->LoadScriptFromString(fmt::format(LETTERBOX_CROP_TEST_SCRIPT, LETTERBOX_CROP_PROJECT_FILE_PATH))
+        );
+        const vector<uint8_t> processedFrame = CopyLumaPlane(s_aviSynthTestEnv->GetVideoFrame(0));
+
+        ASSERT_TRUE(
+            s_aviSynthTestEnv->LoadScriptFromString(LETTERBOX_CROP_BASELINE_SCRIPT)
+        );
+        const vector<uint8_t> baselineFrame = CopyLumaPlane(s_aviSynthTestEnv->GetVideoFrame(0));
+
+        ASSERT_EQ(processedFrame.size(), baselineFrame.size());
+
+        int maxLumaDifference = 0;
+        for (size_t i = 0; i < processedFrame.size(); ++i)
+        {
+            maxLumaDifference = max(maxLumaDifference, abs(processedFrame[i] - baselineFrame[i]));
+        }
+
+        EXPECT_LE(maxLumaDifference, LETTERBOX_CROP_LUMA_TOLERANCE);
+    }
+
+    TEST_F(VSEProcessorAviSynthTestFixture, StageTimingReport)
+    {
+        const filesystem::path reportFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.StageTimingReport.txt";
+        filesystem::remove(reportFilePath);
+
+        ASSERT_TRUE(
+            s_aviSynthTestEnv->LoadScriptFromString(fmt::format(STAGE_TIMING_TEST_SCRIPT, PROJECT_FILE_PATH, reportFilePath.generic_string()))
+        );
+
+        ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(0));
+        ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(100));
+        ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(269));
+
+        // The report is written when the filter instance is destroyed with its script environment
+        s_aviSynthTestEnv->DeleteScriptEnvironment();
+
+        ifstream reportFileStream(reportFilePath);
+        ASSERT_TRUE(reportFileStream.is_open());
+
+        const string report((istreambuf_iterator<char>(reportFileStream)), istreambuf_iterator<char>());
+        EXPECT_NE(report.find("GetFrame"), string::npos);
+        EXPECT_NE(report.find("SegmentLookup"), string::npos);
+
+        reportFileStream.close();
+        filesystem::remove(reportFilePath);
+    }
+
+    TEST_F(VSEProcessorAviSynthTestFixture, TraceFile)
+    {
+        const filesystem::path traceFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.TraceFile.json";
+        filesystem::remove(traceFilePath);
+
+        ASSERT_TRUE(
+            s_aviSynthTestEnv->LoadScriptFromString(fmt::format(TRACE_TEST_SCRIPT, PROJECT_FILE_PATH, traceFilePath.generic_string()))
+        );
+
+        ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(0));
+        ASSERT_NO_THROW(s_aviSynthTestEnv->RequestFrame(100));
+
+        // The trace is written when the last filter instance tracing to the file is destroyed with its script environment
+        s_aviSynthTestEnv->DeleteScriptEnvironment();
+
+        ifstream traceFileStream(traceFilePath);
+        ASSERT_TRUE(traceFileStream.is_open());
+
+        const string trace((istreambuf_iterator<char>(traceFileStream)), istreambuf_iterator<char>());
+        EXPECT_EQ(trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), size_t{ 0 });
+        EXPECT_NE(trace.find(R"("name":"GetFrame","ph":"X")"), string::npos);
+        EXPECT_NE(trace.find(R"("args":{"frame":100})"), string::npos);
+
+        traceFileStream.close();
+        filesystem::remove(traceFilePath);
+    }
+
+    TEST_F(VSEProcessorAviSynthTestFixture, WatchProject)
+    {
+        const filesystem::path projectFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.WatchProject.vseproj";
+        filesystem::copy_file(PROJECT_FILE_PATH, projectFilePath, filesystem::copy_options::overwrite_existing);
+
+        ASSERT_TRUE(
+            s_aviSynthTestEnv->LoadScriptFromString(fmt::format(WATCH_PROJECT_TEST_SCRIPT, projectFilePath.generic_string()))
+        );
+
+        const vector<uint8_t> originalFrame0 = CopyLumaPlane(s_aviSynthTestEnv->GetVideoFrame(0));
+        const vector<uint8_t> originalFrame100 = CopyLumaPlane(s_aviSynthTestEnv->GetVideoFrame(100));
+
+        // Move the first key frame of the crop segment covering frames 0 to 82
+        {
+            ifstream projectFileStream(projectFilePath);
+            string projectFileContent((istreambuf_iterator<char>(projectFileStream)), istreambuf_iterator<char>());
+            projectFileStream.close();
+
+            const string originalKeyFrameLeft = "<Left>92.50079239302693</Left>";
+            const size_t keyFrameLeftPosition = projectFileContent.find(originalKeyFrameLeft);
+            ASSERT_NE(keyFrameLeftPosition, string::npos);
+            projectFileContent.replace(keyFrameLeftPosition, originalKeyFrameLeft.size(), "<Left>300</Left>");
+
+            ofstream editedProjectFileStream(projectFilePath, ios::trunc);
+            editedProjectFileStream << projectFileContent;
+        }
+
+        // Poll until the watch thread has reloaded the project and frame 0 is rendered from it
+        const chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(10);
+        bool frame0Changed = false;
+        while (!frame0Changed && chrono::steady_clock::now() < deadline)
+        {
+            frame0Changed = CopyLumaPlane(s_aviSynthTestEnv->GetVideoFrame(0)) != originalFrame0;
+            if (!frame0Changed)
+            {
+                this_thread::sleep_for(chrono::milliseconds(50));
+            }
+        }
+
+        EXPECT_TRUE(frame0Changed);
+
+        // Frames outside the edited segment are unaffected
+        EXPECT_EQ(CopyLumaPlane(s_aviSynthTestEnv->GetVideoFrame(100)), originalFrame100);
+
+        // The watch thread is stopped when the filter instance is destroyed with its script environment
+        s_aviSynthTestEnv->DeleteScriptEnvironment();
+        filesystem::remove(projectFilePath);
+    }
 }
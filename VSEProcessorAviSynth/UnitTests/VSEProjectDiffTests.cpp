@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "..\VSEProcessorAviSynth\VSEProjectDiff.h"
+#include "..\VSEProcessorAviSynth\VSEProjectFileParser.h"
+
+namespace UnitTests
+{
+    using namespace std;
+    using namespace VideoScriptEditor::Unmanaged;
+
+    constexpr auto PROJECT_FILE_PATH = R"(TestFiles\MultiCropMaskingNoRotation.vseproj)";
+    constexpr int FRAME_COUNT = 100;
+
+    /// <summary>
+    /// Creates a project with a crop segment on track 0 from frame 10 to 50, with key frames at 10, 30 and 50,
+    /// and a rectangle masking segment on track 1 from frame 60 to 70.
+    /// </summary>
+    VSEProject CreateDiffTestProject()
+    {
+        VSEProject project;
+
+        SegmentModel& cropSegment = project.SegmentModels.emplace_back(SegmentType::Crop, 10, 50, 0);
+        for (const int keyFrameNumber : { 10, 30, 50 })
+        {
+            cropSegment.KeyFrames[keyFrameNumber] = make_shared<CropKeyFrameModel>(keyFrameNumber, 10.0, 20.0, 320.0, 240.0, 0.0);
+        }
+
+        SegmentModel& maskSegment = project.SegmentModels.emplace_back(SegmentType::MaskRectangle, 60, 70, 1);
+        maskSegment.KeyFrames[60] = make_shared<MaskRectangleKeyFrameModel>(60, 100.0, 100.0, 50.0, 50.0);
+
+        return project;
+    }
+
+    TEST(VSEProjectDiffTest, IdenticalProjects)
+    {
+        EXPECT_TRUE(VSEProjectDiff::Compare(CreateDiffTestProject(), CreateDiffTestProject(), FRAME_COUNT).empty());
+    }
+
+    TEST(VSEProjectDiffTest, ParsedProjectMatchesItself)
+    {
+        VSEProject previousProject, currentProject;
+        VSEProjectFileParser previousProjectFileParser(previousProject);
+        VSEProjectFileParser currentProjectFileParser(currentProject);
+        ASSERT_NO_THROW(previousProjectFileParser.Parse(PROJECT_FILE_PATH));
+        ASSERT_NO_THROW(currentProjectFileParser.Parse(PROJECT_FILE_PATH));
+
+        EXPECT_TRUE(VSEProjectDiff::Compare(previousProject, currentProject, 400).empty());
+    }
+
+    TEST(VSEProjectDiffTest, SegmentOrderDoesNotMatter)
+    {
+        VSEProject currentProject = CreateDiffTestProject();
+        reverse(currentProject.SegmentModels.begin(), currentProject.SegmentModels.end());
+
+        EXPECT_TRUE(VSEProjectDiff::Compare(CreateDiffTestProject(), currentProject, FRAME_COUNT).empty());
+    }
+
+    TEST(VSEProjectDiffTest, ChangedKeyFrame)
+    {
+        VSEProject currentProject = CreateDiffTestProject();
+        dynamic_pointer_cast<CropKeyFrameModel>(currentProject.SegmentModels[0].KeyFrames[30])->Left = 12.0;
+
+        // Frames interpolated from the changed key frame change, the neighbouring key frames don't
+        const vector<FrameRange> expectedFrameRanges = { { 11, 49 } };
+        EXPECT_EQ(VSEProjectDiff::Compare(CreateDiffTestProject(), currentProject, FRAME_COUNT), expectedFrameRanges);
+    }
+
+    TEST(VSEProjectDiffTest, ChangedSegmentRange)
+    {
+        VSEProject currentProject = CreateDiffTestProject();
+        currentProject.SegmentModels[1].EndFrame = 75;
+
+        const vector<FrameRange> expectedFrameRanges = { { 71, 75 } };
+        EXPECT_EQ(VSEProjectDiff::Compare(CreateDiffTestProject(), currentProject, FRAME_COUNT), expectedFrameRanges);
+    }
+
+    TEST(VSEProjectDiffTest, ChangedVideoProcessingOptions)
+    {
+        VSEProject currentProject = CreateDiffTestProject();
+        currentProject.VideoProcessingOptions.OutputVideoResizeMode = VideoResizeMode::LetterboxToSize;
+        currentProject.VideoProcessingOptions.OutputVideoSize = D2D1::SizeU(1280, 720);
+
+        const vector<FrameRange> expectedFrameRanges = { { 0, FRAME_COUNT - 1 } };
+        EXPECT_EQ(VSEProjectDiff::Compare(CreateDiffTestProject(), currentProject, FRAME_COUNT), expectedFrameRanges);
+    }
+
+    TEST(VSEProjectDiffTest, GetChangedFrameRanges)
+    {
+        const vector<uint64_t> previousFrameHashes = { 1, 2, 3, 4, 5 };
+        const vector<uint64_t> currentFrameHashes = { 1, 0, 0, 4, 0, 6, 7 };
+
+        // Frames without a previous hash are changed, and adjacent changed frames merge into one range
+        const vector<FrameRange> expectedFrameRanges = { { 1, 2 }, { 4, 6 } };
+        EXPECT_EQ(VSEProjectDiff::GetChangedFrameRanges(previousFrameHashes, currentFrameHashes), expectedFrameRanges);
+    }
+}
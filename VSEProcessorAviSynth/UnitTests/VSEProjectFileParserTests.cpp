@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "..\VSEProcessorAviSynth\VSEProjectFileParser.h"
+#include "..\ProjectGenerator\SyntheticProjectGenerator.h"
+#include <filesystem>
 
 namespace UnitTests
 {
@@ -14,4 +16,45 @@ namespace UnitTests
 
         // TODO: Verify testProject content is correct.
     }
-}
\ No newline at end of file
+
+    TEST(VSEProjectFileParserTest, ParseSyntheticProject)
+    {
+        ProjectGenerator::SyntheticProjectOptions generatorOptions;
+        generatorOptions.Seed = 42;
+        generatorOptions.FrameCount = 1000;
+        generatorOptions.CropTrackCount = 2;
+        generatorOptions.MaskTrackCount = 3;
+        generatorOptions.SegmentsPerTrack = 4;
+        generatorOptions.KeyFramesPerSegment = 5;
+        generatorOptions.PolygonVertexCount = 12;
+        generatorOptions.MaxCropAngle = 30.0;
+        generatorOptions.Letterbox = ProjectGenerator::LetterboxMode::ToAspectRatio;
+
+        ProjectGenerator::SyntheticProjectGenerator projectGenerator(generatorOptions);
+
+        // Equal options generate identical projects
+        EXPECT_EQ(projectGenerator.Generate(), ProjectGenerator::SyntheticProjectGenerator(generatorOptions).Generate());
+
+        const std::filesystem::path projectFilePath = std::filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.Synthetic.vseproj";
+        projectGenerator.WriteProjectFile(projectFilePath);
+
+        VSEProject testProject;
+        VSEProjectFileParser testProjectFileParser(testProject);
+
+        ASSERT_NO_THROW(testProjectFileParser.Parse(projectFilePath.string().c_str()));
+        std::filesystem::remove(projectFilePath);
+
+        ASSERT_EQ(testProject.SegmentModels.size(), 20);
+        for (const SegmentModel& segmentModel : testProject.SegmentModels)
+        {
+            EXPECT_EQ(segmentModel.KeyFrames.size(), 5);
+            EXPECT_EQ(segmentModel.KeyFrames.begin()->first, segmentModel.StartFrame);
+            EXPECT_EQ(segmentModel.KeyFrames.rbegin()->first, segmentModel.EndFrame);
+        }
+
+        EXPECT_TRUE(testProject.NeedsDirect2DProcessing);
+        EXPECT_EQ(testProject.VideoProcessingOptions.OutputVideoResizeMode, VideoResizeMode::LetterboxToAspectRatio);
+        EXPECT_EQ(testProject.VideoProcessingOptions.OutputAspectRatio.Numerator, 4u);
+        EXPECT_EQ(testProject.VideoProcessingOptions.OutputAspectRatio.Denominator, 3u);
+    }
+}
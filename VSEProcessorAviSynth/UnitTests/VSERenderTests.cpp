@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "..\..\Shared\cpp\AviSynthTestEnvironment.h"
+#include "..\VSERender\FrameHashFile.h"
+#include "..\VSERender\RenderJob.h"
+#include "..\VSERender\RenderManifest.h"
+#include "..\VSERender\Y4MWriter.h"
+#include "..\VSERender\YuvFileSource.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace UnitTests
+{
+    using namespace std;
+    using namespace VSERender;
+
+    constexpr auto Y4M_ROUND_TRIP_SCRIPT = R"(ColorBars(320, 240, "YV12").AssumeFPS(24000, 1001).KillAudio().Trim(0, 9))";
+    constexpr auto SHARDED_RENDER_SOURCE_SCRIPT = R"(ColorBars(640, 480, "YV12").AssumeFPS("ntsc_video").KillAudio().Trim(0, 89))";
+    constexpr auto SHARDED_RENDER_PROJECT_FILE_PATH = R"(TestFiles\MultiCropMaskingNoRotation.vseproj)";
+
+    /// <summary>
+    /// Starts a VSERender.exe process from the test output directory.
+    /// </summary>
+    /// <param name="arguments">(IN) The command line arguments.</param>
+    /// <returns>The process handle, or nullptr if the process couldn't be started.</returns>
+    HANDLE StartVSERenderProcess(const string& arguments)
+    {
+        string commandLine = "VSERender.exe " + arguments;
+        STARTUPINFOA startupInfo = { sizeof(STARTUPINFOA) };
+        PROCESS_INFORMATION processInfo = {};
+        if (!CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo))
+        {
+            return nullptr;
+        }
+
+        CloseHandle(processInfo.hThread);
+        return processInfo.hProcess;
+    }
+
+    /// <summary>
+    /// Waits for a process to exit and closes its handle.
+    /// </summary>
+    /// <param name="processHandle">(IN) The process handle.</param>
+    /// <returns>The process exit code.</returns>
+    DWORD WaitForProcessExit(HANDLE processHandle)
+    {
+        WaitForSingleObject(processHandle, INFINITE);
+
+        DWORD exitCode = 0;
+        GetExitCodeProcess(processHandle, &exitCode);
+        CloseHandle(processHandle);
+
+        return exitCode;
+    }
+
+    string ReadFileBytes(const filesystem::path& filePath)
+    {
+        ifstream fileStream(filePath, ios::binary);
+        return string(istreambuf_iterator<char>(fileStream), istreambuf_iterator<char>());
+    }
+
+    TEST(VSERenderTest, GetSourceType)
+    {
+        EXPECT_EQ(GetSourceType("source.avs"), SourceType::AviSynthScript);
+        EXPECT_EQ(GetSourceType(R"(C:\Videos\Source.AVSI)"), SourceType::AviSynthScript);
+        EXPECT_EQ(GetSourceType("source.y4m"), SourceType::Y4M);
+        EXPECT_EQ(GetSourceType("source.yuv"), SourceType::RawI420);
+        EXPECT_EQ(GetSourceType("source"), SourceType::RawI420);
+    }
+
+    TEST(VSERenderTest, Y4MRoundTrip)
+    {
+        // VideoInfo and VideoFrame members are resolved through the AviSynth linkage, which requires a script environment
+        AviSynthTestEnvironment aviSynthTestEnv;
+        ASSERT_TRUE(aviSynthTestEnv.CreateScriptEnvironment());
+        ASSERT_TRUE(aviSynthTestEnv.LoadScriptFromString(Y4M_ROUND_TRIP_SCRIPT));
+
+        const VideoInfo sourceVideoInfo = *aviSynthTestEnv.get_VideoInfo();
+        EXPECT_EQ(Y4MWriter::FormatStreamHeader(sourceVideoInfo), "YUV4MPEG2 W320 H240 F24000:1001 Ip A1:1 C420mpeg2\n");
+
+        const filesystem::path y4mFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.RoundTrip.y4m";
+        {
+            Y4MWriter y4mWriter(y4mFilePath.string(), sourceVideoInfo);
+            for (int frameNumber = 0; frameNumber < sourceVideoInfo.num_frames; frameNumber++)
+            {
+                ASSERT_NO_THROW(y4mWriter.WriteFrame(aviSynthTestEnv.GetVideoFrame(frameNumber)));
+            }
+        }
+
+        EXPECT_EQ(filesystem::file_size(y4mFilePath), Y4MWriter::FormatStreamHeader(sourceVideoInfo).size() + sourceVideoInfo.num_frames * (6 + 320 * 240 * 3 / 2));
+
+        {
+            PClip y4mSource = YuvFileSource::OpenY4M(y4mFilePath.string());
+            const VideoInfo& y4mVideoInfo = y4mSource->GetVideoInfo();
+
+            EXPECT_EQ(y4mVideoInfo.width, sourceVideoInfo.width);
+            EXPECT_EQ(y4mVideoInfo.height, sourceVideoInfo.height);
+            EXPECT_EQ(y4mVideoInfo.num_frames, sourceVideoInfo.num_frames);
+            EXPECT_EQ(y4mVideoInfo.fps_numerator, sourceVideoInfo.fps_numerator);
+            EXPECT_EQ(y4mVideoInfo.fps_denominator, sourceVideoInfo.fps_denominator);
+            EXPECT_TRUE(y4mVideoInfo.IsYV12());
+        }
+
+        filesystem::remove(y4mFilePath);
+    }
+
+    TEST(VSERenderTest, Y4MRejectsHighBitDepthColorSpace)
+    {
+        // VideoInfo members are resolved through the AviSynth linkage, which requires a script environment
+        AviSynthTestEnvironment aviSynthTestEnv;
+        ASSERT_TRUE(aviSynthTestEnv.CreateScriptEnvironment());
+
+        const filesystem::path y4mFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.HighBitDepth.y4m";
+        {
+            ofstream y4mFileStream(y4mFilePath, ios::binary);
+            y4mFileStream << "YUV4MPEG2 W320 H240 F24000:1001 Ip A1:1 C420p10\n";
+            y4mFileStream << "FRAME\n" << string(320 * 240 * 3, '\0');
+        }
+
+        EXPECT_THROW(YuvFileSource::OpenY4M(y4mFilePath.string()), runtime_error);
+
+        filesystem::remove(y4mFilePath);
+    }
+
+    TEST(VSERenderTest, FrameHashFileRoundTrip)
+    {
+        const filesystem::path outputFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.FrameHashes.y4m";
+        const string frameHashFilePath = FrameHashFile::GetFilePath(outputFilePath.string());
+        const vector<uint64_t> frameHashes = { 0, 1, 0xFEDCBA9876543210ULL, UINT64_MAX };
+
+        ASSERT_NO_THROW(FrameHashFile::Save(frameHashFilePath, frameHashes));
+        EXPECT_EQ(FrameHashFile::Load(frameHashFilePath), frameHashes);
+
+        filesystem::remove(frameHashFilePath);
+        EXPECT_THROW(FrameHashFile::Load(frameHashFilePath), runtime_error);
+    }
+
+    TEST(VSERenderTest, RenderManifestPlan)
+    {
+        RenderOptions sharedOptions;
+        sharedOptions.ProjectFilePath = "project.vseproj";
+        sharedOptions.SourceFilePath = "source.y4m";
+
+        const filesystem::path manifestFilePath = filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.Plan.xml";
+        const RenderManifest manifest = RenderManifest::Plan(sharedOptions, 10, 3, manifestFilePath.string());
+
+        ASSERT_EQ(manifest.Shards.size(), size_t{ 3 });
+        EXPECT_EQ(manifest.Shards[0].StartFrame, 0);
+        EXPECT_EQ(manifest.Shards[0].EndFrame, 3);
+        EXPECT_EQ(manifest.Shards[1].StartFrame, 4);
+        EXPECT_EQ(manifest.Shards[1].EndFrame, 6);
+        EXPECT_EQ(manifest.Shards[2].StartFrame, 7);
+        EXPECT_EQ(manifest.Shards[2].EndFrame, 9);
+
+        manifest.Save(manifestFilePath.string());
+        const RenderManifest loadedManifest = RenderManifest::Load(manifestFilePath.string());
+        filesystem::remove(manifestFilePath);
+
+        EXPECT_EQ(loadedManifest.FrameCount, 10);
+        EXPECT_EQ(loadedManifest.SharedOptions.ProjectFilePath, manifest.SharedOptions.ProjectFilePath);
+        ASSERT_EQ(loadedManifest.Shards.size(), manifest.Shards.size());
+        for (size_t shardIndex = 0; shardIndex < manifest.Shards.size(); shardIndex++)
+        {
+            EXPECT_EQ(loadedManifest.Shards[shardIndex].StartFrame, manifest.Shards[shardIndex].StartFrame);
+            EXPECT_EQ(loadedManifest.Shards[shardIndex].EndFrame, manifest.Shards[shardIndex].EndFrame);
+            EXPECT_EQ(filesystem::path(loadedManifest.Shards[shardIndex].OutputFilePath), filesystem::path(manifest.Shards[shardIndex].OutputFilePath));
+        }
+
+        // More shards than frames are clamped to one frame per shard
+        EXPECT_EQ(RenderManifest::Plan(sharedOptions, 2, 5, manifestFilePath.string()).Shards.size(), size_t{ 2 });
+    }
+
+    TEST(VSERenderTest, ShardedRenderMatchesSingleProcessRender)
+    {
+        const filesystem::path workingDirectory = filesystem::temp_directory_path() / "VSEProcessorAviSynth.UnitTests.ShardedRender";
+        filesystem::remove_all(workingDirectory);
+        filesystem::create_directories(workingDirectory);
+
+        const filesystem::path sourceFilePath = workingDirectory / "source.y4m";
+        {
+            AviSynthTestEnvironment aviSynthTestEnv;
+            ASSERT_TRUE(aviSynthTestEnv.CreateScriptEnvironment());
+            ASSERT_TRUE(aviSynthTestEnv.LoadScriptFromString(SHARDED_RENDER_SOURCE_SCRIPT));
+
+            const VideoInfo sourceVideoInfo = *aviSynthTestEnv.get_VideoInfo();
+            Y4MWriter y4mWriter(sourceFilePath.string(), sourceVideoInfo);
+            for (int frameNumber = 0; frameNumber < sourceVideoInfo.num_frames; frameNumber++)
+            {
+                y4mWriter.WriteFrame(aviSynthTestEnv.GetVideoFrame(frameNumber));
+            }
+        }
+
+        const string projectFilePath = filesystem::absolute(SHARDED_RENDER_PROJECT_FILE_PATH).string();
+        const filesystem::path singleOutputFilePath = workingDirectory / "single.y4m";
+        const filesystem::path manifestFilePath = workingDirectory / "render.xml";
+        const filesystem::path concatenatedOutputFilePath = workingDirectory / "concatenated.y4m";
+
+        HANDLE singleRenderProcess = StartVSERenderProcess(fmt::format(R"("{:s}" "{:s}" "{:s}")", projectFilePath, sourceFilePath.string(), singleOutputFilePath.string()));
+        ASSERT_NE(singleRenderProcess, nullptr);
+        ASSERT_EQ(WaitForProcessExit(singleRenderProcess), DWORD{ 0 });
+
+        HANDLE planProcess = StartVSERenderProcess(fmt::format(R"(plan "{:s}" "{:s}" 3 "{:s}")", projectFilePath, sourceFilePath.string(), manifestFilePath.string()));
+        ASSERT_NE(planProcess, nullptr);
+        ASSERT_EQ(WaitForProcessExit(planProcess), DWORD{ 0 });
+
+        // Shards render concurrently in separate processes, as they would on separate machines
+        vector<HANDLE> shardProcesses;
+        for (int shardIndex = 0; shardIndex < 3; shardIndex++)
+        {
+            HANDLE shardProcess = StartVSERenderProcess(fmt::format(R"(shard "{:s}" {:d})", manifestFilePath.string(), shardIndex));
+            ASSERT_NE(shardProcess, nullptr);
+            shardProcesses.push_back(shardProcess);
+        }
+
+        for (HANDLE shardProcess : shardProcesses)
+        {
+            EXPECT_EQ(WaitForProcessExit(shardProcess), DWORD{ 0 });
+        }
+
+        HANDLE concatProcess = StartVSERenderProcess(fmt::format(R"(concat "{:s}" "{:s}")", manifestFilePath.string(), concatenatedOutputFilePath.string()));
+        ASSERT_NE(concatProcess, nullptr);
+        ASSERT_EQ(WaitForProcessExit(concatProcess), DWORD{ 0 });
+
+        const string singleOutput = ReadFileBytes(singleOutputFilePath);
+        const string concatenatedOutput = ReadFileBytes(concatenatedOutputFilePath);
+        EXPECT_FALSE(singleOutput.empty());
+        EXPECT_TRUE(singleOutput == concatenatedOutput);
+
+        filesystem::remove_all(workingDirectory);
+    }
+}
@@ -0,0 +1,75 @@
+#include "pch.h"
+#include "CompiledProjectCache.h"
+#include "VSEProjectFileParser.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+using namespace std;
+
+namespace
+{
+    /// <summary>A canonical project file path, last write time and content hash.</summary>
+    using CompiledProjectKey = tuple<filesystem::path, filesystem::file_time_type, uint64_t>;
+
+    /// <summary>Guards <see cref="CompiledProjects"/>.</summary>
+    mutex CompiledProjectsMutex;
+
+    /// <summary>The live parsed projects.</summary>
+    map<CompiledProjectKey, weak_ptr<const VSEProject>> CompiledProjects;
+}
+
+shared_ptr<const VSEProject> CompiledProjectCache::GetOrParse(const char* projectFileName)
+{
+    const filesystem::path projectFilePath = filesystem::canonical(projectFileName);
+    const filesystem::file_time_type lastWriteTime = filesystem::last_write_time(projectFilePath);
+
+    string projectFileContent;
+    {
+        ifstream projectFileStream(projectFilePath, ios::binary);
+        if (!projectFileStream)
+        {
+            throw runtime_error("Unable to load the project file for parsing");
+        }
+
+        projectFileContent.assign(istreambuf_iterator<char>(projectFileStream), istreambuf_iterator<char>());
+    }
+
+    const CompiledProjectKey projectKey(projectFilePath, lastWriteTime, HashContent(projectFileContent));
+
+    // Held while parsing, so that instances constructed concurrently share the first parse
+    lock_guard<mutex> compiledProjectsLock(CompiledProjectsMutex);
+
+    weak_ptr<const VSEProject>& compiledProject = CompiledProjects[projectKey];
+    shared_ptr<const VSEProject> project = compiledProject.lock();
+    if (project == nullptr)
+    {
+        shared_ptr<VSEProject> parsedProject = make_shared<VSEProject>();
+        VSEProjectFileParser projectFileParser(*parsedProject);
+        projectFileParser.Parse(string_view(projectFileContent));
+
+        project = move(parsedProject);
+        compiledProject = project;
+
+        // Drop entries of released projects, including earlier versions of this file
+        erase_if(CompiledProjects, [](const auto& compiledProjectPair) { return compiledProjectPair.second.expired(); });
+    }
+
+    return project;
+}
+
+uint64_t CompiledProjectCache::HashContent(const std::string_view& projectFileContent)
+{
+    constexpr uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+    constexpr uint64_t FnvPrime = 1099511628211ULL;
+
+    uint64_t hash = FnvOffsetBasis;
+    for (const char contentByte : projectFileContent)
+    {
+        hash ^= static_cast<uint8_t>(contentByte);
+        hash *= FnvPrime;
+    }
+
+    return hash;
+}
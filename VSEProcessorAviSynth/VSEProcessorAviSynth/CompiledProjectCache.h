@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/// <summary>
+/// A process-wide cache of parsed, read-only Video Script Editor projects.
+/// </summary>
+/// <remarks>
+/// Filter instances processing the same project file share a single <see cref="VSEProject"/> through <see cref="GetOrParse"/>.
+/// Projects are keyed by canonical file path, last write time and a hash of the file content,
+/// so an edited project file is parsed again while instances created before the edit keep their copy.
+/// The cache only holds weak references; a project is released with the last instance using it.
+/// </remarks>
+class CompiledProjectCache
+{
+public:
+    CompiledProjectCache() = delete;
+
+    /// <summary>
+    /// Gets the cached project parsed from a project file, or parses the file and caches the project if it isn't cached.
+    /// </summary>
+    /// <param name="projectFileName">(IN) The file path of the Video Script Editor project file.</param>
+    /// <returns>A shared pointer to the read-only <see cref="VSEProject"/>.</returns>
+    static std::shared_ptr<const VSEProject> GetOrParse(const char* projectFileName);
+
+    /// <summary>
+    /// Computes the 64-bit FNV-1a hash of project file content.
+    /// </summary>
+    /// <param name="projectFileContent">(IN) The project file content.</param>
+    /// <returns>The content hash.</returns>
+    static uint64_t HashContent(const std::string_view& projectFileContent);
+};
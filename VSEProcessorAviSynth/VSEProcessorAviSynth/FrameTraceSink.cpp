@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "FrameTraceSink.h"
+#include <fstream>
+
+using namespace std;
+
+namespace
+{
+    /// <summary>The source of <see cref="FrameTraceSink"/> identifiers. Zero is reserved for an empty thread-local cache entry.</summary>
+    atomic<uint64_t> NextSinkId = 1;
+
+    /// <summary>Guards <see cref="LiveSinks"/>.</summary>
+    mutex LiveSinksMutex;
+
+    /// <summary>The live sinks keyed by trace file path.</summary>
+    map<string, weak_ptr<FrameTraceSink>> LiveSinks;
+
+    constexpr double NanosecondsToMicroseconds(const uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1000.0;
+    }
+}
+
+FrameTraceSink::FrameTraceSink(const std::string& traceFilePath)
+    : _sinkId(NextSinkId++), _traceFilePath(traceFilePath), _epoch(chrono::steady_clock::now())
+{
+}
+
+FrameTraceSink::~FrameTraceSink()
+{
+    try
+    {
+        ofstream traceFileStream(_traceFilePath, ios::trunc);
+        traceFileStream << FormatTrace();
+    }
+    catch (...)
+    {
+        // Never throw from a destructor. Traces are diagnostic only.
+    }
+}
+
+std::shared_ptr<FrameTraceSink> FrameTraceSink::GetOrCreate(const std::string& traceFilePath)
+{
+    lock_guard<mutex> liveSinksLock(LiveSinksMutex);
+
+    weak_ptr<FrameTraceSink>& liveSink = LiveSinks[traceFilePath];
+    shared_ptr<FrameTraceSink> sink = liveSink.lock();
+    if (sink == nullptr)
+    {
+        sink = make_shared<FrameTraceSink>(traceFilePath);
+        liveSink = sink;
+    }
+
+    return sink;
+}
+
+void FrameTraceSink::RecordSpan(const char* name, const std::chrono::steady_clock::time_point beginTime, const std::chrono::steady_clock::time_point endTime, const int frameNumber)
+{
+    ThreadTraceBuffer& threadBuffer = GetThreadBuffer();
+
+    // Only the owning thread writes to its buffer, so a relaxed load of its own write count is sufficient.
+    const uint64_t writeCount = threadBuffer.WriteCount.load(memory_order_relaxed);
+
+    TraceSpan& span = threadBuffer.Spans[writeCount % ThreadTraceBuffer::Capacity];
+    span.Name = name;
+    span.BeginNanoseconds = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(beginTime - _epoch).count());
+    span.EndNanoseconds = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(endTime - _epoch).count());
+    span.FrameNumber = frameNumber;
+
+    threadBuffer.WriteCount.store(writeCount + 1, memory_order_release);
+}
+
+std::string FrameTraceSink::FormatTrace()
+{
+    lock_guard<mutex> threadBuffersLock(_threadBuffersMutex);
+
+    const DWORD processId = GetCurrentProcessId();
+
+    string trace = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    trace += fmt::format(R"({{"name":"process_name","ph":"M","pid":{:d},"args":{{"name":"{:s}"}}}})", processId, PLUGIN_NAME);
+
+    for (const unique_ptr<ThreadTraceBuffer>& threadBuffer : _threadBuffers)
+    {
+        trace += fmt::format(",\n" R"({{"name":"thread_name","ph":"M","pid":{:d},"tid":{:d},"args":{{"name":"Thread {:d}"}}}})", processId, threadBuffer->ThreadId, threadBuffer->ThreadId);
+
+        const uint64_t writeCount = threadBuffer->WriteCount.load(memory_order_acquire);
+        const uint64_t firstRetainedSpan = writeCount > ThreadTraceBuffer::Capacity ? writeCount - ThreadTraceBuffer::Capacity : 0;
+
+        for (uint64_t spanIndex = firstRetainedSpan; spanIndex < writeCount; spanIndex++)
+        {
+            const TraceSpan& span = threadBuffer->Spans[spanIndex % ThreadTraceBuffer::Capacity];
+
+            trace += fmt::format(",\n" R"({{"name":"{:s}","ph":"X","pid":{:d},"tid":{:d},"ts":{:.3f},"dur":{:.3f})",
+                                 span.Name,
+                                 processId,
+                                 threadBuffer->ThreadId,
+                                 NanosecondsToMicroseconds(span.BeginNanoseconds),
+                                 NanosecondsToMicroseconds(span.EndNanoseconds - span.BeginNanoseconds));
+
+            if (span.FrameNumber >= 0)
+            {
+                trace += fmt::format(R"(,"args":{{"frame":{:d}}})", span.FrameNumber);
+            }
+
+            trace += '}';
+        }
+    }
+
+    trace += "\n]}\n";
+    return trace;
+}
+
+FrameTraceSink::ThreadTraceBuffer& FrameTraceSink::GetThreadBuffer()
+{
+    // Caches the buffer of the sink this thread last recorded to.
+    // Sink identifiers are never reused, so an entry left behind by a destroyed sink can't match.
+    thread_local uint64_t t_cachedSinkId = 0;
+    thread_local ThreadTraceBuffer* t_cachedThreadBuffer = nullptr;
+
+    if (t_cachedSinkId == _sinkId)
+    {
+        return *t_cachedThreadBuffer;
+    }
+
+    const uint32_t threadId = GetCurrentThreadId();
+
+    lock_guard<mutex> threadBuffersLock(_threadBuffersMutex);
+
+    auto threadBufferIter = find_if(_threadBuffers.begin(), _threadBuffers.end(), [threadId](const unique_ptr<ThreadTraceBuffer>& threadBuffer) { return threadBuffer->ThreadId == threadId; });
+    if (threadBufferIter == _threadBuffers.end())
+    {
+        auto threadBuffer = make_unique<ThreadTraceBuffer>();
+        threadBuffer->ThreadId = threadId;
+        threadBufferIter = _threadBuffers.insert(_threadBuffers.end(), move(threadBuffer));
+    }
+
+    t_cachedSinkId = _sinkId;
+    t_cachedThreadBuffer = threadBufferIter->get();
+
+    return *t_cachedThreadBuffer;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Records per-thread timelines of frame processing spans and writes them as
+/// Chrome trace event JSON (see https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU)
+/// for loading into chrome://tracing or the Perfetto UI.
+/// </summary>
+/// <remarks>
+/// Filter instances tracing to the same file share a single sink through <see cref="GetOrCreate"/>,
+/// so the trace is written once, by the last instance to release it.
+/// </remarks>
+class FrameTraceSink
+{
+public:
+    /// <summary>
+    /// A completed span on a thread's timeline.
+    /// </summary>
+    struct TraceSpan
+    {
+        /// <summary>The span name. Must point to a string with static storage duration.</summary>
+        const char* Name;
+
+        /// <summary>The span start time in nanoseconds since the sink was created.</summary>
+        uint64_t BeginNanoseconds;
+
+        /// <summary>The span end time in nanoseconds since the sink was created.</summary>
+        uint64_t EndNanoseconds;
+
+        /// <summary>The zero-based number of the frame being processed, or -1 if not applicable.</summary>
+        int FrameNumber;
+    };
+
+private:
+    /// <summary>
+    /// A fixed capacity ring buffer of spans written by a single thread.
+    /// When full, the oldest spans are overwritten.
+    /// </summary>
+    struct ThreadTraceBuffer
+    {
+        /// <summary>The maximum number of spans retained per thread.</summary>
+        static constexpr size_t Capacity = 1 << 16;
+
+        /// <summary>The operating system identifier of the writing thread.</summary>
+        uint32_t ThreadId;
+
+        /// <summary>
+        /// The total number of spans written. Only the writing thread stores to this;
+        /// the release store publishes the span before it is read when writing the trace.
+        /// </summary>
+        std::atomic<uint64_t> WriteCount = 0;
+
+        std::unique_ptr<TraceSpan[]> Spans = std::make_unique<TraceSpan[]>(Capacity);
+    };
+
+    /// <summary>A process-unique identifier distinguishing this sink in the thread-local buffer cache.</summary>
+    const uint64_t _sinkId;
+
+    /// <summary>The file path to write the trace to on destruction.</summary>
+    const std::string _traceFilePath;
+
+    /// <summary>The time which span timestamps are relative to.</summary>
+    const std::chrono::steady_clock::time_point _epoch;
+
+    /// <summary>Guards <see cref="_threadBuffers"/>. Only taken the first time a thread records a span.</summary>
+    std::mutex _threadBuffersMutex;
+    std::vector<std::unique_ptr<ThreadTraceBuffer>> _threadBuffers;
+
+public:
+    /// <summary>
+    /// The environment variable which enables tracing for all filter instances.
+    /// Its value is the file path to write the trace to.
+    /// </summary>
+    static constexpr auto EnvironmentVariableName = "VSEPROCESSOR_TRACE_FILE";
+
+    /// <summary>
+    /// Constructor for the <see cref="FrameTraceSink"/> class.
+    /// </summary>
+    /// <param name="traceFilePath">(IN) The file path to write the trace to on destruction.</param>
+    explicit FrameTraceSink(const std::string& traceFilePath);
+
+    /// <summary>
+    /// Destructor for the <see cref="FrameTraceSink"/> class. Writes the trace file.
+    /// </summary>
+    ~FrameTraceSink();
+
+    FrameTraceSink(const FrameTraceSink&) = delete;
+    FrameTraceSink& operator=(const FrameTraceSink&) = delete;
+
+    /// <summary>
+    /// Gets the live sink writing to a file path, or creates one if there isn't one.
+    /// </summary>
+    /// <param name="traceFilePath">(IN) The file path to write the trace to.</param>
+    /// <returns>A shared pointer to the <see cref="FrameTraceSink"/>.</returns>
+    static std::shared_ptr<FrameTraceSink> GetOrCreate(const std::string& traceFilePath);
+
+    /// <summary>
+    /// Records a completed span on the calling thread's timeline. Lock-free after the first span recorded by a thread.
+    /// </summary>
+    /// <param name="name">(IN) The span name. Must point to a string with static storage duration.</param>
+    /// <param name="beginTime">(IN) The span start time.</param>
+    /// <param name="endTime">(IN) The span end time.</param>
+    /// <param name="frameNumber">(IN) The zero-based number of the frame being processed, or -1 if not applicable.</param>
+    void RecordSpan(const char* name, const std::chrono::steady_clock::time_point beginTime, const std::chrono::steady_clock::time_point endTime, const int frameNumber = -1);
+
+    /// <summary>
+    /// Formats the recorded spans of all threads as a Chrome trace event JSON document.
+    /// </summary>
+    /// <returns>The JSON document.</returns>
+    std::string FormatTrace();
+
+private:
+    /// <summary>
+    /// Gets the calling thread's buffer, creating and registering it the first time the thread records a span.
+    /// </summary>
+    /// <returns>A reference to the calling thread's <see cref="ThreadTraceBuffer"/>.</returns>
+    ThreadTraceBuffer& GetThreadBuffer();
+};
@@ -0,0 +1,146 @@
+#include "pch.h"
+#include "LetterboxClip.h"
+
+using namespace std;
+
+namespace
+{
+    /// <summary>
+    /// Maps the output chroma samples covering the picture along one axis to the pair of source chroma samples each is averaged from.
+    /// </summary>
+    /// <param name="lumaOffset">The number of luma samples before the picture along the axis.</param>
+    /// <param name="lumaSize">The number of picture luma samples along the axis. Must be even.</param>
+    /// <returns>The source chroma sample pairs, starting with the output chroma sample at <paramref name="lumaOffset"/> / 2.</returns>
+    vector<pair<int, int>> MapChromaSourceSamples(const int lumaOffset, const int lumaSize)
+    {
+        const int firstOutputSample = lumaOffset / 2;
+        const int lastOutputSample = (lumaOffset + lumaSize - 1) / 2;
+        const int lastSourceSample = lumaSize / 2 - 1;
+
+        vector<pair<int, int>> sourceSamples;
+        sourceSamples.reserve(lastOutputSample - firstOutputSample + 1);
+
+        for (int outputSample = firstOutputSample; outputSample <= lastOutputSample; outputSample++)
+        {
+            // With an odd offset, each output chroma sample sits halfway between two source chroma samples
+            const int sourceSample = outputSample - firstOutputSample;
+            const int previousSourceSample = lumaOffset % 2 != 0 ? sourceSample - 1 : sourceSample;
+
+            sourceSamples.emplace_back(clamp(previousSourceSample, 0, lastSourceSample), clamp(sourceSample, 0, lastSourceSample));
+        }
+
+        return sourceSamples;
+    }
+
+    /// <summary>
+    /// Fills the area of a plane outside a picture rectangle with a value.
+    /// </summary>
+    /// <param name="planePtr">A pointer to the first row of the plane.</param>
+    /// <param name="pitch">The plane's pitch in bytes.</param>
+    /// <param name="planeWidth">The plane width in samples.</param>
+    /// <param name="planeHeight">The plane height in samples.</param>
+    /// <param name="pictureRect">The picture rectangle, in samples.</param>
+    /// <param name="value">The sample value to fill with.</param>
+    void FillPlaneBorders(BYTE* planePtr, const int pitch, const int planeWidth, const int planeHeight, const RECT& pictureRect, const uint32_t value)
+    {
+        const auto fillRect = [planePtr, pitch, value](const int left, const int top, const int width, const int height) {
+            if (width > 0 && height > 0)
+            {
+                libyuv::SetPlane(planePtr + top * pitch + left, pitch, width, height, value);
+            }
+        };
+
+        const int pictureHeight = pictureRect.bottom - pictureRect.top;
+
+        fillRect(0, 0, planeWidth, pictureRect.top);
+        fillRect(0, pictureRect.bottom, planeWidth, planeHeight - pictureRect.bottom);
+        fillRect(0, pictureRect.top, pictureRect.left, pictureHeight);
+        fillRect(pictureRect.right, pictureRect.top, planeWidth - pictureRect.right, pictureHeight);
+    }
+}
+
+LetterboxClip::LetterboxClip(PClip childClip, const int outputWidth, const int outputHeight, const int offsetX, const int offsetY, IScriptEnvironment* env)
+    : GenericVideoFilter(childClip), _offsetX(offsetX), _offsetY(offsetY), _pictureWidth(vi.width), _pictureHeight(vi.height)
+{
+    if (!vi.IsYV12())
+    {
+        env->ThrowError(PLUGIN_NAME ": Letterboxing requires YV12 frames");
+    }
+
+    if (outputWidth % YV12_MOD_FACTOR > 0 || outputHeight % YV12_MOD_FACTOR > 0
+        || offsetX < 0 || offsetY < 0 || offsetX + vi.width > outputWidth || offsetY + vi.height > outputHeight)
+    {
+        env->ThrowError(PLUGIN_NAME ": Invalid letterbox size or offset");
+    }
+
+    _chromaSourceColumns = MapChromaSourceSamples(offsetX, vi.width);
+    _chromaSourceRows = MapChromaSourceSamples(offsetY, vi.height);
+
+    vi.width = outputWidth;
+    vi.height = outputHeight;
+}
+
+PVideoFrame __stdcall LetterboxClip::GetFrame(int n, IScriptEnvironment* env)
+{
+    PVideoFrame sourceFrame = child->GetFrame(n, env);
+    PVideoFrame outputFrame = env->NewVideoFrame(vi);
+
+    FillBorders(outputFrame);
+
+    libyuv::CopyPlane(sourceFrame->GetReadPtr(PLANAR_Y), sourceFrame->GetPitch(PLANAR_Y),
+                      outputFrame->GetWritePtr(PLANAR_Y) + _offsetY * outputFrame->GetPitch(PLANAR_Y) + _offsetX, outputFrame->GetPitch(PLANAR_Y),
+                      sourceFrame->GetRowSize(PLANAR_Y), sourceFrame->GetHeight(PLANAR_Y));
+
+    CopyChromaPlane(sourceFrame, outputFrame, PLANAR_U);
+    CopyChromaPlane(sourceFrame, outputFrame, PLANAR_V);
+
+    return outputFrame;
+}
+
+void LetterboxClip::FillBorders(PVideoFrame& outputFrame) const
+{
+    const RECT lumaPictureRect = { _offsetX, _offsetY, _offsetX + _pictureWidth, _offsetY + _pictureHeight };
+    FillPlaneBorders(outputFrame->GetWritePtr(PLANAR_Y), outputFrame->GetPitch(PLANAR_Y), vi.width, vi.height, lumaPictureRect, 16);
+
+    // The chroma samples written by CopyChromaPlane
+    const RECT chromaPictureRect = {
+        _offsetX / 2,
+        _offsetY / 2,
+        _offsetX / 2 + static_cast<LONG>(_chromaSourceColumns.size()),
+        _offsetY / 2 + static_cast<LONG>(_chromaSourceRows.size())
+    };
+
+    for (const int plane : { PLANAR_U, PLANAR_V })
+    {
+        FillPlaneBorders(outputFrame->GetWritePtr(plane), outputFrame->GetPitch(plane), vi.width / 2, vi.height / 2, chromaPictureRect, 128);
+    }
+}
+
+void LetterboxClip::CopyChromaPlane(const PVideoFrame& sourceFrame, PVideoFrame& outputFrame, const int plane) const
+{
+    const BYTE* sourceReadPtr = sourceFrame->GetReadPtr(plane);
+    const int sourcePitch = sourceFrame->GetPitch(plane);
+    const int outputPitch = outputFrame->GetPitch(plane);
+    BYTE* outputWritePtr = outputFrame->GetWritePtr(plane) + (_offsetY / 2) * outputPitch + _offsetX / 2;
+
+    if (_offsetX % 2 == 0 && _offsetY % 2 == 0)
+    {
+        libyuv::CopyPlane(sourceReadPtr, sourcePitch, outputWritePtr, outputPitch, sourceFrame->GetRowSize(plane), sourceFrame->GetHeight(plane));
+        return;
+    }
+
+    for (const auto& [previousSourceRow, sourceRow] : _chromaSourceRows)
+    {
+        const BYTE* previousSourceRowPtr = sourceReadPtr + previousSourceRow * sourcePitch;
+        const BYTE* sourceRowPtr = sourceReadPtr + sourceRow * sourcePitch;
+
+        BYTE* outputPixelPtr = outputWritePtr;
+        for (const auto& [previousSourceColumn, sourceColumn] : _chromaSourceColumns)
+        {
+            *outputPixelPtr++ = static_cast<BYTE>((previousSourceRowPtr[previousSourceColumn] + previousSourceRowPtr[sourceColumn]
+                                                   + sourceRowPtr[previousSourceColumn] + sourceRowPtr[sourceColumn] + 2) >> 2);
+        }
+
+        outputWritePtr += outputPitch;
+    }
+}
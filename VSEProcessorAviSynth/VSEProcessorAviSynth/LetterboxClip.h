@@ -0,0 +1,73 @@
+#pragma once
+
+/// <summary>
+/// Letterboxes a YV12 clip by placing each frame at an offset within a larger black frame.
+/// Unlike AddBorders, the offset doesn't have to be mod2 (divisible by 2).
+/// </summary>
+/// <remarks>
+/// Luma rows are copied to the offset. A chroma plane can only be offset by whole chroma samples,
+/// so an odd luma offset shifts the chroma by half a sample, averaging each pair of neighboring samples
+/// and duplicating the edge samples.
+/// Only the borders of each output frame are filled, so no sample is written twice.
+/// </remarks>
+class LetterboxClip : public GenericVideoFilter
+{
+    /// <summary>The number of pixel columns left of the picture.</summary>
+    const int _offsetX;
+
+    /// <summary>The number of pixel rows above the picture.</summary>
+    const int _offsetY;
+
+    /// <summary>The width of the picture in pixels.</summary>
+    const int _pictureWidth;
+
+    /// <summary>The height of the picture in pixels.</summary>
+    const int _pictureHeight;
+
+    /// <summary>
+    /// For each output chroma column covering the picture, the pair of source chroma columns it is averaged from.
+    /// The pair is the same column when the horizontal offset is even.
+    /// </summary>
+    std::vector<std::pair<int, int>> _chromaSourceColumns;
+
+    /// <summary>
+    /// For each output chroma row covering the picture, the pair of source chroma rows it is averaged from.
+    /// The pair is the same row when the vertical offset is even.
+    /// </summary>
+    std::vector<std::pair<int, int>> _chromaSourceRows;
+
+public:
+    /// <summary>
+    /// Constructor for the <see cref="LetterboxClip"/> class.
+    /// </summary>
+    /// <param name="childClip">The YV12 <see cref="PClip"/> to letterbox.</param>
+    /// <param name="outputWidth">The output frame width in pixels. Must be even.</param>
+    /// <param name="outputHeight">The output frame height in pixels. Must be even.</param>
+    /// <param name="offsetX">The number of pixel columns left of the picture.</param>
+    /// <param name="offsetY">The number of pixel rows above the picture.</param>
+    /// <param name="env">The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
+    LetterboxClip(PClip childClip, const int outputWidth, const int outputHeight, const int offsetX, const int offsetY, IScriptEnvironment* env);
+
+    /// <summary>
+    /// Called when AviSynth requests frame <paramref name="n"/> from this filter.
+    /// </summary>
+    /// <param name="n">The frame number.</param>
+    /// <param name="env">The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
+    /// <returns>The letterboxed frame.</returns>
+    PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override;
+
+private:
+    /// <summary>
+    /// Fills the luma and chroma samples of an output frame outside the picture area with black.
+    /// </summary>
+    /// <param name="outputFrame">The output <see cref="PVideoFrame"/>.</param>
+    void FillBorders(PVideoFrame& outputFrame) const;
+
+    /// <summary>
+    /// Copies a source chroma plane into the picture area of an output chroma plane.
+    /// </summary>
+    /// <param name="sourceFrame">The source <see cref="PVideoFrame"/>.</param>
+    /// <param name="outputFrame">The output <see cref="PVideoFrame"/>.</param>
+    /// <param name="plane">The chroma plane, PLANAR_U or PLANAR_V.</param>
+    void CopyChromaPlane(const PVideoFrame& sourceFrame, PVideoFrame& outputFrame, const int plane) const;
+};
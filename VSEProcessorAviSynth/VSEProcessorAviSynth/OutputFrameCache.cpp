@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "OutputFrameCache.h"
+
+using namespace std;
+
+PVideoFrame OutputFrameCache::Get(const int frameNumber)
+{
+    lock_guard<mutex> cacheLock(_cacheMutex);
+
+    auto cachedFrameIter = _cachedFrames.find(frameNumber);
+    if (cachedFrameIter == _cachedFrames.end())
+    {
+        return nullptr;
+    }
+
+    cachedFrameIter->second.LastUse = ++_useCount;
+    return cachedFrameIter->second.Frame;
+}
+
+void OutputFrameCache::Add(const int frameNumber, const PVideoFrame& frame, const uint64_t generation)
+{
+    lock_guard<mutex> cacheLock(_cacheMutex);
+
+    if (generation != _generation)
+    {
+        return;
+    }
+
+    if (_cachedFrames.size() >= Capacity && !_cachedFrames.contains(frameNumber))
+    {
+        auto leastRecentlyUsedIter = min_element(_cachedFrames.begin(), _cachedFrames.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second.LastUse < rhs.second.LastUse;
+        });
+
+        _cachedFrames.erase(leastRecentlyUsedIter);
+    }
+
+    _cachedFrames[frameNumber] = { frame, ++_useCount };
+}
+
+void OutputFrameCache::Invalidate(const std::vector<FrameRange>& changedFrameRanges, const uint64_t generation)
+{
+    lock_guard<mutex> cacheLock(_cacheMutex);
+
+    _generation = generation;
+
+    for (const FrameRange& changedFrameRange : changedFrameRanges)
+    {
+        _cachedFrames.erase(_cachedFrames.lower_bound(changedFrameRange.StartFrame), _cachedFrames.upper_bound(changedFrameRange.EndFrame));
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <mutex>
+#include "VSEProjectDiff.h"
+
+/// <summary>
+/// A small least recently used cache of processed frames, which discards only the frames a project change affects.
+/// </summary>
+/// <remarks>
+/// Used in place of AviSynth's frame cache while the project file is watched, as AviSynth can't be told which frames are stale.
+/// Frames are tagged with the generation of the compiled timeline they were rendered from,
+/// so a frame still being rendered from a replaced timeline isn't cached after its range is invalidated.
+/// </remarks>
+class OutputFrameCache
+{
+public:
+    /// <summary>The maximum number of cached frames.</summary>
+    static constexpr size_t Capacity = 32;
+
+private:
+    /// <summary>A cached frame and the time it was last used.</summary>
+    struct CachedFrame
+    {
+        /// <summary>The processed frame.</summary>
+        PVideoFrame Frame;
+
+        /// <summary>The value of <see cref="_useCount"/> when the frame was last added or retrieved.</summary>
+        uint64_t LastUse;
+    };
+
+    /// <summary>Guards all other members, as frames may be requested from multiple threads.</summary>
+    std::mutex _cacheMutex;
+
+    /// <summary>Cached frames keyed by zero-based source frame number.</summary>
+    std::map<int, CachedFrame> _cachedFrames;
+
+    /// <summary>A counter incremented on each use of the cache, ordering frames by recency of use.</summary>
+    uint64_t _useCount = 0;
+
+    /// <summary>The generation of the compiled timeline frames are currently accepted from.</summary>
+    uint64_t _generation = 0;
+
+public:
+    /// <summary>
+    /// Gets a cached frame.
+    /// </summary>
+    /// <param name="frameNumber">(IN) The zero-based source frame number.</param>
+    /// <returns>The cached frame, or nullptr if the frame isn't cached.</returns>
+    PVideoFrame Get(const int frameNumber);
+
+    /// <summary>
+    /// Caches a frame, evicting the least recently used frame if the cache is full.
+    /// </summary>
+    /// <param name="frameNumber">(IN) The zero-based source frame number.</param>
+    /// <param name="frame">(IN) The processed frame.</param>
+    /// <param name="generation">(IN) The generation of the compiled timeline the frame was rendered from. Stale frames aren't cached.</param>
+    void Add(const int frameNumber, const PVideoFrame& frame, const uint64_t generation);
+
+    /// <summary>
+    /// Discards the cached frames in changed frame ranges, and stops accepting frames from earlier timeline generations.
+    /// </summary>
+    /// <param name="changedFrameRanges">(IN) The changed <see cref="FrameRange"/>s of zero-based source frame numbers.</param>
+    /// <param name="generation">(IN) The generation of the compiled timeline replacing the previous one.</param>
+    void Invalidate(const std::vector<FrameRange>& changedFrameRanges, const uint64_t generation);
+};
@@ -0,0 +1,39 @@
+#include "pch.h"
+#include "ProjectFileWatcher.h"
+#include "CompiledProjectCache.h"
+
+using namespace std;
+
+ProjectFileWatcher::ProjectFileWatcher(const char* projectFileName, ProjectChangedCallback onProjectChanged)
+    : _projectFilePath(filesystem::canonical(projectFileName)), _onProjectChanged(move(onProjectChanged)), _lastWriteTime(filesystem::last_write_time(_projectFilePath))
+{
+    _watchThread = jthread([this](stop_token stopToken) { Watch(stopToken); });
+}
+
+void ProjectFileWatcher::Watch(std::stop_token stopToken)
+{
+    unique_lock<mutex> stopLock(_stopMutex);
+
+    // Wakes early when the watcher is destroyed
+    while (!_stopCondition.wait_for(stopLock, stopToken, PollInterval, [&stopToken] { return stopToken.stop_requested(); }))
+    {
+        error_code lastWriteTimeError;
+        const filesystem::file_time_type lastWriteTime = filesystem::last_write_time(_projectFilePath, lastWriteTimeError);
+        if (lastWriteTimeError || lastWriteTime == _lastWriteTime)
+        {
+            // Unchanged, or briefly missing while an editor replaces it
+            continue;
+        }
+
+        _lastWriteTime = lastWriteTime;
+
+        try
+        {
+            _onProjectChanged(CompiledProjectCache::GetOrParse(_projectFilePath.string().c_str()));
+        }
+        catch (const exception&)
+        {
+            // Keep the current project until the file changes again
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+/// <summary>
+/// Watches a Video Script Editor project file on a background thread, re-parsing it after each change.
+/// </summary>
+/// <remarks>
+/// The file's last write time is polled rather than using directory change notifications,
+/// so that editors which save by replacing the file are handled the same as those which rewrite it.
+/// A project file which fails to parse, for example while it is still being written, is ignored until its next change.
+/// </remarks>
+class ProjectFileWatcher
+{
+public:
+    /// <summary>
+    /// A function called on the watch thread with the re-parsed project after the project file changes.
+    /// </summary>
+    using ProjectChangedCallback = std::function<void(std::shared_ptr<const VSEProject>)>;
+
+    /// <summary>The interval between checks of the project file's last write time.</summary>
+    static constexpr std::chrono::milliseconds PollInterval = std::chrono::milliseconds(250);
+
+private:
+    /// <summary>The file path of the watched project file.</summary>
+    const std::filesystem::path _projectFilePath;
+
+    /// <summary>The function called with the re-parsed project after the project file changes.</summary>
+    const ProjectChangedCallback _onProjectChanged;
+
+    /// <summary>The project file's last write time when it was last parsed. Only accessed by the watch thread after construction.</summary>
+    std::filesystem::file_time_type _lastWriteTime;
+
+    /// <summary>Guards waiting on <see cref="_stopCondition"/>.</summary>
+    std::mutex _stopMutex;
+
+    /// <summary>Wakes the watch thread when a stop is requested.</summary>
+    std::condition_variable_any _stopCondition;
+
+    /// <summary>The watch thread. Declared last, so that it is stopped and joined before the other members are destroyed.</summary>
+    std::jthread _watchThread;
+
+public:
+    /// <summary>
+    /// Constructor for the <see cref="ProjectFileWatcher"/> class. Starts watching the project file.
+    /// </summary>
+    /// <param name="projectFileName">(IN) The file path of the already parsed project file to watch.</param>
+    /// <param name="onProjectChanged">(IN) The function to call with the re-parsed project after the project file changes.</param>
+    ProjectFileWatcher(const char* projectFileName, ProjectChangedCallback onProjectChanged);
+
+    /// <summary>
+    /// Destructor for the <see cref="ProjectFileWatcher"/> class. Stops watching and waits for the watch thread to exit.
+    /// </summary>
+    ~ProjectFileWatcher() = default;
+
+    ProjectFileWatcher(const ProjectFileWatcher&) = delete;
+    ProjectFileWatcher& operator=(const ProjectFileWatcher&) = delete;
+
+private:
+    /// <summary>
+    /// The watch thread procedure. Polls the project file until a stop is requested.
+    /// </summary>
+    /// <param name="stopToken">(IN) The <see cref="std::stop_token"/> signalled when the watcher is destroyed.</param>
+    void Watch(std::stop_token stopToken);
+};
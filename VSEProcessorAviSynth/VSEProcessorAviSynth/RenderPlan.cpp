@@ -0,0 +1,128 @@
+#include "pch.h"
+#include "RenderPlan.h"
+#include <set>
+
+using namespace VideoScriptEditor::Unmanaged;
+using namespace std;
+
+namespace
+{
+    /// <summary>
+    /// Determines whether a crop segment's frame data may have a non-zero rotation angle on a frame.
+    /// </summary>
+    /// <remarks>Mirrors the key frame lookup in VSEProcessorAviSynth::GetFrame.</remarks>
+    bool IsCropRotated(const SegmentModel& cropSegmentModel, const int frameNumber)
+    {
+        auto keyFrameAtOrAfterIter = cropSegmentModel.KeyFrames.lower_bound(frameNumber);
+        if (keyFrameAtOrAfterIter == cropSegmentModel.KeyFrames.end())
+        {
+            --keyFrameAtOrAfterIter;
+        }
+
+        auto hasAngle = [](const shared_ptr<KeyFrameModelBase>& keyFrame) {
+            const CropKeyFrameModel* cropKeyFrame = dynamic_cast<const CropKeyFrameModel*>(keyFrame.get());
+            assert(cropKeyFrame != nullptr);
+            return cropKeyFrame->Angle != 0.0;
+        };
+
+        if (hasAngle(keyFrameAtOrAfterIter->second))
+        {
+            return true;
+        }
+
+        // Interpolated frame
+        return keyFrameAtOrAfterIter->first > frameNumber && keyFrameAtOrAfterIter != cropSegmentModel.KeyFrames.begin()
+            && hasAngle(prev(keyFrameAtOrAfterIter)->second);
+    }
+}
+
+RenderPlan::RenderPlan(const VSEProject& project, const int firstFrame, const int lastFrame)
+{
+    // Frame numbers where the active segments or a crop's rotation can change
+    vector<int> boundaries = { firstFrame, lastFrame + 1 };
+    for (const SegmentModel& segmentModel : project.SegmentModels)
+    {
+        boundaries.push_back(segmentModel.StartFrame);
+        boundaries.push_back(segmentModel.EndFrame + 1);
+
+        if (segmentModel.Type == SegmentType::Crop)
+        {
+            for (const auto& [keyFrameNumber, keyFrame] : segmentModel.KeyFrames)
+            {
+                boundaries.push_back(keyFrameNumber);
+                boundaries.push_back(keyFrameNumber + 1);
+            }
+        }
+    }
+
+    erase_if(boundaries, [firstFrame, lastFrame](const int boundary) { return boundary < firstFrame || boundary > lastFrame + 1; });
+    sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    for (size_t boundaryIndex = 0; boundaryIndex + 1 < boundaries.size(); boundaryIndex++)
+    {
+        RenderPlanRange range = { boundaries[boundaryIndex], boundaries[boundaryIndex + 1] - 1, RenderPipeline::PassThrough, {} };
+
+        set<int> croppingTracks, maskingTracks;
+        bool anyCropRotated = false;
+
+        for (size_t segmentIndex = 0; segmentIndex < project.SegmentModels.size(); segmentIndex++)
+        {
+            const SegmentModel& segmentModel = project.SegmentModels[segmentIndex];
+            if (segmentModel.KeyFrames.empty() || range.StartFrame < segmentModel.StartFrame || range.StartFrame > segmentModel.EndFrame)
+            {
+                continue;
+            }
+
+            range.SegmentIndices.push_back(segmentIndex);
+
+            if (segmentModel.Type == SegmentType::Crop)
+            {
+                croppingTracks.insert(segmentModel.TrackNumber);
+                anyCropRotated = anyCropRotated || IsCropRotated(segmentModel, range.StartFrame);
+            }
+            else
+            {
+                maskingTracks.insert(segmentModel.TrackNumber);
+            }
+        }
+
+        if (croppingTracks.size() > 1 || anyCropRotated)
+        {
+            range.Pipeline = RenderPipeline::Direct2D;
+        }
+        else if (croppingTracks.size() == 1)
+        {
+            range.Pipeline = maskingTracks.empty() ? RenderPipeline::AxisAlignedCrop : RenderPipeline::BlurMaskAndAxisAlignedCrop;
+        }
+        else if (!maskingTracks.empty())
+        {
+            range.Pipeline = RenderPipeline::BlurMask;
+        }
+
+        if (!_ranges.empty() && _ranges.back().Pipeline == range.Pipeline && _ranges.back().SegmentIndices == range.SegmentIndices)
+        {
+            _ranges.back().EndFrame = range.EndFrame;
+        }
+        else
+        {
+            _ranges.push_back(move(range));
+        }
+    }
+}
+
+const RenderPlanRange& RenderPlan::GetRange(const int frameNumber) const
+{
+    auto rangeAfterIter = upper_bound(_ranges.begin(), _ranges.end(), frameNumber, [](const int frame, const RenderPlanRange& range) {
+        return frame < range.StartFrame;
+    });
+
+    if (rangeAfterIter == _ranges.begin() || frameNumber > prev(rangeAfterIter)->EndFrame)
+    {
+        // Outside the planned frames, where no segment is active
+        static const RenderPlanRange PassThroughRange = { 0, -1, RenderPipeline::PassThrough, {} };
+        return PassThroughRange;
+    }
+
+    return *prev(rangeAfterIter);
+}
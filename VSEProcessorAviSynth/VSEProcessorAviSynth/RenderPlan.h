@@ -0,0 +1,80 @@
+#pragma once
+
+/// <summary>
+/// The processing pipeline variants a frame can be rendered through.
+/// </summary>
+enum class RenderPipeline
+{
+    /// <summary>No active segments. The child frame is passed through unprocessed.</summary>
+    PassThrough,
+
+    /// <summary>Masking segments only. The blur mask is overlaid through the AviSynth Overlay filter.</summary>
+    BlurMask,
+
+    /// <summary>A single axis-aligned (zero rotation angle) crop, resized through AviSynth.</summary>
+    AxisAlignedCrop,
+
+    /// <summary>Masking segments overlaid through AviSynth, followed by a single axis-aligned crop.</summary>
+    BlurMaskAndAxisAlignedCrop,
+
+    /// <summary>Rotated or multiple crops rendered through Direct2D, with or without masking segments.</summary>
+    Direct2D
+};
+
+/// <summary>
+/// An inclusive range of frames sharing the same active segments and <see cref="RenderPipeline"/>.
+/// </summary>
+struct RenderPlanRange
+{
+    /// <summary>The inclusive zero-based start frame number of the range.</summary>
+    int StartFrame;
+
+    /// <summary>The inclusive zero-based end frame number of the range.</summary>
+    int EndFrame;
+
+    /// <summary>The <see cref="RenderPipeline"/> that renders the frames in the range.</summary>
+    RenderPipeline Pipeline;
+
+    /// <summary>The indices into the project's <see cref="VSEProject::SegmentModels"/> of the segments active on every frame in the range.</summary>
+    std::vector<size_t> SegmentIndices;
+};
+
+/// <summary>
+/// A Video Script Editor project compiled into contiguous frame ranges,
+/// each with its active segments and pre-selected <see cref="RenderPipeline"/>,
+/// so that rendering a frame doesn't search every segment or re-evaluate which pipeline to use.
+/// </summary>
+/// <remarks>
+/// A crop is treated as rotated on a frame interpolated between two key frames if either key frame has a non-zero angle.
+/// Rendering such a frame through Direct2D is correct even at an exact zero angle crossing, just slower.
+/// </remarks>
+class RenderPlan
+{
+    /// <summary>The plan's ranges, contiguous and in frame order.</summary>
+    std::vector<RenderPlanRange> _ranges;
+
+public:
+    /// <summary>Creates an empty <see cref="RenderPlan"/>.</summary>
+    RenderPlan() = default;
+
+    /// <summary>
+    /// Compiles a <see cref="RenderPlan"/> for a range of frames of a project.
+    /// </summary>
+    /// <param name="project">(IN) A reference to the <see cref="VSEProject"/> to compile. Segments without key frames are ignored.</param>
+    /// <param name="firstFrame">(IN) The zero-based number of the first frame to plan.</param>
+    /// <param name="lastFrame">(IN) The zero-based number of the last frame to plan.</param>
+    RenderPlan(const VSEProject& project, const int firstFrame, const int lastFrame);
+
+    /// <summary>Gets the plan's ranges, contiguous and in frame order.</summary>
+    const std::vector<RenderPlanRange>& get_Ranges() const { return _ranges; }
+
+    /// <summary>
+    /// Gets the range containing a frame.
+    /// </summary>
+    /// <param name="frameNumber">(IN) The zero-based frame number.</param>
+    /// <returns>
+    /// A reference to the <see cref="RenderPlanRange"/> containing <paramref name="frameNumber"/>,
+    /// or to an empty <see cref="RenderPipeline::PassThrough"/> range if the frame is outside the planned frames.
+    /// </returns>
+    const RenderPlanRange& GetRange(const int frameNumber) const;
+};
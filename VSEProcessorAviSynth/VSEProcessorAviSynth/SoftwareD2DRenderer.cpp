@@ -7,8 +7,8 @@ using namespace VideoScriptEditor::Unmanaged;
 using Microsoft::WRL::ComPtr;	// See https://github.com/Microsoft/DirectXTK/wiki/ComPtr
 using namespace std;
 
-SoftwareD2DRenderer::SoftwareD2DRenderer(const D2D1_SIZE_U& sourceVideoSize, const D2D1_SIZE_U& outputVideoSize, std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingSegmentFrames)
-    : D2DRendererBase(maskingGeometries, croppingSegmentFrames), _sourceVideoSize(sourceVideoSize), _outputVideoSize(outputVideoSize)
+SoftwareD2DRenderer::SoftwareD2DRenderer(const D2D1_SIZE_U& sourceVideoSize, const D2D1_SIZE_U& outputVideoSize, VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingSegmentFrames, const StageInstrumentation& stageInstrumentation)
+    : D2DRendererBase(maskingGeometries, croppingSegmentFrames), _sourceVideoSize(sourceVideoSize), _outputVideoSize(outputVideoSize), _stageInstrumentation(stageInstrumentation)
 {
     CreateDeviceIndependentResources();
 }
@@ -25,38 +25,23 @@ void SoftwareD2DRenderer::RenderBlurMaskedAndCroppedFrame(const PVideoFrame& sou
         CopyVideoFramePixelsToD2DBitmap(sourceVideoFrame, srcFrameD2DBmp)
     );
 
-    ComPtr<ID2D1Bitmap1> sourceCompatibleRenderTargetBitmap;
-    HR::ThrowIfFailed(
-        CreateSourceCompatibleRenderTargetBitmap(srcFrameD2DBmp.Get(), sourceCompatibleRenderTargetBitmap.ReleaseAndGetAddressOf())
-    );
-
-    // Preserve the pre-existing target.
-    ComPtr<ID2D1Image> wicRenderTarget;
-    _d2dContext->GetTarget(&wicRenderTarget);
-
-    //
-    // Masking
-    //
-
-    RenderBlurMask(srcFrameD2DBmp.Get(), sourceCompatibleRenderTargetBitmap.Get());
+    {
+        // Masking and cropping are fused into a single pass per crop viewport, without a full frame blur mask intermediate.
+        // Only the masked area visible through each viewport is blurred, so blur time is recorded as part of the crop.
+        ScopedStageTimer cropTimer(_stageInstrumentation, ProcessingStage::Direct2DCrop);
+        RenderCroppedFrameInternal(srcFrameD2DBmp.Get(), true);
+    }
 
     // Clear effect input to ease memory
     _gaussianBlurEffect->SetInput(0, nullptr);
 
-    //
-    // Cropping
-    //
-
-    // Restore render target
-    _d2dContext->SetTarget(wicRenderTarget.Get());
-
-    RenderCroppedFrameInternal(sourceCompatibleRenderTargetBitmap.Get());
-
     CopyRenderTargetBmpPixelsToFrame(outputVideoFrame, outputVideoFrameInfo);
 }
 
 void SoftwareD2DRenderer::RenderOverlayMaskFrame(PVideoFrame& outputVideoFrame, const VideoInfo& outputVideoFrameInfo)
 {
+    ScopedStageTimer maskRenderTimer(_stageInstrumentation, ProcessingStage::MaskRender);
+
     ComPtr<ID2D1SolidColorBrush> whiteColorBrush;
     HR::ThrowIfFailed(
         _renderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::White, 1.0f), &whiteColorBrush)
@@ -84,14 +69,18 @@ void SoftwareD2DRenderer::RenderBlurFrame(const PVideoFrame& sourceVideoFrame, P
         CopyVideoFramePixelsToD2DBitmap(sourceVideoFrame, srcFrameD2DBmp)
     );
 
-    _gaussianBlurEffect->SetInput(0, srcFrameD2DBmp.Get());
-    _d2dContext->BeginDraw();
-    _d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black, 1.f));
-    _d2dContext->DrawImage(_gaussianBlurEffect.Get());
+    {
+        ScopedStageTimer blurTimer(_stageInstrumentation, ProcessingStage::Blur);
 
-    HR::ThrowIfFailed(
-        _d2dContext->EndDraw()
-    );
+        _gaussianBlurEffect->SetInput(0, srcFrameD2DBmp.Get());
+        _d2dContext->BeginDraw();
+        _d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black, 1.f));
+        _d2dContext->DrawImage(_gaussianBlurEffect.Get());
+
+        HR::ThrowIfFailed(
+            _d2dContext->EndDraw()
+        );
+    }
 
     // Clear effect input to ease memory
     _gaussianBlurEffect->SetInput(0, nullptr);
@@ -106,7 +95,10 @@ void SoftwareD2DRenderer::RenderCroppedFrame(const PVideoFrame& sourceVideoFrame
         CopyVideoFramePixelsToD2DBitmap(sourceVideoFrame, srcFrameD2DBmp)
     );
 
-    RenderCroppedFrameInternal(srcFrameD2DBmp.Get());
+    {
+        ScopedStageTimer cropTimer(_stageInstrumentation, ProcessingStage::Direct2DCrop);
+        RenderCroppedFrameInternal(srcFrameD2DBmp.Get());
+    }
 
     CopyRenderTargetBmpPixelsToFrame(outputVideoFrame, outputVideoFrameInfo);
 }
@@ -147,6 +139,8 @@ void SoftwareD2DRenderer::CreateDeviceIndependentResources()
 
 HRESULT SoftwareD2DRenderer::CopyVideoFramePixelsToD2DBitmap(const PVideoFrame& sourceVideoFrame, Microsoft::WRL::ComPtr<ID2D1Bitmap1>& targetBitmap)
 {
+    ScopedStageTimer pixelCopyTimer(_stageInstrumentation, ProcessingStage::PixelCopy);
+
     const D2D1_PIXEL_FORMAT renderTargetPixelFormat = _renderTarget->GetPixelFormat();
     const BYTE* srcFrameReadPtr = sourceVideoFrame->GetReadPtr();
     const D2D1_BITMAP_PROPERTIES1 targetBitmapProps = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE, renderTargetPixelFormat);
@@ -156,6 +150,8 @@ HRESULT SoftwareD2DRenderer::CopyVideoFramePixelsToD2DBitmap(const PVideoFrame&
 
 void SoftwareD2DRenderer::CopyRenderTargetBmpPixelsToFrame(PVideoFrame& destinationVideoFrame, const VideoInfo& destinationVideoFrameInfo)
 {
+    ScopedStageTimer pixelCopyTimer(_stageInstrumentation, ProcessingStage::PixelCopy);
+
     WICRect renderTargetBmpLockRect = { 0, 0, destinationVideoFrameInfo.width, destinationVideoFrameInfo.height };
     ComPtr<IWICBitmapLock> renderTargetBmpLock;
 
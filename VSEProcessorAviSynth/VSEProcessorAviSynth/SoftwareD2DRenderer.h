@@ -1,5 +1,6 @@
 #pragma once
 #include "..\..\Shared\cpp\D2DRendererBase.h"
+#include "StageTimingProfiler.h"
 
 /// <summary>
 /// Software Direct2D Renderer.
@@ -17,6 +18,9 @@ class SoftwareD2DRenderer : public VideoScriptEditor::Unmanaged::D2DRendererBase
     // Direct2D objects.
     Microsoft::WRL::ComPtr<ID2D1RenderTarget> _renderTarget;
 
+    /// <summary>The <see cref="StageInstrumentation"/> to record rendering stage durations to.</summary>
+    const StageInstrumentation _stageInstrumentation;
+
 public:
     /// <summary>
     /// Constructor for the <see cref="SoftwareD2DRenderer"/> class.
@@ -29,11 +33,14 @@ public:
     /// A reference to a <see cref="D2D1_SIZE_U"/> structure containing the width and height of the output video in pixels.
     /// </param>
     /// <param name="maskingGeometries">
-    /// A reference to a masking geometries <see cref="std::map"/>, keyed by masking segment track number,
+    /// A reference to a masking geometries <see cref="TrackIndexedTable"/>, indexed by masking segment track number,
     /// which provides a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
     /// </param>
-    /// <param name="croppingSegmentFrames">A reference to a cropping segment frame data <see cref="std::map"/> keyed by the cropping segment's track number.</param>
-    SoftwareD2DRenderer(const D2D1_SIZE_U& sourceVideoSize, const D2D1_SIZE_U& outputVideoSize, std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingSegmentFrames);
+    /// <param name="croppingSegmentFrames">A reference to a cropping segment frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.</param>
+    /// <param name="stageInstrumentation">
+    /// The <see cref="StageInstrumentation"/> to record rendering stage durations to. Disabled by default.
+    /// </param>
+    SoftwareD2DRenderer(const D2D1_SIZE_U& sourceVideoSize, const D2D1_SIZE_U& outputVideoSize, VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingSegmentFrames, const StageInstrumentation& stageInstrumentation = StageInstrumentation());
 
     /// <summary>
     /// Destructor for the <see cref="SoftwareD2DRenderer"/> class.
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "SourceFrameSet.h"
+#include "SingleFrameClip.h"
+
+SourceFrameSet::SourceFrameSet(const PClip& sourceClip, const PClip& childClip, const int frameNumber, IScriptEnvironment* env, const StageInstrumentation& stageInstrumentation)
+    : _sourceClip(sourceClip), _childClip(childClip), _frameNumber(frameNumber), _env(env), _stageInstrumentation(stageInstrumentation)
+{
+}
+
+const PVideoFrame& SourceFrameSet::GetSourceFrame()
+{
+    if (!_sourceFrame)
+    {
+        ScopedStageTimer upstreamFrameRequestTimer(_stageInstrumentation, ProcessingStage::UpstreamFrameRequest);
+        _sourceFrame = _sourceClip->GetFrame(_frameNumber, _env);
+    }
+
+    return _sourceFrame;
+}
+
+const PVideoFrame& SourceFrameSet::GetChildFrame()
+{
+    if (static_cast<void*>(_childClip) == static_cast<void*>(_sourceClip))
+    {
+        return GetSourceFrame();
+    }
+
+    if (!_childFrame)
+    {
+        ScopedStageTimer upstreamFrameRequestTimer(_stageInstrumentation, ProcessingStage::UpstreamFrameRequest);
+        _childFrame = _childClip->GetFrame(_frameNumber, _env);
+    }
+
+    return _childFrame;
+}
+
+PClip SourceFrameSet::GetChildFrameClip()
+{
+    return new SingleFrameClip(_childClip->GetVideoInfo(), GetChildFrame());
+}
+
+const PVideoFrame& SourceFrameSet::GetRgbSourceFrame()
+{
+    if (!_rgbSourceFrame)
+    {
+        const PVideoFrame& sourceFrame = GetSourceFrame();
+
+        VideoInfo rgbFrameInfo = _sourceClip->GetVideoInfo();
+        rgbFrameInfo.pixel_type = VideoInfo::CS_BGR32;
+
+        PVideoFrame rgbFrame = _env->NewVideoFrame(rgbFrameInfo);
+
+        ScopedStageTimer colorConversionTimer(_stageInstrumentation, ProcessingStage::ColorConversion);
+
+        // Matches the matrix InvokeAvsColorConversionFilter selects for the conversion back to YV12
+        const libyuv::YuvConstants* yuvConstants = rgbFrameInfo.height < 720 ? &libyuv::kYuvI601Constants : &libyuv::kYuvH709Constants;
+
+        // AviSynth RGB frames are stored bottom-up, so writing rows top-down gives the vertically flipped frame Direct2D expects
+        if (libyuv::I420ToARGBMatrix(sourceFrame->GetReadPtr(PLANAR_Y), sourceFrame->GetPitch(PLANAR_Y),
+                                     sourceFrame->GetReadPtr(PLANAR_U), sourceFrame->GetPitch(PLANAR_U),
+                                     sourceFrame->GetReadPtr(PLANAR_V), sourceFrame->GetPitch(PLANAR_V),
+                                     rgbFrame->GetWritePtr(), rgbFrame->GetPitch(),
+                                     yuvConstants,
+                                     rgbFrameInfo.width, rgbFrameInfo.height) == -1)
+        {
+            _env->ThrowError(PLUGIN_NAME ": Failed to convert the source frame to RGB.");
+        }
+
+        _rgbSourceFrame = rgbFrame;
+    }
+
+    return _rgbSourceFrame;
+}
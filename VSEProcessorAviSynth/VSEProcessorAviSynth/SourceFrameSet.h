@@ -0,0 +1,82 @@
+#pragma once
+#include "StageTimingProfiler.h"
+
+/// <summary>
+/// The source frames needed to process one output frame, each fetched or derived at most once per GetFrame call
+/// and shared between the processing branches that need them.
+/// </summary>
+/// <remarks>
+/// The RGB source frame is converted directly from the fetched YV12 source frame,
+/// rather than requested through a separate ConvertToRGB32 and FlipVertical filter chain,
+/// and only if a Direct2D stage actually needs it.
+/// </remarks>
+class SourceFrameSet
+{
+    /// <summary>The source <see cref="PClip"/> passed to the filter.</summary>
+    const PClip& _sourceClip;
+
+    /// <summary>The filter's child <see cref="PClip"/>, which is either <see cref="_sourceClip"/> or a letterboxed version of it.</summary>
+    const PClip& _childClip;
+
+    /// <summary>The zero-based source frame number.</summary>
+    const int _frameNumber;
+
+    /// <summary>The AviSynth <see cref="IScriptEnvironment"/> interface.</summary>
+    IScriptEnvironment* _env;
+
+    /// <summary>The <see cref="StageInstrumentation"/> recording frame requests and color conversion.</summary>
+    const StageInstrumentation& _stageInstrumentation;
+
+    /// <summary>The YV12 source frame, or nullptr if it hasn't been fetched yet.</summary>
+    PVideoFrame _sourceFrame;
+
+    /// <summary>The YV12 child frame, or nullptr if it hasn't been fetched yet.</summary>
+    PVideoFrame _childFrame;
+
+    /// <summary>The source frame converted to top-down RGB32, or nullptr if it hasn't been converted yet.</summary>
+    PVideoFrame _rgbSourceFrame;
+
+public:
+    /// <summary>
+    /// Creates a new <see cref="SourceFrameSet"/> instance. No frames are fetched until they are first requested.
+    /// </summary>
+    /// <param name="sourceClip">(IN) A reference to the source <see cref="PClip"/>, which must outlive this instance.</param>
+    /// <param name="childClip">(IN) A reference to the child <see cref="PClip"/>, which must outlive this instance.</param>
+    /// <param name="frameNumber">(IN) The zero-based source frame number.</param>
+    /// <param name="env">(IN) The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
+    /// <param name="stageInstrumentation">(IN) A reference to the <see cref="StageInstrumentation"/>, which must outlive this instance.</param>
+    SourceFrameSet(const PClip& sourceClip, const PClip& childClip, const int frameNumber, IScriptEnvironment* env, const StageInstrumentation& stageInstrumentation);
+
+    /// <summary>Gets the zero-based source frame number.</summary>
+    int get_FrameNumber() const { return _frameNumber; }
+
+    /// <summary>
+    /// Gets the YV12 source frame, fetching it from the source clip on first use.
+    /// </summary>
+    /// <returns>A reference to the source <see cref="PVideoFrame"/>.</returns>
+    const PVideoFrame& GetSourceFrame();
+
+    /// <summary>
+    /// Gets the YV12 child frame, fetching it from the child clip on first use.
+    /// </summary>
+    /// <remarks>When the child clip is the source clip, this is the source frame.</remarks>
+    /// <returns>A reference to the child <see cref="PVideoFrame"/>.</returns>
+    const PVideoFrame& GetChildFrame();
+
+    /// <summary>
+    /// Gets the child frame wrapped in a single frame <see cref="PClip"/>,
+    /// so that AviSynth filters invoked on it don't request the frame from the child clip again.
+    /// </summary>
+    /// <returns>A <see cref="PClip"/> with the child clip's <see cref="VideoInfo"/> that returns the child frame.</returns>
+    PClip GetChildFrameClip();
+
+    /// <summary>
+    /// Gets the source frame converted to top-down RGB32 for input to Direct2D, converting it on first use.
+    /// </summary>
+    /// <remarks>
+    /// Equivalent to the AviSynth ConvertToRGB32 filter followed by FlipVertical, using the Rec.601 matrix
+    /// for frames less than 720 pixels high and Rec.709 otherwise, as when converting the processed frame back to YV12.
+    /// </remarks>
+    /// <returns>A reference to the RGB32 source <see cref="PVideoFrame"/>.</returns>
+    const PVideoFrame& GetRgbSourceFrame();
+};
@@ -0,0 +1,172 @@
+#include "pch.h"
+#include "StageTimingProfiler.h"
+#include <bit>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+namespace
+{
+    constexpr const char* StageNames[] = {
+        "GetFrame",
+        "SegmentLookup",
+        "Interpolation",
+        "GeometryRebuild",
+        "UpstreamFrameRequest",
+        "FilterInvocation",
+        "MaskRender",
+        "Blur",
+        "MaskOverlay",
+        "Direct2DCrop",
+        "CropResize",
+        "ColorConversion",
+        "PixelCopy",
+        "FilterConstruction",
+        "RendererInitialization",
+        "ProjectReload"
+    };
+    static_assert(size(StageNames) == static_cast<size_t>(ProcessingStage::Count), "StageNames must name every ProcessingStage");
+
+    /// <summary>Guards <see cref="LiveProfilers"/>.</summary>
+    mutex LiveProfilersMutex;
+
+    /// <summary>The registry of live profilers for on-demand reports.</summary>
+    vector<const StageTimingProfiler*> LiveProfilers;
+
+    constexpr double NanosecondsToMicroseconds(const uint64_t nanoseconds)
+    {
+        return static_cast<double>(nanoseconds) / 1000.0;
+    }
+}
+
+const char* GetProcessingStageName(const ProcessingStage stage)
+{
+    return StageNames[static_cast<size_t>(stage)];
+}
+
+void StageTimingHistogram::Record(const uint64_t durationNanoseconds)
+{
+    // bit_width(0) is 0 and bit_width(1) is 1, so sub-nanosecond and 1ns durations share the first bucket.
+    const size_t bucketIndex = min<size_t>(max<int>(bit_width(durationNanoseconds) - 1, 0), BucketCount - 1);
+
+    BucketCounts[bucketIndex]++;
+    Count++;
+    TotalNanoseconds += durationNanoseconds;
+    MinNanoseconds = min(MinNanoseconds, durationNanoseconds);
+    MaxNanoseconds = max(MaxNanoseconds, durationNanoseconds);
+}
+
+uint64_t StageTimingHistogram::EstimatePercentileNanoseconds(const double fraction) const
+{
+    if (Count == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t targetCount = max<uint64_t>(static_cast<uint64_t>(ceil(fraction * Count)), 1);
+    uint64_t cumulativeCount = 0;
+
+    for (size_t bucketIndex = 0; bucketIndex < BucketCount; bucketIndex++)
+    {
+        cumulativeCount += BucketCounts[bucketIndex];
+        if (cumulativeCount >= targetCount)
+        {
+            const uint64_t bucketUpperBound = (uint64_t{ 1 } << (bucketIndex + 1)) - 1;
+            return clamp(bucketUpperBound, MinNanoseconds, MaxNanoseconds);
+        }
+    }
+
+    return MaxNanoseconds;
+}
+
+StageTimingProfiler::StageTimingProfiler(const std::string& name, const std::string& reportDestination)
+    : _name(name), _reportDestination(reportDestination)
+{
+    lock_guard<mutex> liveProfilersLock(LiveProfilersMutex);
+    LiveProfilers.push_back(this);
+}
+
+StageTimingProfiler::~StageTimingProfiler()
+{
+    {
+        lock_guard<mutex> liveProfilersLock(LiveProfilersMutex);
+        erase(LiveProfilers, this);
+    }
+
+    try
+    {
+        WriteReport();
+    }
+    catch (...)
+    {
+        // Never throw from a destructor. Timing reports are diagnostic only.
+    }
+}
+
+void StageTimingProfiler::Record(const ProcessingStage stage, const std::chrono::steady_clock::duration duration)
+{
+    const uint64_t durationNanoseconds = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(duration).count());
+
+    lock_guard<mutex> histogramsLock(_histogramsMutex);
+    _stageHistograms[static_cast<size_t>(stage)].Record(durationNanoseconds);
+}
+
+std::string StageTimingProfiler::FormatReport() const
+{
+    lock_guard<mutex> histogramsLock(_histogramsMutex);
+
+    string report = fmt::format(PLUGIN_NAME " stage timings for {:s} (microseconds)\n", _name);
+    report += fmt::format("{:<22s}{:>10s}{:>14s}{:>12s}{:>12s}{:>12s}{:>12s}{:>12s}\n", "Stage", "Count", "Total", "Mean", "p50", "p90", "p99", "Max");
+
+    for (size_t stageIndex = 0; stageIndex < _stageHistograms.size(); stageIndex++)
+    {
+        const StageTimingHistogram& histogram = _stageHistograms[stageIndex];
+        if (histogram.Count == 0)
+        {
+            continue;
+        }
+
+        report += fmt::format("{:<22s}{:>10d}{:>14.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}\n",
+                              GetProcessingStageName(static_cast<ProcessingStage>(stageIndex)),
+                              histogram.Count,
+                              NanosecondsToMicroseconds(histogram.TotalNanoseconds),
+                              NanosecondsToMicroseconds(histogram.TotalNanoseconds) / histogram.Count,
+                              NanosecondsToMicroseconds(histogram.EstimatePercentileNanoseconds(0.50)),
+                              NanosecondsToMicroseconds(histogram.EstimatePercentileNanoseconds(0.90)),
+                              NanosecondsToMicroseconds(histogram.EstimatePercentileNanoseconds(0.99)),
+                              NanosecondsToMicroseconds(histogram.MaxNanoseconds));
+    }
+
+    return report;
+}
+
+std::string StageTimingProfiler::FormatAllReports()
+{
+    lock_guard<mutex> liveProfilersLock(LiveProfilersMutex);
+
+    string reports;
+    for (const StageTimingProfiler* profiler : LiveProfilers)
+    {
+        reports += profiler->FormatReport();
+        reports += '\n';
+    }
+
+    return reports;
+}
+
+void StageTimingProfiler::WriteReport() const
+{
+    const string report = FormatReport();
+
+    if (_reportDestination == "-")
+    {
+        fputs(report.c_str(), stderr);
+        fflush(stderr);
+    }
+    else
+    {
+        ofstream reportFileStream(_reportDestination, ios::app);
+        reportFileStream << report << '\n';
+    }
+}
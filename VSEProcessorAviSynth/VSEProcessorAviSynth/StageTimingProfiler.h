@@ -0,0 +1,248 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "FrameTraceSink.h"
+
+/// <summary>
+/// The timed stages of processing a frame.
+/// </summary>
+/// <remarks>
+/// Stages may nest. <see cref="ProcessingStage::GetFrame"/> includes all other per-frame stages
+/// and <see cref="ProcessingStage::SegmentLookup"/> includes <see cref="ProcessingStage::Interpolation"/>
+/// and <see cref="ProcessingStage::GeometryRebuild"/>.
+/// </remarks>
+enum class ProcessingStage : size_t
+{
+    /// <summary>The whole of a VSEProcessorAviSynth::GetFrame call.</summary>
+    GetFrame,
+
+    /// <summary>Finding the segments active on the requested frame.</summary>
+    SegmentLookup,
+
+    /// <summary>Interpolating segment frame data from key frames.</summary>
+    Interpolation,
+
+    /// <summary>Rebuilding masking geometries and the masking geometry group.</summary>
+    GeometryRebuild,
+
+    /// <summary>Requesting source frames from the upstream clip, including decoding and any upstream filters.</summary>
+    UpstreamFrameRequest,
+
+    /// <summary>Invoking an AviSynth filter to construct a new filter instance.</summary>
+    FilterInvocation,
+
+    /// <summary>Rendering the black and white overlay mask frame.</summary>
+    MaskRender,
+
+    /// <summary>Rendering the Gaussian blur effect.</summary>
+    Blur,
+
+    /// <summary>Overlaying the blurred frame through the AviSynth Overlay filter.</summary>
+    MaskOverlay,
+
+    /// <summary>Rendering rotated or multiple segment crops through Direct2D.</summary>
+    Direct2DCrop,
+
+    /// <summary>Resizing a single axis-aligned crop through the AviSynth Spline64Resize filter.</summary>
+    CropResize,
+
+    /// <summary>Converting YV12 source frames to RGB for Direct2D and Direct2D rendered RGB frames back to YV12.</summary>
+    ColorConversion,
+
+    /// <summary>Copying pixels between AviSynth video frames and Direct2D bitmaps.</summary>
+    PixelCopy,
+
+    /// <summary>Constructing the filter, including parsing the project. Recorded once per filter instance.</summary>
+    FilterConstruction,
+
+    /// <summary>Creating the Direct2D renderer when a frame first needs it.</summary>
+    RendererInitialization,
+
+    /// <summary>Swapping in a project reloaded after the watched project file changed, excluding parsing it.</summary>
+    ProjectReload,
+
+    /// <summary>The number of stages.</summary>
+    Count
+};
+
+/// <summary>
+/// Gets the name of a <see cref="ProcessingStage"/> for reports and traces.
+/// </summary>
+/// <param name="stage">(IN) The <see cref="ProcessingStage"/>.</param>
+/// <returns>A pointer to the stage name, which has static storage duration.</returns>
+const char* GetProcessingStageName(const ProcessingStage stage);
+
+/// <summary>
+/// A histogram of stage durations with power of two nanosecond buckets.
+/// </summary>
+struct StageTimingHistogram
+{
+    /// <summary>
+    /// The number of histogram buckets. Bucket i counts durations in the range [2^i, 2^(i+1)) nanoseconds.
+    /// </summary>
+    static constexpr size_t BucketCount = 48;
+
+    std::array<uint64_t, BucketCount> BucketCounts{};
+    uint64_t Count = 0;
+    uint64_t TotalNanoseconds = 0;
+    uint64_t MinNanoseconds = UINT64_MAX;
+    uint64_t MaxNanoseconds = 0;
+
+    /// <summary>
+    /// Records a stage duration.
+    /// </summary>
+    /// <param name="durationNanoseconds">(IN) The stage duration in nanoseconds.</param>
+    void Record(const uint64_t durationNanoseconds);
+
+    /// <summary>
+    /// Estimates a duration percentile from the histogram buckets.
+    /// </summary>
+    /// <param name="fraction">(IN) The percentile as a fraction between 0 and 1.</param>
+    /// <returns>The upper bound of the bucket containing the percentile, clamped to the recorded maximum, in nanoseconds.</returns>
+    uint64_t EstimatePercentileNanoseconds(const double fraction) const;
+};
+
+/// <summary>
+/// Aggregates per-stage frame processing durations into histograms.
+/// </summary>
+/// <remarks>
+/// Live profilers are tracked in a process-wide registry so that reports can be requested on demand
+/// through the VSEProcessorAviSynthStageTimings AviSynth function.
+/// </remarks>
+class StageTimingProfiler
+{
+    /// <summary>A name identifying the profiled filter instance in reports.</summary>
+    const std::string _name;
+
+    /// <summary>The file path to append the report to on destruction, or "-" for the standard error stream.</summary>
+    const std::string _reportDestination;
+
+    /// <summary>Guards <see cref="_stageHistograms"/>, which may be read on demand from another thread.</summary>
+    mutable std::mutex _histogramsMutex;
+    std::array<StageTimingHistogram, static_cast<size_t>(ProcessingStage::Count)> _stageHistograms;
+
+public:
+    /// <summary>
+    /// The environment variable which enables stage timing for all filter instances.
+    /// Its value is the report destination.
+    /// </summary>
+    static constexpr auto EnvironmentVariableName = "VSEPROCESSOR_STAGE_TIMING";
+
+    /// <summary>
+    /// Constructor for the <see cref="StageTimingProfiler"/> class. Registers the profiler for on-demand reports.
+    /// </summary>
+    /// <param name="name">(IN) A name identifying the profiled filter instance in reports.</param>
+    /// <param name="reportDestination">(IN) The file path to append the report to on destruction, or "-" for the standard error stream.</param>
+    StageTimingProfiler(const std::string& name, const std::string& reportDestination);
+
+    /// <summary>
+    /// Destructor for the <see cref="StageTimingProfiler"/> class. Writes the report and unregisters the profiler.
+    /// </summary>
+    ~StageTimingProfiler();
+
+    StageTimingProfiler(const StageTimingProfiler&) = delete;
+    StageTimingProfiler& operator=(const StageTimingProfiler&) = delete;
+
+    /// <summary>
+    /// Records a stage duration.
+    /// </summary>
+    /// <param name="stage">(IN) The timed <see cref="ProcessingStage"/>.</param>
+    /// <param name="duration">(IN) The stage duration.</param>
+    void Record(const ProcessingStage stage, const std::chrono::steady_clock::duration duration);
+
+    /// <summary>
+    /// Formats a table of the recorded stage durations.
+    /// </summary>
+    /// <returns>The formatted report.</returns>
+    std::string FormatReport() const;
+
+    /// <summary>
+    /// Formats the reports of all live profilers.
+    /// </summary>
+    /// <returns>The concatenated reports, or an empty string if no profilers are live.</returns>
+    static std::string FormatAllReports();
+
+private:
+    /// <summary>
+    /// Writes the report to the <see cref="_reportDestination"/>.
+    /// </summary>
+    void WriteReport() const;
+};
+
+/// <summary>
+/// The sinks that <see cref="ScopedStageTimer"/> instances record stage durations to.
+/// Either or both may be null when the corresponding instrumentation is disabled.
+/// </summary>
+struct StageInstrumentation
+{
+    /// <summary>The <see cref="StageTimingProfiler"/> aggregating stage durations, or nullptr if stage timing is disabled.</summary>
+    StageTimingProfiler* Profiler = nullptr;
+
+    /// <summary>The <see cref="FrameTraceSink"/> recording stage spans, or nullptr if tracing is disabled.</summary>
+    FrameTraceSink* TraceSink = nullptr;
+
+    /// <summary>
+    /// Records a stage duration to the enabled sinks.
+    /// </summary>
+    /// <param name="stage">(IN) The timed <see cref="ProcessingStage"/>.</param>
+    /// <param name="startTime">(IN) The time the stage started.</param>
+    /// <param name="endTime">(IN) The time the stage ended.</param>
+    /// <param name="frameNumber">(IN) The zero-based number of the frame being processed, to annotate the trace span with, or -1 if not applicable.</param>
+    void Record(const ProcessingStage stage, const std::chrono::steady_clock::time_point startTime, const std::chrono::steady_clock::time_point endTime, const int frameNumber = -1) const
+    {
+        if (Profiler != nullptr)
+        {
+            Profiler->Record(stage, endTime - startTime);
+        }
+
+        if (TraceSink != nullptr)
+        {
+            TraceSink->RecordSpan(GetProcessingStageName(stage), startTime, endTime, frameNumber);
+        }
+    }
+};
+
+/// <summary>
+/// Records the duration of a <see cref="ProcessingStage"/> from construction to destruction.
+/// Does nothing when constructed with disabled instrumentation, so disabled timing only costs two null checks.
+/// </summary>
+class ScopedStageTimer
+{
+    const StageInstrumentation& _instrumentation;
+    const ProcessingStage _stage;
+    const int _frameNumber;
+    std::chrono::steady_clock::time_point _startTime;
+
+public:
+    /// <summary>
+    /// Constructor for the <see cref="ScopedStageTimer"/> class. Starts timing the stage.
+    /// </summary>
+    /// <param name="instrumentation">(IN) The <see cref="StageInstrumentation"/> to record to. Must outlive the timer.</param>
+    /// <param name="stage">(IN) The timed <see cref="ProcessingStage"/>.</param>
+    /// <param name="frameNumber">(IN) The zero-based number of the frame being processed, to annotate the trace span with, or -1 if not applicable.</param>
+    ScopedStageTimer(const StageInstrumentation& instrumentation, const ProcessingStage stage, const int frameNumber = -1)
+        : _instrumentation(instrumentation), _stage(stage), _frameNumber(frameNumber)
+    {
+        if (_instrumentation.Profiler != nullptr || _instrumentation.TraceSink != nullptr)
+        {
+            _startTime = std::chrono::steady_clock::now();
+        }
+    }
+
+    /// <summary>
+    /// Destructor for the <see cref="ScopedStageTimer"/> class. Records the stage duration.
+    /// </summary>
+    ~ScopedStageTimer()
+    {
+        if (_instrumentation.Profiler != nullptr || _instrumentation.TraceSink != nullptr)
+        {
+            _instrumentation.Record(_stage, _startTime, std::chrono::steady_clock::now(), _frameNumber);
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+};
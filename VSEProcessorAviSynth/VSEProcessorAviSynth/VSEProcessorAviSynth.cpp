@@ -1,23 +1,94 @@
 #include "pch.h"
 #include "VSEProcessorAviSynth.h"
-#include "VSEProjectFileParser.h"
+#include "CompiledProjectCache.h"
 #include "SingleFrameClip.h"
+#include "LetterboxClip.h"
 
 using namespace VideoScriptEditor::Unmanaged;
 using Microsoft::WRL::ComPtr;   // See https://github.com/Microsoft/DirectXTK/wiki/ComPtr
 using namespace std;
 
-VSEProcessorAviSynth::VSEProcessorAviSynth(PClip childClip, const char* projectFileName, IScriptEnvironment* env)
-    : GenericVideoFilter(childClip)
+namespace
 {
+    /// <summary>
+    /// Gets an optional filter argument value, falling back to the value of an environment variable if the argument is empty.
+    /// </summary>
+    /// <param name="argumentValue">(IN) The filter argument value.</param>
+    /// <param name="environmentVariableName">(IN) The name of the fallback environment variable.</param>
+    /// <returns>The argument value, the environment variable value, or an empty string if neither is set.</returns>
+    string GetArgumentOrEnvironmentVariable(const char* argumentValue, const char* environmentVariableName)
     {
-        VSEProjectFileParser projectFileParser(_project);
-        projectFileParser.Parse(projectFileName);
+        string value(argumentValue);
+        if (value.empty())
+        {
+            char environmentVariableValue[MAX_PATH];
+            const DWORD environmentVariableLength = GetEnvironmentVariableA(environmentVariableName, environmentVariableValue, MAX_PATH);
+            if (environmentVariableLength > 0 && environmentVariableLength < MAX_PATH)
+            {
+                value.assign(environmentVariableValue, environmentVariableLength);
+            }
+        }
+
+        return value;
+    }
+
+    /// <summary>
+    /// Gets whether two sets of video processing options produce the same output video size for any source video.
+    /// </summary>
+    /// <param name="lhs">(IN) The left hand side <see cref="VideoProcessingOptionsModel"/> to compare.</param>
+    /// <param name="rhs">(IN) The right hand side <see cref="VideoProcessingOptionsModel"/> to compare.</param>
+    /// <returns>True if the output video sizes are the same, False otherwise.</returns>
+    bool HaveSameOutputVideoSize(const VideoProcessingOptionsModel& lhs, const VideoProcessingOptionsModel& rhs)
+    {
+        if (lhs.OutputVideoResizeMode != rhs.OutputVideoResizeMode)
+        {
+            return false;
+        }
+
+        switch (lhs.OutputVideoResizeMode)
+        {
+        case VideoResizeMode::LetterboxToSize:
+            return lhs.OutputVideoSize.width == rhs.OutputVideoSize.width && lhs.OutputVideoSize.height == rhs.OutputVideoSize.height;
+        case VideoResizeMode::LetterboxToAspectRatio:
+            return lhs.OutputAspectRatio.Numerator == rhs.OutputAspectRatio.Numerator && lhs.OutputAspectRatio.Denominator == rhs.OutputAspectRatio.Denominator;
+        default:
+            return true;
+        }
     }
+}
+
+VSEProcessorAviSynth::VSEProcessorAviSynth(PClip childClip, const char* projectFileName, const char* stageTimingReportDestination, const char* traceFilePath, const int startFrame, const int endFrame, const bool watchProject, IScriptEnvironment* env)
+    : GenericVideoFilter(childClip), _renderedTimelineGeneration(0), _startFrame(startFrame)
+{
+    const chrono::steady_clock::time_point constructionStartTime = chrono::steady_clock::now();
+
+    const int lastFrame = endFrame < 0 ? vi.num_frames - 1 : endFrame;
+    if (startFrame < 0 || startFrame > lastFrame || lastFrame >= vi.num_frames)
+    {
+        env->ThrowError(PLUGIN_NAME ": Frame range %d-%d is outside the source clip's %d frames", startFrame, lastFrame, vi.num_frames);
+    }
+
+    // Shared with other filter instances processing the same project file, so it must not be modified.
+    // When rendering a shard, segments outside the shard's range are excluded by the render plan instead.
+    shared_ptr<const VSEProject> project = CompiledProjectCache::GetOrParse(projectFileName);
+
+    const string timingReportDestination = GetArgumentOrEnvironmentVariable(stageTimingReportDestination, StageTimingProfiler::EnvironmentVariableName);
+    if (!timingReportDestination.empty())
+    {
+        _stageTimingProfiler = make_unique<StageTimingProfiler>(projectFileName, timingReportDestination);
+    }
+
+    const string traceFile = GetArgumentOrEnvironmentVariable(traceFilePath, FrameTraceSink::EnvironmentVariableName);
+    if (!traceFile.empty())
+    {
+        _frameTraceSink = FrameTraceSink::GetOrCreate(traceFile);
+    }
+
+    _stageInstrumentation = { _stageTimingProfiler.get(), _frameTraceSink.get() };
 
     _sourceClip = child;
 
-    VideoProcessingOptionsModel& videoProcessingOptions = _project.VideoProcessingOptions;
+    VideoProcessingOptionsModel videoProcessingOptions = project->VideoProcessingOptions;
     if (videoProcessingOptions.OutputVideoResizeMode == VideoResizeMode::LetterboxToAspectRatio || videoProcessingOptions.OutputVideoResizeMode == VideoResizeMode::LetterboxToSize)
     {
         if (videoProcessingOptions.OutputVideoResizeMode == VideoResizeMode::LetterboxToAspectRatio)
@@ -42,11 +113,8 @@ VSEProcessorAviSynth::VSEProcessorAviSynth(PClip childClip, const char* projectF
 
         if (borderLeftRight % YV12_MOD_FACTOR > 0 || borderTopBottom % YV12_MOD_FACTOR > 0)
         {
-            // Overlay
-            const char* blankClipArgNames[] = { "clip", "width", "height", "audio_rate" };
-            AVSValue blankClipArgVals[] = { child, static_cast<int>(videoProcessingOptions.OutputVideoSize.width), static_cast<int>(videoProcessingOptions.OutputVideoSize.height), 0 };
-            PClip backgroundClip = InvokeAvsFilter(env, "BlankClip", AVSValue(blankClipArgVals, ARRAYSIZE(blankClipArgVals)), blankClipArgNames);
-            child = InvokeAvsOverlayFilter(env, backgroundClip, child, borderLeftRight, borderTopBottom);
+            // AddBorders can't offset YV12 chroma by an odd number of pixels
+            child = new LetterboxClip(child, videoProcessingOptions.OutputVideoSize.width, videoProcessingOptions.OutputVideoSize.height, borderLeftRight, borderTopBottom, env);
         }
         else
         {
@@ -57,29 +125,121 @@ VSEProcessorAviSynth::VSEProcessorAviSynth(PClip childClip, const char* projectF
 
         vi = child->GetVideoInfo();
     }
-    else
+
+    const VideoInfo& sourceClipVideoInfo = _sourceClip->GetVideoInfo();
+    _sourceClipOffset = {
+        (vi.width - sourceClipVideoInfo.width) / 2,
+        (vi.height - sourceClipVideoInfo.height) / 2
+    };
+
+    // The Direct2D renderer is created by GetD2DRenderer when a frame first needs it
+    if (vi.num_frames != lastFrame - startFrame + 1)
     {
-        videoProcessingOptions.OutputVideoSize = D2D1::SizeU(vi.width, vi.height);
+        vi.num_frames = lastFrame - startFrame + 1;
+
+        // Source audio isn't offset, so it would be out of sync with a shard's frames
+        vi.audio_samples_per_second = 0;
+        vi.num_audio_samples = 0;
     }
 
-    if (_project.NeedsDirect2DProcessing)
+    shared_ptr<const CompiledTimeline> timeline = CompileTimeline(move(project), 0);
+
+    // Reserve active segment table storage for every track, so that activating a track never reallocates
+    _activeMaskingSegments.Reserve(timeline->MaxTrackNumber);
+    _activeCroppingSegments.Reserve(timeline->MaxTrackNumber);
+
+    _timeline.store(move(timeline));
+
+    if (watchProject)
     {
-        VideoInfo sourceClipVideoInfo = _sourceClip->GetVideoInfo();
+        _projectFileWatcher = make_unique<ProjectFileWatcher>(projectFileName, [this](shared_ptr<const VSEProject> reloadedProject) {
+            ReloadProject(move(reloadedProject));
+        });
+    }
 
-        _d2dRenderer = make_unique<SoftwareD2DRenderer>(D2D1::SizeU(sourceClipVideoInfo.width, sourceClipVideoInfo.height), D2D1::SizeU(vi.width, vi.height), _activeMaskingSegments, _activeCroppingSegments);
+    // The instrumentation doesn't exist yet when construction starts, so construction is recorded directly
+    _stageInstrumentation.Record(ProcessingStage::FilterConstruction, constructionStartTime, chrono::steady_clock::now());
+}
+
+PVideoFrame __stdcall VSEProcessorAviSynth::GetFrame(int n, IScriptEnvironment* env)
+{
+    // Frame numbers from here on are source clip frame numbers
+    n += _startFrame;
 
-        _d2dRgbSourceClip = InvokeAvsColorConversionFilter(env, "ConvertToRGB32", _sourceClip);
-        _d2dRgbSourceClip = InvokeAvsFilter(env, "FlipVertical", _d2dRgbSourceClip);
+    ScopedStageTimer getFrameTimer(_stageInstrumentation, ProcessingStage::GetFrame, n);
+
+    // Rendered from a single timeline throughout, even if a reload swaps in another meanwhile
+    const shared_ptr<const CompiledTimeline> timeline = _timeline.load();
+
+    if (_projectFileWatcher == nullptr)
+    {
+        return RenderFrame(n, *timeline, env);
     }
-    else
+
+    PVideoFrame outputFrame = _outputFrameCache.Get(n);
+    if (outputFrame == nullptr)
     {
-        _d2dRenderer = nullptr;
-        _d2dRgbSourceClip = nullptr;
+        outputFrame = RenderFrame(n, *timeline, env);
+        _outputFrameCache.Add(n, outputFrame, timeline->Generation);
     }
+
+    return outputFrame;
 }
 
-PVideoFrame __stdcall VSEProcessorAviSynth::GetFrame(int n, IScriptEnvironment* env)
+shared_ptr<const CompiledTimeline> VSEProcessorAviSynth::CompileTimeline(shared_ptr<const VSEProject> project, const uint64_t generation) const
+{
+    int maxTrackNumber = 0;
+    for (const SegmentModel& segmentModel : project->SegmentModels)
+    {
+        maxTrackNumber = max(maxTrackNumber, segmentModel.TrackNumber);
+    }
+
+    RenderPlan renderPlan(*project, _startFrame, _startFrame + vi.num_frames - 1);
+    return make_shared<CompiledTimeline>(CompiledTimeline{ generation, move(project), move(renderPlan), maxTrackNumber });
+}
+
+void VSEProcessorAviSynth::ReloadProject(shared_ptr<const VSEProject> project)
+{
+    ScopedStageTimer projectReloadTimer(_stageInstrumentation, ProcessingStage::ProjectReload);
+
+    // Only the watch thread swaps timelines, so the previous timeline can't change before the swap
+    const shared_ptr<const CompiledTimeline> previousTimeline = _timeline.load();
+    if (project == previousTimeline->Project || !HaveSameOutputVideoSize(project->VideoProcessingOptions, previousTimeline->Project->VideoProcessingOptions))
+    {
+        // Unchanged, or the output video size would change, which requires reloading the script
+        return;
+    }
+
+    const vector<FrameRange> changedFrameRanges = VSEProjectDiff::Compare(*previousTimeline->Project, *project, _startFrame + vi.num_frames);
+
+    const uint64_t generation = previousTimeline->Generation + 1;
+    shared_ptr<const CompiledTimeline> timeline = CompileTimeline(move(project), generation);
+
+    // Discard changed frames before publishing the new timeline, so a frame request that sees the new timeline
+    // can't be given a cached frame of the replaced project. Frames still being rendered from the replaced timeline
+    // are no longer accepted by the cache. Frames in unchanged ranges remain valid, so nothing else is discarded.
+    _outputFrameCache.Invalidate(changedFrameRanges, generation);
+    _timeline.store(move(timeline));
+}
+
+PVideoFrame VSEProcessorAviSynth::RenderFrame(const int n, const CompiledTimeline& timeline, IScriptEnvironment* env)
 {
+    bool maskingGeometryGroupNeedsUpdate = false;
+
+    if (timeline.Generation != _renderedTimelineGeneration)
+    {
+        // Active segment items may be for segments of the replaced project, so they're all re-created from the new timeline
+        maskingGeometryGroupNeedsUpdate = !_activeMaskingSegments.empty();
+        _activeMaskingSegments.clear();
+        _activeCroppingSegments.clear();
+        _activeMaskingSegments.Reserve(timeline.MaxTrackNumber);
+        _activeCroppingSegments.Reserve(timeline.MaxTrackNumber);
+
+        _renderedTimelineGeneration = timeline.Generation;
+    }
+
+    const RenderPlanRange& renderPlanRange = timeline.Plan.GetRange(n);
+
     if (!_activeMaskingSegmentTracks.empty())
     {
         _activeMaskingSegmentTracks.clear();
@@ -90,15 +250,15 @@ PVideoFrame __stdcall VSEProcessorAviSynth::GetFrame(int n, IScriptEnvironment*
         _activeCroppingSegmentTracks.clear();
     }
 
-    bool maskingGeometryGroupNeedsUpdate = false;
-
-    // Has to be a linear search unfortunately as a binary search on SegmentModel.StartFrame misses valid matches
-    // due to the collection not being able to be sorted for every possible '(n >= SegmentModel.StartFrame && n <= SegmentModel.EndFrame)'.
-    for (const SegmentModel& segmentModel : _project.SegmentModels)
     {
-        if (n >= segmentModel.StartFrame && n <= segmentModel.EndFrame)
+        ScopedStageTimer segmentLookupTimer(_stageInstrumentation, ProcessingStage::SegmentLookup);
+
+        // Only the segments active on every frame of the render plan range are visited
+        for (const size_t segmentIndex : renderPlanRange.SegmentIndices)
         {
-            // A binary search on KeyFrameModelBase.FrameNumber works though :)
+            const SegmentModel& segmentModel = timeline.Project->SegmentModels[segmentIndex];
+
+            // Binary search on KeyFrameModelBase.FrameNumber
             auto keyFrameAtOrAfterIter = segmentModel.KeyFrames.lower_bound(n);
 
             if (keyFrameAtOrAfterIter == segmentModel.KeyFrames.end())
@@ -134,6 +294,8 @@ PVideoFrame __stdcall VSEProcessorAviSynth::GetFrame(int n, IScriptEnvironment*
 
                 // Get existing or insert new item keyed on Track number
                 CropSegmentFrameDataItem& cropSegmentFrame = _activeCroppingSegments[segmentModel.TrackNumber];
+
+                ScopedStageTimer interpolationTimer(_stageInstrumentation, ProcessingStage::Interpolation);
                 cropSegmentKeyFrameAtOrBefore->SetFrameDataItemFromLerpedKeyFrames(cropSegmentKeyFrameAtOrAfter, lerpAmount, cropSegmentFrame);
             }
             else  // SegmentType::Mask[Shape]
@@ -146,12 +308,18 @@ PVideoFrame __stdcall VSEProcessorAviSynth::GetFrame(int n, IScriptEnvironment*
 
                 // Get existing or insert new item keyed on Track number
                 auto& maskingFrameItemPair = _activeMaskingSegments[segmentModel.TrackNumber];
-                if (maskSegmentKeyFrameAtOrBefore->SetFrameDataItemFromLerpedKeyFrames(maskSegmentKeyFrameAtOrAfter, lerpAmount, maskingFrameItemPair.first))
+
+                bool maskingFrameDataChanged;
                 {
-                    // Frame data item was changed
-                    assert(_d2dRenderer != nullptr);
+                    ScopedStageTimer interpolationTimer(_stageInstrumentation, ProcessingStage::Interpolation);
+                    maskingFrameDataChanged = maskSegmentKeyFrameAtOrBefore->SetFrameDataItemFromLerpedKeyFrames(maskSegmentKeyFrameAtOrAfter, lerpAmount, maskingFrameItemPair.first);
+                }
 
-                    _d2dRenderer->UpdateMaskingGeometry(maskingFrameItemPair);
+                if (maskingFrameDataChanged)
+                {
+                    // Frame data item was changed
+                    ScopedStageTimer geometryRebuildTimer(_stageInstrumentation, ProcessingStage::GeometryRebuild);
+                    GetD2DRenderer().UpdateMaskingGeometry(maskingFrameItemPair);
                     maskingGeometryGroupNeedsUpdate = true;
                 }
             }
@@ -159,104 +327,104 @@ PVideoFrame __stdcall VSEProcessorAviSynth::GetFrame(int n, IScriptEnvironment*
     }
 
     // Remove items not keyed to an active Track number
-    RemoveInactiveSegmentsFromMap(_activeCroppingSegments, _activeCroppingSegmentTracks);
-    if (RemoveInactiveSegmentsFromMap(_activeMaskingSegments, _activeMaskingSegmentTracks) > 0)
+    _activeCroppingSegments.RemoveInactive(_activeCroppingSegmentTracks);
+    if (_activeMaskingSegments.RemoveInactive(_activeMaskingSegmentTracks) > 0)
     {
         maskingGeometryGroupNeedsUpdate = true;
     }
 
     if (maskingGeometryGroupNeedsUpdate)
     {
-        assert(_d2dRenderer != nullptr);
-
-        _d2dRenderer->UpdateMaskingGeometryGroup();
+        ScopedStageTimer geometryRebuildTimer(_stageInstrumentation, ProcessingStage::GeometryRebuild);
+        GetD2DRenderer().UpdateMaskingGeometryGroup();
     }
 
-    if (_activeMaskingSegments.empty() && _activeCroppingSegments.empty())
+    if (renderPlanRange.Pipeline == RenderPipeline::PassThrough)
     {
+        ScopedStageTimer upstreamFrameRequestTimer(_stageInstrumentation, ProcessingStage::UpstreamFrameRequest);
         return child->GetFrame(n, env);
     }
-    else if (!_activeMaskingSegments.empty() && !_activeCroppingSegments.empty() && (_activeCroppingSegments.size() > 1 || abs(static_cast<float>(_activeCroppingSegments.begin()->second.Angle)) != 0.f))
+
+    // Each source frame is fetched at most once, however many processing branches need it
+    SourceFrameSet sourceFrames(_sourceClip, child, n, env, _stageInstrumentation);
+
+    switch (renderPlanRange.Pipeline)
     {
-        // All-in-one Direct2D mask and crop
-        return ProcessActiveSegmentsUsingDirect2D(n, env);
-    }
-    else
+    case RenderPipeline::BlurMask:
     {
-        PClip processedClip = child;
-        const VideoInfo sourceClipVideoInfo = _sourceClip->GetVideoInfo();
-        POINT sourceClipOffset = {
-            (vi.width - sourceClipVideoInfo.width) / 2,
-            (vi.height - sourceClipVideoInfo.height) / 2
-        };
+        PClip processedClip = ApplyBlurMask(_sourceClipOffset, sourceFrames, env);
 
-        if (!_activeMaskingSegments.empty())
-        {
-            PClip maskingOverlaySourceClip = (_activeCroppingSegments.empty() || abs(static_cast<float>(_activeCroppingSegments.begin()->second.Angle)) == 0.f) ? child : _sourceClip;
-            processedClip = ApplyBlurMask(sourceClipOffset, maskingOverlaySourceClip, n, env);
-        }
-
-        if (!_activeCroppingSegments.empty())
-        {
-            // Perform crop(s)
+        ScopedStageTimer maskOverlayTimer(_stageInstrumentation, ProcessingStage::MaskOverlay);
+        return processedClip->GetFrame(n, env);
+    }
+    case RenderPipeline::AxisAlignedCrop:
+        return ApplySingleAxisAlignedCrop(sourceFrames.GetChildFrameClip(), _activeCroppingSegments.begin()->second, _sourceClipOffset, n, env);
+    case RenderPipeline::BlurMaskAndAxisAlignedCrop:
+        // The mask is overlaid on the child frame before cropping
+        return ApplySingleAxisAlignedCrop(ApplyBlurMask(_sourceClipOffset, sourceFrames, env), _activeCroppingSegments.begin()->second, _sourceClipOffset, n, env);
+    default:
+        break;
+    }
 
-            if (_activeCroppingSegments.size() > 1 || abs(static_cast<float>(_activeCroppingSegments.begin()->second.Angle)) != 0.f)
-            {
-                assert(_activeMaskingSegments.empty());
+    // All-in-one Direct2D mask and crop
+    assert(renderPlanRange.Pipeline == RenderPipeline::Direct2D);
+    return ProcessActiveSegmentsUsingDirect2D(sourceFrames, env);
+}
 
-                return ProcessActiveSegmentsUsingDirect2D(n, env);
-            }
-            else
-            {
-                return ApplySingleAxisAlignedCrop(processedClip, _activeCroppingSegments.begin()->second, sourceClipOffset, n, env);
-            }
-        }
+SoftwareD2DRenderer& VSEProcessorAviSynth::GetD2DRenderer()
+{
+    if (_d2dRenderer == nullptr)
+    {
+        ScopedStageTimer rendererInitializationTimer(_stageInstrumentation, ProcessingStage::RendererInitialization);
 
-        // Masking frame
-        return processedClip->GetFrame(n, env);
+        const VideoInfo& sourceClipVideoInfo = _sourceClip->GetVideoInfo();
+        _d2dRenderer = make_unique<SoftwareD2DRenderer>(D2D1::SizeU(sourceClipVideoInfo.width, sourceClipVideoInfo.height), D2D1::SizeU(vi.width, vi.height), _activeMaskingSegments, _activeCroppingSegments, _stageInstrumentation);
     }
+
+    return *_d2dRenderer;
 }
 
-PClip VSEProcessorAviSynth::ApplyBlurMask(const POINT& maskGeometryOffset, const PClip& overlaySourceClip, const int frameNumber, IScriptEnvironment* env)
+PClip VSEProcessorAviSynth::ApplyBlurMask(const POINT& maskGeometryOffset, SourceFrameSet& sourceFrames, IScriptEnvironment* env)
 {
     VideoInfo maskFramesInfo = _sourceClip->GetVideoInfo();
     maskFramesInfo.pixel_type = VideoInfo::CS_BGR32;
     maskFramesInfo.num_frames = 1;
 
     PVideoFrame maskFrame = env->NewVideoFrame(maskFramesInfo);
-    _d2dRenderer->RenderOverlayMaskFrame(maskFrame, maskFramesInfo);
+    GetD2DRenderer().RenderOverlayMaskFrame(maskFrame, maskFramesInfo);
 
     PVideoFrame blurFrame = env->NewVideoFrame(maskFramesInfo);
-    _d2dRenderer->RenderBlurFrame(_d2dRgbSourceClip->GetFrame(frameNumber, env), blurFrame, maskFramesInfo);
+    GetD2DRenderer().RenderBlurFrame(sourceFrames.GetRgbSourceFrame(), blurFrame, maskFramesInfo);
 
     PClip maskClip = new SingleFrameClip(maskFramesInfo, maskFrame);
     PClip blurClip = new SingleFrameClip(maskFramesInfo, blurFrame);
 
-    return InvokeAvsOverlayFilter(env, overlaySourceClip, blurClip, static_cast<int>(maskGeometryOffset.x), static_cast<int>(maskGeometryOffset.y), maskClip);
+    return InvokeAvsOverlayFilter(env, sourceFrames.GetChildFrameClip(), blurClip, static_cast<int>(maskGeometryOffset.x), static_cast<int>(maskGeometryOffset.y), maskClip);
 }
 
-PVideoFrame VSEProcessorAviSynth::ProcessActiveSegmentsUsingDirect2D(const int frameNumber, IScriptEnvironment* env)
+PVideoFrame VSEProcessorAviSynth::ProcessActiveSegmentsUsingDirect2D(SourceFrameSet& sourceFrames, IScriptEnvironment* env)
 {
     VideoInfo processedFrameInfo = vi;
     processedFrameInfo.pixel_type = VideoInfo::CS_BGR32;
     processedFrameInfo.num_frames = 1;
 
     PVideoFrame processedFrame = env->NewVideoFrame(processedFrameInfo);
+    const PVideoFrame& rgbSourceFrame = sourceFrames.GetRgbSourceFrame();
 
-    PVideoFrame rgbSourceFrame = _d2dRgbSourceClip->GetFrame(frameNumber, env);
-    
     if (!_activeMaskingSegments.empty())
     {
-        _d2dRenderer->RenderBlurMaskedAndCroppedFrame(rgbSourceFrame, processedFrame, processedFrameInfo);
+        GetD2DRenderer().RenderBlurMaskedAndCroppedFrame(rgbSourceFrame, processedFrame, processedFrameInfo);
     }
     else
     {
-        _d2dRenderer->RenderCroppedFrame(rgbSourceFrame, processedFrame, processedFrameInfo);
+        GetD2DRenderer().RenderCroppedFrame(rgbSourceFrame, processedFrame, processedFrameInfo);
     }
 
     PClip processedClip = new SingleFrameClip(processedFrameInfo, processedFrame);
     processedClip = InvokeAvsColorConversionFilter(env, "ConvertToYV12", processedClip);
-    return processedClip->GetFrame(frameNumber, env);
+
+    ScopedStageTimer colorConversionTimer(_stageInstrumentation, ProcessingStage::ColorConversion);
+    return processedClip->GetFrame(sourceFrames.get_FrameNumber(), env);
 }
 
 PVideoFrame VSEProcessorAviSynth::ApplySingleAxisAlignedCrop(const PClip& croppingSourceClip, const CropSegmentFrameDataItem& cropSegmentFrameData, const POINT& cropSegmentFrameOffset, const int frameNumber, IScriptEnvironment* env)
@@ -265,32 +433,56 @@ PVideoFrame VSEProcessorAviSynth::ApplySingleAxisAlignedCrop(const PClip& croppi
 
     SingleAxisAlignedCropRenderData cropRenderData = CalculateRenderDataForSingleAxisAlignedCrop(cropSegmentFrameData, cropSegmentFrameOffset, env);
 
+    if (cropRenderData.BorderLeftRight % YV12_MOD_FACTOR == 0 && cropRenderData.BorderTopBottom % YV12_MOD_FACTOR == 0
+        && (cropRenderData.BorderLeftRight > 0 || cropRenderData.BorderTopBottom > 0))
+    {
+        // Resample only the picture area between the borders, mapping it to the same part of the source rectangle it covers in the full frame
+        const int pictureWidth = vi.width - (cropRenderData.BorderLeftRight * 2);
+        const int pictureHeight = vi.height - (cropRenderData.BorderTopBottom * 2);
+        const float sourceScaleX = cropRenderData.SourceWidth / static_cast<float>(vi.width);
+        const float sourceScaleY = cropRenderData.SourceHeight / static_cast<float>(vi.height);
+
+        AVSValue pictureResizeArgs[] = {
+            croppingSourceClip, pictureWidth, pictureHeight,
+            cropRenderData.SourceLeft + (cropRenderData.BorderLeftRight * sourceScaleX),
+            cropRenderData.SourceTop + (cropRenderData.BorderTopBottom * sourceScaleY),
+            pictureWidth * sourceScaleX,
+            pictureHeight * sourceScaleY
+        };
+        PClip pictureClip = InvokeAvsFilter(env, "Spline64Resize", AVSValue(pictureResizeArgs, ARRAYSIZE(pictureResizeArgs)));
+
+        PVideoFrame borderedFrame = env->NewVideoFrame(vi);
+        FillYV12Borders(borderedFrame, vi, cropRenderData.BorderLeftRight, cropRenderData.BorderTopBottom, env);
+
+        ScopedStageTimer cropResizeTimer(_stageInstrumentation, ProcessingStage::CropResize);
+        PVideoFrame pictureFrame = pictureClip->GetFrame(frameNumber, env);
+
+        const int chromaOffsetX = cropRenderData.BorderLeftRight / 2;
+        const int chromaOffsetY = cropRenderData.BorderTopBottom / 2;
+        if (libyuv::I420Copy(pictureFrame->GetReadPtr(PLANAR_Y), pictureFrame->GetPitch(PLANAR_Y),
+                             pictureFrame->GetReadPtr(PLANAR_U), pictureFrame->GetPitch(PLANAR_U),
+                             pictureFrame->GetReadPtr(PLANAR_V), pictureFrame->GetPitch(PLANAR_V),
+                             borderedFrame->GetWritePtr(PLANAR_Y) + (cropRenderData.BorderTopBottom * borderedFrame->GetPitch(PLANAR_Y)) + cropRenderData.BorderLeftRight, borderedFrame->GetPitch(PLANAR_Y),
+                             borderedFrame->GetWritePtr(PLANAR_U) + (chromaOffsetY * borderedFrame->GetPitch(PLANAR_U)) + chromaOffsetX, borderedFrame->GetPitch(PLANAR_U),
+                             borderedFrame->GetWritePtr(PLANAR_V) + (chromaOffsetY * borderedFrame->GetPitch(PLANAR_V)) + chromaOffsetX, borderedFrame->GetPitch(PLANAR_V),
+                             pictureWidth, pictureHeight) == -1)
+        {
+            env->ThrowError(PLUGIN_NAME ": Failed to copy the cropped picture into the bordered frame.");
+        }
+
+        return borderedFrame;
+    }
+
     AVSValue resizeArgs[] = { croppingSourceClip, vi.width, vi.height, cropRenderData.SourceLeft, cropRenderData.SourceTop, cropRenderData.SourceWidth, cropRenderData.SourceHeight };
     PClip processedClip = InvokeAvsFilter(env, "Spline64Resize", AVSValue(resizeArgs, ARRAYSIZE(resizeArgs)));
 
     if (cropRenderData.BorderLeftRight > 0 || cropRenderData.BorderTopBottom > 0)
     {
-        // Fill-in borders
-        if (cropRenderData.BorderLeftRight % YV12_MOD_FACTOR == 0 && cropRenderData.BorderTopBottom % YV12_MOD_FACTOR == 0)
-        {
-            PVideoFrame croppedFrame = processedClip->GetFrame(frameNumber, env);
-            PVideoFrame borderedFrame = croppedFrame;
-            if (!env->MakeWritable(&borderedFrame))
-            {
-                env->ThrowError(PLUGIN_NAME ": Failed to make frame writable.");
-            }
-            
-            FillYV12Borders(borderedFrame, vi, cropRenderData.BorderLeftRight, cropRenderData.BorderTopBottom, env);
-
-            return borderedFrame;
-        }
-        else
-        {
-            // Overlay borders
-            processedClip = OverlayBorders(processedClip, cropRenderData.BorderLeftRight, cropRenderData.BorderTopBottom, env);
-        }
+        // Overlay an odd number of border pixels
+        processedClip = OverlayBorders(processedClip, cropRenderData.BorderLeftRight, cropRenderData.BorderTopBottom, env);
     }
 
+    ScopedStageTimer cropResizeTimer(_stageInstrumentation, ProcessingStage::CropResize);
     return processedClip->GetFrame(frameNumber, env);
 }
 
@@ -515,6 +707,8 @@ PClip VSEProcessorAviSynth::InvokeAvsColorConversionFilter(IScriptEnvironment* e
 
 PClip VSEProcessorAviSynth::InvokeAvsFilter(IScriptEnvironment* env, const char* filterName, const AVSValue filterArgs, const char* filterArgNames[])
 {
+    ScopedStageTimer filterInvocationTimer(_stageInstrumentation, ProcessingStage::FilterInvocation);
+
     AVSValue filterOutput;
     if (!env->InvokeTry(&filterOutput, filterName, filterArgs, filterArgNames))
     {
@@ -526,7 +720,13 @@ PClip VSEProcessorAviSynth::InvokeAvsFilter(IScriptEnvironment* env, const char*
 
 AVSValue __cdecl VSEProcessorAviSynth::Create(AVSValue args, void* user_data, IScriptEnvironment* env)
 {
-    return new VSEProcessorAviSynth(args[0].AsClip(), args[1].AsString(""), env);
+    return new VSEProcessorAviSynth(args[0].AsClip(), args[1].AsString(""), args[2].AsString(""), args[3].AsString(""), args[4].AsInt(0), args[5].AsInt(-1), args[6].AsBool(false), env);
+}
+
+AVSValue __cdecl VSEProcessorAviSynth::GetStageTimings(AVSValue args, void* user_data, IScriptEnvironment* env)
+{
+    const string stageTimingReports = StageTimingProfiler::FormatAllReports();
+    return env->SaveString(stageTimingReports.c_str(), static_cast<int>(stageTimingReports.size()));
 }
 
 const AVS_Linkage* AVS_linkage = nullptr;   // for dynamic linkage
@@ -534,6 +734,7 @@ const AVS_Linkage* AVS_linkage = nullptr;   // for dynamic linkage
 extern "C" __declspec(dllexport) const char* __stdcall AvisynthPluginInit3(IScriptEnvironment* env, const AVS_Linkage* const vectors)
 {
     AVS_linkage = vectors;
-    env->AddFunction(PLUGIN_NAME, "c[projectFileName]s", VSEProcessorAviSynth::Create, nullptr);
+    env->AddFunction(PLUGIN_NAME, "c[projectFileName]s[stage_timing]s[trace_file]s[start_frame]i[end_frame]i[watch_project]b", VSEProcessorAviSynth::Create, nullptr);
+    env->AddFunction(PLUGIN_NAME "StageTimings", "", VSEProcessorAviSynth::GetStageTimings, nullptr);
     return PLUGIN_NAME " plugin";
 }
\ No newline at end of file
@@ -1,5 +1,10 @@
 #pragma once
+#include <atomic>
 #include "SoftwareD2DRenderer.h"
+#include "SourceFrameSet.h"
+#include "RenderPlan.h"
+#include "OutputFrameCache.h"
+#include "ProjectFileWatcher.h"
 
 /// <summary>
 /// Encapsulates rendering data for a single axis-aligned (zero rotation angle) crop.
@@ -25,26 +30,72 @@ struct SingleAxisAlignedCropRenderData
     int BorderTopBottom;
 };
 
+/// <summary>
+/// A read-only project and the <see cref="RenderPlan"/> compiled from it,
+/// replaced as a whole when the project file is reloaded.
+/// </summary>
+struct CompiledTimeline
+{
+    /// <summary>The number of timelines compiled by the filter instance before this one.</summary>
+    uint64_t Generation;
+
+    /// <summary>The read-only Video Script Editor project, shared through the <see cref="CompiledProjectCache"/>.</summary>
+    std::shared_ptr<const VSEProject> Project;
+
+    /// <summary>The <see cref="RenderPlan"/> selecting the active segments and <see cref="RenderPipeline"/> for each frame.</summary>
+    RenderPlan Plan;
+
+    /// <summary>The highest zero-based track number of the project's segments.</summary>
+    int MaxTrackNumber;
+};
+
 /// <summary>
 /// AviSynth filter/plugin for processing Video Script Editor projects
 /// via AviSynth and a suitable encoding application such as x264.
 /// </summary>
 class VSEProcessorAviSynth : public GenericVideoFilter
 {
-    /// <summary>The Video Script Editor project being processed.</summary>
-    VSEProject _project;
+    /// <summary>
+    /// The <see cref="CompiledTimeline"/> of the project being processed.
+    /// Swapped by the <see cref="_projectFileWatcher"/> thread while frames may be rendering from the previous timeline.
+    /// </summary>
+    std::atomic<std::shared_ptr<const CompiledTimeline>> _timeline;
+
+    /// <summary>
+    /// The <see cref="CompiledTimeline::Generation"/> of the timeline the previous frame was rendered from.
+    /// The active segment tables are reset when a frame is rendered from a different timeline.
+    /// </summary>
+    uint64_t _renderedTimelineGeneration;
+
+    /// <summary>
+    /// The zero-based number of the source frame output as frame 0 of this filter. Non-zero when rendering a shard of the project.
+    /// </summary>
+    int _startFrame;
 
-    /// <summary>The <see cref="SoftwareD2DRenderer"/> instance.</summary>
+    /// <summary>
+    /// The <see cref="StageTimingProfiler"/> recording frame processing stage durations, or nullptr if stage timing is disabled.
+    /// </summary>
+    /// <remarks>Declared before <see cref="_d2dRenderer"/>, which holds a pointer to it, so that it is destroyed last.</remarks>
+    std::unique_ptr<StageTimingProfiler> _stageTimingProfiler;
+
+    /// <summary>
+    /// The <see cref="FrameTraceSink"/> recording frame processing spans, shared with other filter instances tracing to the same file,
+    /// or nullptr if tracing is disabled.
+    /// </summary>
+    /// <remarks>Declared before <see cref="_d2dRenderer"/>, which holds a pointer to it, so that it is released last.</remarks>
+    std::shared_ptr<FrameTraceSink> _frameTraceSink;
+
+    /// <summary>The <see cref="StageInstrumentation"/> referring to <see cref="_stageTimingProfiler"/> and <see cref="_frameTraceSink"/>.</summary>
+    StageInstrumentation _stageInstrumentation;
+
+    /// <summary>The <see cref="SoftwareD2DRenderer"/> instance, or nullptr until a frame first needs Direct2D processing.</summary>
     std::unique_ptr<SoftwareD2DRenderer> _d2dRenderer;
 
     /// <summary>The source <see cref="PClip"/> passed to this filter.</summary>
     PClip _sourceClip;
 
-    /// <summary>
-    /// The <see cref="_sourceClip"/> converted to RGB and flipped vertically,
-    /// ready for input to <see cref="_d2dRenderer"/> functions if Direct2D processing is needed.
-    /// </summary>
-    PClip _d2dRgbSourceClip;
+    /// <summary>The horizontal and vertical offset of <see cref="_sourceClip"/> frames within letterboxed output frames.</summary>
+    POINT _sourceClipOffset;
 
     /// <summary>
     /// An unsorted collection of zero-based track numbers for masking segments whose frame range includes the current frame number.
@@ -52,11 +103,11 @@ class VSEProcessorAviSynth : public GenericVideoFilter
     std::vector<int> _activeMaskingSegmentTracks;
 
     /// <summary>
-    /// A <see cref="std::map"/> of 'Active' masking segments sorted and keyed by zero-based track number,
+    /// A <see cref="TrackIndexedTable"/> of 'Active' masking segments indexed by zero-based track number,
     /// providing a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
     /// </summary>
     /// <remarks>Active masking segments are those whose frame range includes the current frame number.</remarks>
-    std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>> _activeMaskingSegments;
+    VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>> _activeMaskingSegments;
 
     /// <summary>
     /// An unsorted collection of zero-based track numbers for cropping segments whose frame range includes the current frame number.
@@ -64,10 +115,19 @@ class VSEProcessorAviSynth : public GenericVideoFilter
     std::vector<int> _activeCroppingSegmentTracks;
 
     /// <summary>
-    /// A <see cref="std::map"/> of 'Active' cropping segments sorted and keyed by zero-based track number.
+    /// A <see cref="TrackIndexedTable"/> of 'Active' cropping segments indexed by zero-based track number.
     /// </summary>
     /// <remarks>Active cropping segments are those whose frame range includes the current frame number.</remarks>
-    std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem> _activeCroppingSegments;
+    VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem> _activeCroppingSegments;
+
+    /// <summary>Processed frames, cached by this filter instead of AviSynth while the project file is watched.</summary>
+    OutputFrameCache _outputFrameCache;
+
+    /// <summary>
+    /// The <see cref="ProjectFileWatcher"/> reloading the project after it changes, or nullptr if the project file isn't watched.
+    /// </summary>
+    /// <remarks>Declared last, so that its thread is stopped before the members it updates are destroyed.</remarks>
+    std::unique_ptr<ProjectFileWatcher> _projectFileWatcher;
 
 public:
     /// <summary>
@@ -75,8 +135,24 @@ public:
     /// </summary>
     /// <param name="childClip">The child (source) clip.</param>
     /// <param name="projectFileName">The file path of the Video Script Editor project to process.</param>
+    /// <param name="stageTimingReportDestination">
+    /// The file path to append a stage timing report to when the filter is destroyed, or "-" for the standard error stream.
+    /// An empty string falls back to the <see cref="StageTimingProfiler::EnvironmentVariableName"/> environment variable,
+    /// and stage timing is disabled if that isn't set either.
+    /// </param>
+    /// <param name="traceFilePath">
+    /// The file path to write a Chrome trace event JSON timeline of frame processing spans to when the filter is destroyed.
+    /// An empty string falls back to the <see cref="FrameTraceSink::EnvironmentVariableName"/> environment variable,
+    /// and tracing is disabled if that isn't set either.
+    /// </param>
+    /// <param name="startFrame">The zero-based number of the first source frame to output.</param>
+    /// <param name="endFrame">The zero-based number of the last source frame to output, or -1 for the last frame of the source clip.</param>
+    /// <param name="watchProject">
+    /// Whether to watch the project file and reload it after it changes, for previewing edits in a long-running frameserver.
+    /// Changes to the video processing options are ignored, as the output video size can't change.
+    /// </param>
     /// <param name="env">The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
-    VSEProcessorAviSynth(PClip childClip, const char* projectFileName, IScriptEnvironment* env);
+    VSEProcessorAviSynth(PClip childClip, const char* projectFileName, const char* stageTimingReportDestination, const char* traceFilePath, const int startFrame, const int endFrame, const bool watchProject, IScriptEnvironment* env);
 
     /// <summary>Destructor.</summary>
     ~VSEProcessorAviSynth() {}
@@ -89,6 +165,33 @@ public:
     /// <returns>The requested frame.</returns>
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
 
+    /// <summary>
+    /// Called when AviSynth requests the field parity of frame <paramref name="n"/> from this filter.
+    /// </summary>
+    /// <param name="n">The frame number.</param>
+    /// <returns>The field parity of the corresponding source frame.</returns>
+    bool __stdcall GetParity(int n) { return child->GetParity(n + _startFrame); }
+
+    /// <summary>
+    /// Called when AviSynth queries or sets the caching behavior of this filter.
+    /// </summary>
+    /// <remarks>
+    /// While the project file is watched, AviSynth is told not to cache this filter's frames,
+    /// as its cache would keep returning frames rendered from a replaced project. The <see cref="_outputFrameCache"/> is used instead.
+    /// </remarks>
+    /// <param name="cachehints">The cache hint to query or set.</param>
+    /// <param name="frame_range">The cache hint value.</param>
+    /// <returns>The cache hint query result.</returns>
+    int __stdcall SetCacheHints(int cachehints, int frame_range) override
+    {
+        if (cachehints == CACHE_DONT_CACHE_ME && _projectFileWatcher != nullptr)
+        {
+            return 1;
+        }
+
+        return GenericVideoFilter::SetCacheHints(cachehints, frame_range);
+    }
+
     /// <summary>
     /// AviSynth callback function for creating a new instance of this filter.
     /// </summary>
@@ -98,31 +201,71 @@ public:
     /// <returns>An <see cref="AVSValue"/> containing a new instance of this filter as a clip.</returns>
     static AVSValue __cdecl Create(AVSValue args, void* user_data, IScriptEnvironment* env);
 
+    /// <summary>
+    /// AviSynth callback function returning the stage timing reports of all filter instances with stage timing enabled.
+    /// </summary>
+    /// <param name="args">An <see cref="AVSValue"/> containing an empty array of function arguments.</param>
+    /// <param name="user_data">The user_data cookie.</param>
+    /// <param name="env">The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
+    /// <returns>An <see cref="AVSValue"/> containing the reports as a string.</returns>
+    static AVSValue __cdecl GetStageTimings(AVSValue args, void* user_data, IScriptEnvironment* env);
+
 private:
+    /// <summary>
+    /// Compiles a <see cref="CompiledTimeline"/> for the frame range output by this filter.
+    /// </summary>
+    /// <param name="project">(IN) The read-only <see cref="VSEProject"/> to compile.</param>
+    /// <param name="generation">(IN) The <see cref="CompiledTimeline::Generation"/> of the timeline.</param>
+    /// <returns>A shared pointer to the read-only <see cref="CompiledTimeline"/>.</returns>
+    std::shared_ptr<const CompiledTimeline> CompileTimeline(std::shared_ptr<const VSEProject> project, const uint64_t generation) const;
+
+    /// <summary>
+    /// Swaps in a reloaded project and discards the cached frames it changes. Called on the <see cref="_projectFileWatcher"/> thread.
+    /// </summary>
+    /// <param name="project">(IN) The reloaded read-only <see cref="VSEProject"/>.</param>
+    void ReloadProject(std::shared_ptr<const VSEProject> project);
+
+    /// <summary>
+    /// Renders a frame from a <see cref="CompiledTimeline"/>.
+    /// </summary>
+    /// <param name="n">(IN) The zero-based source frame number.</param>
+    /// <param name="timeline">(IN) The <see cref="CompiledTimeline"/> to render from.</param>
+    /// <param name="env">(IN) The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
+    /// <returns>The rendered frame.</returns>
+    PVideoFrame RenderFrame(const int n, const CompiledTimeline& timeline, IScriptEnvironment* env);
+
+    /// <summary>
+    /// Gets the <see cref="_d2dRenderer"/>, creating it on first use.
+    /// </summary>
+    /// <remarks>
+    /// Creating the renderer's Direct2D and WIC factories, bitmaps and blur effect is deferred,
+    /// so that opening a script or rendering frames without masking or Direct2D crops doesn't pay for it.
+    /// </remarks>
+    /// <returns>A reference to the <see cref="SoftwareD2DRenderer"/>.</returns>
+    SoftwareD2DRenderer& GetD2DRenderer();
+
     /// <summary>
     /// Returns a <see cref="PClip"/> with a blur mask effect
-    /// overlaid on the current frame of the <paramref name="overlaySourceClip"/> at a given offset.
+    /// overlaid on the current child frame at a given offset.
     /// </summary>
     /// <param name="maskGeometryOffset">
     /// A reference to a <see cref="POINT"/> specifying the horizontal and vertical amount to offset the geometric mask overlay.
     /// </param>
-    /// <param name="overlaySourceClip">A reference to the source <see cref="PClip"/> for the Overlay filter.</param>
-    /// <param name="frameNumber">The current frame number.</param>
+    /// <param name="sourceFrames">A reference to the <see cref="SourceFrameSet"/> for the current frame.</param>
     /// <param name="env">The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
     /// <returns>
-    /// A <see cref="PClip"/> with a blur mask effect overlaid on the current frame of the <paramref name="overlaySourceClip"/>
-    /// at the specified offset.
+    /// A <see cref="PClip"/> with a blur mask effect overlaid on the current child frame at the specified offset.
     /// </returns>
-    PClip ApplyBlurMask(const POINT& maskGeometryOffset, const PClip& overlaySourceClip, const int frameNumber, IScriptEnvironment* env);
+    PClip ApplyBlurMask(const POINT& maskGeometryOffset, SourceFrameSet& sourceFrames, IScriptEnvironment* env);
 
     /// <summary>
     /// Processes the <see cref="_activeMaskingSegments"/> and rotated/multiple <see cref="_activeCroppingSegments"/>
     /// using the <see cref="_d2dRenderer"/>.
     /// </summary>
-    /// <param name="frameNumber">The current frame number.</param>
+    /// <param name="sourceFrames">A reference to the <see cref="SourceFrameSet"/> for the current frame.</param>
     /// <param name="env">The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
     /// <returns>A <see cref="PVideoFrame"/> containing Direct2D rendered content, converted to YV12.</returns>
-    PVideoFrame ProcessActiveSegmentsUsingDirect2D(const int frameNumber, IScriptEnvironment* env);
+    PVideoFrame ProcessActiveSegmentsUsingDirect2D(SourceFrameSet& sourceFrames, IScriptEnvironment* env);
 
     /// <summary>
     /// Applies a single axis-aligned (zero rotation angle) crop using the <paramref name="cropSegmentFrameData"/>
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "VSEProjectDiff.h"
+
+using namespace VideoScriptEditor::Unmanaged;
+using namespace std;
+
+namespace
+{
+    /// <summary>
+    /// Incrementally computes a 64-bit FNV-1a hash.
+    /// </summary>
+    class FrameParameterHasher
+    {
+        uint64_t _hash = 14695981039346656037ULL;
+
+    public:
+        template <typename T>
+        void Add(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                _hash = (_hash ^ bytes[i]) * 1099511628211ULL;
+            }
+        }
+
+        void AddKeyFrame(const KeyFrameModelBase& keyFrame)
+        {
+            Add(keyFrame.FrameNumber);
+
+            if (const CropKeyFrameModel* cropKeyFrame = dynamic_cast<const CropKeyFrameModel*>(&keyFrame))
+            {
+                Add(cropKeyFrame->Left);
+                Add(cropKeyFrame->Top);
+                Add(cropKeyFrame->Width);
+                Add(cropKeyFrame->Height);
+                Add(cropKeyFrame->Angle);
+            }
+            else if (const MaskEllipseKeyFrameModel* ellipseKeyFrame = dynamic_cast<const MaskEllipseKeyFrameModel*>(&keyFrame))
+            {
+                Add(ellipseKeyFrame->CenterPoint.X);
+                Add(ellipseKeyFrame->CenterPoint.Y);
+                Add(ellipseKeyFrame->RadiusX);
+                Add(ellipseKeyFrame->RadiusY);
+            }
+            else if (const MaskPolygonKeyFrameModel* polygonKeyFrame = dynamic_cast<const MaskPolygonKeyFrameModel*>(&keyFrame))
+            {
+                Add(polygonKeyFrame->Points.size());
+                for (const PointD& point : polygonKeyFrame->Points)
+                {
+                    Add(point.X);
+                    Add(point.Y);
+                }
+            }
+            else if (const MaskRectangleKeyFrameModel* rectangleKeyFrame = dynamic_cast<const MaskRectangleKeyFrameModel*>(&keyFrame))
+            {
+                Add(rectangleKeyFrame->Left);
+                Add(rectangleKeyFrame->Top);
+                Add(rectangleKeyFrame->Width);
+                Add(rectangleKeyFrame->Height);
+            }
+        }
+
+        /// <summary>
+        /// Gets the hash, finalized with the SplitMix64 mixing function so that hashes can be summed without losing entropy.
+        /// </summary>
+        uint64_t get_Hash() const
+        {
+            uint64_t mixedHash = _hash;
+            mixedHash = (mixedHash ^ (mixedHash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            mixedHash = (mixedHash ^ (mixedHash >> 27)) * 0x94D049BB133111EBULL;
+            return mixedHash ^ (mixedHash >> 31);
+        }
+    };
+
+    /// <summary>
+    /// Hashes the video processing options, which affect every frame.
+    /// </summary>
+    uint64_t HashVideoProcessingOptions(const VideoProcessingOptionsModel& videoProcessingOptions)
+    {
+        FrameParameterHasher hasher;
+        hasher.Add(videoProcessingOptions.OutputVideoResizeMode);
+
+        switch (videoProcessingOptions.OutputVideoResizeMode)
+        {
+        case VideoResizeMode::LetterboxToAspectRatio:
+            hasher.Add(videoProcessingOptions.OutputAspectRatio.Numerator);
+            hasher.Add(videoProcessingOptions.OutputAspectRatio.Denominator);
+            break;
+        case VideoResizeMode::LetterboxToSize:
+            hasher.Add(videoProcessingOptions.OutputVideoSize.width);
+            hasher.Add(videoProcessingOptions.OutputVideoSize.height);
+            break;
+        default:
+            break;
+        }
+
+        return hasher.get_Hash();
+    }
+}
+
+namespace VSEProjectDiff
+{
+    std::vector<uint64_t> ComputeFrameParameterHashes(const VSEProject& project, const int frameCount)
+    {
+        // Each frame accumulates the sum of its active segments' parameter hashes, so that segment order doesn't matter.
+        // Iterating segments rather than frames visits each segment's frames once, walking its key frames in order.
+        vector<uint64_t> segmentHashSums(max(frameCount, 0), 0);
+
+        for (const SegmentModel& segmentModel : project.SegmentModels)
+        {
+            if (segmentModel.KeyFrames.empty())
+            {
+                continue;
+            }
+
+            const int startFrame = max(segmentModel.StartFrame, 0);
+            const int endFrame = min(segmentModel.EndFrame, frameCount - 1);
+            auto keyFrameAtOrAfterIter = segmentModel.KeyFrames.lower_bound(startFrame);
+
+            for (int frameNumber = startFrame; frameNumber <= endFrame; frameNumber++)
+            {
+                while (keyFrameAtOrAfterIter != segmentModel.KeyFrames.end() && keyFrameAtOrAfterIter->first < frameNumber)
+                {
+                    ++keyFrameAtOrAfterIter;
+                }
+
+                // Mirrors the key frame lookup in VSEProcessorAviSynth::GetFrame
+                auto lookupIter = keyFrameAtOrAfterIter != segmentModel.KeyFrames.end() ? keyFrameAtOrAfterIter : prev(keyFrameAtOrAfterIter);
+
+                FrameParameterHasher hasher;
+                hasher.Add(segmentModel.Type);
+                hasher.Add(segmentModel.TrackNumber);
+                hasher.Add(frameNumber);
+                hasher.AddKeyFrame(*lookupIter->second);
+
+                if (lookupIter->first > frameNumber && lookupIter != segmentModel.KeyFrames.begin())
+                {
+                    // Interpolated frame
+                    hasher.AddKeyFrame(*prev(lookupIter)->second);
+                }
+
+                segmentHashSums[frameNumber] += hasher.get_Hash();
+            }
+        }
+
+        const uint64_t videoProcessingOptionsHash = HashVideoProcessingOptions(project.VideoProcessingOptions);
+
+        vector<uint64_t> frameHashes(segmentHashSums.size());
+        for (size_t frameNumber = 0; frameNumber < frameHashes.size(); frameNumber++)
+        {
+            FrameParameterHasher hasher;
+            hasher.Add(videoProcessingOptionsHash);
+            hasher.Add(segmentHashSums[frameNumber]);
+            frameHashes[frameNumber] = hasher.get_Hash();
+        }
+
+        return frameHashes;
+    }
+
+    std::vector<FrameRange> GetChangedFrameRanges(const std::vector<uint64_t>& previousFrameHashes, const std::vector<uint64_t>& currentFrameHashes)
+    {
+        vector<FrameRange> changedFrameRanges;
+
+        for (int frameNumber = 0; frameNumber < static_cast<int>(currentFrameHashes.size()); frameNumber++)
+        {
+            if (frameNumber < static_cast<int>(previousFrameHashes.size()) && previousFrameHashes[frameNumber] == currentFrameHashes[frameNumber])
+            {
+                continue;
+            }
+
+            if (!changedFrameRanges.empty() && changedFrameRanges.back().EndFrame == frameNumber - 1)
+            {
+                changedFrameRanges.back().EndFrame = frameNumber;
+            }
+            else
+            {
+                changedFrameRanges.push_back({ frameNumber, frameNumber });
+            }
+        }
+
+        return changedFrameRanges;
+    }
+
+    std::vector<FrameRange> Compare(const VSEProject& previousProject, const VSEProject& currentProject, const int frameCount)
+    {
+        return GetChangedFrameRanges(ComputeFrameParameterHashes(previousProject, frameCount), ComputeFrameParameterHashes(currentProject, frameCount));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+/// <summary>
+/// An inclusive range of zero-based frame numbers.
+/// </summary>
+struct FrameRange
+{
+    /// <summary>The inclusive zero-based start frame number of the range.</summary>
+    int StartFrame;
+
+    /// <summary>The inclusive zero-based end frame number of the range.</summary>
+    int EndFrame;
+
+    /// <summary>
+    /// Compares two <see cref="FrameRange"/> instances for equality.
+    /// </summary>
+    /// <param name="lhs">The left hand side <see cref="FrameRange"/> instance to compare.</param>
+    /// <param name="rhs">The right hand side <see cref="FrameRange"/> instance to compare.</param>
+    /// <returns>True if the two <see cref="FrameRange"/> instances are equal, False otherwise.</returns>
+    friend bool operator==(const FrameRange& lhs, const FrameRange& rhs)
+    {
+        return lhs.StartFrame == rhs.StartFrame && lhs.EndFrame == rhs.EndFrame;
+    }
+};
+
+/// <summary>
+/// Functions for finding the frames whose render parameters differ between two versions of a Video Script Editor project,
+/// so that only those frames need to be re-rendered.
+/// </summary>
+/// <remarks>
+/// A frame's render parameters are the project's video processing options and, for each segment active on the frame,
+/// its type, track number and the key frames its frame data is interpolated from.
+/// Frame parameter hashes are persisted alongside rendered output so that a later version of the project can be
+/// compared against the version that was rendered without keeping the old project file.
+/// </remarks>
+namespace VSEProjectDiff
+{
+    /// <summary>
+    /// Computes a hash of the render parameters of each frame of a project.
+    /// </summary>
+    /// <param name="project">The <see cref="VSEProject"/> to hash.</param>
+    /// <param name="frameCount">The number of frames to hash, usually the number of frames in the source video.</param>
+    /// <returns>A <see cref="std::vector"/> of frame parameter hashes indexed by zero-based frame number.</returns>
+    std::vector<uint64_t> ComputeFrameParameterHashes(const VSEProject& project, const int frameCount);
+
+    /// <summary>
+    /// Gets the ranges of frames whose parameter hashes differ.
+    /// </summary>
+    /// <remarks>Frames without a previous hash are treated as changed.</remarks>
+    /// <param name="previousFrameHashes">The frame parameter hashes of the previously rendered project version.</param>
+    /// <param name="currentFrameHashes">The frame parameter hashes of the current project version.</param>
+    /// <returns>A <see cref="std::vector"/> of non-adjacent changed <see cref="FrameRange"/>s, in frame order.</returns>
+    std::vector<FrameRange> GetChangedFrameRanges(const std::vector<uint64_t>& previousFrameHashes, const std::vector<uint64_t>& currentFrameHashes);
+
+    /// <summary>
+    /// Gets the ranges of frames whose render parameters differ between two versions of a project.
+    /// </summary>
+    /// <param name="previousProject">The previously rendered <see cref="VSEProject"/> version.</param>
+    /// <param name="currentProject">The current <see cref="VSEProject"/> version.</param>
+    /// <param name="frameCount">The number of frames to compare.</param>
+    /// <returns>A <see cref="std::vector"/> of non-adjacent changed <see cref="FrameRange"/>s, in frame order.</returns>
+    std::vector<FrameRange> Compare(const VSEProject& previousProject, const VSEProject& currentProject, const int frameCount);
+}
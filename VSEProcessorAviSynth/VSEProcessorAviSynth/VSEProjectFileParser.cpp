@@ -19,8 +19,28 @@ void VSEProjectFileParser::Parse(const char* projectFileName)
         throw std::runtime_error("Unable to load the project file for parsing");
     }
 
-    const XMLElement* projectXml = projectXmlDoc->RootElement();
-    
+    ParseProjectElement(projectXmlDoc->RootElement());
+}
+
+void VSEProjectFileParser::Parse(const std::string_view& projectFileContent)
+{
+    std::unique_ptr<tinyxml2::XMLDocument> projectXmlDoc = std::make_unique<tinyxml2::XMLDocument>();
+
+    if (projectXmlDoc->Parse(projectFileContent.data(), projectFileContent.size()) != XML_SUCCESS)
+    {
+        throw std::runtime_error("Unable to parse the project file content");
+    }
+
+    ParseProjectElement(projectXmlDoc->RootElement());
+}
+
+void VSEProjectFileParser::ParseProjectElement(const XMLElement* projectXml)
+{
+    if (projectXml == nullptr)
+    {
+        throw std::runtime_error("The project file has no root element");
+    }
+
     const XMLElement* croppingElement = projectXml->FirstChildElement(ElementNames::Cropping);
     if (croppingElement != nullptr)
     {
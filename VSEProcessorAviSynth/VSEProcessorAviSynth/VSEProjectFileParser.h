@@ -26,7 +26,20 @@ public:
     /// <param name="projectFileName">The file path of the Video Script Editor project file to parse.</param>
     void Parse(const char* projectFileName);
 
+    /// <summary>
+    /// Parses the XML content of a Video Script Editor project file, already read into memory,
+    /// into the <see cref="VSEProject"/> structure reference.
+    /// </summary>
+    /// <param name="projectFileContent">The XML content of the Video Script Editor project file.</param>
+    void Parse(const std::string_view& projectFileContent);
+
 private:
+    /// <summary>
+    /// Parses the root Project <see cref="tinyxml2::XMLElement"/> into the <see cref="VSEProject"/> structure reference.
+    /// </summary>
+    /// <param name="projectXml">A pointer to the root Project <see cref="tinyxml2::XMLElement"/>, or nullptr if the document is empty.</param>
+    void ParseProjectElement(const tinyxml2::XMLElement* projectXml);
+
     /// <summary>
     /// Parses the Cropping <see cref="tinyxml2::XMLElement"/>, creating and adding <see cref="SegmentModel"/>s
     /// for each parsed Crop type child Segment element to the <see cref="VSEProject::SegmentModels"/> collection.
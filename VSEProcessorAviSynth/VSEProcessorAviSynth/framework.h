@@ -29,7 +29,7 @@
 
 #include "..\..\Shared\cpp\Primitives.h"
 #include "..\..\Shared\cpp\CommonDataStructs.h"
-#include "..\..\Shared\cpp\CommonFunctionTemplates.h"
+#include "..\..\Shared\cpp\TrackIndexedTable.h"
 #include "MathHelpers.h"
 #include "VSEProject.h"
 
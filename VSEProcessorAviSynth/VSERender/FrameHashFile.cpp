@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "FrameHashFile.h"
+
+namespace VSERender::FrameHashFile
+{
+    using namespace std;
+
+    namespace
+    {
+        constexpr char FileSignature[8] = { 'V', 'S', 'E', 'F', 'H', 'A', 'S', 'H' };
+    }
+
+    std::string GetFilePath(const std::string& outputFilePath)
+    {
+        return outputFilePath + ".framehash";
+    }
+
+    void Save(const std::string& filePath, const std::vector<uint64_t>& frameHashes)
+    {
+        FILE* file = nullptr;
+        if (fopen_s(&file, filePath.c_str(), "wb") != 0 || file == nullptr)
+        {
+            throw runtime_error(fmt::format("Failed to create the frame hash file '{:s}'.", filePath));
+        }
+
+        unique_ptr<FILE, decltype(&fclose)> fileCloser(file, &fclose);
+
+        const uint32_t frameCount = static_cast<uint32_t>(frameHashes.size());
+        if (fwrite(FileSignature, sizeof(FileSignature), 1, file) != 1
+            || fwrite(&frameCount, sizeof(frameCount), 1, file) != 1
+            || fwrite(frameHashes.data(), sizeof(uint64_t), frameHashes.size(), file) != frameHashes.size())
+        {
+            throw runtime_error(fmt::format("Failed to write the frame hash file '{:s}'.", filePath));
+        }
+    }
+
+    std::vector<uint64_t> Load(const std::string& filePath)
+    {
+        FILE* file = nullptr;
+        if (fopen_s(&file, filePath.c_str(), "rb") != 0 || file == nullptr)
+        {
+            throw runtime_error(fmt::format("Failed to open the frame hash file '{:s}'.", filePath));
+        }
+
+        unique_ptr<FILE, decltype(&fclose)> fileCloser(file, &fclose);
+
+        char signature[sizeof(FileSignature)];
+        uint32_t frameCount;
+        if (fread(signature, sizeof(signature), 1, file) != 1 || memcmp(signature, FileSignature, sizeof(FileSignature)) != 0
+            || fread(&frameCount, sizeof(frameCount), 1, file) != 1)
+        {
+            throw runtime_error(fmt::format("'{:s}' isn't a frame hash file.", filePath));
+        }
+
+        vector<uint64_t> frameHashes(frameCount);
+        if (fread(frameHashes.data(), sizeof(uint64_t), frameHashes.size(), file) != frameHashes.size())
+        {
+            throw runtime_error(fmt::format("Frame hash file '{:s}' is truncated.", filePath));
+        }
+
+        return frameHashes;
+    }
+}
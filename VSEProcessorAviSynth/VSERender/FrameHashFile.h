@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace VSERender
+{
+    /// <summary>
+    /// Reads and writes the per-frame parameter hashes persisted alongside rendered output,
+    /// which incremental renders compare to find the frames that need re-rendering.
+    /// </summary>
+    /// <remarks>
+    /// The file holds an 8 byte signature, a 32-bit frame count and a little-endian 64-bit hash per frame.
+    /// </remarks>
+    namespace FrameHashFile
+    {
+        /// <summary>
+        /// Gets the path of the frame hash file persisted alongside an output file.
+        /// </summary>
+        /// <param name="outputFilePath">(IN) The path of the rendered output file.</param>
+        /// <returns>The frame hash file path.</returns>
+        std::string GetFilePath(const std::string& outputFilePath);
+
+        /// <summary>
+        /// Saves frame parameter hashes to a file.
+        /// </summary>
+        /// <param name="filePath">(IN) The path of the frame hash file.</param>
+        /// <param name="frameHashes">(IN) The frame parameter hashes, indexed by output frame number.</param>
+        void Save(const std::string& filePath, const std::vector<uint64_t>& frameHashes);
+
+        /// <summary>
+        /// Loads frame parameter hashes from a file.
+        /// </summary>
+        /// <param name="filePath">(IN) The path of the frame hash file.</param>
+        /// <returns>The frame parameter hashes, indexed by output frame number.</returns>
+        std::vector<uint64_t> Load(const std::string& filePath);
+    }
+}
@@ -0,0 +1,30 @@
+#include "pch.h"
+#include "FrameRangeSpliceClip.h"
+
+namespace VSERender
+{
+    using namespace std;
+
+    FrameRangeSpliceClip::FrameRangeSpliceClip(PClip baseClip, PClip rangeClip, std::vector<FrameRange> frameRanges)
+        : _baseClip(baseClip), _rangeClip(rangeClip), _frameRanges(move(frameRanges))
+    {
+        assert(is_sorted(_frameRanges.begin(), _frameRanges.end(), [](const FrameRange& lhs, const FrameRange& rhs) { return lhs.EndFrame < rhs.StartFrame; }));
+    }
+
+    PVideoFrame __stdcall FrameRangeSpliceClip::GetFrame(int n, IScriptEnvironment* env)
+    {
+        return IsInFrameRange(n) ? _rangeClip->GetFrame(n, env) : _baseClip->GetFrame(n, env);
+    }
+
+    bool FrameRangeSpliceClip::IsInFrameRange(const int n) const
+    {
+        // Find the last range starting at or before frame n
+        auto frameRangeIter = upper_bound(_frameRanges.begin(), _frameRanges.end(), n, [](const int frameNumber, const FrameRange& frameRange) { return frameNumber < frameRange.StartFrame; });
+        if (frameRangeIter == _frameRanges.begin())
+        {
+            return false;
+        }
+
+        return n <= prev(frameRangeIter)->EndFrame;
+    }
+}
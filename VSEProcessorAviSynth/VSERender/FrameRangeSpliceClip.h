@@ -0,0 +1,64 @@
+#pragma once
+#include "..\VSEProcessorAviSynth\VSEProjectDiff.h"
+#include <vector>
+
+namespace VSERender
+{
+    /// <summary>
+    /// An AviSynth clip that takes frames in a set of ranges from one clip and all other frames from another,
+    /// so that an incremental render only processes the frames whose render parameters changed.
+    /// </summary>
+    /// <remarks>
+    /// Unlike a chain of Trim and splice filters, frame lookup is a single binary search however many ranges there are.
+    /// </remarks>
+    class FrameRangeSpliceClip : public IClip
+    {
+        /// <summary>The clip frames outside <see cref="_frameRanges"/> are taken from.</summary>
+        PClip _baseClip;
+
+        /// <summary>The clip frames inside <see cref="_frameRanges"/> are taken from.</summary>
+        PClip _rangeClip;
+
+        /// <summary>The non-overlapping frame ranges taken from <see cref="_rangeClip"/>, in frame order.</summary>
+        std::vector<FrameRange> _frameRanges;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="FrameRangeSpliceClip"/> class.
+        /// </summary>
+        /// <param name="baseClip">(IN) The clip frames outside <paramref name="frameRanges"/> are taken from.</param>
+        /// <param name="rangeClip">(IN) The clip frames inside <paramref name="frameRanges"/> are taken from. Its <see cref="VideoInfo"/> is used.</param>
+        /// <param name="frameRanges">(IN) The non-overlapping frame ranges to take from <paramref name="rangeClip"/>, in frame order.</param>
+        FrameRangeSpliceClip(PClip baseClip, PClip rangeClip, std::vector<FrameRange> frameRanges);
+
+        PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override;
+
+        void __stdcall GetAudio(void* buf, __int64 start, __int64 count, IScriptEnvironment* env) override
+        {
+            _rangeClip->GetAudio(buf, start, count, env);
+        }
+
+        const VideoInfo& __stdcall GetVideoInfo() override
+        {
+            return _rangeClip->GetVideoInfo();
+        }
+
+        bool __stdcall GetParity(int n) override
+        {
+            return _rangeClip->GetParity(n);
+        }
+
+        int __stdcall SetCacheHints(int cachehints, int frame_range) override
+        {
+            // Frame lookup only reads immutable state
+            return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
+        }
+
+        /// <summary>
+        /// Determines whether a frame is taken from the range clip.
+        /// </summary>
+        /// <param name="n">(IN) The zero-based frame number.</param>
+        /// <returns>True if frame <paramref name="n"/> is in one of the frame ranges, False otherwise.</returns>
+        bool IsInFrameRange(const int n) const;
+    };
+}
@@ -0,0 +1,247 @@
+#include "pch.h"
+#include "RenderJob.h"
+#include "..\VSEProcessorAviSynth\VSEProjectDiff.h"
+#include "..\VSEProcessorAviSynth\VSEProjectFileParser.h"
+#include "FrameHashFile.h"
+#include "FrameRangeSpliceClip.h"
+#include "Y4MWriter.h"
+#include "YuvFileSource.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+using namespace VideoScriptEditor::Unmanaged;
+
+namespace VSERender
+{
+    using namespace std;
+
+    namespace
+    {
+        /// <summary>The interval between progress reports.</summary>
+        constexpr chrono::milliseconds ProgressReportInterval(1000);
+
+        /// <summary>
+        /// Invokes an AviSynth function, translating AviSynth errors into <see cref="std::runtime_error"/> exceptions.
+        /// </summary>
+        /// <param name="env">(IN) The AviSynth <see cref="IScriptEnvironment"/> interface.</param>
+        /// <param name="functionName">(IN) The name of the function to invoke.</param>
+        /// <param name="args">(IN) The function arguments.</param>
+        /// <param name="argNames">(IN) The function argument names, or nullptr if all arguments are positional.</param>
+        /// <returns>The function's return value.</returns>
+        AVSValue InvokeAvsFunction(IScriptEnvironment* env, const char* functionName, const AVSValue& args, const char* const* argNames = nullptr)
+        {
+            try
+            {
+                return env->Invoke(functionName, args, argNames);
+            }
+            catch (const IScriptEnvironment::NotFound&)
+            {
+                throw runtime_error(fmt::format("AviSynth function {:s} not found.", functionName));
+            }
+            catch (const AvisynthError& avisynthError)
+            {
+                throw runtime_error(avisynthError.msg);
+            }
+        }
+
+        string GetDefaultPluginFilePath()
+        {
+            char executableFilePath[MAX_PATH];
+            const DWORD executableFilePathLength = GetModuleFileNameA(nullptr, executableFilePath, MAX_PATH);
+            if (executableFilePathLength == 0 || executableFilePathLength == MAX_PATH)
+            {
+                return "VSEProcessorAviSynth.dll";
+            }
+
+            return (filesystem::path(executableFilePath).parent_path() / "VSEProcessorAviSynth.dll").string();
+        }
+    }
+
+    SourceType GetSourceType(const std::string& sourceFilePath)
+    {
+        string extension = filesystem::path(sourceFilePath).extension().string();
+        transform(extension.begin(), extension.end(), extension.begin(), [](const char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+        if (extension == ".avs" || extension == ".avsi")
+        {
+            return SourceType::AviSynthScript;
+        }
+        else if (extension == ".y4m")
+        {
+            return SourceType::Y4M;
+        }
+
+        return SourceType::RawI420;
+    }
+
+    RenderJob::RenderJob(const RenderOptions& options)
+        : AviSynthEnvironmentBase(), _options(options)
+    {
+        if (!CreateScriptEnvironment())
+        {
+            throw runtime_error("Failed to create the AviSynth script environment.");
+        }
+    }
+
+    RenderJob::~RenderJob()
+    {
+        // Falls through to base class destructor
+    }
+
+    int RenderJob::Run()
+    {
+        BuildProcessingChain();
+
+        const VideoInfo& vi = _clip->GetVideoInfo();
+        Y4MWriter y4mWriter(_options.OutputFilePath, vi);
+
+        const auto startTime = chrono::steady_clock::now();
+        auto lastProgressReportTime = startTime;
+
+        for (int frameNumber = 0; frameNumber < vi.num_frames; frameNumber++)
+        {
+            PVideoFrame frame;
+            try
+            {
+                frame = _clip->GetFrame(frameNumber, _scriptEnvironment);
+            }
+            catch (const AvisynthError& avisynthError)
+            {
+                throw runtime_error(fmt::format("Frame {:d}: {:s}", _options.StartFrame + frameNumber, avisynthError.msg));
+            }
+
+            y4mWriter.WriteFrame(frame);
+
+            const auto now = chrono::steady_clock::now();
+            if (now - lastProgressReportTime >= ProgressReportInterval)
+            {
+                const double elapsedSeconds = chrono::duration<double>(now - startTime).count();
+                cerr << fmt::format("\r{:d}/{:d} frames, {:.2f} fps", frameNumber + 1, vi.num_frames, (frameNumber + 1) / elapsedSeconds) << flush;
+                lastProgressReportTime = now;
+            }
+        }
+
+        const double elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        cerr << fmt::format("\rRendered {:d} frames in {:.2f} s, {:.2f} fps\n", vi.num_frames, elapsedSeconds, vi.num_frames / elapsedSeconds);
+
+        if (_options.OutputFilePath != "-")
+        {
+            const auto firstFrameHashIter = _frameHashes.begin() + _options.StartFrame;
+            FrameHashFile::Save(FrameHashFile::GetFilePath(_options.OutputFilePath), vector<uint64_t>(firstFrameHashIter, firstFrameHashIter + vi.num_frames));
+        }
+
+        return vi.num_frames;
+    }
+
+    int RenderJob::GetSourceFrameCount()
+    {
+        return OpenSource()->GetVideoInfo().num_frames;
+    }
+
+    PClip RenderJob::OpenSource()
+    {
+        PClip sourceClip;
+        switch (GetSourceType(_options.SourceFilePath))
+        {
+        case SourceType::AviSynthScript:
+            sourceClip = InvokeAvsFunction(_scriptEnvironment, "Import", AVSValue(_options.SourceFilePath.c_str())).AsClip();
+            break;
+        case SourceType::Y4M:
+            sourceClip = YuvFileSource::OpenY4M(_options.SourceFilePath);
+            break;
+        default:
+            if (_options.RawFrameWidth <= 0 || _options.RawFrameHeight <= 0)
+            {
+                throw invalid_argument("Raw YUV sources require a frame size.");
+            }
+
+            sourceClip = YuvFileSource::OpenRawI420(_options.SourceFilePath, _options.RawFrameWidth, _options.RawFrameHeight, _options.RawFrameRateNumerator, _options.RawFrameRateDenominator);
+            break;
+        }
+
+        if (!sourceClip->GetVideoInfo().IsYV12())
+        {
+            // VSEProcessorAviSynth processes YV12 frames
+            const char* convertArgNames[] = { nullptr, "matrix" };
+            AVSValue convertArgs[] = { sourceClip, sourceClip->GetVideoInfo().height < 720 ? "Rec601" : "Rec709" };
+            sourceClip = InvokeAvsFunction(_scriptEnvironment, "ConvertToYV12", AVSValue(convertArgs, ARRAYSIZE(convertArgs)), convertArgNames).AsClip();
+        }
+
+        return sourceClip;
+    }
+
+    void RenderJob::BuildProcessingChain()
+    {
+        const string pluginFilePath = _options.PluginFilePath.empty() ? GetDefaultPluginFilePath() : _options.PluginFilePath;
+        InvokeAvsFunction(_scriptEnvironment, "LoadPlugin", AVSValue(pluginFilePath.c_str()));
+
+        PClip sourceClip = OpenSource();
+
+        {
+            VSEProject project;
+            VSEProjectFileParser projectFileParser(project);
+            projectFileParser.Parse(_options.ProjectFilePath.c_str());
+
+            _frameHashes = VSEProjectDiff::ComputeFrameParameterHashes(project, sourceClip->GetVideoInfo().num_frames);
+        }
+
+        // The plugin selects the frame range itself, so that shards skip segments outside their range
+        const char* processorArgNames[] = { nullptr, "projectFileName", "start_frame", "end_frame" };
+        AVSValue processorArgs[] = { sourceClip, _options.ProjectFilePath.c_str(), _options.StartFrame, _options.EndFrame };
+        PClip processedClip = InvokeAvsFunction(_scriptEnvironment, PLUGIN_NAME, AVSValue(processorArgs, ARRAYSIZE(processorArgs)), processorArgNames).AsClip();
+
+        if (!_options.PreviousOutputFilePath.empty())
+        {
+            processedClip = SpliceUnchangedFrames(processedClip);
+        }
+
+        const int workerCount = _options.WorkerCount > 0 ? _options.WorkerCount : static_cast<int>(thread::hardware_concurrency());
+        if (workerCount > 1)
+        {
+            AVSValue prefetchArgs[] = { processedClip, workerCount };
+            processedClip = InvokeAvsFunction(_scriptEnvironment, "Prefetch", AVSValue(prefetchArgs, ARRAYSIZE(prefetchArgs))).AsClip();
+        }
+
+        _clip = processedClip;
+    }
+
+    PClip RenderJob::SpliceUnchangedFrames(PClip processedClip)
+    {
+        if (_options.StartFrame != 0 || _options.EndFrame >= 0)
+        {
+            throw invalid_argument("Incremental renders can't be limited to a frame range.");
+        }
+
+        if (_options.OutputFilePath == _options.PreviousOutputFilePath
+            || (filesystem::exists(_options.OutputFilePath) && filesystem::equivalent(_options.OutputFilePath, _options.PreviousOutputFilePath)))
+        {
+            throw invalid_argument("Incremental renders must write to a different file than the previous output.");
+        }
+
+        const vector<uint64_t> previousFrameHashes = FrameHashFile::Load(FrameHashFile::GetFilePath(_options.PreviousOutputFilePath));
+        PClip previousOutputClip = YuvFileSource::OpenY4M(_options.PreviousOutputFilePath);
+
+        const VideoInfo& previousOutputVideoInfo = previousOutputClip->GetVideoInfo();
+        const VideoInfo& processedVideoInfo = processedClip->GetVideoInfo();
+        if (previousOutputVideoInfo.width != processedVideoInfo.width || previousOutputVideoInfo.height != processedVideoInfo.height
+            || previousOutputVideoInfo.num_frames < static_cast<int>(previousFrameHashes.size()) || !previousOutputVideoInfo.IsSameColorspace(processedVideoInfo))
+        {
+            cerr << "The previous output doesn't match the project's output format. Rendering all frames.\n";
+            return processedClip;
+        }
+
+        vector<FrameRange> changedFrameRanges = VSEProjectDiff::GetChangedFrameRanges(previousFrameHashes, _frameHashes);
+
+        int changedFrameCount = 0;
+        for (const FrameRange& changedFrameRange : changedFrameRanges)
+        {
+            changedFrameCount += changedFrameRange.EndFrame - changedFrameRange.StartFrame + 1;
+        }
+
+        cerr << fmt::format("Re-rendering {:d} of {:d} frames in {:d} ranges.\n", changedFrameCount, processedVideoInfo.num_frames, changedFrameRanges.size());
+
+        return new FrameRangeSpliceClip(previousOutputClip, processedClip, move(changedFrameRanges));
+    }
+}
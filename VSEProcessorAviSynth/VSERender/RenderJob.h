@@ -0,0 +1,134 @@
+#pragma once
+#include "..\..\Shared\cpp\AviSynthEnvironmentBase.h"
+#include <string>
+#include <vector>
+
+namespace VSERender
+{
+    /// <summary>
+    /// Describes the format of a render source file.
+    /// </summary>
+    enum class SourceType
+    {
+        /// <summary>An AviSynth script (.avs or .avsi), imported into the render script environment.</summary>
+        AviSynthScript,
+
+        /// <summary>A YUV4MPEG2 stream (.y4m).</summary>
+        Y4M,
+
+        /// <summary>Headerless raw I420 frames (any other extension).</summary>
+        RawI420
+    };
+
+    /// <summary>
+    /// Options controlling a headless render of a Video Script Editor project.
+    /// </summary>
+    struct RenderOptions
+    {
+        /// <summary>The path of the Video Script Editor project file to process.</summary>
+        std::string ProjectFilePath;
+
+        /// <summary>The path of the source video file. Its <see cref="SourceType"/> is determined by its extension.</summary>
+        std::string SourceFilePath;
+
+        /// <summary>The path of the YUV4MPEG2 file to write, or "-" for the standard output stream.</summary>
+        std::string OutputFilePath;
+
+        /// <summary>
+        /// The path of an earlier render of the project over the same source, or an empty string to render every frame.
+        /// Frames whose render parameters haven't changed since are copied from it instead of being re-rendered.
+        /// </summary>
+        std::string PreviousOutputFilePath;
+
+        /// <summary>The path of the VSEProcessorAviSynth plugin DLL, or an empty string for the DLL next to the executable.</summary>
+        std::string PluginFilePath;
+
+        /// <summary>The frame width of a <see cref="SourceType::RawI420"/> source.</summary>
+        int RawFrameWidth = 0;
+
+        /// <summary>The frame height of a <see cref="SourceType::RawI420"/> source.</summary>
+        int RawFrameHeight = 0;
+
+        /// <summary>The frame rate numerator of a <see cref="SourceType::RawI420"/> source.</summary>
+        unsigned RawFrameRateNumerator = 30000;
+
+        /// <summary>The frame rate denominator of a <see cref="SourceType::RawI420"/> source.</summary>
+        unsigned RawFrameRateDenominator = 1001;
+
+        /// <summary>
+        /// The number of threads processing frames through AviSynth+ Prefetch.
+        /// 1 processes frames on the writing thread and 0 uses one thread per logical processor.
+        /// </summary>
+        int WorkerCount = 1;
+
+        /// <summary>The zero-based number of the first frame to render.</summary>
+        int StartFrame = 0;
+
+        /// <summary>The zero-based number of the last frame to render, or -1 to render to the end of the project.</summary>
+        int EndFrame = -1;
+    };
+
+    /// <summary>
+    /// Determines the format of a source file from its extension.
+    /// </summary>
+    /// <param name="sourceFilePath">(IN) The path of the source file.</param>
+    /// <returns>The <see cref="SourceType"/> of the file.</returns>
+    SourceType GetSourceType(const std::string& sourceFilePath);
+
+    /// <summary>
+    /// Renders a Video Script Editor project to a YUV4MPEG2 stream through the same
+    /// AviSynth and VSEProcessorAviSynth pipeline as a hand-written script, without a GUI.
+    /// </summary>
+    class RenderJob : public VideoScriptEditor::Unmanaged::AviSynthEnvironmentBase
+    {
+        const RenderOptions _options;
+
+        /// <summary>The render parameter hash of each source frame, persisted alongside the output for incremental renders.</summary>
+        std::vector<uint64_t> _frameHashes;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="RenderJob"/> class. Loads AviSynth.
+        /// </summary>
+        /// <param name="options">(IN) The <see cref="RenderOptions"/> describing the render.</param>
+        explicit RenderJob(const RenderOptions& options);
+
+        /// <summary>
+        /// Destructor for the <see cref="RenderJob"/> class.
+        /// </summary>
+        ~RenderJob();
+
+        /// <summary>
+        /// Builds the processing chain and writes each frame in the frame range to the output,
+        /// then saves the frame parameter hashes alongside it. Reports progress to the standard error stream.
+        /// </summary>
+        /// <returns>The number of frames written.</returns>
+        int Run();
+
+        /// <summary>
+        /// Opens the source file to count its frames, for planning a sharded render.
+        /// </summary>
+        /// <returns>The number of frames in the source.</returns>
+        int GetSourceFrameCount();
+
+    private:
+        /// <summary>
+        /// Opens the source file as a YV12 AviSynth clip.
+        /// </summary>
+        /// <returns>A <see cref="PClip"/> smart pointer to the source clip.</returns>
+        PClip OpenSource();
+
+        /// <summary>
+        /// Builds the source, VSEProcessorAviSynth (including the frame range) and prefetch processing chain into <see cref="_clip"/>.
+        /// </summary>
+        void BuildProcessingChain();
+
+        /// <summary>
+        /// Splices the frames of the previous output whose render parameters haven't changed into the processed clip.
+        /// Falls back to rendering every frame if the previous output doesn't match the processed clip's format.
+        /// </summary>
+        /// <param name="processedClip">(IN) The VSEProcessorAviSynth clip rendering the current project.</param>
+        /// <returns>A <see cref="PClip"/> smart pointer to the spliced clip, or <paramref name="processedClip"/>.</returns>
+        PClip SpliceUnchangedFrames(PClip processedClip);
+    };
+}
@@ -0,0 +1,310 @@
+#include "pch.h"
+#include "RenderManifest.h"
+#include "FrameHashFile.h"
+#include <fcntl.h>
+#include <filesystem>
+#include <io.h>
+
+using namespace tinyxml2;
+
+namespace VSERender
+{
+    using namespace std;
+
+    namespace
+    {
+        namespace ElementNames
+        {
+            constexpr auto RenderManifest = "RenderManifest";
+            constexpr auto Shard = "Shard";
+        }
+
+        namespace AttributeNames
+        {
+            constexpr auto ProjectFile = "ProjectFile";
+            constexpr auto SourceFile = "SourceFile";
+            constexpr auto RawFrameWidth = "RawFrameWidth";
+            constexpr auto RawFrameHeight = "RawFrameHeight";
+            constexpr auto RawFrameRateNumerator = "RawFrameRateNumerator";
+            constexpr auto RawFrameRateDenominator = "RawFrameRateDenominator";
+            constexpr auto FrameCount = "FrameCount";
+            constexpr auto Index = "Index";
+            constexpr auto StartFrame = "StartFrame";
+            constexpr auto EndFrame = "EndFrame";
+            constexpr auto OutputFile = "OutputFile";
+        }
+
+        /// <summary>The size of the buffer shard output files are copied through.</summary>
+        constexpr size_t ConcatenationBufferSize = 4 * 1024 * 1024;
+
+        const char* GetRequiredAttribute(const XMLElement* element, const char* attributeName)
+        {
+            const char* attributeValue = element->Attribute(attributeName);
+            if (attributeValue == nullptr)
+            {
+                throw runtime_error(fmt::format("Render manifest {:s} element is missing the {:s} attribute.", element->Name(), attributeName));
+            }
+
+            return attributeValue;
+        }
+
+        int GetRequiredIntAttribute(const XMLElement* element, const char* attributeName)
+        {
+            int attributeValue;
+            if (element->QueryIntAttribute(attributeName, &attributeValue) != XML_SUCCESS)
+            {
+                throw runtime_error(fmt::format("Render manifest {:s} element has a missing or invalid {:s} attribute.", element->Name(), attributeName));
+            }
+
+            return attributeValue;
+        }
+
+        /// <summary>
+        /// Opens a file, or the standard output stream in binary mode for a "-" path.
+        /// </summary>
+        FILE* OpenFile(const string& filePath, const char* mode)
+        {
+            if (filePath == "-")
+            {
+                _setmode(_fileno(stdout), _O_BINARY);
+                return stdout;
+            }
+
+            FILE* file = nullptr;
+            if (fopen_s(&file, filePath.c_str(), mode) != 0 || file == nullptr)
+            {
+                throw runtime_error(fmt::format("Failed to open '{:s}'.", filePath));
+            }
+
+            return file;
+        }
+    }
+
+    RenderManifest RenderManifest::Plan(const RenderOptions& sharedOptions, const int frameCount, const int shardCount, const std::string& manifestFilePath)
+    {
+        if (frameCount <= 0 || shardCount <= 0)
+        {
+            throw invalid_argument("A sharded render needs at least one frame and one shard.");
+        }
+
+        RenderManifest manifest;
+        manifest.SharedOptions = sharedOptions;
+        manifest.SharedOptions.ProjectFilePath = filesystem::absolute(sharedOptions.ProjectFilePath).string();
+        manifest.SharedOptions.SourceFilePath = filesystem::absolute(sharedOptions.SourceFilePath).string();
+        manifest.FrameCount = frameCount;
+
+        const filesystem::path manifestPath = filesystem::absolute(manifestFilePath);
+        const int clampedShardCount = min(shardCount, frameCount);
+
+        // The first (frameCount % shardCount) shards get one extra frame
+        const int baseShardFrameCount = frameCount / clampedShardCount;
+        const int extraFrameShardCount = frameCount % clampedShardCount;
+
+        int startFrame = 0;
+        for (int shardIndex = 0; shardIndex < clampedShardCount; shardIndex++)
+        {
+            RenderShard& shard = manifest.Shards.emplace_back();
+            shard.Index = shardIndex;
+            shard.StartFrame = startFrame;
+            shard.EndFrame = startFrame + baseShardFrameCount + (shardIndex < extraFrameShardCount ? 1 : 0) - 1;
+            shard.OutputFilePath = (manifestPath.parent_path() / fmt::format("{:s}.shard{:03d}.y4m", manifestPath.stem().string(), shardIndex)).string();
+
+            startFrame = shard.EndFrame + 1;
+        }
+
+        assert(startFrame == frameCount);
+
+        return manifest;
+    }
+
+    RenderManifest RenderManifest::Load(const std::string& manifestFilePath)
+    {
+        XMLDocument manifestXmlDoc;
+        if (manifestXmlDoc.LoadFile(manifestFilePath.c_str()) != XML_SUCCESS)
+        {
+            throw runtime_error(fmt::format("Unable to load the render manifest '{:s}'.", manifestFilePath));
+        }
+
+        const XMLElement* manifestElement = manifestXmlDoc.RootElement();
+        if (manifestElement == nullptr || strcmp(manifestElement->Name(), ElementNames::RenderManifest) != 0)
+        {
+            throw runtime_error(fmt::format("'{:s}' isn't a render manifest.", manifestFilePath));
+        }
+
+        RenderManifest manifest;
+        manifest.SharedOptions.ProjectFilePath = GetRequiredAttribute(manifestElement, AttributeNames::ProjectFile);
+        manifest.SharedOptions.SourceFilePath = GetRequiredAttribute(manifestElement, AttributeNames::SourceFile);
+        manifest.SharedOptions.RawFrameWidth = manifestElement->IntAttribute(AttributeNames::RawFrameWidth);
+        manifest.SharedOptions.RawFrameHeight = manifestElement->IntAttribute(AttributeNames::RawFrameHeight);
+        manifest.SharedOptions.RawFrameRateNumerator = manifestElement->UnsignedAttribute(AttributeNames::RawFrameRateNumerator, manifest.SharedOptions.RawFrameRateNumerator);
+        manifest.SharedOptions.RawFrameRateDenominator = manifestElement->UnsignedAttribute(AttributeNames::RawFrameRateDenominator, manifest.SharedOptions.RawFrameRateDenominator);
+        manifest.FrameCount = GetRequiredIntAttribute(manifestElement, AttributeNames::FrameCount);
+
+        const filesystem::path manifestDirectory = filesystem::absolute(manifestFilePath).parent_path();
+        int expectedStartFrame = 0;
+
+        for (const XMLElement* shardElement = manifestElement->FirstChildElement(ElementNames::Shard); shardElement != nullptr; shardElement = shardElement->NextSiblingElement(ElementNames::Shard))
+        {
+            RenderShard& shard = manifest.Shards.emplace_back();
+            shard.Index = GetRequiredIntAttribute(shardElement, AttributeNames::Index);
+            shard.StartFrame = GetRequiredIntAttribute(shardElement, AttributeNames::StartFrame);
+            shard.EndFrame = GetRequiredIntAttribute(shardElement, AttributeNames::EndFrame);
+            shard.OutputFilePath = (manifestDirectory / GetRequiredAttribute(shardElement, AttributeNames::OutputFile)).string();
+
+            // Shards must tile the frame range without gaps or overlaps for concatenation to reproduce a single process render
+            if (shard.Index != static_cast<int>(manifest.Shards.size()) - 1 || shard.StartFrame != expectedStartFrame || shard.EndFrame < shard.StartFrame)
+            {
+                throw runtime_error(fmt::format("Render manifest shard {:d} doesn't follow on from the previous shard.", shard.Index));
+            }
+
+            expectedStartFrame = shard.EndFrame + 1;
+        }
+
+        if (manifest.Shards.empty() || expectedStartFrame != manifest.FrameCount)
+        {
+            throw runtime_error("Render manifest shards don't cover all frames.");
+        }
+
+        return manifest;
+    }
+
+    void RenderManifest::Save(const std::string& manifestFilePath) const
+    {
+        const filesystem::path manifestDirectory = filesystem::absolute(manifestFilePath).parent_path();
+
+        XMLDocument manifestXmlDoc;
+        manifestXmlDoc.InsertEndChild(manifestXmlDoc.NewDeclaration());
+
+        XMLElement* manifestElement = manifestXmlDoc.NewElement(ElementNames::RenderManifest);
+        manifestElement->SetAttribute(AttributeNames::ProjectFile, SharedOptions.ProjectFilePath.c_str());
+        manifestElement->SetAttribute(AttributeNames::SourceFile, SharedOptions.SourceFilePath.c_str());
+        if (GetSourceType(SharedOptions.SourceFilePath) == SourceType::RawI420)
+        {
+            manifestElement->SetAttribute(AttributeNames::RawFrameWidth, SharedOptions.RawFrameWidth);
+            manifestElement->SetAttribute(AttributeNames::RawFrameHeight, SharedOptions.RawFrameHeight);
+            manifestElement->SetAttribute(AttributeNames::RawFrameRateNumerator, SharedOptions.RawFrameRateNumerator);
+            manifestElement->SetAttribute(AttributeNames::RawFrameRateDenominator, SharedOptions.RawFrameRateDenominator);
+        }
+        manifestElement->SetAttribute(AttributeNames::FrameCount, FrameCount);
+        manifestXmlDoc.InsertEndChild(manifestElement);
+
+        for (const RenderShard& shard : Shards)
+        {
+            XMLElement* shardElement = manifestElement->InsertNewChildElement(ElementNames::Shard);
+            shardElement->SetAttribute(AttributeNames::Index, shard.Index);
+            shardElement->SetAttribute(AttributeNames::StartFrame, shard.StartFrame);
+            shardElement->SetAttribute(AttributeNames::EndFrame, shard.EndFrame);
+            shardElement->SetAttribute(AttributeNames::OutputFile, filesystem::relative(shard.OutputFilePath, manifestDirectory).string().c_str());
+        }
+
+        if (manifestXmlDoc.SaveFile(manifestFilePath.c_str()) != XML_SUCCESS)
+        {
+            throw runtime_error(fmt::format("Failed to save the render manifest '{:s}'.", manifestFilePath));
+        }
+    }
+
+    RenderOptions RenderManifest::GetShardRenderOptions(const int shardIndex) const
+    {
+        if (shardIndex < 0 || shardIndex >= static_cast<int>(Shards.size()))
+        {
+            throw out_of_range(fmt::format("Shard index {:d} is outside the manifest's {:d} shards.", shardIndex, Shards.size()));
+        }
+
+        const RenderShard& shard = Shards[shardIndex];
+
+        RenderOptions shardOptions = SharedOptions;
+        shardOptions.OutputFilePath = shard.OutputFilePath;
+        shardOptions.StartFrame = shard.StartFrame;
+        shardOptions.EndFrame = shard.EndFrame;
+
+        return shardOptions;
+    }
+
+    void RenderManifest::ConcatenateShards(const std::string& outputFilePath) const
+    {
+        auto closeFile = [](FILE* file) {
+            if (file == stdout)
+            {
+                fflush(file);
+            }
+            else
+            {
+                fclose(file);
+            }
+        };
+
+        unique_ptr<FILE, decltype(closeFile)> outputFile(OpenFile(outputFilePath, "wb"), closeFile);
+        vector<char> buffer(ConcatenationBufferSize);
+
+        string streamHeader;
+        int64_t frameRecordSize = 0;
+
+        for (const RenderShard& shard : Shards)
+        {
+            unique_ptr<FILE, decltype(closeFile)> shardFile(OpenFile(shard.OutputFilePath, "rb"), closeFile);
+
+            // Every shard has the same stream header, which is written once
+            string shardStreamHeader;
+            int character;
+            while ((character = fgetc(shardFile.get())) != EOF)
+            {
+                shardStreamHeader += static_cast<char>(character);
+                if (character == '\n')
+                {
+                    break;
+                }
+            }
+
+            if (shardStreamHeader.empty() || shardStreamHeader.back() != '\n')
+            {
+                throw runtime_error(fmt::format("Shard {:d} output '{:s}' has no YUV4MPEG2 stream header.", shard.Index, shard.OutputFilePath));
+            }
+
+            if (streamHeader.empty())
+            {
+                streamHeader = shardStreamHeader;
+                if (fwrite(streamHeader.data(), 1, streamHeader.size(), outputFile.get()) != streamHeader.size())
+                {
+                    throw runtime_error("Failed to write to the output stream.");
+                }
+            }
+            else if (shardStreamHeader != streamHeader)
+            {
+                throw runtime_error(fmt::format("Shard {:d} output '{:s}' has a different stream header to shard 0.", shard.Index, shard.OutputFilePath));
+            }
+
+            int64_t shardFrameDataSize = 0;
+            size_t bytesRead;
+            while ((bytesRead = fread(buffer.data(), 1, buffer.size(), shardFile.get())) > 0)
+            {
+                if (fwrite(buffer.data(), 1, bytesRead, outputFile.get()) != bytesRead)
+                {
+                    throw runtime_error("Failed to write to the output stream.");
+                }
+
+                shardFrameDataSize += static_cast<int64_t>(bytesRead);
+            }
+
+            // Frame headers and frame data are the same size in every frame written by Y4MWriter
+            if (shardFrameDataSize % shard.get_FrameCount() != 0 || (frameRecordSize != 0 && shardFrameDataSize / shard.get_FrameCount() != frameRecordSize))
+            {
+                throw runtime_error(fmt::format("Shard {:d} output '{:s}' doesn't contain its {:d} frames. Was the shard render interrupted?", shard.Index, shard.OutputFilePath, shard.get_FrameCount()));
+            }
+
+            frameRecordSize = shardFrameDataSize / shard.get_FrameCount();
+        }
+
+        if (outputFilePath != "-")
+        {
+            // Concatenate the shards' frame hashes too, so that the output can be the previous output of an incremental render
+            vector<uint64_t> frameHashes;
+            for (const RenderShard& shard : Shards)
+            {
+                const vector<uint64_t> shardFrameHashes = FrameHashFile::Load(FrameHashFile::GetFilePath(shard.OutputFilePath));
+                frameHashes.insert(frameHashes.end(), shardFrameHashes.begin(), shardFrameHashes.end());
+            }
+
+            FrameHashFile::Save(FrameHashFile::GetFilePath(outputFilePath), frameHashes);
+        }
+    }
+}
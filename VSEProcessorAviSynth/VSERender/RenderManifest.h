@@ -0,0 +1,86 @@
+#pragma once
+#include "RenderJob.h"
+#include <string>
+#include <vector>
+
+namespace VSERender
+{
+    /// <summary>
+    /// A contiguous frame range of a sharded render, rendered by a single process.
+    /// </summary>
+    struct RenderShard
+    {
+        /// <summary>The zero-based index of the shard in rendering order.</summary>
+        int Index = 0;
+
+        /// <summary>The zero-based number of the shard's first frame.</summary>
+        int StartFrame = 0;
+
+        /// <summary>The zero-based number of the shard's last frame.</summary>
+        int EndFrame = 0;
+
+        /// <summary>The path of the shard's YUV4MPEG2 output file.</summary>
+        std::string OutputFilePath;
+
+        /// <summary>Gets the number of frames in the shard.</summary>
+        int get_FrameCount() const { return EndFrame - StartFrame + 1; }
+    };
+
+    /// <summary>
+    /// Describes how a render is split into frame range shards, so that the shards can be rendered by separate processes
+    /// or machines and their outputs concatenated into the same stream a single process would render.
+    /// </summary>
+    /// <remarks>
+    /// Manifests are saved as XML. Shard output file paths are saved relative to the manifest file.
+    /// </remarks>
+    class RenderManifest
+    {
+    public:
+        /// <summary>The project, source and raw source options shared by every shard. Frame range and worker options are unused.</summary>
+        RenderOptions SharedOptions;
+
+        /// <summary>The number of frames in the whole render.</summary>
+        int FrameCount = 0;
+
+        /// <summary>The shards, in frame order.</summary>
+        std::vector<RenderShard> Shards;
+
+        /// <summary>
+        /// Plans a sharded render, splitting the frames as evenly as possible.
+        /// </summary>
+        /// <param name="sharedOptions">(IN) The project, source and raw source options shared by every shard.</param>
+        /// <param name="frameCount">(IN) The number of frames in the whole render.</param>
+        /// <param name="shardCount">(IN) The number of shards. Clamped to the number of frames.</param>
+        /// <param name="manifestFilePath">(IN) The path the manifest will be saved to. Shard output files are named after it.</param>
+        /// <returns>The planned <see cref="RenderManifest"/>.</returns>
+        static RenderManifest Plan(const RenderOptions& sharedOptions, const int frameCount, const int shardCount, const std::string& manifestFilePath);
+
+        /// <summary>
+        /// Loads a manifest from an XML file.
+        /// </summary>
+        /// <param name="manifestFilePath">(IN) The path of the manifest file.</param>
+        /// <returns>The loaded <see cref="RenderManifest"/>, with absolute shard output file paths.</returns>
+        static RenderManifest Load(const std::string& manifestFilePath);
+
+        /// <summary>
+        /// Saves the manifest to an XML file.
+        /// </summary>
+        /// <param name="manifestFilePath">(IN) The path of the manifest file.</param>
+        void Save(const std::string& manifestFilePath) const;
+
+        /// <summary>
+        /// Gets the <see cref="RenderOptions"/> for rendering a shard.
+        /// </summary>
+        /// <param name="shardIndex">(IN) The zero-based index of the shard.</param>
+        /// <returns>The <see cref="RenderOptions"/> for the shard.</returns>
+        RenderOptions GetShardRenderOptions(const int shardIndex) const;
+
+        /// <summary>
+        /// Concatenates the shard output files into a single YUV4MPEG2 stream,
+        /// verifying that every shard has the same stream header and its expected number of frames.
+        /// The shards' frame hash files are concatenated alongside an output file.
+        /// </summary>
+        /// <param name="outputFilePath">(IN) The path of the file to write, or "-" for the standard output stream.</param>
+        void ConcatenateShards(const std::string& outputFilePath) const;
+    };
+}
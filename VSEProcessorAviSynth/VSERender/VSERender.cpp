@@ -0,0 +1,343 @@
+// VSERender.cpp : Renders Video Script Editor projects to YUV4MPEG2 without a GUI or a hand-written AviSynth script.
+
+#include "pch.h"
+#include "RenderJob.h"
+#include "RenderManifest.h"
+#include "..\VSEProcessorAviSynth\VSEProjectDiff.h"
+#include "..\VSEProcessorAviSynth\VSEProjectFileParser.h"
+#include <iostream>
+
+using namespace VSERender;
+using namespace std;
+
+namespace
+{
+    constexpr auto USAGE_TEXT =
+R"(Usage: VSERender <project file> <source file> <output file> [options]
+       VSERender plan <project file> <source file> <shard count> <manifest file> [options]
+       VSERender shard <manifest file> <shard index> [options]
+       VSERender concat <manifest file> <output file>
+       VSERender diff <previous project file> <project file> <frame count>
+
+Renders a Video Script Editor project over a source video and writes YUV4MPEG2 (.y4m) to the output file.
+An output file of - writes to the standard output stream, for piping into an encoder, e.g.
+  VSERender project.vseproj source.avs - | x264 --demuxer y4m -o output.264 -
+
+Sharded renders split the frames into contiguous ranges that can be rendered by separate processes or machines:
+  plan                        Writes a manifest of evenly sized shards. Shard outputs are written next to the manifest.
+  shard                       Renders one shard of a manifest
+  concat                      Joins the rendered shards into the same stream a single render writes
+
+Renders save a hash of each frame's render parameters to <output file>.framehash. After editing the project,
+--previous re-renders only the frames whose parameters changed and copies the rest from the earlier output.
+diff prints the frame ranges whose render parameters differ between two versions of a project.
+
+Source files:
+  .avs, .avsi                 AviSynth script, imported into the render script environment
+  .y4m                        YUV4MPEG2 stream
+  any other extension         Headerless raw I420 frames (requires --raw-size)
+
+Options:
+  --workers <n>               Number of frame processing threads, 0 for one per logical processor (default 1)
+  --start <n>                 Zero-based number of the first frame to render (default 0)
+  --end <n>                   Zero-based number of the last frame to render (default last frame)
+  --raw-size <w>x<h>          Raw I420 source frame size
+  --raw-fps <num>/<den>       Raw I420 source frame rate (default 30000/1001)
+  --plugin <path>             VSEProcessorAviSynth.dll path (default next to VSERender.exe)
+  --previous <file>           Earlier output of the project over the same source to copy unchanged frames from
+)";
+
+    int ParseIntArgument(const string_view& optionName, const char* value)
+    {
+        try
+        {
+            return stoi(value);
+        }
+        catch (const logic_error&)
+        {
+            throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+        }
+    }
+
+    /// <summary>
+    /// Parses a pair of integers separated by a character, such as a frame size or frame rate.
+    /// </summary>
+    /// <param name="optionName">(IN) The name of the option being parsed, for error messages.</param>
+    /// <param name="value">(IN) The option value.</param>
+    /// <param name="separator">(IN) The character separating the integers.</param>
+    /// <returns>A <see cref="std::pair"/> of the first and second integers.</returns>
+    pair<int, int> ParseIntPairArgument(const string_view& optionName, const char* value, const char separator)
+    {
+        const string_view valueView(value);
+        const size_t separatorPosition = valueView.find(separator);
+        if (separatorPosition == string_view::npos)
+        {
+            throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+        }
+
+        return {
+            ParseIntArgument(optionName, string(valueView.substr(0, separatorPosition)).c_str()),
+            ParseIntArgument(optionName, value + separatorPosition + 1)
+        };
+    }
+
+    /// <summary>
+    /// Parses the options following the positional arguments.
+    /// </summary>
+    /// <param name="argc">(IN) The number of command line arguments.</param>
+    /// <param name="argv">(IN) The command line arguments.</param>
+    /// <param name="firstOptionIndex">(IN) The index of the first option argument.</param>
+    /// <param name="options">(IN/OUT) The <see cref="RenderOptions"/> to set parsed options in.</param>
+    void ParseOptions(const int argc, char* argv[], const int firstOptionIndex, RenderOptions& options)
+    {
+        for (int argIndex = firstOptionIndex; argIndex < argc; argIndex += 2)
+        {
+            const string_view optionName(argv[argIndex]);
+            if (argIndex + 1 >= argc)
+            {
+                throw invalid_argument(fmt::format("Missing value for option {:s}.", optionName));
+            }
+
+            const char* value = argv[argIndex + 1];
+
+            if (optionName == "--workers")
+            {
+                options.WorkerCount = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--start")
+            {
+                options.StartFrame = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--end")
+            {
+                options.EndFrame = ParseIntArgument(optionName, value);
+            }
+            else if (optionName == "--raw-size")
+            {
+                tie(options.RawFrameWidth, options.RawFrameHeight) = ParseIntPairArgument(optionName, value, 'x');
+            }
+            else if (optionName == "--raw-fps")
+            {
+                const auto [frameRateNumerator, frameRateDenominator] = ParseIntPairArgument(optionName, value, '/');
+                if (frameRateNumerator <= 0 || frameRateDenominator <= 0)
+                {
+                    throw invalid_argument(fmt::format("Invalid value '{:s}' for option {:s}.", value, optionName));
+                }
+
+                options.RawFrameRateNumerator = static_cast<unsigned>(frameRateNumerator);
+                options.RawFrameRateDenominator = static_cast<unsigned>(frameRateDenominator);
+            }
+            else if (optionName == "--plugin")
+            {
+                options.PluginFilePath = value;
+            }
+            else if (optionName == "--previous")
+            {
+                options.PreviousOutputFilePath = value;
+            }
+            else
+            {
+                throw invalid_argument(fmt::format("Unknown option {:s}.", optionName));
+            }
+        }
+
+        if (options.WorkerCount < 0)
+        {
+            throw invalid_argument("The worker count can't be negative.");
+        }
+    }
+
+    /// <summary>
+    /// Plans a sharded render and saves its manifest.
+    /// </summary>
+    int PlanShards(const int argc, char* argv[])
+    {
+        RenderOptions sharedOptions;
+        int shardCount = 0;
+        try
+        {
+            sharedOptions.ProjectFilePath = argv[2];
+            sharedOptions.SourceFilePath = argv[3];
+            shardCount = ParseIntArgument("shard count", argv[4]);
+            if (shardCount < 1)
+            {
+                throw invalid_argument("The shard count must be at least 1.");
+            }
+
+            ParseOptions(argc, argv, 6, sharedOptions);
+        }
+        catch (const exception& ex)
+        {
+            cerr << ex.what() << endl << endl << USAGE_TEXT;
+            return 1;
+        }
+
+        const string manifestFilePath = argv[5];
+        try
+        {
+            RenderJob renderJob(sharedOptions);
+            const RenderManifest manifest = RenderManifest::Plan(sharedOptions, renderJob.GetSourceFrameCount(), shardCount, manifestFilePath);
+            manifest.Save(manifestFilePath);
+
+            for (const RenderShard& shard : manifest.Shards)
+            {
+                cerr << fmt::format("Shard {:d}: frames {:d}-{:d} -> {:s}\n", shard.Index, shard.StartFrame, shard.EndFrame, shard.OutputFilePath);
+            }
+        }
+        catch (const exception& ex)
+        {
+            cerr << "Planning failed: " << ex.what() << endl;
+            return 2;
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Renders one shard of a sharded render.
+    /// </summary>
+    int RenderShardFromManifest(const int argc, char* argv[])
+    {
+        RenderManifest manifest;
+        RenderOptions options;
+        try
+        {
+            manifest = RenderManifest::Load(argv[2]);
+            options = manifest.GetShardRenderOptions(ParseIntArgument("shard index", argv[3]));
+            ParseOptions(argc, argv, 4, options);
+        }
+        catch (const exception& ex)
+        {
+            cerr << ex.what() << endl << endl << USAGE_TEXT;
+            return 1;
+        }
+
+        try
+        {
+            RenderJob renderJob(options);
+            renderJob.Run();
+        }
+        catch (const exception& ex)
+        {
+            cerr << endl << "Render failed: " << ex.what() << endl;
+            return 2;
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Concatenates the rendered shards of a sharded render.
+    /// </summary>
+    int ConcatenateShards(char* argv[])
+    {
+        try
+        {
+            RenderManifest::Load(argv[2]).ConcatenateShards(argv[3]);
+        }
+        catch (const exception& ex)
+        {
+            cerr << "Concatenation failed: " << ex.what() << endl;
+            return 2;
+        }
+
+        return 0;
+    }
+
+    /// <summary>
+    /// Prints the frame ranges whose render parameters differ between two versions of a project.
+    /// </summary>
+    int DiffProjects(char* argv[])
+    {
+        try
+        {
+            const int frameCount = ParseIntArgument("frame count", argv[4]);
+
+            VSEProject previousProject;
+            VSEProjectFileParser previousProjectFileParser(previousProject);
+            previousProjectFileParser.Parse(argv[2]);
+
+            VSEProject currentProject;
+            VSEProjectFileParser currentProjectFileParser(currentProject);
+            currentProjectFileParser.Parse(argv[3]);
+
+            for (const FrameRange& changedFrameRange : VSEProjectDiff::Compare(previousProject, currentProject, frameCount))
+            {
+                cout << fmt::format("{:d}-{:d}\n", changedFrameRange.StartFrame, changedFrameRange.EndFrame);
+            }
+        }
+        catch (const exception& ex)
+        {
+            cerr << "Diff failed: " << ex.what() << endl;
+            return 2;
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4 || argv[1][0] == '-')
+    {
+        cerr << USAGE_TEXT;
+        return 1;
+    }
+
+    const string_view command(argv[1]);
+    if (command == "plan")
+    {
+        if (argc < 6)
+        {
+            cerr << USAGE_TEXT;
+            return 1;
+        }
+
+        return PlanShards(argc, argv);
+    }
+    else if (command == "shard")
+    {
+        return RenderShardFromManifest(argc, argv);
+    }
+    else if (command == "concat")
+    {
+        return ConcatenateShards(argv);
+    }
+    else if (command == "diff")
+    {
+        if (argc < 5)
+        {
+            cerr << USAGE_TEXT;
+            return 1;
+        }
+
+        return DiffProjects(argv);
+    }
+
+    RenderOptions options;
+    try
+    {
+        options.ProjectFilePath = argv[1];
+        options.SourceFilePath = argv[2];
+        options.OutputFilePath = argv[3];
+        ParseOptions(argc, argv, 4, options);
+    }
+    catch (const exception& ex)
+    {
+        cerr << ex.what() << endl << endl << USAGE_TEXT;
+        return 1;
+    }
+
+    try
+    {
+        RenderJob renderJob(options);
+        renderJob.Run();
+    }
+    catch (const exception& ex)
+    {
+        cerr << endl << "Render failed: " << ex.what() << endl;
+        return 2;
+    }
+
+    return 0;
+}
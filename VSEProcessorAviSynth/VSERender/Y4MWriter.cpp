@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "Y4MWriter.h"
+#include <fcntl.h>
+#include <io.h>
+
+namespace VSERender
+{
+    using namespace std;
+
+    namespace
+    {
+        /// <summary>The YUV4MPEG2 frame header, for frames without per-frame parameters.</summary>
+        constexpr string_view Y4MFrameHeader = "FRAME\n";
+
+        /// <summary>The number of frames the output stream buffer holds.</summary>
+        constexpr size_t StreamBufferFrameCount = 4;
+
+        const char* GetY4MColorSpace(const VideoInfo& videoInfo)
+        {
+            if (videoInfo.IsY8())
+            {
+                return "mono";
+            }
+            else if (videoInfo.Is420() && videoInfo.BitsPerComponent() == 8)
+            {
+                // AviSynth doesn't track chroma siting, but its 4:2:0 conversions default to MPEG-2 (left) siting.
+                return "420mpeg2";
+            }
+            else if (videoInfo.Is422() && videoInfo.BitsPerComponent() == 8)
+            {
+                return "422";
+            }
+            else if (videoInfo.Is444() && videoInfo.BitsPerComponent() == 8)
+            {
+                return "444";
+            }
+
+            throw runtime_error("YUV4MPEG2 output requires planar 8-bit YUV or Y8 video.");
+        }
+    }
+
+    Y4MWriter::Y4MWriter(const std::string& outputFilePath, const VideoInfo& videoInfo)
+        : _file(nullptr), _ownsFile(false), _videoInfo(videoInfo)
+    {
+        const string streamHeader = FormatStreamHeader(videoInfo);
+
+        if (outputFilePath == "-")
+        {
+            // Frames are binary data, so stop the C runtime translating '\n' bytes to "\r\n"
+            _setmode(_fileno(stdout), _O_BINARY);
+            _file = stdout;
+        }
+        else
+        {
+            if (fopen_s(&_file, outputFilePath.c_str(), "wb") != 0 || _file == nullptr)
+            {
+                throw runtime_error(fmt::format("Failed to open output file '{:s}'.", outputFilePath));
+            }
+
+            _ownsFile = true;
+        }
+
+        _streamBuffer.resize(static_cast<size_t>(videoInfo.BMPSize()) * StreamBufferFrameCount);
+        setvbuf(_file, _streamBuffer.data(), _IOFBF, _streamBuffer.size());
+
+        Write(streamHeader.data(), streamHeader.size());
+    }
+
+    Y4MWriter::~Y4MWriter()
+    {
+        if (_file != nullptr)
+        {
+            fflush(_file);
+
+            if (_ownsFile)
+            {
+                fclose(_file);
+            }
+            else
+            {
+                // The stream buffer is about to be freed
+                setvbuf(_file, nullptr, _IONBF, 0);
+            }
+
+            _file = nullptr;
+        }
+    }
+
+    void Y4MWriter::WriteFrame(const PVideoFrame& frame)
+    {
+        Write(Y4MFrameHeader.data(), Y4MFrameHeader.size());
+
+        constexpr int planes[] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+        const int planeCount = _videoInfo.IsY8() ? 1 : 3;
+        for (int planeIndex = 0; planeIndex < planeCount; planeIndex++)
+        {
+            const int plane = planes[planeIndex];
+            const BYTE* rowPtr = frame->GetReadPtr(plane);
+            const int pitch = frame->GetPitch(plane);
+            const int rowSize = frame->GetRowSize(plane);
+            const int planeHeight = frame->GetHeight(plane);
+
+            if (pitch == rowSize)
+            {
+                Write(rowPtr, static_cast<size_t>(rowSize) * planeHeight);
+            }
+            else
+            {
+                for (int row = 0; row < planeHeight; row++, rowPtr += pitch)
+                {
+                    Write(rowPtr, rowSize);
+                }
+            }
+        }
+    }
+
+    std::string Y4MWriter::FormatStreamHeader(const VideoInfo& videoInfo)
+    {
+        return fmt::format("YUV4MPEG2 W{:d} H{:d} F{:d}:{:d} Ip A1:1 C{:s}\n",
+                           videoInfo.width,
+                           videoInfo.height,
+                           videoInfo.fps_numerator,
+                           videoInfo.fps_denominator,
+                           GetY4MColorSpace(videoInfo));
+    }
+
+    void Y4MWriter::Write(const void* data, const size_t size)
+    {
+        if (fwrite(data, 1, size, _file) != size)
+        {
+            throw runtime_error("Failed to write to the output stream.");
+        }
+    }
+}
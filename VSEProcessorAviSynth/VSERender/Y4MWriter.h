@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace VSERender
+{
+    /// <summary>
+    /// Writes AviSynth video frames as a YUV4MPEG2 stream, which x264, x265 and FFmpeg can read from a pipe.
+    /// </summary>
+    class Y4MWriter
+    {
+        /// <summary>The output file, or the standard output stream.</summary>
+        FILE* _file;
+
+        /// <summary>Whether <see cref="_file"/> was opened by this instance and must be closed.</summary>
+        bool _ownsFile;
+
+        /// <summary>A stream buffer larger than the C runtime default, sized to hold several frames.</summary>
+        std::vector<char> _streamBuffer;
+
+        VideoInfo _videoInfo;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="Y4MWriter"/> class. Opens the output and writes the stream header.
+        /// </summary>
+        /// <param name="outputFilePath">(IN) The path of the file to write, or "-" for the standard output stream.</param>
+        /// <param name="videoInfo">(IN) The <see cref="VideoInfo"/> describing the frames to write. Must be planar 8-bit YUV or Y8.</param>
+        Y4MWriter(const std::string& outputFilePath, const VideoInfo& videoInfo);
+
+        /// <summary>
+        /// Destructor for the <see cref="Y4MWriter"/> class. Flushes and closes the output.
+        /// </summary>
+        ~Y4MWriter();
+
+        Y4MWriter(const Y4MWriter&) = delete;
+        Y4MWriter& operator=(const Y4MWriter&) = delete;
+
+        /// <summary>
+        /// Writes a frame to the stream.
+        /// </summary>
+        /// <param name="frame">(IN) The frame to write.</param>
+        void WriteFrame(const PVideoFrame& frame);
+
+        /// <summary>
+        /// Formats the YUV4MPEG2 stream header for a video format.
+        /// </summary>
+        /// <param name="videoInfo">(IN) The <see cref="VideoInfo"/> describing the stream.</param>
+        /// <returns>The stream header, including the terminating newline.</returns>
+        static std::string FormatStreamHeader(const VideoInfo& videoInfo);
+
+    private:
+        /// <summary>
+        /// Writes a block of bytes, throwing a <see cref="std::runtime_error"/> on failure.
+        /// </summary>
+        /// <param name="data">(IN) A pointer to the bytes to write.</param>
+        /// <param name="size">(IN) The number of bytes to write.</param>
+        void Write(const void* data, const size_t size);
+    };
+}
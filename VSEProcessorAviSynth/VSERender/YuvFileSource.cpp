@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "YuvFileSource.h"
+
+namespace VSERender
+{
+    using namespace std;
+
+    namespace
+    {
+        /// <summary>The signature at the start of every YUV4MPEG2 stream header.</summary>
+        constexpr string_view Y4MStreamSignature = "YUV4MPEG2";
+
+        /// <summary>The signature at the start of every YUV4MPEG2 frame header.</summary>
+        constexpr string_view Y4MFrameSignature = "FRAME";
+
+        /// <summary>The maximum length of a YUV4MPEG2 stream or frame header line.</summary>
+        constexpr size_t Y4MMaxHeaderLength = 1024;
+
+        /// <summary>
+        /// Reads a newline-terminated YUV4MPEG2 header line.
+        /// </summary>
+        /// <param name="file">(IN) The file to read from, positioned at the start of the header.</param>
+        /// <returns>The header line without its terminating newline, or an empty string at the end of the file.</returns>
+        string ReadY4MHeaderLine(FILE* file)
+        {
+            string headerLine;
+            int character;
+            while ((character = fgetc(file)) != EOF && character != '\n')
+            {
+                if (headerLine.size() == Y4MMaxHeaderLength)
+                {
+                    throw runtime_error("Invalid YUV4MPEG2 header: line too long.");
+                }
+
+                headerLine += static_cast<char>(character);
+            }
+
+            return headerLine;
+        }
+
+        int ParseY4MColorSpace(const string_view& colorSpaceParameter)
+        {
+            // 420, 420jpeg, 420mpeg2 and 420paldv only differ in chroma siting. High bit depth tags such as 420p10 aren't supported.
+            if (colorSpaceParameter == "420" || colorSpaceParameter == "420jpeg" || colorSpaceParameter == "420mpeg2" || colorSpaceParameter == "420paldv")
+            {
+                return VideoInfo::CS_YV12;
+            }
+            else if (colorSpaceParameter == "422")
+            {
+                return VideoInfo::CS_YV16;
+            }
+            else if (colorSpaceParameter == "444")
+            {
+                return VideoInfo::CS_YV24;
+            }
+            else if (colorSpaceParameter == "mono")
+            {
+                return VideoInfo::CS_Y8;
+            }
+
+            throw runtime_error(fmt::format("Unsupported YUV4MPEG2 color space 'C{:s}'. Only 8-bit 4:2:0, 4:2:2, 4:4:4 and mono are supported.", colorSpaceParameter));
+        }
+
+        int64_t GetFileSize(FILE* file)
+        {
+            _fseeki64(file, 0, SEEK_END);
+            const int64_t fileSize = _ftelli64(file);
+            _fseeki64(file, 0, SEEK_SET);
+
+            return fileSize;
+        }
+    }
+
+    YuvFileSource::YuvFileSource(const std::string& filePath)
+        : _file(nullptr)
+    {
+        memset(&_videoInfo, 0, sizeof(VideoInfo));
+
+        if (fopen_s(&_file, filePath.c_str(), "rb") != 0 || _file == nullptr)
+        {
+            throw runtime_error(fmt::format("Failed to open source file '{:s}'.", filePath));
+        }
+    }
+
+    YuvFileSource::~YuvFileSource()
+    {
+        if (_file != nullptr)
+        {
+            fclose(_file);
+            _file = nullptr;
+        }
+    }
+
+    PClip YuvFileSource::OpenY4M(const std::string& filePath)
+    {
+        YuvFileSource* source = new YuvFileSource(filePath);
+        PClip sourceClip(source);   // Releases the source if parsing throws
+
+        const int64_t fileSize = GetFileSize(source->_file);
+
+        const string streamHeader = ReadY4MHeaderLine(source->_file);
+        if (!streamHeader.starts_with(Y4MStreamSignature))
+        {
+            throw runtime_error(fmt::format("'{:s}' is not a YUV4MPEG2 file.", filePath));
+        }
+
+        VideoInfo& vi = source->_videoInfo;
+        vi.pixel_type = VideoInfo::CS_YV12;
+        unsigned frameRateNumerator = 0, frameRateDenominator = 0;
+
+        // Space separated parameters, each a single character tag followed by its value
+        size_t parameterStart = Y4MStreamSignature.size();
+        while (parameterStart < streamHeader.size())
+        {
+            size_t parameterEnd = streamHeader.find(' ', parameterStart);
+            if (parameterEnd == string::npos)
+            {
+                parameterEnd = streamHeader.size();
+            }
+
+            const string_view parameter(streamHeader.data() + parameterStart, parameterEnd - parameterStart);
+            if (!parameter.empty())
+            {
+                const string parameterValue(parameter.substr(1));
+                switch (parameter.front())
+                {
+                case 'W':
+                    vi.width = stoi(parameterValue);
+                    break;
+                case 'H':
+                    vi.height = stoi(parameterValue);
+                    break;
+                case 'F':
+                    if (sscanf_s(parameterValue.c_str(), "%u:%u", &frameRateNumerator, &frameRateDenominator) != 2)
+                    {
+                        throw runtime_error(fmt::format("Invalid YUV4MPEG2 frame rate 'F{:s}'.", parameterValue));
+                    }
+                    break;
+                case 'C':
+                    vi.pixel_type = ParseY4MColorSpace(parameterValue);
+                    break;
+                default:
+                    // Interlacing, pixel aspect ratio and extension parameters don't affect frame layout
+                    break;
+                }
+            }
+
+            parameterStart = parameterEnd + 1;
+        }
+
+        if (vi.width <= 0 || vi.height <= 0 || frameRateNumerator == 0 || frameRateDenominator == 0)
+        {
+            throw runtime_error(fmt::format("'{:s}' has an incomplete YUV4MPEG2 stream header.", filePath));
+        }
+
+        vi.SetFPS(frameRateNumerator, frameRateDenominator);
+
+        // Index frame offsets. Frame headers may carry parameters, so their lengths can vary.
+        const int64_t frameDataSize = source->GetFrameDataSize();
+        int64_t frameHeaderOffset = _ftelli64(source->_file);
+        while (frameHeaderOffset < fileSize)
+        {
+            _fseeki64(source->_file, frameHeaderOffset, SEEK_SET);
+
+            const string frameHeader = ReadY4MHeaderLine(source->_file);
+            if (!frameHeader.starts_with(Y4MFrameSignature))
+            {
+                throw runtime_error(fmt::format("Invalid YUV4MPEG2 frame header at byte offset {:d}.", frameHeaderOffset));
+            }
+
+            const int64_t frameDataOffset = frameHeaderOffset + static_cast<int64_t>(frameHeader.size()) + 1;
+            if (frameDataOffset + frameDataSize > fileSize)
+            {
+                break;  // Truncated final frame
+            }
+
+            source->_frameDataOffsets.push_back(frameDataOffset);
+            frameHeaderOffset = frameDataOffset + frameDataSize;
+        }
+
+        if (source->_frameDataOffsets.empty())
+        {
+            throw runtime_error(fmt::format("'{:s}' doesn't contain any complete frames.", filePath));
+        }
+
+        vi.num_frames = static_cast<int>(source->_frameDataOffsets.size());
+        source->_frameDataBuffer.resize(static_cast<size_t>(frameDataSize));
+
+        return sourceClip;
+    }
+
+    PClip YuvFileSource::OpenRawI420(const std::string& filePath, const int frameWidth, const int frameHeight, const unsigned frameRateNumerator, const unsigned frameRateDenominator)
+    {
+        if (frameWidth <= 0 || frameHeight <= 0 || frameWidth % 2 != 0 || frameHeight % 2 != 0)
+        {
+            throw invalid_argument("Raw I420 frame dimensions must be positive and even.");
+        }
+
+        YuvFileSource* source = new YuvFileSource(filePath);
+        PClip sourceClip(source);
+
+        VideoInfo& vi = source->_videoInfo;
+        vi.width = frameWidth;
+        vi.height = frameHeight;
+        vi.pixel_type = VideoInfo::CS_YV12;
+        vi.SetFPS(frameRateNumerator, frameRateDenominator);
+
+        const int64_t frameDataSize = source->GetFrameDataSize();
+        const int64_t frameCount = GetFileSize(source->_file) / frameDataSize;
+        if (frameCount == 0)
+        {
+            throw runtime_error(fmt::format("'{:s}' doesn't contain any complete {:d}x{:d} frames.", filePath, frameWidth, frameHeight));
+        }
+
+        source->_frameDataOffsets.reserve(static_cast<size_t>(frameCount));
+        for (int64_t frameNumber = 0; frameNumber < frameCount; frameNumber++)
+        {
+            source->_frameDataOffsets.push_back(frameNumber * frameDataSize);
+        }
+
+        vi.num_frames = static_cast<int>(frameCount);
+        source->_frameDataBuffer.resize(static_cast<size_t>(frameDataSize));
+
+        return sourceClip;
+    }
+
+    PVideoFrame __stdcall YuvFileSource::GetFrame(int n, IScriptEnvironment* env)
+    {
+        n = clamp(n, 0, _videoInfo.num_frames - 1);
+
+        PVideoFrame frame = env->NewVideoFrame(_videoInfo);
+
+        lock_guard<mutex> fileLock(_fileMutex);
+
+        if (_fseeki64(_file, _frameDataOffsets[n], SEEK_SET) != 0
+            || fread(_frameDataBuffer.data(), 1, _frameDataBuffer.size(), _file) != _frameDataBuffer.size())
+        {
+            env->ThrowError("VSERender: Failed to read source frame %d.", n);
+        }
+
+        const uint8_t* planeData = _frameDataBuffer.data();
+
+        constexpr int planes[] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+        const int planeCount = _videoInfo.IsY8() ? 1 : 3;
+        for (int planeIndex = 0; planeIndex < planeCount; planeIndex++)
+        {
+            const int plane = planes[planeIndex];
+            const int rowSize = frame->GetRowSize(plane);
+            const int planeHeight = frame->GetHeight(plane);
+
+            env->BitBlt(frame->GetWritePtr(plane), frame->GetPitch(plane), planeData, rowSize, rowSize, planeHeight);
+            planeData += static_cast<size_t>(rowSize) * planeHeight;
+        }
+
+        return frame;
+    }
+
+    int64_t YuvFileSource::GetFrameDataSize() const
+    {
+        const int64_t lumaSize = static_cast<int64_t>(_videoInfo.width) * _videoInfo.height;
+        if (_videoInfo.IsY8())
+        {
+            return lumaSize;
+        }
+
+        const int64_t chromaSize = static_cast<int64_t>(_videoInfo.width >> _videoInfo.GetPlaneWidthSubsampling(PLANAR_U))
+                                   * (_videoInfo.height >> _videoInfo.GetPlaneHeightSubsampling(PLANAR_U));
+
+        return lumaSize + 2 * chromaSize;
+    }
+}
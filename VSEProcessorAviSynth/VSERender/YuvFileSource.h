@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VSERender
+{
+    /// <summary>
+    /// An AviSynth source clip reading planar 8-bit YUV frames from a YUV4MPEG2 (.y4m) or headerless raw I420 (.yuv) file.
+    /// </summary>
+    /// <remarks>
+    /// Frame offsets are indexed when the file is opened so that frames can be read in any order,
+    /// as AviSynth requests them.
+    /// </remarks>
+    class YuvFileSource : public IClip
+    {
+        VideoInfo _videoInfo;
+
+        /// <summary>Guards <see cref="_file"/>, as frames may be requested from multiple prefetch threads.</summary>
+        std::mutex _fileMutex;
+        FILE* _file;
+
+        /// <summary>The byte offset of each frame's plane data in the file.</summary>
+        std::vector<int64_t> _frameDataOffsets;
+
+        /// <summary>Holds the plane data of the frame being read. Guarded by <see cref="_fileMutex"/>.</summary>
+        std::vector<uint8_t> _frameDataBuffer;
+
+    public:
+        /// <summary>
+        /// Opens a YUV4MPEG2 file, reading the frame size, frame rate and color space from the stream header.
+        /// </summary>
+        /// <param name="filePath">(IN) The path of the .y4m file.</param>
+        /// <returns>A <see cref="PClip"/> smart pointer to the new source clip.</returns>
+        static PClip OpenY4M(const std::string& filePath);
+
+        /// <summary>
+        /// Opens a headerless raw I420 file.
+        /// </summary>
+        /// <param name="filePath">(IN) The path of the raw .yuv file.</param>
+        /// <param name="frameWidth">(IN) The frame width in pixels.</param>
+        /// <param name="frameHeight">(IN) The frame height in pixels.</param>
+        /// <param name="frameRateNumerator">(IN) The frame rate numerator.</param>
+        /// <param name="frameRateDenominator">(IN) The frame rate denominator.</param>
+        /// <returns>A <see cref="PClip"/> smart pointer to the new source clip.</returns>
+        static PClip OpenRawI420(const std::string& filePath, const int frameWidth, const int frameHeight, const unsigned frameRateNumerator, const unsigned frameRateDenominator);
+
+        /// <summary>
+        /// Destructor for the <see cref="YuvFileSource"/> class. Closes the file.
+        /// </summary>
+        ~YuvFileSource();
+
+        YuvFileSource(const YuvFileSource&) = delete;
+        YuvFileSource& operator=(const YuvFileSource&) = delete;
+
+        PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override;
+
+        void __stdcall GetAudio(void* buf, __int64 start, __int64 count, IScriptEnvironment* env) override
+        {
+        }
+
+        const VideoInfo& __stdcall GetVideoInfo() override
+        {
+            return _videoInfo;
+        }
+
+        bool __stdcall GetParity(int n) override
+        {
+            return false;
+        }
+
+        int __stdcall SetCacheHints(int cachehints, int frame_range) override
+        {
+            // Reads share a single file handle and are serialized by _fileMutex
+            return cachehints == CACHE_GET_MTMODE ? MT_SERIALIZED : 0;
+        }
+
+    private:
+        /// <summary>
+        /// Constructor for the <see cref="YuvFileSource"/> class.
+        /// </summary>
+        /// <param name="filePath">(IN) The path of the file to open for reading.</param>
+        explicit YuvFileSource(const std::string& filePath);
+
+        /// <summary>
+        /// Gets the number of bytes of plane data in each frame.
+        /// </summary>
+        /// <returns>The frame size in bytes.</returns>
+        int64_t GetFrameDataSize() const;
+    };
+}
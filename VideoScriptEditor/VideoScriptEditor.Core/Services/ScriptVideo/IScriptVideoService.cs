@@ -88,6 +88,13 @@ namespace VideoScriptEditor.Services.ScriptVideo
         /// <param name="frameNumber">The zero-based video frame number to seek and render.</param>
         void SeekFrame(int frameNumber);
 
+        /// <summary>
+        /// Begins or ends scrubbing, during which sought frames are rendered from reduced resolution proxy frames.
+        /// </summary>
+        /// <remarks>When scrubbing ends, the current frame is rendered again at full resolution.</remarks>
+        /// <param name="isScrubbing">True to begin scrubbing, False to end scrubbing.</param>
+        void SetScrubbing(bool isScrubbing);
+
         /// <summary>
         /// Starts asynchronous video playback to source and preview Direct3D surfaces beginning at runtime context <see cref="IScriptVideoContext.FrameNumber"/>.
         /// </summary>
@@ -242,6 +242,19 @@ namespace VideoScriptEditor.Services.ScriptVideo
             SeekFrameCore(frameNumber, seekEvenIfCurrent: false, raiseEvents: true);
         }
 
+        /// <inheritdoc cref="IScriptVideoService.SetScrubbing(bool)"/>
+        public void SetScrubbing(bool isScrubbing)
+        {
+            SetUnmanagedScrubbing(isScrubbing);
+
+            var internalContext = InternalContext;
+            if (!isScrubbing && internalContext.HasVideo && !internalContext.IsVideoPlaying)
+            {
+                // Replace the last proxy render with a full resolution render
+                SeekFrameCore(internalContext.FrameNumber, seekEvenIfCurrent: true, raiseEvents: false);
+            }
+        }
+
         /// <summary>
         /// Sets video resizing preview options such as resize mode, aspect ratio or pixel width and height.
         /// </summary>
@@ -559,6 +572,12 @@ namespace VideoScriptEditor.Services.ScriptVideo
         /// </summary>
         protected abstract void RenderUnmanagedPreviewFrameSurface();
 
+        /// <summary>
+        /// Begins or ends scrubbing in the unmanaged script video controller.
+        /// </summary>
+        /// <param name="isScrubbing">True to begin scrubbing, False to end scrubbing.</param>
+        protected abstract void SetUnmanagedScrubbing(bool isScrubbing);
+
         /// <summary>
         /// Sets the content of the unmanaged Direct2D renderer's masking preview items cache via interop to
         /// frame data interpolated from masking segment key frame models.
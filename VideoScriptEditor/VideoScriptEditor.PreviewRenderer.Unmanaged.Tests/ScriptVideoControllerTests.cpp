@@ -1,12 +1,69 @@
 #include "pch.h"
 #include "..\VideoScriptEditor.PreviewRenderer.Unmanaged\ScriptVideoController.h"
+#include "..\..\Shared\cpp\D2DRendererBase.h"
 
 using namespace VideoScriptEditor::PreviewRenderer::Unmanaged;
+using namespace VideoScriptEditor::Unmanaged;
 using namespace std;
 
 namespace VideoScriptEditor::PreviewRenderer::Unmanaged::Tests
 {
     constexpr auto AVS_TEST_SCRIPT_FILE_PATH = R"(TestFiles\AVSSourceTestScript-628x472-23.976fps.avs)";
+    constexpr auto AVS_YUY2_TEST_SCRIPT_FILE_PATH = R"(TestFiles\AVSSourceTestScript-628x472-23.976fps-YUY2.avs)";
+    constexpr auto AVS_RGB32_TEST_SCRIPT_FILE_PATH = R"(TestFiles\AVSSourceTestScript-628x472-23.976fps-RGB32.avs)";
+    constexpr auto AVS_TWO_TONE_TEST_SCRIPT_FILE_PATH = R"(TestFiles\AVSTwoToneTestScript-640x480.avs)";
+
+    // BGRA reference colors of the two-tone test script's left (YUV 128,128,200) and right (YUV 128,180,128) halves,
+    // converted with the full range BT.601 equations
+    constexpr uint8_t TWO_TONE_LEFT_BGRA[] = { 128, 77, 229, 255 };
+    constexpr uint8_t TWO_TONE_RIGHT_BGRA[] = { 220, 110, 128, 255 };
+    constexpr uint8_t OPAQUE_BLACK_BGRA[] = { 0, 0, 0, 255 };
+
+    // Allows for the fixed point rounding of libyuv's color conversion
+    constexpr int REFERENCE_COLOR_TOLERANCE = 2;
+
+    const uint8_t* GetPixel(const BgraFrameBuffer& frameBuffer, const int x, const int y)
+    {
+        return frameBuffer.Pixels.data() + (static_cast<size_t>(y) * frameBuffer.Stride) + (static_cast<size_t>(x) * 4);
+    }
+
+    ::testing::AssertionResult IsPixelNear(const BgraFrameBuffer& frameBuffer, const int x, const int y, const uint8_t (&expectedBgra)[4])
+    {
+        const uint8_t* pixel = GetPixel(frameBuffer, x, y);
+        for (int channel = 0; channel < 4; ++channel)
+        {
+            if (abs(pixel[channel] - expectedBgra[channel]) > REFERENCE_COLOR_TOLERANCE)
+            {
+                return ::testing::AssertionFailure() << "Pixel (" << x << ", " << y << ") channel " << channel << " is " << static_cast<int>(pixel[channel])
+                                                     << ", expected " << static_cast<int>(expectedBgra[channel]);
+            }
+        }
+
+        return ::testing::AssertionSuccess();
+    }
+
+    /// <summary>
+    /// Renders source and preview frames from scratch with a new controller, for comparison against incrementally updated or cached renders.
+    /// </summary>
+    void RenderFrameFromScratch(const int frameNumber, const VideoSizeInfo& previewSizeInfo, const vector<pair<int, shared_ptr<MaskSegmentFrameDataItemBase>>>& maskingItems,
+                                const bool applyMaskingPreviewToSource, const float blurStandardDeviation, BgraFrameBuffer& sourceFrameBuffer, BgraFrameBuffer& previewFrameBuffer)
+    {
+        ScriptVideoController scriptVideoController;
+        scriptVideoController.LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        scriptVideoController.InitializePreviewRenderSurface(previewSizeInfo);
+        scriptVideoController.SetMaskingBlurStandardDeviation(blurStandardDeviation);
+
+        auto& maskingPreviewItems = scriptVideoController.get_MaskingPreviewItems();
+        for (const auto& [trackNumber, maskingItem] : maskingItems)
+        {
+            maskingPreviewItems[trackNumber].first = maskingItem;
+            scriptVideoController.UpdateMaskingGeometry(maskingPreviewItems[trackNumber]);
+        }
+
+        scriptVideoController.UpdateMaskingGeometryGroup();
+        scriptVideoController.RenderFrameSurfaces(frameNumber, applyMaskingPreviewToSource);
+        scriptVideoController.ReadRenderedFramePixels(sourceFrameBuffer, previewFrameBuffer);
+    }
 
     class ScriptVideoControllerTestFixture : public ::testing::Test
     {
@@ -37,4 +94,341 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged::Tests
 
         _scriptVideoController->RenderSourceFrameSurface(0);
     }
-}
\ No newline at end of file
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderSourceFrameSurfaceWithReadAheadAndSeek)
+    {
+        LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+        ASSERT_GT(loadedScriptVideoInfo.FrameCount, 20);
+
+        // Forward playback served by read-ahead
+        for (int frameNumber = 0; frameNumber < 10; ++frameNumber)
+        {
+            _scriptVideoController->RenderSourceFrameSurface(frameNumber);
+        }
+
+        // Seek, then reverse playback
+        for (int frameNumber = 20; frameNumber > 15; --frameNumber)
+        {
+            _scriptVideoController->RenderSourceFrameSurface(frameNumber);
+        }
+    }
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderSourceFrameSurfaceFromDecodedFrameCache)
+    {
+        LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+        ASSERT_GT(loadedScriptVideoInfo.FrameCount, 5);
+
+        for (int frameNumber = 0; frameNumber < 5; ++frameNumber)
+        {
+            _scriptVideoController->RenderSourceFrameSurface(frameNumber);
+        }
+
+        // Step back over the frames just displayed
+        for (int frameNumber = 4; frameNumber >= 0; --frameNumber)
+        {
+            _scriptVideoController->RenderSourceFrameSurface(frameNumber);
+        }
+
+        DecodedFrameCacheStatistics cacheStatistics = _scriptVideoController->GetDecodedFrameCacheStatistics();
+        EXPECT_EQ(cacheStatistics.MissCount, 5);
+        EXPECT_EQ(cacheStatistics.HitCount, 5);
+        EXPECT_EQ(cacheStatistics.CachedFrameCount, 5);
+        EXPECT_LE(cacheStatistics.CachedByteCount, cacheStatistics.ByteCapacity);
+
+        _scriptVideoController->SetDecodedFrameCacheCapacity(0);
+        cacheStatistics = _scriptVideoController->GetDecodedFrameCacheStatistics();
+        EXPECT_EQ(cacheStatistics.CachedFrameCount, 0);
+        EXPECT_EQ(cacheStatistics.CachedByteCount, 0);
+    }
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderSourceFrameSurfaceWhileScrubbing)
+    {
+        LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+        ASSERT_GT(loadedScriptVideoInfo.FrameCount, 4);
+
+        _scriptVideoController->SetScrubbing(true);
+        EXPECT_TRUE(_scriptVideoController->get_IsScrubbing());
+
+        for (int frameNumber = 0; frameNumber < 4; ++frameNumber)
+        {
+            _scriptVideoController->RenderSourceFrameSurface(frameNumber);
+        }
+
+        // Revisiting a scrubbed frame is served from the proxy frame cache without touching the decoded frame cache
+        _scriptVideoController->RenderSourceFrameSurface(0);
+
+        DecodedFrameCacheStatistics cacheStatistics = _scriptVideoController->GetDecodedFrameCacheStatistics();
+        EXPECT_EQ(cacheStatistics.MissCount, 4);
+        EXPECT_EQ(cacheStatistics.HitCount, 0);
+
+        // Playhead settles - the full resolution frame decoded while generating the proxy is reused
+        _scriptVideoController->SetScrubbing(false);
+        _scriptVideoController->RenderSourceFrameSurface(0);
+
+        cacheStatistics = _scriptVideoController->GetDecodedFrameCacheStatistics();
+        EXPECT_EQ(cacheStatistics.HitCount, 1);
+    }
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderSourceFrameSurfaceFromPackedPixelTypes)
+    {
+        // YUY2 and RGB32 clips are uploaded natively, without a conversion filter in the script
+        for (const char* scriptFilePath : { AVS_YUY2_TEST_SCRIPT_FILE_PATH, AVS_RGB32_TEST_SCRIPT_FILE_PATH })
+        {
+            LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(scriptFilePath);
+            ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+            EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(0));
+
+            // Scrubbing proxies are YV12 only, so packed pixel types keep rendering at full resolution
+            _scriptVideoController->SetScrubbing(true);
+            EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(1));
+            _scriptVideoController->SetScrubbing(false);
+        }
+    }
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderSourceFrameSurfacesInHighThroughputPipelineMode)
+    {
+        _scriptVideoController->SetRenderPipelineMode(RenderPipelineMode::HighThroughput);
+        EXPECT_EQ(_scriptVideoController->get_RenderPipelineMode(), RenderPipelineMode::HighThroughput);
+
+        LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+        ASSERT_GT(loadedScriptVideoInfo.FrameCount, 8);
+
+        const VideoSizeInfo previewSizeInfo{ VideoSizeMode::None, loadedScriptVideoInfo.PixelWidth, loadedScriptVideoInfo.PixelHeight };
+        _scriptVideoController->InitializePreviewRenderSurface(previewSizeInfo);
+
+        // Sequential playback alternates between the double-buffered source frame textures,
+        // rendering frames uploaded in the background while the previous frame was presented
+        for (int frameNumber = 0; frameNumber < 8; ++frameNumber)
+        {
+            EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(frameNumber));
+        }
+
+        BgraFrameBuffer pipelinedSourceFrameBuffer, previewFrameBuffer, lowLatencySourceFrameBuffer, lowLatencyPreviewFrameBuffer;
+        _scriptVideoController->ReadRenderedFramePixels(pipelinedSourceFrameBuffer, previewFrameBuffer);
+        RenderFrameFromScratch(7, previewSizeInfo, {}, false, D2DRendererBase::DefaultBlurStandardDeviation, lowLatencySourceFrameBuffer, lowLatencyPreviewFrameBuffer);
+        EXPECT_TRUE(pipelinedSourceFrameBuffer.Pixels == lowLatencySourceFrameBuffer.Pixels) << "Frame uploaded in the background differs from a low latency upload";
+
+        // A seek away from the speculatively uploaded frame, and back to low latency mode mid-playback
+        EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(2));
+        _scriptVideoController->SetRenderPipelineMode(RenderPipelineMode::LowLatency);
+        EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(3));
+    }
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderPreviewFrameSurfaceAfterMaskingGeometryEdits)
+    {
+        LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+        const VideoSizeInfo previewSizeInfo{ VideoSizeMode::Letterbox, loadedScriptVideoInfo.PixelWidth + 12, loadedScriptVideoInfo.PixelHeight + 8 };
+        _scriptVideoController->InitializePreviewRenderSurface(previewSizeInfo);
+
+        auto& maskingPreviewItems = _scriptVideoController->get_MaskingPreviewItems();
+        maskingPreviewItems[0].first = make_shared<MaskRectangleSegmentFrameDataItem>(10.0, 10.0, 100.0, 50.0);
+        _scriptVideoController->UpdateMaskingGeometry(maskingPreviewItems[0]);
+        _scriptVideoController->UpdateMaskingGeometryGroup();
+
+        // Full render
+        _scriptVideoController->RenderFrameSurfaces(0, false);
+
+        // Nudge the mask - only the old and new bounds are re-blurred and composited
+        const auto nudgedMask = make_shared<MaskRectangleSegmentFrameDataItem>(14.0, 12.0, 100.0, 50.0);
+        maskingPreviewItems[0].first = nudgedMask;
+        _scriptVideoController->UpdateMaskingGeometry(maskingPreviewItems[0]);
+        _scriptVideoController->UpdateMaskingGeometryGroup();
+        _scriptVideoController->RenderPreviewFrameSurface(false);
+
+        BgraFrameBuffer sourceFrameBuffer, previewFrameBuffer, fullRedrawSourceFrameBuffer, fullRedrawFrameBuffer;
+        _scriptVideoController->ReadRenderedFramePixels(sourceFrameBuffer, previewFrameBuffer);
+        RenderFrameFromScratch(0, previewSizeInfo, { { 0, nudgedMask } }, false, D2DRendererBase::DefaultBlurStandardDeviation, fullRedrawSourceFrameBuffer, fullRedrawFrameBuffer);
+        EXPECT_TRUE(previewFrameBuffer.Pixels == fullRedrawFrameBuffer.Pixels) << "Dirty rectangle render differs from a full redraw after moving a mask";
+
+        // Unchanged masking geometry
+        _scriptVideoController->RenderPreviewFrameSurface(false);
+        _scriptVideoController->ReadRenderedFramePixels(sourceFrameBuffer, previewFrameBuffer);
+        EXPECT_TRUE(previewFrameBuffer.Pixels == fullRedrawFrameBuffer.Pixels) << "Render differs after re-rendering unchanged masking geometry";
+
+        // Add a mask, then remove the first
+        const auto addedMask = make_shared<MaskRectangleSegmentFrameDataItem>(200.0, 200.0, 40.0, 40.0);
+        maskingPreviewItems[1].first = addedMask;
+        _scriptVideoController->UpdateMaskingGeometry(maskingPreviewItems[1]);
+        EXPECT_EQ(_scriptVideoController->RemoveInactiveMaskingPreviewItems({ 1 }), 1);
+        _scriptVideoController->UpdateMaskingGeometryGroup();
+        _scriptVideoController->RenderPreviewFrameSurface(false);
+
+        _scriptVideoController->ReadRenderedFramePixels(sourceFrameBuffer, previewFrameBuffer);
+        RenderFrameFromScratch(0, previewSizeInfo, { { 1, addedMask } }, false, D2DRendererBase::DefaultBlurStandardDeviation, fullRedrawSourceFrameBuffer, fullRedrawFrameBuffer);
+        EXPECT_TRUE(previewFrameBuffer.Pixels == fullRedrawFrameBuffer.Pixels) << "Dirty rectangle render differs from a full redraw after adding and removing masks";
+    }
+
+    TEST_F(ScriptVideoControllerTestFixture, RenderSourceFrameSurfaceWithMaskingAppliedAfterMaskingGeometryEdits)
+    {
+        LoadedScriptVideoInfo loadedScriptVideoInfo = _scriptVideoController->LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+        const VideoSizeInfo previewSizeInfo{ VideoSizeMode::None, loadedScriptVideoInfo.PixelWidth, loadedScriptVideoInfo.PixelHeight };
+        _scriptVideoController->InitializePreviewRenderSurface(previewSizeInfo);
+
+        auto& maskingPreviewItems = _scriptVideoController->get_MaskingPreviewItems();
+        maskingPreviewItems[0].first = make_shared<MaskRectangleSegmentFrameDataItem>(10.0, 10.0, 100.0, 50.0);
+        _scriptVideoController->UpdateMaskingGeometry(maskingPreviewItems[0]);
+        _scriptVideoController->UpdateMaskingGeometryGroup();
+
+        EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(0, true));
+
+        // Mask edits on the same frame reuse the cached source frame blur
+        shared_ptr<MaskRectangleSegmentFrameDataItem> editedMask;
+        for (double left = 20.0; left <= 60.0; left += 20.0)
+        {
+            editedMask = make_shared<MaskRectangleSegmentFrameDataItem>(left, 10.0, 100.0, 50.0);
+            maskingPreviewItems[0].first = editedMask;
+            _scriptVideoController->UpdateMaskingGeometry(maskingPreviewItems[0]);
+            _scriptVideoController->UpdateMaskingGeometryGroup();
+            EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(0, true));
+        }
+
+        BgraFrameBuffer cachedBlurSourceFrameBuffer, previewFrameBuffer, freshBlurSourceFrameBuffer, freshBlurPreviewFrameBuffer;
+        _scriptVideoController->ReadRenderedFramePixels(cachedBlurSourceFrameBuffer, previewFrameBuffer);
+        RenderFrameFromScratch(0, previewSizeInfo, { { 0, editedMask } }, true, D2DRendererBase::DefaultBlurStandardDeviation, freshBlurSourceFrameBuffer, freshBlurPreviewFrameBuffer);
+        EXPECT_TRUE(cachedBlurSourceFrameBuffer.Pixels == freshBlurSourceFrameBuffer.Pixels) << "Render with the cached blur differs from a render with a fresh blur";
+
+        // A different blur standard deviation invalidates the cached blur
+        constexpr float changedBlurStandardDeviation = 20.0f;
+        _scriptVideoController->SetMaskingBlurStandardDeviation(changedBlurStandardDeviation);
+        EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(0, true));
+
+        BgraFrameBuffer changedBlurSourceFrameBuffer;
+        _scriptVideoController->ReadRenderedFramePixels(changedBlurSourceFrameBuffer, previewFrameBuffer);
+        EXPECT_FALSE(changedBlurSourceFrameBuffer.Pixels == cachedBlurSourceFrameBuffer.Pixels) << "Render still uses the blur cached under the previous standard deviation";
+
+        RenderFrameFromScratch(0, previewSizeInfo, { { 0, editedMask } }, true, changedBlurStandardDeviation, freshBlurSourceFrameBuffer, freshBlurPreviewFrameBuffer);
+        EXPECT_TRUE(changedBlurSourceFrameBuffer.Pixels == freshBlurSourceFrameBuffer.Pixels) << "Render after changing the blur standard deviation differs from a render with a fresh blur";
+        _scriptVideoController->SetMaskingBlurStandardDeviation(D2DRendererBase::DefaultBlurStandardDeviation);
+
+        // A different frame, then a proxy of the same frame, are blurred again
+        EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(1, true));
+        _scriptVideoController->SetScrubbing(true);
+        EXPECT_NO_THROW(_scriptVideoController->RenderSourceFrameSurface(1, true));
+        _scriptVideoController->SetScrubbing(false);
+    }
+
+    TEST(ScriptVideoControllerCpuBackendTests, RenderFrameSurfaces)
+    {
+        ScriptVideoController scriptVideoController(PreviewRendererBackend::Cpu);
+
+        LoadedScriptVideoInfo loadedScriptVideoInfo = scriptVideoController.LoadAviSynthScriptFromFile(AVS_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+        const VideoSizeInfo previewSizeInfo{ VideoSizeMode::Letterbox, loadedScriptVideoInfo.PixelWidth + 12, loadedScriptVideoInfo.PixelHeight + 8 };
+        scriptVideoController.InitializePreviewRenderSurface(previewSizeInfo);
+
+        auto& maskingPreviewItems = scriptVideoController.get_MaskingPreviewItems();
+        maskingPreviewItems[0].first = make_shared<MaskRectangleSegmentFrameDataItem>(10.0, 10.0, 100.0, 50.0);
+        scriptVideoController.UpdateMaskingGeometry(maskingPreviewItems[0]);
+        scriptVideoController.UpdateMaskingGeometryGroup();
+
+        scriptVideoController.get_CroppingPreviewItems()[1] = CropSegmentFrameDataItem(20.0, 20.0, 320.0, 240.0, 15.0);
+
+        scriptVideoController.RenderFrameSurfaces(0, false);
+
+        const BgraFrameBuffer& sourceFrameBuffer = scriptVideoController.get_SourceFrameRenderBuffer();
+        EXPECT_EQ(sourceFrameBuffer.Width, loadedScriptVideoInfo.PixelWidth);
+        EXPECT_EQ(sourceFrameBuffer.Height, loadedScriptVideoInfo.PixelHeight);
+
+        const BgraFrameBuffer& previewFrameBuffer = scriptVideoController.get_PreviewFrameRenderBuffer();
+        EXPECT_EQ(previewFrameBuffer.Width, previewSizeInfo.Width);
+        EXPECT_EQ(previewFrameBuffer.Height, previewSizeInfo.Height);
+        EXPECT_EQ(previewFrameBuffer.Pixels.size(), static_cast<size_t>(previewFrameBuffer.Stride) * previewFrameBuffer.Height);
+    }
+    TEST(ScriptVideoControllerCpuBackendTests, RenderFrameSurfacesMatchesReferenceColors)
+    {
+        ScriptVideoController scriptVideoController(PreviewRendererBackend::Cpu);
+
+        LoadedScriptVideoInfo loadedScriptVideoInfo = scriptVideoController.LoadAviSynthScriptFromFile(AVS_TWO_TONE_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+        const VideoSizeInfo previewSizeInfo{ VideoSizeMode::Letterbox, loadedScriptVideoInfo.PixelWidth + 12, loadedScriptVideoInfo.PixelHeight + 8 };
+        scriptVideoController.InitializePreviewRenderSurface(previewSizeInfo);
+
+        scriptVideoController.RenderFrameSurfaces(0, false);
+
+        const BgraFrameBuffer& sourceFrameBuffer = scriptVideoController.get_SourceFrameRenderBuffer();
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 0, 0, TWO_TONE_LEFT_BGRA));
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 319, 479, TWO_TONE_LEFT_BGRA));
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 320, 0, TWO_TONE_RIGHT_BGRA));
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 639, 479, TWO_TONE_RIGHT_BGRA));
+
+        // The source frame is centered between black letterbox borders, unscaled
+        const BgraFrameBuffer& previewFrameBuffer = scriptVideoController.get_PreviewFrameRenderBuffer();
+        EXPECT_TRUE(IsPixelNear(previewFrameBuffer, 0, 0, OPAQUE_BLACK_BGRA));
+        EXPECT_TRUE(IsPixelNear(previewFrameBuffer, 5, 243, OPAQUE_BLACK_BGRA));
+        EXPECT_TRUE(IsPixelNear(previewFrameBuffer, 325, 3, OPAQUE_BLACK_BGRA));
+        EXPECT_TRUE(IsPixelNear(previewFrameBuffer, previewSizeInfo.Width - 1, previewSizeInfo.Height - 1, OPAQUE_BLACK_BGRA));
+
+        for (int y = 0; y < sourceFrameBuffer.Height; ++y)
+        {
+            ASSERT_EQ(memcmp(GetPixel(previewFrameBuffer, 6, y + 4), GetPixel(sourceFrameBuffer, 0, y), static_cast<size_t>(sourceFrameBuffer.Width) * 4), 0) << "Row " << y;
+        }
+    }
+
+    TEST(ScriptVideoControllerCpuBackendTests, RenderFrameSurfacesBlursOnlyWithinMaskingGeometry)
+    {
+        ScriptVideoController scriptVideoController(PreviewRendererBackend::Cpu);
+
+        LoadedScriptVideoInfo loadedScriptVideoInfo = scriptVideoController.LoadAviSynthScriptFromFile(AVS_TWO_TONE_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+        // Straddles the boundary between the two halves
+        auto& maskingPreviewItems = scriptVideoController.get_MaskingPreviewItems();
+        maskingPreviewItems[0].first = make_shared<MaskRectangleSegmentFrameDataItem>(300.0, 200.0, 40.0, 40.0);
+        scriptVideoController.UpdateMaskingGeometry(maskingPreviewItems[0]);
+        scriptVideoController.UpdateMaskingGeometryGroup();
+
+        scriptVideoController.RenderFrameSurfaces(0, true);
+
+        const BgraFrameBuffer& sourceFrameBuffer = scriptVideoController.get_SourceFrameRenderBuffer();
+
+        // Outside the mask, the frame is untouched up to the mask edge
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 299, 220, TWO_TONE_LEFT_BGRA));
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 340, 220, TWO_TONE_RIGHT_BGRA));
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 319, 199, TWO_TONE_LEFT_BGRA));
+        EXPECT_TRUE(IsPixelNear(sourceFrameBuffer, 320, 240, TWO_TONE_RIGHT_BGRA));
+
+        // Inside the mask, either side of the boundary is blended with the other half
+        for (const int x : { 319, 320 })
+        {
+            const uint8_t blendedRed = GetPixel(sourceFrameBuffer, x, 220)[2];
+            EXPECT_GT(blendedRed, TWO_TONE_RIGHT_BGRA[2] + 8) << "Column " << x;
+            EXPECT_LT(blendedRed, TWO_TONE_LEFT_BGRA[2] - 8) << "Column " << x;
+        }
+    }
+
+    TEST(ScriptVideoControllerCpuBackendTests, RenderFrameSurfacesCropsRotatedSegment)
+    {
+        ScriptVideoController scriptVideoController(PreviewRendererBackend::Cpu);
+
+        LoadedScriptVideoInfo loadedScriptVideoInfo = scriptVideoController.LoadAviSynthScriptFromFile(AVS_TWO_TONE_TEST_SCRIPT_FILE_PATH);
+        ASSERT_TRUE(loadedScriptVideoInfo.HasVideo);
+
+        const VideoSizeInfo previewSizeInfo{ VideoSizeMode::Letterbox, loadedScriptVideoInfo.PixelWidth, loadedScriptVideoInfo.PixelHeight };
+        scriptVideoController.InitializePreviewRenderSurface(previewSizeInfo);
+
+        // A 4:3 crop rotated within the left half fills the whole preview with the left half's color
+        scriptVideoController.get_CroppingPreviewItems()[0] = CropSegmentFrameDataItem(60.0, 140.0, 160.0, 120.0, 15.0);
+
+        scriptVideoController.RenderFrameSurfaces(0, false);
+
+        const BgraFrameBuffer& previewFrameBuffer = scriptVideoController.get_PreviewFrameRenderBuffer();
+        for (int y = 0; y < previewFrameBuffer.Height; y += 7)
+        {
+            for (int x = 0; x < previewFrameBuffer.Width; x += 7)
+            {
+                ASSERT_TRUE(IsPixelNear(previewFrameBuffer, x, y, TWO_TONE_LEFT_BGRA));
+            }
+        }
+    }
+}
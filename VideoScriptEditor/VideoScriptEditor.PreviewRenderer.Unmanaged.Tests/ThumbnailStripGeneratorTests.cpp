@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "..\VideoScriptEditor.PreviewRenderer.Unmanaged\ThumbnailStripGenerator.h"
+#include <filesystem>
+
+using namespace VideoScriptEditor::PreviewRenderer::Unmanaged;
+using namespace std;
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged::Tests
+{
+    constexpr auto AVS_THUMBNAIL_TEST_SCRIPT_FILE_PATH = R"(TestFiles\AVSSourceTestScript-628x472-23.976fps.avs)";
+
+    class ThumbnailStripGeneratorTestFixture : public ::testing::Test
+    {
+    protected:
+        filesystem::path _cacheDirectory;
+
+        void SetUp() override
+        {
+            _cacheDirectory = filesystem::temp_directory_path() / "VideoScriptEditor.ThumbnailStripGeneratorTests";
+            filesystem::remove_all(_cacheDirectory);
+        }
+
+        void TearDown() override
+        {
+            filesystem::remove_all(_cacheDirectory);
+        }
+    };
+
+    TEST_F(ThumbnailStripGeneratorTestFixture, GenerateThumbnailStrip)
+    {
+        ThumbnailStripGenerator thumbnailStripGenerator(_cacheDirectory.string());
+
+        ThumbnailStrip thumbnailStrip = thumbnailStripGenerator.GenerateThumbnailStrip(AVS_THUMBNAIL_TEST_SCRIPT_FILE_PATH, 10, 48);
+        ASSERT_EQ(thumbnailStrip.Thumbnails.size(), 10);
+        ASSERT_EQ(thumbnailStrip.FrameNumbers.size(), 10);
+        EXPECT_EQ(thumbnailStrip.ThumbnailHeight, 48);
+        EXPECT_EQ(thumbnailStrip.ThumbnailWidth, 62);   // 628x472 aspect ratio, rounded down to even
+
+        for (size_t i = 1; i < thumbnailStrip.FrameNumbers.size(); ++i)
+        {
+            EXPECT_LT(thumbnailStrip.FrameNumbers[i - 1], thumbnailStrip.FrameNumbers[i]);
+        }
+
+        // A second request is served from the on-disk cache with identical content
+        ThumbnailStrip cachedThumbnailStrip = thumbnailStripGenerator.GenerateThumbnailStrip(AVS_THUMBNAIL_TEST_SCRIPT_FILE_PATH, 10, 48);
+        EXPECT_FALSE(filesystem::is_empty(_cacheDirectory));
+        EXPECT_EQ(cachedThumbnailStrip.FrameNumbers, thumbnailStrip.FrameNumbers);
+        ASSERT_EQ(cachedThumbnailStrip.Thumbnails.size(), thumbnailStrip.Thumbnails.size());
+        EXPECT_EQ(cachedThumbnailStrip.Thumbnails[5].Pixels, thumbnailStrip.Thumbnails[5].Pixels);
+    }
+}
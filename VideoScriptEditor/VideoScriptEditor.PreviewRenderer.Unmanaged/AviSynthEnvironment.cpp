@@ -50,4 +50,9 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
 
         return true;
     }
+
+    PVideoFrame AviSynthEnvironment::NewVideoFrame(const VideoInfo& vi)
+    {
+        return _scriptEnvironment->NewVideoFrame(vi);
+    }
 }
\ No newline at end of file
@@ -31,5 +31,12 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         /// <returns>A boolean value indicating whether the script was loaded</returns>
         /// <remarks>Utilizes the AviSynth Import source filter which doesn't support relative file paths.</remarks>
         bool LoadScriptFromFile(const std::string& fileName);
+
+        /// <summary>
+        /// Allocates a new writable video frame from the environment's frame buffer pool.
+        /// </summary>
+        /// <param name="vi">A reference to a <see cref="VideoInfo"/> structure describing the format and dimensions of the frame.</param>
+        /// <returns>A smart pointer (PVideoFrame) to the new video frame.</returns>
+        PVideoFrame NewVideoFrame(const VideoInfo& vi);
     };
 }
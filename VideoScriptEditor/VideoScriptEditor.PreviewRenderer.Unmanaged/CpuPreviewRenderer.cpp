@@ -0,0 +1,576 @@
+#include "pch.h"
+#include "CpuPreviewRenderer.h"
+#include <libyuv.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <cassert>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    using namespace VideoScriptEditor::Unmanaged;
+    using namespace std;
+
+    namespace
+    {
+        constexpr int BGRA_BYTES_PER_PIXEL = 4;
+
+        // Three successive box blurs of radius r approximate a Gaussian blur with a standard deviation of roughly r,
+        // so this approximates the D2DRendererBase Gaussian blur standard deviation of 72.
+        constexpr int BLUR_BOX_RADIUS = 72;
+        constexpr int BLUR_BOX_PASS_COUNT = 3;
+
+        constexpr double PI = 3.14159265358979323846;
+
+        /// <summary>
+        /// Marks the pixels of a coverage mask row whose horizontal centers lie within [xStart, xEnd).
+        /// </summary>
+        void FillCoverageSpan(uint8_t* coverageRow, const int width, const double xStart, const double xEnd)
+        {
+            const int firstPixel = std::clamp(static_cast<int>(ceil(xStart - 0.5)), 0, width);
+            const int endPixel = std::clamp(static_cast<int>(ceil(xEnd - 0.5)), 0, width);
+            if (endPixel > firstPixel)
+            {
+                memset(coverageRow + firstPixel, 0xFF, static_cast<size_t>(endPixel) - firstPixel);
+            }
+        }
+
+        /// <summary>
+        /// Rasterizes a closed polygon into a coverage mask using the non-zero winding rule (D2D1_FILL_MODE_WINDING) sampled at pixel centers.
+        /// </summary>
+        void RasterizePolygonCoverage(const vector<PointD>& points, uint8_t* coverage, const int width, const int height)
+        {
+            struct EdgeCrossing
+            {
+                double X;
+                int Direction;
+            };
+
+            const size_t pointCount = points.size();
+            vector<EdgeCrossing> crossings;
+            crossings.reserve(pointCount);
+
+            for (int y = 0; y < height; ++y)
+            {
+                const double sampleY = y + 0.5;
+
+                crossings.clear();
+                for (size_t i = 0; i < pointCount; ++i)
+                {
+                    const PointD& p0 = points[i];
+                    const PointD& p1 = points[(i + 1) % pointCount];
+
+                    int direction;
+                    if (p0.Y <= sampleY && p1.Y > sampleY)
+                    {
+                        direction = 1;
+                    }
+                    else if (p1.Y <= sampleY && p0.Y > sampleY)
+                    {
+                        direction = -1;
+                    }
+                    else
+                    {
+                        continue;
+                    }
+
+                    const double crossingX = p0.X + ((sampleY - p0.Y) * (p1.X - p0.X)) / (p1.Y - p0.Y);
+                    crossings.push_back({ crossingX, direction });
+                }
+
+                sort(crossings.begin(), crossings.end(), [](const EdgeCrossing& lhs, const EdgeCrossing& rhs) { return lhs.X < rhs.X; });
+
+                uint8_t* coverageRow = coverage + (static_cast<size_t>(y) * width);
+                int winding = 0;
+                for (size_t i = 0; i + 1 < crossings.size(); ++i)
+                {
+                    winding += crossings[i].Direction;
+                    if (winding != 0)
+                    {
+                        FillCoverageSpan(coverageRow, width, crossings[i].X, crossings[i + 1].X);
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// Rasterizes an axis-aligned ellipse into a coverage mask sampled at pixel centers.
+        /// </summary>
+        void RasterizeEllipseCoverage(const MaskEllipseSegmentFrameDataItem& ellipse, uint8_t* coverage, const int width, const int height)
+        {
+            if (ellipse.RadiusX <= 0.0 || ellipse.RadiusY <= 0.0)
+            {
+                return;
+            }
+
+            const int firstRow = std::clamp(static_cast<int>(floor(ellipse.CenterPoint.Y - ellipse.RadiusY)), 0, height);
+            const int endRow = std::clamp(static_cast<int>(ceil(ellipse.CenterPoint.Y + ellipse.RadiusY)), 0, height);
+            for (int y = firstRow; y < endRow; ++y)
+            {
+                const double normalizedY = ((y + 0.5) - ellipse.CenterPoint.Y) / ellipse.RadiusY;
+                if (abs(normalizedY) >= 1.0)
+                {
+                    continue;
+                }
+
+                const double halfSpan = ellipse.RadiusX * sqrt(1.0 - (normalizedY * normalizedY));
+                FillCoverageSpan(coverage + (static_cast<size_t>(y) * width), width, ellipse.CenterPoint.X - halfSpan, ellipse.CenterPoint.X + halfSpan);
+            }
+        }
+
+        /// <summary>
+        /// Rasterizes an axis-aligned rectangle into a coverage mask sampled at pixel centers.
+        /// </summary>
+        void RasterizeRectangleCoverage(const MaskRectangleSegmentFrameDataItem& rectangle, uint8_t* coverage, const int width, const int height)
+        {
+            const int firstRow = std::clamp(static_cast<int>(ceil(rectangle.Top - 0.5)), 0, height);
+            const int endRow = std::clamp(static_cast<int>(ceil(rectangle.Top + rectangle.Height - 0.5)), 0, height);
+            for (int y = firstRow; y < endRow; ++y)
+            {
+                FillCoverageSpan(coverage + (static_cast<size_t>(y) * width), width, rectangle.Left, rectangle.Left + rectangle.Width);
+            }
+        }
+
+        /// <summary>
+        /// Bilinearly samples a frame buffer at a (pixel area) coordinate, matching Direct2D's linear interpolation of a drawn bitmap.
+        /// Coordinates outside the frame leave the destination pixel untouched.
+        /// </summary>
+        void SampleBilinear(const BgraFrameBuffer& sourceFrame, double x, double y, uint8_t* destinationPixel)
+        {
+            if (x < 0.0 || y < 0.0 || x >= sourceFrame.Width || y >= sourceFrame.Height)
+            {
+                return;
+            }
+
+            // Convert to pixel center coordinates.
+            x -= 0.5;
+            y -= 0.5;
+
+            const int x0 = static_cast<int>(floor(x));
+            const int y0 = static_cast<int>(floor(y));
+            const double fractionX = x - x0;
+            const double fractionY = y - y0;
+
+            const int sampleX0 = std::clamp(x0, 0, sourceFrame.Width - 1);
+            const int sampleX1 = std::clamp(x0 + 1, 0, sourceFrame.Width - 1);
+            const int sampleY0 = std::clamp(y0, 0, sourceFrame.Height - 1);
+            const int sampleY1 = std::clamp(y0 + 1, 0, sourceFrame.Height - 1);
+
+            const uint8_t* row0 = sourceFrame.Pixels.data() + (static_cast<size_t>(sampleY0) * sourceFrame.Stride);
+            const uint8_t* row1 = sourceFrame.Pixels.data() + (static_cast<size_t>(sampleY1) * sourceFrame.Stride);
+            const uint8_t* topLeft = row0 + (sampleX0 * BGRA_BYTES_PER_PIXEL);
+            const uint8_t* topRight = row0 + (sampleX1 * BGRA_BYTES_PER_PIXEL);
+            const uint8_t* bottomLeft = row1 + (sampleX0 * BGRA_BYTES_PER_PIXEL);
+            const uint8_t* bottomRight = row1 + (sampleX1 * BGRA_BYTES_PER_PIXEL);
+
+            for (int channel = 0; channel < BGRA_BYTES_PER_PIXEL; ++channel)
+            {
+                const double top = topLeft[channel] + ((topRight[channel] - topLeft[channel]) * fractionX);
+                const double bottom = bottomLeft[channel] + ((bottomRight[channel] - bottomLeft[channel]) * fractionX);
+                destinationPixel[channel] = static_cast<uint8_t>(lround(top + ((bottom - top) * fractionY)));
+            }
+        }
+
+        /// <summary>
+        /// Draws a cropped, scaled and optionally rotated region of a source frame into a rectangular region of a render target
+        /// by inverse mapping each destination pixel through the rotation, scale and translation used by the Direct2D renderer.
+        /// </summary>
+        void DrawTransformedCropSegment(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget, const CropSegmentFrameDataItem& cropItem,
+                                        const double scaleFactor, const double translationX, const double translationY,
+                                        const double destinationOffsetX, const double destinationOffsetY,
+                                        const LtwhRectD& destinationClip)
+        {
+            const bool isRotated = abs(cropItem.Angle) != 0.0; // abs since the angle can be -0.0 for zero rotation angle
+
+            // The Direct2D renderer rotates by the negated crop angle around the crop center, so the inverse rotates by the crop angle.
+            const double inverseRotationRadians = (cropItem.Angle * PI) / 180.0;
+            const double inverseCos = cos(inverseRotationRadians);
+            const double inverseSin = sin(inverseRotationRadians);
+            const double rotationCenterX = cropItem.Left + (cropItem.Width / 2.0);
+            const double rotationCenterY = cropItem.Top + (cropItem.Height / 2.0);
+
+            const int firstRow = std::clamp(static_cast<int>(ceil(destinationClip.Top - 0.5)), 0, renderTarget.Height);
+            const int endRow = std::clamp(static_cast<int>(ceil(destinationClip.Top + destinationClip.Height - 0.5)), 0, renderTarget.Height);
+            const int firstColumn = std::clamp(static_cast<int>(ceil(destinationClip.Left - 0.5)), 0, renderTarget.Width);
+            const int endColumn = std::clamp(static_cast<int>(ceil(destinationClip.Left + destinationClip.Width - 0.5)), 0, renderTarget.Width);
+
+            for (int y = firstRow; y < endRow; ++y)
+            {
+                uint8_t* destinationRow = renderTarget.Pixels.data() + (static_cast<size_t>(y) * renderTarget.Stride);
+                const double localY = ((y + 0.5) - destinationOffsetY - translationY) / scaleFactor;
+
+                for (int x = firstColumn; x < endColumn; ++x)
+                {
+                    const double localX = ((x + 0.5) - destinationOffsetX - translationX) / scaleFactor;
+
+                    double sourceX = localX;
+                    double sourceY = localY;
+                    if (isRotated)
+                    {
+                        const double relativeX = localX - rotationCenterX;
+                        const double relativeY = localY - rotationCenterY;
+                        sourceX = rotationCenterX + (relativeX * inverseCos) - (relativeY * inverseSin);
+                        sourceY = rotationCenterY + (relativeX * inverseSin) + (relativeY * inverseCos);
+                    }
+
+                    SampleBilinear(sourceFrame, sourceX, sourceY, destinationRow + (x * BGRA_BYTES_PER_PIXEL));
+                }
+            }
+        }
+    }
+
+    CpuPreviewRenderer::CpuPreviewRenderer(VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingPreviewItems, VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingPreviewItems)
+        : _maskingPreviewItemsRef(maskingPreviewItems), _croppingPreviewItemsRef(croppingPreviewItems),
+        _hasMaskingCoverage(false), _previewSurfaceSizeOptions{}
+    {
+    }
+
+    CpuPreviewRenderer::~CpuPreviewRenderer()
+    {
+        // Standard library containers automatically free resources via their destructors.
+    }
+
+    void CpuPreviewRenderer::InitializeSourceFrameBuffer(const int width, const int height)
+    {
+        AllocateFrameBuffer(_sourceFrameBuffer, width, height);
+        AllocateFrameBuffer(_sourceFrameRenderTarget, width, height);
+
+        _maskingCoverage.assign(static_cast<size_t>(width) * height, 0);
+        _hasMaskingCoverage = false;
+    }
+
+    void CpuPreviewRenderer::InitializeProxySourceFrameBuffer(const int width, const int height)
+    {
+        AllocateFrameBuffer(_proxySourceFrameBuffer, width, height);
+    }
+
+    void CpuPreviewRenderer::UpscaleProxySourceFrameBuffer()
+    {
+        int scaleResult = libyuv::ARGBScale(_proxySourceFrameBuffer.Pixels.data(),
+                                            _proxySourceFrameBuffer.Stride,
+                                            _proxySourceFrameBuffer.Width,
+                                            _proxySourceFrameBuffer.Height,
+                                            _sourceFrameBuffer.Pixels.data(),
+                                            _sourceFrameBuffer.Stride,
+                                            _sourceFrameBuffer.Width,
+                                            _sourceFrameBuffer.Height,
+                                            libyuv::kFilterBilinear);
+        if (scaleResult == -1)
+        {
+            throw std::runtime_error("Failed to scale the proxy source frame buffer to the source frame buffer size.");
+        }
+    }
+
+    void CpuPreviewRenderer::InitializePreviewRenderSurface(const VideoSizeInfo& sizeOptions)
+    {
+        _previewSurfaceSizeOptions = sizeOptions;
+
+        AllocateFrameBuffer(_previewFrameRenderTarget, sizeOptions.Width, sizeOptions.Height);
+    }
+
+    void CpuPreviewRenderer::UpdateMaskingCoverage()
+    {
+        _hasMaskingCoverage = false;
+        if (_maskingCoverage.empty())
+        {
+            return;
+        }
+
+        fill(_maskingCoverage.begin(), _maskingCoverage.end(), static_cast<uint8_t>(0));
+
+        const int width = _sourceFrameBuffer.Width;
+        const int height = _sourceFrameBuffer.Height;
+
+        for (const auto& maskingTrackPreviewItemPair : _maskingPreviewItemsRef)
+        {
+            const MaskSegmentFrameDataItemBase* maskingFrameDataItem = maskingTrackPreviewItemPair.second.first.get();
+
+            if (const auto* polygonDataItem = dynamic_cast<const MaskPolygonSegmentFrameDataItem*>(maskingFrameDataItem))
+            {
+                assert(polygonDataItem->Points.size() > 1);
+                RasterizePolygonCoverage(polygonDataItem->Points, _maskingCoverage.data(), width, height);
+            }
+            else if (const auto* rectangleDataItem = dynamic_cast<const MaskRectangleSegmentFrameDataItem*>(maskingFrameDataItem))
+            {
+                RasterizeRectangleCoverage(*rectangleDataItem, _maskingCoverage.data(), width, height);
+            }
+            else if (const auto* ellipseDataItem = dynamic_cast<const MaskEllipseSegmentFrameDataItem*>(maskingFrameDataItem))
+            {
+                RasterizeEllipseCoverage(*ellipseDataItem, _maskingCoverage.data(), width, height);
+            }
+            else
+            {
+                throw std::invalid_argument("Unsupported masking segment frame data type.");
+            }
+
+            _hasMaskingCoverage = true;
+        }
+    }
+
+    void CpuPreviewRenderer::RenderSourceFrameSurface(const bool applyMaskingPreview)
+    {
+        if (applyMaskingPreview && _hasMaskingCoverage)
+        {
+            RenderBlurMask(_sourceFrameBuffer, _sourceFrameRenderTarget);
+        }
+        else
+        {
+            _sourceFrameRenderTarget.Pixels = _sourceFrameBuffer.Pixels;
+        }
+    }
+
+    void CpuPreviewRenderer::RenderPreviewFrameSurface(const bool maskingPreviewAppliedToSource)
+    {
+        const bool shouldRenderMaskingPreview = (!maskingPreviewAppliedToSource && _hasMaskingCoverage);
+        const bool shouldRenderCroppingPreview = !_croppingPreviewItemsRef.empty();
+
+        const BgraFrameBuffer* intermediateFrame = &_sourceFrameRenderTarget;
+        if (shouldRenderMaskingPreview)
+        {
+            AllocateFrameBuffer(_intermediateFrameBuffer, _sourceFrameRenderTarget.Width, _sourceFrameRenderTarget.Height);
+            RenderBlurMask(_sourceFrameRenderTarget, _intermediateFrameBuffer);
+
+            intermediateFrame = &_intermediateFrameBuffer;
+        }
+
+        if (shouldRenderCroppingPreview)
+        {
+            RenderCroppedFrame(*intermediateFrame, _previewFrameRenderTarget);
+        }
+        else
+        {
+            RenderLetterboxedFrame(*intermediateFrame, _previewFrameRenderTarget);
+        }
+    }
+
+    void CpuPreviewRenderer::RenderFrameSurfaces(const bool applyMaskingPreviewToSource)
+    {
+        RenderSourceFrameSurface(applyMaskingPreviewToSource);
+
+        RenderPreviewFrameSurface(applyMaskingPreviewToSource);
+    }
+
+    void CpuPreviewRenderer::ReleaseAndResetResources()
+    {
+        _hasMaskingCoverage = false;
+        _maskingCoverage.clear();
+        _blurCumulativeSumBuffer.clear();
+
+        _sourceFrameBuffer = BgraFrameBuffer();
+        _proxySourceFrameBuffer = BgraFrameBuffer();
+        _sourceFrameRenderTarget = BgraFrameBuffer();
+        _previewFrameRenderTarget = BgraFrameBuffer();
+        _intermediateFrameBuffer = BgraFrameBuffer();
+        _blurredFrameBuffer = BgraFrameBuffer();
+        _blurScratchFrameBuffer = BgraFrameBuffer();
+
+        _previewSurfaceSizeOptions = VideoSizeInfo{};
+    }
+
+    void CpuPreviewRenderer::RenderBlurMask(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget)
+    {
+        const int width = sourceFrame.Width;
+        const int height = sourceFrame.Height;
+
+        AllocateFrameBuffer(_blurredFrameBuffer, width, height);
+        AllocateFrameBuffer(_blurScratchFrameBuffer, width, height);
+
+        // libyuv::ARGBBlur uses a rolling window of (radius * 2 + 2) rows of cumulative sums and clamps the radius to the frame size.
+        const int blurRadius = min({ BLUR_BOX_RADIUS, height, (width / 2) - 1 });
+        const int cumulativeSumStride = width * BGRA_BYTES_PER_PIXEL;
+        _blurCumulativeSumBuffer.resize(static_cast<size_t>(cumulativeSumStride) * ((BLUR_BOX_RADIUS * 2) + 2));
+
+        if (blurRadius > 0)
+        {
+            const BgraFrameBuffer* passSource = &sourceFrame;
+            for (int pass = 0; pass < BLUR_BOX_PASS_COUNT; ++pass)
+            {
+                // Ping-pong between the scratch and blurred buffers, finishing in the blurred buffer.
+                BgraFrameBuffer& passTarget = ((BLUR_BOX_PASS_COUNT - pass) % 2 == 1) ? _blurredFrameBuffer : _blurScratchFrameBuffer;
+
+                int blurResult = libyuv::ARGBBlur(passSource->Pixels.data(), passSource->Stride,
+                                                  passTarget.Pixels.data(), passTarget.Stride,
+                                                  _blurCumulativeSumBuffer.data(), cumulativeSumStride,
+                                                  width, height, blurRadius);
+                if (blurResult != 0)
+                {
+                    throw std::runtime_error("Failed to blur the frame buffer.");
+                }
+
+                passSource = &passTarget;
+            }
+        }
+        else
+        {
+            _blurredFrameBuffer.Pixels = sourceFrame.Pixels;
+        }
+
+        // Layer 0 (source frame), layer 1 (blur masked by the coverage)
+        if (&renderTarget != &sourceFrame)
+        {
+            renderTarget.Pixels = sourceFrame.Pixels;
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            const uint8_t* coverageRow = _maskingCoverage.data() + (static_cast<size_t>(y) * width);
+            const uint8_t* blurredRow = _blurredFrameBuffer.Pixels.data() + (static_cast<size_t>(y) * _blurredFrameBuffer.Stride);
+            uint8_t* targetRow = renderTarget.Pixels.data() + (static_cast<size_t>(y) * renderTarget.Stride);
+
+            for (int x = 0; x < width; ++x)
+            {
+                if (coverageRow[x] != 0)
+                {
+                    memcpy(targetRow + (x * BGRA_BYTES_PER_PIXEL), blurredRow + (x * BGRA_BYTES_PER_PIXEL), BGRA_BYTES_PER_PIXEL);
+                }
+            }
+        }
+    }
+
+    void CpuPreviewRenderer::RenderCroppedFrame(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget)
+    {
+        ClearFrameBuffer(renderTarget);
+
+        const SizeD renderTargetSize(renderTarget.Width, renderTarget.Height);
+        const LtwhRectD renderBoundingBox = GetCroppingSegmentFramesRenderBounds(renderTargetSize);
+
+        if (_croppingPreviewItemsRef.size() > 1)
+        {
+            // Multi-segment frame crop - each segment is rendered top-left relative to its composite drawing position.
+            double compositeDrawingPosX = renderBoundingBox.Left;
+            for (const auto& croppingTrackDataItemPair : _croppingPreviewItemsRef)
+            {
+                const CropSegmentFrameDataItem& cropItem = croppingTrackDataItemPair.second;
+
+                const double scaleFactor = renderBoundingBox.Height / cropItem.Height;
+                const double scaledWidth = (cropItem.Width * renderBoundingBox.Height) / cropItem.Height;
+
+                DrawTransformedCropSegment(sourceFrame, renderTarget, cropItem,
+                                           scaleFactor, -(cropItem.Left * scaleFactor), -(cropItem.Top * scaleFactor),
+                                           compositeDrawingPosX, renderBoundingBox.Top,
+                                           LtwhRectD(compositeDrawingPosX, renderBoundingBox.Top, scaledWidth, renderBoundingBox.Height));
+
+                compositeDrawingPosX += scaledWidth;
+            }
+        }
+        else
+        {
+            // Single-segment frame crop - centered horizontally and vertically and clipped to the render bounds.
+            const CropSegmentFrameDataItem& cropItem = _croppingPreviewItemsRef.begin()->second;
+
+            const double renderOffsetX = (renderTargetSize.Width - renderBoundingBox.Width) / 2.0;
+            const double renderOffsetY = (renderTargetSize.Height - renderBoundingBox.Height) / 2.0;
+            const double scaleFactor = renderBoundingBox.Height / cropItem.Height;
+
+            DrawTransformedCropSegment(sourceFrame, renderTarget, cropItem,
+                                       scaleFactor, -((cropItem.Left * scaleFactor) - renderOffsetX), -((cropItem.Top * scaleFactor) - renderOffsetY),
+                                       0.0, 0.0,
+                                       renderBoundingBox);
+        }
+    }
+
+    void CpuPreviewRenderer::RenderLetterboxedFrame(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget)
+    {
+        if (sourceFrame.Width == renderTarget.Width && sourceFrame.Height == renderTarget.Height)
+        {
+            renderTarget.Pixels = sourceFrame.Pixels;
+            return;
+        }
+
+        ClearFrameBuffer(renderTarget);
+
+        int offsetX = 0;
+        int offsetY = 0;
+        if (_previewSurfaceSizeOptions.SizeMode == VideoSizeMode::Letterbox)
+        {
+            offsetX = (renderTarget.Width - sourceFrame.Width) / 2;
+            offsetY = (renderTarget.Height - sourceFrame.Height) / 2;
+        }
+
+        const int copyWidth = min(sourceFrame.Width, renderTarget.Width - offsetX);
+        const int copyHeight = min(sourceFrame.Height, renderTarget.Height - offsetY);
+        if (offsetX < 0 || offsetY < 0 || copyWidth <= 0 || copyHeight <= 0)
+        {
+            return;
+        }
+
+        libyuv::ARGBCopy(sourceFrame.Pixels.data(), sourceFrame.Stride,
+                         renderTarget.Pixels.data() + (static_cast<size_t>(offsetY) * renderTarget.Stride) + (offsetX * BGRA_BYTES_PER_PIXEL), renderTarget.Stride,
+                         copyWidth, copyHeight);
+    }
+
+    LtwhRectD CpuPreviewRenderer::GetCroppingSegmentFramesRenderBounds(const SizeD& renderTargetSize) const
+    {
+        //
+        // Calculate composite size
+        //
+        SizeD compositeSize{};
+        if (_croppingPreviewItemsRef.size() > 1)
+        {
+            // Multi-segment frame crop - scale items to the max height and combine widths
+            for (const auto& croppingTrackDataItemPair : _croppingPreviewItemsRef)
+            {
+                compositeSize.Height = max(compositeSize.Height, croppingTrackDataItemPair.second.Height);
+            }
+
+            for (const auto& croppingTrackDataItemPair : _croppingPreviewItemsRef)
+            {
+                const CropSegmentFrameDataItem& croppingDataItem = croppingTrackDataItemPair.second;
+                compositeSize.Width += (croppingDataItem.Height != compositeSize.Height)
+                                        ? (croppingDataItem.Width * compositeSize.Height) / croppingDataItem.Height
+                                        : croppingDataItem.Width;
+            }
+        }
+        else
+        {
+            // Single-segment frame crop
+            const CropSegmentFrameDataItem& croppingDataItem = _croppingPreviewItemsRef.begin()->second;
+            compositeSize.Width = croppingDataItem.Width;
+            compositeSize.Height = croppingDataItem.Height;
+        }
+
+        //
+        // Scale composite size for best fit and center
+        //
+        LtwhRectD compositeRenderBounds{};
+
+        const double scaleHeightX = (compositeSize.Width * renderTargetSize.Height) / compositeSize.Height;
+        if (scaleHeightX > renderTargetSize.Width)
+        {
+            // Scale to the target width
+            compositeRenderBounds.Width = renderTargetSize.Width;
+            compositeRenderBounds.Height = (compositeSize.Height * renderTargetSize.Width) / compositeSize.Width;
+            compositeRenderBounds.Top = (renderTargetSize.Height - compositeRenderBounds.Height) / 2.0;
+        }
+        else
+        {
+            // Scale to the target height
+            compositeRenderBounds.Width = scaleHeightX;
+            compositeRenderBounds.Height = renderTargetSize.Height;
+            compositeRenderBounds.Left = (renderTargetSize.Width - compositeRenderBounds.Width) / 2.0;
+        }
+
+        return compositeRenderBounds;
+    }
+
+    void CpuPreviewRenderer::AllocateFrameBuffer(BgraFrameBuffer& frameBuffer, const int width, const int height)
+    {
+        assert(width >= 0 && height >= 0);
+
+        if (frameBuffer.Width == width && frameBuffer.Height == height && !frameBuffer.Pixels.empty())
+        {
+            return;
+        }
+
+        frameBuffer.Width = width;
+        frameBuffer.Height = height;
+        frameBuffer.Stride = width * BGRA_BYTES_PER_PIXEL;
+        frameBuffer.Pixels.assign(static_cast<size_t>(frameBuffer.Stride) * height, 0);
+    }
+
+    void CpuPreviewRenderer::ClearFrameBuffer(BgraFrameBuffer& frameBuffer)
+    {
+        libyuv::ARGBRect(frameBuffer.Pixels.data(), frameBuffer.Stride, 0, 0, frameBuffer.Width, frameBuffer.Height, 0xFF000000);
+    }
+}
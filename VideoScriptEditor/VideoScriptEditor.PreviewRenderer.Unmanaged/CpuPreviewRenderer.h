@@ -0,0 +1,201 @@
+#pragma once
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    /// <summary>
+    /// CPU Preview Renderer.
+    /// Renders source and preview frames into CPU memory <see cref="BgraFrameBuffer"/>s using libyuv and plain C++ kernels,
+    /// approximating the output of the <see cref="D2DPreviewRenderer"/> without requiring Direct3D or Direct2D devices.
+    /// </summary>
+    /// <remarks>
+    /// The masking blur is an approximation of the Direct2D Gaussian blur built from box blur passes,
+    /// so masked areas aren't pixel identical to the <see cref="D2DPreviewRenderer"/>'s output.
+    /// Still Windows only, as the shared masking preview items table carries Direct2D geometry.
+    /// </remarks>
+    class CpuPreviewRenderer
+    {
+    private:
+        /// <summary>
+        /// A reference to a masking preview items <see cref="TrackIndexedTable"/> indexed by masking segment track number.
+        /// Only the masking segment frame data part of each <see cref="std::pair"/> is used for rendering.
+        /// </summary>
+        VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& _maskingPreviewItemsRef;
+
+        /// <summary>
+        /// A reference to a cropping segment preview frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.
+        /// </summary>
+        VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& _croppingPreviewItemsRef;
+
+        // Frame buffers.
+        BgraFrameBuffer _sourceFrameBuffer;
+        BgraFrameBuffer _proxySourceFrameBuffer;
+        BgraFrameBuffer _sourceFrameRenderTarget;
+        BgraFrameBuffer _previewFrameRenderTarget;
+        BgraFrameBuffer _intermediateFrameBuffer;
+        BgraFrameBuffer _blurredFrameBuffer;
+        BgraFrameBuffer _blurScratchFrameBuffer;
+
+        /// <summary>
+        /// Scratch buffer of cumulative sums required by <see cref="libyuv::ARGBBlur"/>.
+        /// </summary>
+        std::vector<int32_t> _blurCumulativeSumBuffer;
+
+        /// <summary>
+        /// A source frame sized coverage mask where non-zero bytes mark pixels inside the combined masking geometry.
+        /// </summary>
+        std::vector<uint8_t> _maskingCoverage;
+
+        /// <summary>
+        /// Whether <see cref="_maskingCoverage"/> contains any masking geometry.
+        /// Analogous to a non-null Direct2D masking geometry group.
+        /// </summary>
+        bool _hasMaskingCoverage;
+
+        VideoSizeInfo _previewSurfaceSizeOptions;
+
+    public:
+        /* Properties */
+
+        /// <summary>
+        /// Gets a reference to the source frame (input) buffer which decoded video frames are copied to prior to rendering.
+        /// </summary>
+        /// <returns>A reference to the source frame (input) <see cref="BgraFrameBuffer"/>.</returns>
+        BgraFrameBuffer& get_SourceFrameBuffer() { return _sourceFrameBuffer; }
+
+        /// <summary>
+        /// Gets a reference to the low resolution proxy source frame (input) buffer which proxy video frames are copied to
+        /// prior to being scaled up into the source frame (input) buffer by <see cref="UpscaleProxySourceFrameBuffer"/>.
+        /// </summary>
+        /// <returns>A reference to the proxy source frame (input) <see cref="BgraFrameBuffer"/>.</returns>
+        BgraFrameBuffer& get_ProxySourceFrameBuffer() { return _proxySourceFrameBuffer; }
+
+        /// <summary>
+        /// Gets a reference to the source frame render target buffer.
+        /// </summary>
+        /// <returns>A const reference to the source frame render target <see cref="BgraFrameBuffer"/>.</returns>
+        const BgraFrameBuffer& get_SourceFrameRenderTarget() const { return _sourceFrameRenderTarget; }
+
+        /// <summary>
+        /// Gets a reference to the preview frame render target buffer.
+        /// </summary>
+        /// <returns>A const reference to the preview frame render target <see cref="BgraFrameBuffer"/>.</returns>
+        const BgraFrameBuffer& get_PreviewFrameRenderTarget() const { return _previewFrameRenderTarget; }
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="CpuPreviewRenderer"/> class.
+        /// </summary>
+        /// <param name="maskingPreviewItems">A reference to a masking preview items <see cref="TrackIndexedTable"/> indexed by masking segment track number.</param>
+        /// <param name="croppingPreviewItems">A reference to a cropping segment frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.</param>
+        CpuPreviewRenderer(VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingPreviewItems, VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingPreviewItems);
+
+        /// <summary>
+        /// Destructor for the <see cref="CpuPreviewRenderer"/> class.
+        /// Standard library containers automatically free resources via their destructors.
+        /// </summary>
+        ~CpuPreviewRenderer();
+
+        /// <summary>
+        /// Allocates the source frame (input) and source frame render target buffers.
+        /// </summary>
+        /// <param name="width">(IN) The frame width in pixels.</param>
+        /// <param name="height">(IN) The frame height in pixels.</param>
+        void InitializeSourceFrameBuffer(const int width, const int height);
+
+        /// <summary>
+        /// Allocates the low resolution proxy source frame (input) buffer.
+        /// </summary>
+        /// <param name="width">(IN) The proxy frame width in pixels.</param>
+        /// <param name="height">(IN) The proxy frame height in pixels.</param>
+        void InitializeProxySourceFrameBuffer(const int width, const int height);
+
+        /// <summary>
+        /// Scales the content of the proxy source frame (input) buffer up into the source frame (input) buffer
+        /// so that it lines up with masking and cropping geometry, which is always in source frame coordinates.
+        /// </summary>
+        void UpscaleProxySourceFrameBuffer();
+
+        /// <summary>
+        /// Allocates the preview frame render target buffer for an output video size.
+        /// </summary>
+        /// <param name="sizeOptions">(IN) A reference to a <see cref="VideoSizeInfo"/> structure containg the width and height to use.</param>
+        void InitializePreviewRenderSurface(const VideoSizeInfo& sizeOptions);
+
+        /// <summary>
+        /// Rasterizes the masking frame data contained in the masking preview items collection into the masking coverage mask.
+        /// Analogous to <see cref="VideoScriptEditor::Unmanaged::D2DRendererBase::UpdateMaskingGeometryGroup"/>.
+        /// </summary>
+        void UpdateMaskingCoverage();
+
+        /// <summary>
+        /// Renders the source frame and optionally a masking preview frame to the source frame render target buffer.
+        /// </summary>
+        /// <param name="applyMaskingPreview">(IN) Whether to apply a masking preview frame to the source frame render. Defaults to false.</param>
+        void RenderSourceFrameSurface(const bool applyMaskingPreview = false);
+
+        /// <summary>
+        /// Renders a preview frame to the preview frame render target buffer
+        /// using the content of the source frame render target buffer as image source.
+        /// </summary>
+        /// <param name="maskingPreviewAppliedToSource">(IN) Whether a masking preview frame has been applied to the source frame render target. Defaults to false.</param>
+        void RenderPreviewFrameSurface(const bool maskingPreviewAppliedToSource = false);
+
+        /// <summary>
+        /// Renders the source frame and preview frame buffers,
+        /// optionally applying a masking preview frame to the source render.
+        /// </summary>
+        /// <param name="applyMaskingPreviewToSource">(IN) Whether to apply a masking preview frame to the source frame render. Defaults to false.</param>
+        void RenderFrameSurfaces(const bool applyMaskingPreviewToSource = false);
+
+        /// <summary>
+        /// Releases all frame buffers so that the renderer is in a reset state.
+        /// </summary>
+        void ReleaseAndResetResources();
+
+    private:
+        /// <summary>
+        /// Renders a blur effect on a frame using the masking coverage mask to define the areas to blur.
+        /// Approximates the Direct2D Gaussian blur via repeated box blur passes.
+        /// </summary>
+        /// <param name="sourceFrame">(IN) The <see cref="BgraFrameBuffer"/> containing the content to draw and blur.</param>
+        /// <param name="renderTarget">(OUT) The <see cref="BgraFrameBuffer"/> target to render to.</param>
+        void RenderBlurMask(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget);
+
+        /// <summary>
+        /// Renders a single or multi-segment crop of a source frame.
+        /// In the case of a multi-segment crop, the segments are scaled to best fit height and drawn horizontally from left to right.
+        /// </summary>
+        /// <param name="sourceFrame">(IN) The source <see cref="BgraFrameBuffer"/> containing the content to crop.</param>
+        /// <param name="renderTarget">(OUT) The <see cref="BgraFrameBuffer"/> target to render to.</param>
+        void RenderCroppedFrame(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget);
+
+        /// <summary>
+        /// Draws a source frame centered within a (larger) render target with black borders, or copies it if the sizes match.
+        /// </summary>
+        /// <param name="sourceFrame">(IN) The source <see cref="BgraFrameBuffer"/> to draw.</param>
+        /// <param name="renderTarget">(OUT) The <see cref="BgraFrameBuffer"/> target to render to.</param>
+        void RenderLetterboxedFrame(const BgraFrameBuffer& sourceFrame, BgraFrameBuffer& renderTarget);
+
+        /// <summary>
+        /// Calculates the scaled bounds for rendering a single or multi-segment crop.
+        /// Mirrors <see cref="VideoScriptEditor::Unmanaged::D2DRendererBase::GetCroppingSegmentFramesRenderBounds"/>.
+        /// </summary>
+        /// <param name="renderTargetSize">(IN) The size of the render target.</param>
+        /// <returns>A <see cref="VideoScriptEditor::Unmanaged::LtwhRectD"/> structure describing the scaled left, top, width and height rectangular bounds.</returns>
+        VideoScriptEditor::Unmanaged::LtwhRectD GetCroppingSegmentFramesRenderBounds(const VideoScriptEditor::Unmanaged::SizeD& renderTargetSize) const;
+
+        /// <summary>
+        /// Allocates a <see cref="BgraFrameBuffer"/> of the specified size if its current size differs.
+        /// </summary>
+        /// <param name="frameBuffer">(IN/OUT) The <see cref="BgraFrameBuffer"/> to allocate.</param>
+        /// <param name="width">(IN) The frame width in pixels.</param>
+        /// <param name="height">(IN) The frame height in pixels.</param>
+        static void AllocateFrameBuffer(BgraFrameBuffer& frameBuffer, const int width, const int height);
+
+        /// <summary>
+        /// Fills a <see cref="BgraFrameBuffer"/> with opaque black.
+        /// </summary>
+        /// <param name="frameBuffer">(IN/OUT) The <see cref="BgraFrameBuffer"/> to fill.</param>
+        static void ClearFrameBuffer(BgraFrameBuffer& frameBuffer);
+    };
+}
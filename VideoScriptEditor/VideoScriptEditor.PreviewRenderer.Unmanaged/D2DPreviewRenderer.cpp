@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "D2DPreviewRenderer.h"
 #include <cassert>
+#include <stdexcept>
+#include <cmath>
 
 namespace VideoScriptEditor::PreviewRenderer::Unmanaged
 {
@@ -8,11 +10,22 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
     using Microsoft::WRL::ComPtr;   // See https://github.com/Microsoft/DirectXTK/wiki/ComPtr
     using namespace std;
 
-    D2DPreviewRenderer::D2DPreviewRenderer(std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingPreviewItems)
-        : VideoScriptEditor::Unmanaged::D2DRendererBase(maskingGeometries, croppingPreviewItems),
+    D2DPreviewRenderer::D2DPreviewRenderer(VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingPreviewItems)
+        : VideoScriptEditor::Unmanaged::D2DRendererBase(maskingGeometries, croppingPreviewItems, true),
         _d3dFeatureLevel(D3D_FEATURE_LEVEL_11_0),
-        _d3dDriverType(D3D_DRIVER_TYPE_UNKNOWN)
+        _d3dDriverType(D3D_DRIVER_TYPE_UNKNOWN),
+        _renderFromProxySourceFrame(false),
+        _sourceFrameNumber(-1),
+        _blurredSourceFrameKey{ -1, false, 0.f },
+        _isMaskingPreviewRenderValid(false),
+        _previewTargetHoldsMaskingRender(false),
+        _sourceFrameTextureFencePending{},
+        _sourceFrameBufferCount(1),
+        _frontSourceFrameBufferIndex(0),
+        _pipelineMode(RenderPipelineMode::LowLatency),
+        _sourceFramePixelFormat(SourceFramePixelFormat::Yuv420Planar)
     {
+        ZeroMemory(&_sourceFrameTextureDesc, sizeof(_sourceFrameTextureDesc));
         ZeroMemory(&_sourceFrameRenderTargetDesc, sizeof(_sourceFrameRenderTargetDesc));
         ZeroMemory(&_previewFrameRenderTargetDesc, sizeof(_previewFrameRenderTargetDesc));
 
@@ -53,26 +66,22 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         );
     }
 
-    void D2DPreviewRenderer::InitializeSourceFrameTexture(const UINT width, const UINT height, const DXGI_FORMAT pixelFormat)
+    void D2DPreviewRenderer::InitializeSourceFrameTexture(const UINT width, const UINT height, const SourceFramePixelFormat pixelFormat)
     {
-        D3D11_TEXTURE2D_DESC sourceFrameTextureDesc{};
-        sourceFrameTextureDesc.Width = width;
-        sourceFrameTextureDesc.Height = height;
-        sourceFrameTextureDesc.MipLevels = sourceFrameTextureDesc.ArraySize = 1;
-        sourceFrameTextureDesc.Format = pixelFormat;
-        sourceFrameTextureDesc.SampleDesc.Count = 1;
-        sourceFrameTextureDesc.Usage = D3D11_USAGE_DYNAMIC;
-        sourceFrameTextureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        sourceFrameTextureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        sourceFrameTextureDesc.MiscFlags = 0;
+        _sourceFrameTextureDesc.Width = width;
+        _sourceFrameTextureDesc.Height = height;
+        _sourceFramePixelFormat = pixelFormat;
+        _isMaskingPreviewRenderValid = false;
 
-        HR::ThrowIfFailed(
-            _d3d11Device->CreateTexture2D(&sourceFrameTextureDesc, nullptr, _sourceFrameTexture.ReleaseAndGetAddressOf())
-        );
+        // The cached source frame blur is sized to the source frame.
+        _d2dBlurredSourceFrameBitmap.Reset();
+        InvalidateBlurredSourceFrame();
+
+        CreateSourceFrameBuffers();
 
         // Create and initialize the Direct3D source frame render target texture
         // using the same width, height, etc. as the source frame (input) texture by copying and modifying its D3D11_TEXTURE2D_DESC.
-        _sourceFrameRenderTargetDesc = sourceFrameTextureDesc;
+        _sourceFrameRenderTargetDesc = _sourceFrameTextureDesc;
         _sourceFrameRenderTargetDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
         _sourceFrameRenderTargetDesc.Usage = D3D11_USAGE_DEFAULT;
         _sourceFrameRenderTargetDesc.BindFlags |= D3D11_BIND_RENDER_TARGET;
@@ -89,6 +98,26 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         );
     }
 
+    void D2DPreviewRenderer::InitializeProxySourceFrameTexture(const UINT width, const UINT height)
+    {
+        _d2dProxySourceFrameImage.Reset();
+        _renderFromProxySourceFrame = false;
+
+        CreateSourceFramePlaneTextures(width, height, SourceFramePixelFormat::Yuv420Planar, _proxySourceFrameTextures);
+    }
+
+    void D2DPreviewRenderer::SetPipelineMode(const RenderPipelineMode pipelineMode)
+    {
+        if (_pipelineMode == pipelineMode)
+        {
+            return;
+        }
+
+        _pipelineMode = pipelineMode;
+
+        CreateSourceFrameBuffers();
+    }
+
     void D2DPreviewRenderer::GetSourceFrameD3D9RenderSurface(IDirect3DSurface9Ptr& d3d9SourceFrameSurface)
     {
         GetD3D9SurfaceFromD3D11SharedTexture(_sourceFrameRenderTarget, _sourceFrameRenderTargetDesc, d3d9SourceFrameSurface);
@@ -102,6 +131,7 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
     void D2DPreviewRenderer::InitializePreviewRenderSurface(const VideoSizeInfo& sizeOptions)
     {
         _previewSurfaceSizeOptions = sizeOptions;
+        _previewTargetHoldsMaskingRender = false;
 
         _d2dPreviewRenderTargetBitmap.Reset();
         _previewFrameRenderTarget.Reset();
@@ -128,6 +158,11 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
 
     void D2DPreviewRenderer::RenderSourceFrameSurface(const bool applyMaskingPreview, const bool flushDeviceAfterRender)
     {
+        // The source frame render target content is replaced (and the intermediate bitmap may be drawn to below),
+        // so the next masking preview render must be a full one.
+        _isMaskingPreviewRenderValid = false;
+        _previewTargetHoldsMaskingRender = false;
+
         if (applyMaskingPreview && _maskingGeometryGroup != nullptr)
         {
             if (_d2dSourceCompatibleRenderTargetBitmap == nullptr)
@@ -146,19 +181,15 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
             _d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black, 1.0f));
 
             // Draw source frame
-            _d2dContext->DrawImage(
-                _d2dSourceFrameImageSource.Get(),
-                nullptr,                                    // default targetOffset of (0,0)
-                nullptr,                                    // default imageRectangle (entire image)
-                D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
-                D2D1_COMPOSITE_MODE_SOURCE_ATOP
-            );
+            DrawSourceFrameImage();
 
             HR::ThrowIfFailed(
                 _d2dContext->EndDraw()
             );
 
-            RenderBlurMask(_d2dSourceCompatibleRenderTargetBitmap.Get(), _d2dSourceRenderTargetBitmap.Get());
+            ID2D1Bitmap1* blurredSourceFrameBitmap = GetBlurredSourceFrameBitmap(_d2dSourceCompatibleRenderTargetBitmap.Get());
+            RenderBlurMask(_d2dSourceCompatibleRenderTargetBitmap.Get(), _d2dSourceRenderTargetBitmap.Get(), nullptr, blurredSourceFrameBitmap);
+            ResetMaskingDirtyRect();
         }
         else
         {
@@ -169,23 +200,21 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
             // Fill bitmap with a black background.
             _d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black, 1.0f));
 
-            if (_d2dSourceFrameImageSource != nullptr)
-            {
-                // Draw source frame
-                _d2dContext->DrawImage(
-                    _d2dSourceFrameImageSource.Get(),
-                    nullptr,                                    // default targetOffset of (0,0)
-                    nullptr,                                    // default imageRectangle (entire image)
-                    D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
-                    D2D1_COMPOSITE_MODE_SOURCE_ATOP
-                );
-            }
+            // Draw source frame
+            DrawSourceFrameImage();
 
             HR::ThrowIfFailed(
                 _d2dContext->EndDraw()
             );
         }
 
+        if (_sourceFrameBufferCount > 1)
+        {
+            // Signal once the GPU has finished reading the front buffer texture, so that it can safely be uploaded to again.
+            _d3d11DeviceContext->End(_sourceFrameTextureFences[_frontSourceFrameBufferIndex].Get());
+            _sourceFrameTextureFencePending[_frontSourceFrameBufferIndex] = true;
+        }
+
         if (flushDeviceAfterRender)
         {
             _d3d11DeviceContext->Flush();
@@ -262,29 +291,69 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
                     HR::ThrowIfFailed(
                         CreateSourceCompatibleRenderTargetBitmap(_d2dSourceRenderTargetBitmap.Get(), _d2dSourceCompatibleRenderTargetBitmap.ReleaseAndGetAddressOf())
                     );
+
+                    _isMaskingPreviewRenderValid = false;
                 }
 
                 intermediateTargetBitmap = _d2dSourceCompatibleRenderTargetBitmap.Get();
 
-                RenderBlurMask(_d2dSourceRenderTargetBitmap.Get(), intermediateTargetBitmap);
+                // When only masking geometry has changed since the last render, only re-blur the area it affects.
+                const bool renderDirtyRectOnly = _isMaskingPreviewRenderValid;
+                ID2D1Bitmap1* blurredSourceFrameBitmap = GetBlurredSourceFrameBitmap(_d2dSourceRenderTargetBitmap.Get());
+                const D2D1_RECT_U redrawRect = RenderBlurMask(_d2dSourceRenderTargetBitmap.Get(), intermediateTargetBitmap, renderDirtyRectOnly ? &_maskingDirtyRect : nullptr, blurredSourceFrameBitmap);
+                ResetMaskingDirtyRect();
+                _isMaskingPreviewRenderValid = true;
+
+                const bool compositeRedrawRectOnly = renderDirtyRectOnly && _previewTargetHoldsMaskingRender;
 
                 // Prepare render target for Masking (and possibly Cropping also)
                 _d2dContext->SetTarget(_d2dPreviewRenderTargetBitmap.Get());
 
                 if (!shouldRenderCroppingPreview)
                 {
-                    if (_previewSurfaceSizeOptions.SizeMode == VideoSizeMode::None)
+                    if (compositeRedrawRectOnly && (redrawRect.left >= redrawRect.right || redrawRect.top >= redrawRect.bottom))
                     {
-                        HR::ThrowIfFailed(
-                            CopyD2DBitmap(intermediateTargetBitmap, _d2dPreviewRenderTargetBitmap.Get())
-                        );
+                        // Nothing changed, so the preview render target is already up to date.
+                    }
+                    else if (_previewSurfaceSizeOptions.SizeMode == VideoSizeMode::None)
+                    {
+                        if (compositeRedrawRectOnly)
+                        {
+                            const D2D1_POINT_2U copyDestPoint = D2D1::Point2U(redrawRect.left, redrawRect.top);
+                            HR::ThrowIfFailed(
+                                _d2dPreviewRenderTargetBitmap->CopyFromBitmap(&copyDestPoint, intermediateTargetBitmap, &redrawRect)
+                            );
+                        }
+                        else
+                        {
+                            HR::ThrowIfFailed(
+                                CopyD2DBitmap(intermediateTargetBitmap, _d2dPreviewRenderTargetBitmap.Get())
+                            );
+                        }
                     }
                     else
                     {
                         // Render to preview texture
 
                         _d2dContext->BeginDraw();
-                        _d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black, 1.0f));
+
+                        if (compositeRedrawRectOnly)
+                        {
+                            // Keep the existing letterbox and unchanged content - clip to the redrawn area, rounded out to whole pixels.
+                            _d2dContext->PushAxisAlignedClip(
+                                D2D1::RectF(
+                                    floor(pvwRenderTargetOffset.x + redrawRect.left),
+                                    floor(pvwRenderTargetOffset.y + redrawRect.top),
+                                    ceil(pvwRenderTargetOffset.x + redrawRect.right),
+                                    ceil(pvwRenderTargetOffset.y + redrawRect.bottom)
+                                ),
+                                D2D1_ANTIALIAS_MODE_ALIASED
+                            );
+                        }
+                        else
+                        {
+                            _d2dContext->Clear(D2D1::ColorF(D2D1::ColorF::Black, 1.0f));
+                        }
 
                         D2D1_RECT_F destRect = D2D1::RectF(
                             pvwRenderTargetOffset.x,
@@ -298,6 +367,11 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
                             &destRect
                         );
 
+                        if (compositeRedrawRectOnly)
+                        {
+                            _d2dContext->PopAxisAlignedClip();
+                        }
+
                         HR::ThrowIfFailed(
                             _d2dContext->EndDraw()
                         );
@@ -318,6 +392,8 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
             }
         }
 
+        _previewTargetHoldsMaskingRender = shouldRenderMaskingPreview && !shouldRenderCroppingPreview;
+
         if (flushDeviceAfterRender)
         {
             _d3d11DeviceContext->Flush();
@@ -336,48 +412,123 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         _d3d11DeviceContext->Flush();
     }
 
-    HRESULT D2DPreviewRenderer::MapSourceFrameTextureForWriting(D3D11_MAPPED_SUBRESOURCE& mappedSourceFrameTexture)
+    void D2DPreviewRenderer::ReadRenderTargetPixels(const bool readPreviewFrame, BgraFrameBuffer& frameBuffer)
+    {
+        ID2D1Bitmap1* renderTargetBitmap = readPreviewFrame ? _d2dPreviewRenderTargetBitmap.Get() : _d2dSourceRenderTargetBitmap.Get();
+        assert(renderTargetBitmap != nullptr);
+
+        const D2D1_SIZE_U pixelSize = renderTargetBitmap->GetPixelSize();
+
+        // Render target bitmaps can't be mapped, so copy to a CPU readable bitmap first
+        ComPtr<ID2D1Bitmap1> readbackBitmap;
+        HR::ThrowIfFailed(
+            _d2dContext->CreateBitmap(pixelSize,
+                                      nullptr,
+                                      0,
+                                      D2D1::BitmapProperties1(
+                                          D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+                                          renderTargetBitmap->GetPixelFormat()
+                                      ),
+                                      readbackBitmap.GetAddressOf())
+        );
+
+        HR::ThrowIfFailed(
+            CopyD2DBitmap(renderTargetBitmap, readbackBitmap.Get())
+        );
+
+        D2D1_MAPPED_RECT mappedRect;
+        HR::ThrowIfFailed(
+            readbackBitmap->Map(D2D1_MAP_OPTIONS_READ, &mappedRect)
+        );
+
+        frameBuffer.Width = static_cast<int>(pixelSize.width);
+        frameBuffer.Height = static_cast<int>(pixelSize.height);
+        frameBuffer.Stride = frameBuffer.Width * 4;
+        frameBuffer.Pixels.resize(static_cast<size_t>(frameBuffer.Stride) * frameBuffer.Height);
+
+        for (int y = 0; y < frameBuffer.Height; ++y)
+        {
+            memcpy(frameBuffer.Pixels.data() + (static_cast<size_t>(y) * frameBuffer.Stride), mappedRect.bits + (static_cast<size_t>(y) * mappedRect.pitch), frameBuffer.Stride);
+        }
+
+        HR::ThrowIfFailed(
+            readbackBitmap->Unmap()
+        );
+    }
+
+    HRESULT D2DPreviewRenderer::MapSourceFrameTextureForWriting(const UINT planeIndex, D3D11_MAPPED_SUBRESOURCE& mappedSourceFrameTexture)
     {
+        assert(planeIndex < get_SourceFramePlaneCount());
+
+        const UINT backBufferIndex = GetBackSourceFrameBufferIndex();
+
+        // A single source texture relies on D3D11_MAP_WRITE_DISCARD renaming instead of fences.
+        if (_sourceFrameBufferCount > 1)
+        {
+            WaitForSourceFrameTextureFence(backBufferIndex);
+        }
+
         // Disable GPU access to the source texture data.
-        return _d3d11DeviceContext->Map(_sourceFrameTexture.Get(),
+        return _d3d11DeviceContext->Map(_sourceFrameTextures[backBufferIndex][planeIndex].Get(),
                                         0,                          // Subresource index
                                         D3D11_MAP_WRITE_DISCARD,
                                         0,                          // Default MapFlags
                                         &mappedSourceFrameTexture);
     }
 
-    void D2DPreviewRenderer::UnmapSourceFrameTexture()
+    void D2DPreviewRenderer::UnmapSourceFrameTexture(const UINT planeIndex)
     {
         // Reenable GPU access to the source texture data.
-        _d3d11DeviceContext->Unmap(_sourceFrameTexture.Get(),
+        _d3d11DeviceContext->Unmap(_sourceFrameTextures[GetBackSourceFrameBufferIndex()][planeIndex].Get(),
+                                   0);                          // Subresource index
+    }
+
+    void D2DPreviewRenderer::SwapSourceFrameBuffers()
+    {
+        _frontSourceFrameBufferIndex = GetBackSourceFrameBufferIndex();
+    }
+
+    HRESULT D2DPreviewRenderer::MapProxySourceFrameTextureForWriting(const UINT planeIndex, D3D11_MAPPED_SUBRESOURCE& mappedProxySourceFrameTexture)
+    {
+        assert(planeIndex < MaxSourceFramePlaneCount);
+
+        // Disable GPU access to the proxy source texture data.
+        return _d3d11DeviceContext->Map(_proxySourceFrameTextures[planeIndex].Get(),
+                                        0,                          // Subresource index
+                                        D3D11_MAP_WRITE_DISCARD,
+                                        0,                          // Default MapFlags
+                                        &mappedProxySourceFrameTexture);
+    }
+
+    void D2DPreviewRenderer::UnmapProxySourceFrameTexture(const UINT planeIndex)
+    {
+        // Reenable GPU access to the proxy source texture data.
+        _d3d11DeviceContext->Unmap(_proxySourceFrameTextures[planeIndex].Get(),
                                    0);                          // Subresource index
     }
 
     void D2DPreviewRenderer::CheckD2DSourceFrameImageSource()
     {
-        if (_d2dSourceFrameImageSource != nullptr)
+        const UINT backBufferIndex = GetBackSourceFrameBufferIndex();
+        if (_d2dSourceFrameImages[backBufferIndex] != nullptr)
         {
-            // When not null and bound to a surface, ID2D1ImageSource content is automatically updated
+            // When not null and bound to a surface, ID2D1ImageSource and ID2D1Bitmap1 content is automatically updated
             // so all's good...
             return;
         }
 
-        // Get the DXGI surface to bind to the newly created ID2D1ImageSource
-        ComPtr<IDXGISurface> surfaceForD2DImageSource;
-        HR::ThrowIfFailed(
-            _sourceFrameTexture.As(&surfaceForD2DImageSource)
-        );
+        CreateD2DImageFromTextures(_sourceFrameTextures[backBufferIndex], _sourceFramePixelFormat, _d2dSourceFrameImages[backBufferIndex]);
+    }
 
-        // Create the ID2D1ImageSource bound to the DXGI surface
-        HR::ThrowIfFailed(
-            _d2dContext->CreateImageSourceFromDxgi(
-                surfaceForD2DImageSource.GetAddressOf(),
-                1,                                              // surfaceCount
-                DXGI_COLOR_SPACE_YCBCR_FULL_G22_NONE_P709_X601, // colorSpace
-                D2D1_IMAGE_SOURCE_FROM_DXGI_OPTIONS_NONE,       // options
-                _d2dSourceFrameImageSource.ReleaseAndGetAddressOf()
-            )
-        );
+    void D2DPreviewRenderer::CheckD2DProxySourceFrameImageSource()
+    {
+        if (_d2dProxySourceFrameImage != nullptr)
+        {
+            // When not null and bound to a surface, ID2D1ImageSource content is automatically updated
+            return;
+        }
+
+        CreateD2DImageFromTextures(_proxySourceFrameTextures, SourceFramePixelFormat::Yuv420Planar, _d2dProxySourceFrameImage);
     }
 
     void D2DPreviewRenderer::ReleaseAndResetResources()
@@ -391,9 +542,16 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         // Reset Direct2D resources
         _gaussianBlurEffect->SetInput(0, nullptr);
         _d2dSourceCompatibleRenderTargetBitmap.Reset();
+        _d2dBlurredSourceFrameBitmap.Reset();
+        InvalidateBlurredSourceFrame();
         _d2dPreviewRenderTargetBitmap.Reset();
         _d2dSourceRenderTargetBitmap.Reset();
-        _d2dSourceFrameImageSource.Reset();
+        _d2dProxySourceFrameImage.Reset();
+        _renderFromProxySourceFrame = false;
+        _sourceFrameNumber = -1;
+        _isMaskingPreviewRenderValid = false;
+        _previewTargetHoldsMaskingRender = false;
+        ResetMaskingDirtyRect();
 
         // Reset Direct3D resources
         _previewFrameRenderTarget.Reset();
@@ -401,7 +559,14 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         ZeroMemory(&_previewSurfaceSizeOptions, sizeof(_previewSurfaceSizeOptions));
         _sourceFrameRenderTarget.Reset();
         ZeroMemory(&_sourceFrameRenderTargetDesc, sizeof(_sourceFrameRenderTargetDesc));
-        _sourceFrameTexture.Reset();
+        for (auto& proxySourceFrameTexture : _proxySourceFrameTextures)
+        {
+            proxySourceFrameTexture.Reset();
+        }
+
+        // Release the source frame (input) textures and their image sources and fences, keeping the pipeline mode.
+        ZeroMemory(&_sourceFrameTextureDesc, sizeof(_sourceFrameTextureDesc));
+        CreateSourceFrameBuffers();
     }
 
     void D2DPreviewRenderer::CreateDeviceResources()
@@ -491,6 +656,226 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         );
     }
 
+    void D2DPreviewRenderer::CreateSourceFrameBuffers()
+    {
+        for (UINT bufferIndex = 0; bufferIndex < MaxSourceFrameBufferCount; ++bufferIndex)
+        {
+            _d2dSourceFrameImages[bufferIndex].Reset();
+            for (auto& sourceFramePlaneTexture : _sourceFrameTextures[bufferIndex])
+            {
+                sourceFramePlaneTexture.Reset();
+            }
+
+            _sourceFrameTextureFences[bufferIndex].Reset();
+            _sourceFrameTextureFencePending[bufferIndex] = false;
+        }
+
+        _sourceFrameBufferCount = (_pipelineMode == RenderPipelineMode::HighThroughput) ? MaxSourceFrameBufferCount : 1;
+        _frontSourceFrameBufferIndex = 0;
+
+        if (_sourceFrameTextureDesc.Width == 0 || _sourceFrameTextureDesc.Height == 0)
+        {
+            // Source frame size not yet initialized.
+            return;
+        }
+
+        D3D11_QUERY_DESC fenceDesc{};
+        fenceDesc.Query = D3D11_QUERY_EVENT;
+
+        for (UINT bufferIndex = 0; bufferIndex < _sourceFrameBufferCount; ++bufferIndex)
+        {
+            _sourceFrameTextureDesc = CreateSourceFramePlaneTextures(_sourceFrameTextureDesc.Width, _sourceFrameTextureDesc.Height, _sourceFramePixelFormat, _sourceFrameTextures[bufferIndex]);
+
+            HR::ThrowIfFailed(
+                _d3d11Device->CreateQuery(&fenceDesc, _sourceFrameTextureFences[bufferIndex].ReleaseAndGetAddressOf())
+            );
+        }
+    }
+
+    void D2DPreviewRenderer::WaitForSourceFrameTextureFence(const UINT bufferIndex)
+    {
+        if (!_sourceFrameTextureFencePending[bufferIndex])
+        {
+            return;
+        }
+
+        // Without D3D11_ASYNC_GETDATA_DONOTFLUSH, GetData flushes pending commands so the fence is guaranteed to be reached.
+        BOOL fenceSignalled = FALSE;
+        HRESULT hr;
+        while ((hr = _d3d11DeviceContext->GetData(_sourceFrameTextureFences[bufferIndex].Get(), &fenceSignalled, sizeof(fenceSignalled), 0)) == S_FALSE)
+        {
+            SwitchToThread();
+        }
+
+        HR::ThrowIfFailed(hr);
+
+        _sourceFrameTextureFencePending[bufferIndex] = false;
+    }
+
+    D3D11_TEXTURE2D_DESC D2DPreviewRenderer::CreateSourceFramePlaneTextures(const UINT width, const UINT height, const SourceFramePixelFormat pixelFormat, Microsoft::WRL::ComPtr<ID3D11Texture2D>(&planeTextures)[MaxSourceFramePlaneCount])
+    {
+        switch (pixelFormat)
+        {
+        case SourceFramePixelFormat::Yuv420Planar:
+        {
+            // Separate full size Y and half size U and V planes, sampled together by the ID2D1ImageSource.
+            const D3D11_TEXTURE2D_DESC lumaPlaneTextureDesc = CreateDynamicSourceFrameTexture(width, height, DXGI_FORMAT_R8_UNORM, planeTextures[0]);
+            CreateDynamicSourceFrameTexture(width / 2, height / 2, DXGI_FORMAT_R8_UNORM, planeTextures[1]);
+            CreateDynamicSourceFrameTexture(width / 2, height / 2, DXGI_FORMAT_R8_UNORM, planeTextures[2]);
+            return lumaPlaneTextureDesc;
+        }
+        case SourceFramePixelFormat::Yuy2:
+            return CreateDynamicSourceFrameTexture(width, height, DXGI_FORMAT_YUY2, planeTextures[0]);
+        case SourceFramePixelFormat::Bgra32:
+            return CreateDynamicSourceFrameTexture(width, height, DXGI_FORMAT_B8G8R8A8_UNORM, planeTextures[0]);
+        default:
+            throw std::invalid_argument("Unsupported source frame pixel format.");
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC D2DPreviewRenderer::CreateDynamicSourceFrameTexture(const UINT width, const UINT height, const DXGI_FORMAT pixelFormat, Microsoft::WRL::ComPtr<ID3D11Texture2D>& d3dTexture)
+    {
+        D3D11_TEXTURE2D_DESC textureDesc{};
+        textureDesc.Width = width;
+        textureDesc.Height = height;
+        textureDesc.MipLevels = textureDesc.ArraySize = 1;
+        textureDesc.Format = pixelFormat;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.Usage = D3D11_USAGE_DYNAMIC;
+        textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        textureDesc.MiscFlags = 0;
+
+        HR::ThrowIfFailed(
+            _d3d11Device->CreateTexture2D(&textureDesc, nullptr, d3dTexture.ReleaseAndGetAddressOf())
+        );
+
+        return textureDesc;
+    }
+
+    void D2DPreviewRenderer::CreateD2DImageFromTextures(const Microsoft::WRL::ComPtr<ID3D11Texture2D>(&planeTextures)[MaxSourceFramePlaneCount], const SourceFramePixelFormat pixelFormat, Microsoft::WRL::ComPtr<ID2D1Image>& d2dImage)
+    {
+        // Get the DXGI surfaces to bind to the newly created image
+        const UINT planeCount = GetSourceFramePlaneCount(pixelFormat);
+        ComPtr<IDXGISurface> planeSurfaces[MaxSourceFramePlaneCount];
+        IDXGISurface* planeSurfacePtrs[MaxSourceFramePlaneCount]{};
+        for (UINT planeIndex = 0; planeIndex < planeCount; ++planeIndex)
+        {
+            HR::ThrowIfFailed(
+                planeTextures[planeIndex].As(&planeSurfaces[planeIndex])
+            );
+
+            planeSurfacePtrs[planeIndex] = planeSurfaces[planeIndex].Get();
+        }
+
+        if (pixelFormat == SourceFramePixelFormat::Bgra32)
+        {
+            // Already RGB, so bind a bitmap directly to the DXGI surface. AviSynth RGB32 alpha is typically unused.
+            D2D1_BITMAP_PROPERTIES1 bitmapProperties =
+                D2D1::BitmapProperties1(
+                    D2D1_BITMAP_OPTIONS_NONE,
+                    D2D1::PixelFormat(
+                        DXGI_FORMAT_B8G8R8A8_UNORM,
+                        D2D1_ALPHA_MODE_IGNORE
+                    )
+                );
+
+            ComPtr<ID2D1Bitmap1> d2dBitmap;
+            HR::ThrowIfFailed(
+                _d2dContext->CreateBitmapFromDxgiSurface(planeSurfacePtrs[0], &bitmapProperties, d2dBitmap.GetAddressOf())
+            );
+
+            HR::ThrowIfFailed(
+                d2dBitmap.As(&d2dImage)
+            );
+
+            return;
+        }
+
+        // Create the ID2D1ImageSource bound to the DXGI surfaces.
+        // Three R8 surfaces are treated as Y, Cb and Cr planes, with chroma subsampling inferred from the surface sizes.
+        ComPtr<ID2D1ImageSource> d2dImageSource;
+        HR::ThrowIfFailed(
+            _d2dContext->CreateImageSourceFromDxgi(
+                planeSurfacePtrs,
+                planeCount,                                     // surfaceCount
+                DXGI_COLOR_SPACE_YCBCR_FULL_G22_NONE_P709_X601, // colorSpace
+                D2D1_IMAGE_SOURCE_FROM_DXGI_OPTIONS_NONE,       // options
+                d2dImageSource.GetAddressOf()
+            )
+        );
+
+        HR::ThrowIfFailed(
+            d2dImageSource.As(&d2dImage)
+        );
+    }
+
+    ID2D1Bitmap1* D2DPreviewRenderer::GetBlurredSourceFrameBitmap(ID2D1Bitmap1* sourceFrameBitmap)
+    {
+        const BlurredSourceFrameKey sourceFrameKey{
+            _sourceFrameNumber,
+            _renderFromProxySourceFrame && _d2dProxySourceFrameImage != nullptr,
+            GetBlurStandardDeviation()
+        };
+
+        if (_d2dBlurredSourceFrameBitmap == nullptr)
+        {
+            HR::ThrowIfFailed(
+                CreateSourceCompatibleRenderTargetBitmap(sourceFrameBitmap, _d2dBlurredSourceFrameBitmap.ReleaseAndGetAddressOf())
+            );
+
+            InvalidateBlurredSourceFrame();
+        }
+
+        // An unknown frame number can't be matched, so is always re-blurred.
+        if (sourceFrameKey.FrameNumber < 0 || !(sourceFrameKey == _blurredSourceFrameKey))
+        {
+            RenderBlurredFrame(sourceFrameBitmap, _d2dBlurredSourceFrameBitmap.Get());
+            _blurredSourceFrameKey = sourceFrameKey;
+        }
+
+        return _d2dBlurredSourceFrameBitmap.Get();
+    }
+
+    void D2DPreviewRenderer::DrawSourceFrameImage()
+    {
+        if (_renderFromProxySourceFrame && _d2dProxySourceFrameImage != nullptr)
+        {
+            // Scale the proxy frame up to the source frame size so that it lines up with
+            // masking and cropping geometry, which is always in source frame coordinates.
+            D2D1_SIZE_F srcRenderTargetSize = _d2dSourceRenderTargetBitmap->GetSize();
+            D3D11_TEXTURE2D_DESC proxySourceFrameTextureDesc{};
+            _proxySourceFrameTextures[0]->GetDesc(&proxySourceFrameTextureDesc);
+
+            _d2dContext->SetTransform(
+                D2D1::Matrix3x2F::Scale(
+                    srcRenderTargetSize.width / proxySourceFrameTextureDesc.Width,
+                    srcRenderTargetSize.height / proxySourceFrameTextureDesc.Height
+                )
+            );
+
+            _d2dContext->DrawImage(
+                _d2dProxySourceFrameImage.Get(),
+                nullptr,                                    // default targetOffset of (0,0)
+                nullptr,                                    // default imageRectangle (entire image)
+                D2D1_INTERPOLATION_MODE_LINEAR,
+                D2D1_COMPOSITE_MODE_SOURCE_ATOP
+            );
+
+            _d2dContext->SetTransform(D2D1::Matrix3x2F::Identity());
+        }
+        else if (_d2dSourceFrameImages[_frontSourceFrameBufferIndex] != nullptr)
+        {
+            _d2dContext->DrawImage(
+                _d2dSourceFrameImages[_frontSourceFrameBufferIndex].Get(),
+                nullptr,                                    // default targetOffset of (0,0)
+                nullptr,                                    // default imageRectangle (entire image)
+                D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
+                D2D1_COMPOSITE_MODE_SOURCE_ATOP
+            );
+        }
+    }
+
     HRESULT D2DPreviewRenderer::InitializeD2DRenderTargetBitmap(const Microsoft::WRL::ComPtr<ID3D11Texture2D>& d3dTexture, const DXGI_FORMAT d3dTextureFormat, ID2D1Bitmap1** d2dRenderTargetBitmap)
     {
         //
@@ -9,6 +9,30 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
     /// </summary>
     class D2DPreviewRenderer : public VideoScriptEditor::Unmanaged::D2DRendererBase
     {
+    public:
+        /// <summary>
+        /// The number of source frame (input) textures used by the <see cref="RenderPipelineMode::HighThroughput"/> pipeline mode.
+        /// </summary>
+        static constexpr UINT MaxSourceFrameBufferCount = 2;
+
+        /// <summary>
+        /// The maximum number of planes (and so Direct3D textures) per source frame, reached by <see cref="SourceFramePixelFormat::Yuv420Planar"/>.
+        /// </summary>
+        static constexpr UINT MaxSourceFramePlaneCount = 3;
+
+    private:
+        /// <summary>
+        /// Identifies the content of a cached Gaussian blur of the source frame.
+        /// </summary>
+        struct BlurredSourceFrameKey
+        {
+            int FrameNumber;
+            bool IsProxyFrame;
+            float StandardDeviation;
+
+            bool operator==(const BlurredSourceFrameKey&) const = default;
+        };
+
         // Direct3D objects.
         Microsoft::WRL::ComPtr<ID3D11Device5> _d3d11Device;
         Microsoft::WRL::ComPtr<ID3D11DeviceContext4> _d3d11DeviceContext;
@@ -16,17 +40,40 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         Microsoft::WRL::ComPtr<IDirect3DDevice9Ex> _d3d9Device;
 
         // Direct3D rendering objects.
-        Microsoft::WRL::ComPtr<ID3D11Texture2D> _sourceFrameTexture;
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> _sourceFrameTextures[MaxSourceFrameBufferCount][MaxSourceFramePlaneCount];
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> _proxySourceFrameTextures[MaxSourceFramePlaneCount];
         Microsoft::WRL::ComPtr<ID3D11Texture2D> _sourceFrameRenderTarget;
         Microsoft::WRL::ComPtr<ID3D11Texture2D> _previewFrameRenderTarget;
 
         // Direct2D drawing components.
         Microsoft::WRL::ComPtr<ID2D1Device2> _d2dDevice;
         Microsoft::WRL::ComPtr<ID2D1Bitmap1> _d2dSourceRenderTargetBitmap;
-        Microsoft::WRL::ComPtr<ID2D1ImageSource> _d2dSourceFrameImageSource;
+        Microsoft::WRL::ComPtr<ID2D1Image> _d2dSourceFrameImages[MaxSourceFrameBufferCount];
+        Microsoft::WRL::ComPtr<ID2D1Image> _d2dProxySourceFrameImage;
         Microsoft::WRL::ComPtr<ID2D1Bitmap1> _d2dSourceCompatibleRenderTargetBitmap;
         Microsoft::WRL::ComPtr<ID2D1Bitmap1> _d2dPreviewRenderTargetBitmap;
 
+        /// <summary>
+        /// A cached unmasked Gaussian blur of the source frame, reused while masks are edited on the same frame
+        /// so that only the masked composite is redrawn.
+        /// </summary>
+        Microsoft::WRL::ComPtr<ID2D1Bitmap1> _d2dBlurredSourceFrameBitmap;
+        BlurredSourceFrameKey _blurredSourceFrameKey;
+
+        // Source frame texture double buffering.
+
+        /// <summary>
+        /// Event query fences signalled once the GPU has finished the drawing that reads each source frame texture,
+        /// so that a texture is never overwritten while a previous frame is still being composited from it.
+        /// </summary>
+        Microsoft::WRL::ComPtr<ID3D11Query> _sourceFrameTextureFences[MaxSourceFrameBufferCount];
+        bool _sourceFrameTextureFencePending[MaxSourceFrameBufferCount];
+        UINT _sourceFrameBufferCount;
+        UINT _frontSourceFrameBufferIndex;
+        RenderPipelineMode _pipelineMode;
+        D3D11_TEXTURE2D_DESC _sourceFrameTextureDesc;
+        SourceFramePixelFormat _sourceFramePixelFormat;
+
         // Cached device properties.
         D3D_FEATURE_LEVEL _d3dFeatureLevel;
         D3D_DRIVER_TYPE _d3dDriverType;
@@ -35,17 +82,69 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
 
         VideoSizeInfo _previewSurfaceSizeOptions;
 
+        /// <summary>
+        /// Whether the source frame is drawn from the low resolution proxy source frame (input) texture
+        /// scaled up to the source frame render target size, rather than from the full resolution source frame (input) texture.
+        /// </summary>
+        bool _renderFromProxySourceFrame;
+
+        /// <summary>
+        /// The number of the frame contained in the source frame (input) texture, or -1 if unknown.
+        /// </summary>
+        int _sourceFrameNumber;
+
+        /// <summary>
+        /// Whether the source compatible (intermediate) render target bitmap contains a blur masked render of the current source frame render target
+        /// that is only out of date within the masking dirty rectangle, so that masking geometry edits only need that area re-blurred.
+        /// </summary>
+        bool _isMaskingPreviewRenderValid;
+
+        /// <summary>
+        /// Whether the preview render target contains the composited blur masked render (without cropping),
+        /// so that only the re-blurred area needs compositing again.
+        /// </summary>
+        bool _previewTargetHoldsMaskingRender;
+
+    public:
+        /* Properties */
+
+        /// <summary>
+        /// Sets whether the source frame is drawn from the low resolution proxy source frame (input) texture
+        /// scaled up to the source frame render target size, rather than from the full resolution source frame (input) texture.
+        /// </summary>
+        /// <param name="renderFromProxySourceFrame">(IN) True to draw from the proxy source frame texture, False to draw from the full resolution source frame texture.</param>
+        void set_RenderFromProxySourceFrame(const bool renderFromProxySourceFrame) { _renderFromProxySourceFrame = renderFromProxySourceFrame; }
+
+        /// <summary>
+        /// Sets the number of the frame uploaded to the source frame (input) texture that is drawn from,
+        /// identifying its content for reuse of the cached source frame blur.
+        /// </summary>
+        /// <param name="sourceFrameNumber">(IN) The frame number, or -1 if unknown, which disables reuse of the cached source frame blur.</param>
+        void set_SourceFrameNumber(const int sourceFrameNumber) { _sourceFrameNumber = sourceFrameNumber; }
+
+        /// <summary>
+        /// Gets the render pipeline mode.
+        /// </summary>
+        /// <returns>The current <see cref="RenderPipelineMode"/> enum value.</returns>
+        RenderPipelineMode get_PipelineMode() const { return _pipelineMode; }
+
+        /// <summary>
+        /// Gets the number of planes (and so Direct3D textures) that make up each source frame (input) buffer.
+        /// </summary>
+        /// <returns>3 for <see cref="SourceFramePixelFormat::Yuv420Planar"/> source frames, otherwise 1.</returns>
+        UINT get_SourceFramePlaneCount() const { return GetSourceFramePlaneCount(_sourceFramePixelFormat); }
+
     public:
         /// <summary>
         /// Constructor for the <see cref="D2DPreviewRenderer"/> class.
         /// Derived from the <see cref="VideoScriptEditor::Unmanaged::D2DRendererBase"/> class.
         /// </summary>
         /// <param name="maskingGeometries">
-        /// A reference to a masking geometries <see cref="std::map"/>, keyed by masking segment track number,
+        /// A reference to a masking geometries <see cref="TrackIndexedTable"/>, indexed by masking segment track number,
         /// which provides a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
         /// </param>
-        /// <param name="croppingPreviewItems">A reference to a cropping segment frame data <see cref="std::map"/> keyed by the cropping segment's track number.</param>
-        D2DPreviewRenderer(std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingPreviewItems);
+        /// <param name="croppingPreviewItems">A reference to a cropping segment frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.</param>
+        D2DPreviewRenderer(VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& maskingGeometries, VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& croppingPreviewItems);
 
         /// <summary>
         /// Destructor for the <see cref="D2DPreviewRenderer"/> class.
@@ -62,11 +161,27 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         /// <summary>
         /// Creates and initializes the Direct3D source frame (input) and render target textures
         /// and associated Direct2D render target bitmap.
+        /// Source frames are uploaded in their native layout, one texture per plane, and converted to RGB by Direct2D when drawn.
         /// </summary>
         /// <param name="width">(IN) The texture width (in texels).</param>
         /// <param name="height">(IN) The texture height (in texels).</param>
-        /// <param name="pixelFormat">(IN) The source frame (input) texture pixel format. Defaults to <see cref="DXGI_FORMAT::DXGI_FORMAT_NV12"/>.</param>
-        void InitializeSourceFrameTexture(const UINT width, const UINT height, const DXGI_FORMAT pixelFormat = DXGI_FORMAT_NV12);
+        /// <param name="pixelFormat">(IN) The source frame pixel format. Defaults to <see cref="SourceFramePixelFormat::Yuv420Planar"/>.</param>
+        void InitializeSourceFrameTexture(const UINT width, const UINT height, const SourceFramePixelFormat pixelFormat = SourceFramePixelFormat::Yuv420Planar);
+
+        /// <summary>
+        /// Creates and initializes the low resolution Direct3D <see cref="SourceFramePixelFormat::Yuv420Planar"/> proxy source frame (input) textures
+        /// which are scaled up to the source frame render target size when drawn.
+        /// </summary>
+        /// <param name="width">(IN) The texture width (in texels).</param>
+        /// <param name="height">(IN) The texture height (in texels).</param>
+        void InitializeProxySourceFrameTexture(const UINT width, const UINT height);
+
+        /// <summary>
+        /// Sets the render pipeline mode, recreating the source frame (input) textures for the number of buffers the mode requires.
+        /// The content of the source frame (input) textures is discarded, so the current frame should be uploaded and rendered again.
+        /// </summary>
+        /// <param name="pipelineMode">(IN) The <see cref="RenderPipelineMode"/> to use.</param>
+        void SetPipelineMode(const RenderPipelineMode pipelineMode);
 
         /// <summary>
         /// Gets a WPF/Direct3D9Ex-compatible shared surface from the <see cref="ID3D11Texture2D"/> source frame render target texture.
@@ -111,29 +226,69 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         /// </summary>
         /// <param name="applyMaskingPreviewToSource">(IN) Whether to apply a masking preview frame to the source frame render. Defaults to false.</param>
         void RenderFrameSurfaces(const bool applyMaskingPreviewToSource = false);
+
+        /// <summary>
+        /// Reads the content of the source or preview render target back into CPU memory,
+        /// waiting for the GPU to finish rendering to it. Used for comparing rendered output.
+        /// </summary>
+        /// <param name="readPreviewFrame">(IN) True to read the preview render target, False to read the source render target.</param>
+        /// <param name="frameBuffer">(OUT) A reference to a <see cref="BgraFrameBuffer"/> which will contain a copy of the render target's pixels.</param>
+        void ReadRenderTargetPixels(const bool readPreviewFrame, BgraFrameBuffer& frameBuffer);
         
         /// <summary>
-        /// Obtains a CPU write pointer for updating the content of the Direct3D source frame (input) texture
-        /// by mapping it for CPU write access and disabling GPU access until <see cref="UnmapSourceFrameTexture"/> is called.
+        /// Obtains a CPU write pointer for updating the content of a plane of the Direct3D source frame (input) back buffer
+        /// by mapping its texture for CPU write access and disabling GPU access until <see cref="UnmapSourceFrameTexture"/> is called.
+        /// Waits for the GPU to finish any drawing that reads the back buffer textures first.
+        /// The uploaded content isn't drawn until <see cref="SwapSourceFrameBuffers"/> is called.
         /// </summary>
+        /// <param name="planeIndex">(IN) The index of the plane to map, less than <see cref="get_SourceFramePlaneCount"/>. Planes are ordered Y, U, V.</param>
         /// <param name="mappedSourceFrameTexture">(IN/OUT) A reference to a <see cref="D3D11_MAPPED_SUBRESOURCE"/> structure which will if successful contain the write pointer to the mapped texture.</param>
         /// <returns>S_OK for success, or failure code</returns>
-        HRESULT MapSourceFrameTextureForWriting(D3D11_MAPPED_SUBRESOURCE& mappedSourceFrameTexture);
+        HRESULT MapSourceFrameTextureForWriting(const UINT planeIndex, D3D11_MAPPED_SUBRESOURCE& mappedSourceFrameTexture);
+
+        /// <summary>
+        /// Invalidates the CPU write pointer to a plane of the Direct3D source frame (input) back buffer obtained from calling <see cref="MapSourceFrameTextureForWriting"/>
+        /// and reenables GPU access to its texture.
+        /// </summary>
+        /// <param name="planeIndex">(IN) The index of the mapped plane.</param>
+        void UnmapSourceFrameTexture(const UINT planeIndex);
+
+        /// <summary>
+        /// Makes the source frame (input) back buffer texture the front buffer texture that is drawn from.
+        /// Has no effect when using a single source frame texture.
+        /// </summary>
+        void SwapSourceFrameBuffers();
+
+        /// <summary>
+        /// Obtains a CPU write pointer for updating the content of a plane of the Direct3D proxy source frame (input)
+        /// by mapping its texture for CPU write access and disabling GPU access until <see cref="UnmapProxySourceFrameTexture"/> is called.
+        /// </summary>
+        /// <param name="planeIndex">(IN) The index of the plane to map. Planes are ordered Y, U, V.</param>
+        /// <param name="mappedProxySourceFrameTexture">(IN/OUT) A reference to a <see cref="D3D11_MAPPED_SUBRESOURCE"/> structure which will if successful contain the write pointer to the mapped texture.</param>
+        /// <returns>S_OK for success, or failure code</returns>
+        HRESULT MapProxySourceFrameTextureForWriting(const UINT planeIndex, D3D11_MAPPED_SUBRESOURCE& mappedProxySourceFrameTexture);
 
         /// <summary>
-        /// Invalidates the CPU write pointer to the Direct3D source frame (input) texture obtained from calling <see cref="MapSourceFrameTextureForWriting"/>
-        /// and reenables GPU access to the texture.
+        /// Invalidates the CPU write pointer to a plane of the Direct3D proxy source frame (input) obtained from calling <see cref="MapProxySourceFrameTextureForWriting"/>
+        /// and reenables GPU access to its texture.
         /// </summary>
-        void UnmapSourceFrameTexture();
+        /// <param name="planeIndex">(IN) The index of the mapped plane.</param>
+        void UnmapProxySourceFrameTexture(const UINT planeIndex);
 
         /// <summary>
-        /// Checks that a valid <see cref="ID2D1ImageSource"/> is present for the Direct3D source frame (input) texture.
+        /// Checks that a valid Direct2D image is present for the Direct3D source frame (input) back buffer textures.
         /// If not, this method creates one.
-        /// The <see cref="ID2D1ImageSource"/> is used for dynamically converting NV12 (YUV) pixel data from its bound Direct3D texture
-        /// into Direct2D compatible RGB pixel data.
+        /// For YCbCr source frames the image is an <see cref="ID2D1ImageSource"/>, which converts pixel data from its bound Direct3D plane textures
+        /// into Direct2D compatible RGB pixel data as it is sampled.
         /// </summary>
         void CheckD2DSourceFrameImageSource();
 
+        /// <summary>
+        /// Checks that a valid <see cref="ID2D1ImageSource"/> is present for the Direct3D proxy source frame (input) textures.
+        /// If not, this method creates one.
+        /// </summary>
+        void CheckD2DProxySourceFrameImageSource();
+
         /// <summary>
         /// Finishes pending operations and releases all Direct3D and Direct2D resources so that the renderer is in a reset state.
         /// Typically this is done when the source frame (input) texture no longer contains valid data to be processed.
@@ -147,6 +302,80 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         /// </summary>
         void CreateDeviceResources();
 
+        /// <summary>
+        /// Creates the source frame (input) textures and their fences for the current pipeline mode.
+        /// </summary>
+        void CreateSourceFrameBuffers();
+
+        /// <summary>
+        /// Gets the index of the source frame (input) back buffer texture that is uploaded to.
+        /// </summary>
+        /// <returns>The back buffer index, which equals the front buffer index when using a single source frame texture.</returns>
+        UINT GetBackSourceFrameBufferIndex() const { return (_frontSourceFrameBufferIndex + 1) % _sourceFrameBufferCount; }
+
+        /// <summary>
+        /// Blocks until the GPU has finished the drawing that reads a source frame (input) texture.
+        /// </summary>
+        /// <param name="bufferIndex">(IN) The index of the source frame texture.</param>
+        void WaitForSourceFrameTextureFence(const UINT bufferIndex);
+
+        /// <summary>
+        /// Gets the number of planes (and so Direct3D textures) that make up a source frame of a pixel format.
+        /// </summary>
+        /// <param name="pixelFormat">(IN) The source frame pixel format.</param>
+        /// <returns>3 for <see cref="SourceFramePixelFormat::Yuv420Planar"/>, otherwise 1.</returns>
+        static constexpr UINT GetSourceFramePlaneCount(const SourceFramePixelFormat pixelFormat) { return (pixelFormat == SourceFramePixelFormat::Yuv420Planar) ? 3 : 1; }
+
+        /// <summary>
+        /// Creates the dynamic Direct3D plane textures for a source frame of a pixel format.
+        /// </summary>
+        /// <param name="width">(IN) The source frame width (in pixels).</param>
+        /// <param name="height">(IN) The source frame height (in pixels).</param>
+        /// <param name="pixelFormat">(IN) The source frame pixel format.</param>
+        /// <param name="planeTextures">(OUT) An array of smart pointers which will contain the created plane textures.</param>
+        /// <returns>A <see cref="D3D11_TEXTURE2D_DESC"/> describing the first (luma or packed) plane texture.</returns>
+        D3D11_TEXTURE2D_DESC CreateSourceFramePlaneTextures(const UINT width, const UINT height, const SourceFramePixelFormat pixelFormat, Microsoft::WRL::ComPtr<ID3D11Texture2D>(&planeTextures)[MaxSourceFramePlaneCount]);
+
+        /// <summary>
+        /// Creates a dynamic Direct3D texture that is updated by the CPU and read by the GPU as a Direct2D image source.
+        /// </summary>
+        /// <param name="width">(IN) The texture width (in texels).</param>
+        /// <param name="height">(IN) The texture height (in texels).</param>
+        /// <param name="pixelFormat">(IN) The texture pixel format.</param>
+        /// <param name="d3dTexture">(OUT) A reference to a smart pointer which will contain the created <see cref="ID3D11Texture2D"/>.</param>
+        /// <returns>A <see cref="D3D11_TEXTURE2D_DESC"/> describing the created texture.</returns>
+        D3D11_TEXTURE2D_DESC CreateDynamicSourceFrameTexture(const UINT width, const UINT height, const DXGI_FORMAT pixelFormat, Microsoft::WRL::ComPtr<ID3D11Texture2D>& d3dTexture);
+
+        /// <summary>
+        /// Creates a Direct2D image bound to the Direct3D plane textures of a source frame.
+        /// YCbCr planes are bound to an <see cref="ID2D1ImageSource"/> which converts their pixel data into Direct2D compatible RGB pixel data as it is sampled,
+        /// while BGRA textures are bound to an <see cref="ID2D1Bitmap1"/> directly.
+        /// </summary>
+        /// <param name="planeTextures">(IN) An array of smart pointers to the plane textures to bind the image to.</param>
+        /// <param name="pixelFormat">(IN) The source frame pixel format.</param>
+        /// <param name="d2dImage">(OUT) A reference to a smart pointer which will contain the created <see cref="ID2D1Image"/>.</param>
+        void CreateD2DImageFromTextures(const Microsoft::WRL::ComPtr<ID3D11Texture2D>(&planeTextures)[MaxSourceFramePlaneCount], const SourceFramePixelFormat pixelFormat, Microsoft::WRL::ComPtr<ID2D1Image>& d2dImage);
+
+        /// <summary>
+        /// Draws the source frame image to the current Direct2D render target, scaling up the proxy source frame image
+        /// when <see cref="_renderFromProxySourceFrame"/> is set so that it aligns with masking and cropping geometry in source frame coordinates.
+        /// Must be called between BeginDraw and EndDraw.
+        /// </summary>
+        void DrawSourceFrameImage();
+
+        /// <summary>
+        /// Gets a Gaussian blur of the source frame, re-rendering the cached blur <see cref="_d2dBlurredSourceFrameBitmap"/>
+        /// only when the source frame number, proxy state or blur parameters differ from those it was rendered for.
+        /// </summary>
+        /// <param name="sourceFrameBitmap">(IN) The <see cref="ID2D1Bitmap1"/> containing the unmasked source frame to blur.</param>
+        /// <returns>A pointer to the blurred source frame <see cref="ID2D1Bitmap1"/>, owned by the renderer.</returns>
+        ID2D1Bitmap1* GetBlurredSourceFrameBitmap(ID2D1Bitmap1* sourceFrameBitmap);
+
+        /// <summary>
+        /// Discards the cached source frame blur so that it is re-rendered on next use.
+        /// </summary>
+        void InvalidateBlurredSourceFrame() { _blurredSourceFrameKey.FrameNumber = -1; }
+
         /// <summary>
         /// Creates and initializes a Direct2D <see cref="ID2D1Bitmap1"/> from a Direct3D <see cref="ID3D11Texture2D"/> texture that can be rendered to from Direct2D.
         /// </summary>
@@ -74,4 +74,143 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         /// </summary>
         int Height;
     };
+
+    /// <summary>
+    /// Specifies the backend used by the <see cref="ScriptVideoController"/> for rendering source and preview frames.
+    /// </summary>
+    enum class PreviewRendererBackend
+    {
+        /// <summary>
+        /// Render to Direct3D/Direct2D surfaces which can be shared with WPF via Direct3D9Ex.
+        /// </summary>
+        Direct2D,
+
+        /// <summary>
+        /// Render to CPU memory BGRA frame buffers without requiring a Direct3D device.
+        /// </summary>
+        Cpu
+    };
+
+    /// <summary>
+    /// Specifies the memory layout of source frames uploaded to the preview renderer,
+    /// matching the AviSynth clip pixel types that can be uploaded without conversion.
+    /// </summary>
+    enum class SourceFramePixelFormat
+    {
+        /// <summary>
+        /// 8-bit 4:2:0 YCbCr in separate Y, U and V planes (AviSynth YV12 and I420).
+        /// </summary>
+        Yuv420Planar,
+
+        /// <summary>
+        /// 8-bit 4:2:2 YCbCr packed as Y0 U Y1 V (AviSynth YUY2).
+        /// </summary>
+        Yuy2,
+
+        /// <summary>
+        /// 8-bit BGRA stored bottom-up (AviSynth RGB32).
+        /// </summary>
+        Bgra32
+    };
+
+    /// <summary>
+    /// Specifies how the <see cref="ScriptVideoController"/> trades presentation latency against frame throughput
+    /// when rendering to Direct3D/Direct2D surfaces.
+    /// </summary>
+    enum class RenderPipelineMode
+    {
+        /// <summary>
+        /// Upload and composite each requested frame through a single source frame texture.
+        /// </summary>
+        LowLatency,
+
+        /// <summary>
+        /// Double buffer the source frame texture so that the next predicted frame is uploaded
+        /// while the GPU is still compositing the current frame. Suited to playback of heavy masked projects.
+        /// </summary>
+        HighThroughput
+    };
+
+    /// <summary>
+    /// Encapsulates a 32 bits per pixel BGRA (libyuv ARGB) frame buffer stored in CPU memory.
+    /// </summary>
+    struct BgraFrameBuffer
+    {
+        /// <summary>
+        /// The width of the frame in pixels.
+        /// </summary>
+        int Width = 0;
+
+        /// <summary>
+        /// The height of the frame in pixels.
+        /// </summary>
+        int Height = 0;
+
+        /// <summary>
+        /// The number of bytes in a row of pixels.
+        /// </summary>
+        int Stride = 0;
+
+        /// <summary>
+        /// The top-down pixel data of the frame.
+        /// </summary>
+        std::vector<uint8_t> Pixels;
+    };
+
+    /// <summary>
+    /// Encapsulates usage statistics of the decoded video frame cache.
+    /// </summary>
+    struct DecodedFrameCacheStatistics
+    {
+        /// <summary>
+        /// The number of frame requests served from the cache.
+        /// </summary>
+        uint64_t HitCount = 0;
+
+        /// <summary>
+        /// The number of frame requests that required decoding.
+        /// </summary>
+        uint64_t MissCount = 0;
+
+        /// <summary>
+        /// The number of frames currently held in the cache.
+        /// </summary>
+        size_t CachedFrameCount = 0;
+
+        /// <summary>
+        /// The number of bytes of frame data currently held in the cache.
+        /// </summary>
+        size_t CachedByteCount = 0;
+
+        /// <summary>
+        /// The maximum number of bytes of frame data the cache may hold.
+        /// </summary>
+        size_t ByteCapacity = 0;
+    };
+
+    /// <summary>
+    /// Encapsulates a strip of evenly spaced video frame thumbnails for display along the timeline.
+    /// </summary>
+    struct ThumbnailStrip
+    {
+        /// <summary>
+        /// The width of each thumbnail in pixels.
+        /// </summary>
+        int ThumbnailWidth = 0;
+
+        /// <summary>
+        /// The height of each thumbnail in pixels.
+        /// </summary>
+        int ThumbnailHeight = 0;
+
+        /// <summary>
+        /// The source frame number of each thumbnail, in ascending order.
+        /// </summary>
+        std::vector<int> FrameNumbers;
+
+        /// <summary>
+        /// The BGRA thumbnail images, in the same order as <see cref="FrameNumbers"/>.
+        /// </summary>
+        std::vector<BgraFrameBuffer> Thumbnails;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "DecodedFrameCache.h"
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    using namespace std;
+
+    DecodedFrameCache::DecodedFrameCache(const size_t byteCapacity)
+        : _byteCapacity(byteCapacity), _cachedByteCount(0), _hitCount(0), _missCount(0)
+    {
+    }
+
+    DecodedFrameCache::~DecodedFrameCache()
+    {
+        // Standard library containers automatically free resources via their destructors.
+    }
+
+    bool DecodedFrameCache::TryGetFrame(const int frameNumber, PVideoFrame& frame)
+    {
+        auto entryLookupIterator = _entryLookup.find(frameNumber);
+        if (entryLookupIterator == _entryLookup.end())
+        {
+            ++_missCount;
+            return false;
+        }
+
+        // Mark as most recently used.
+        _entries.splice(_entries.begin(), _entries, entryLookupIterator->second);
+
+        frame = entryLookupIterator->second->Frame;
+        ++_hitCount;
+        return true;
+    }
+
+    bool DecodedFrameCache::TryPeekFrame(const int frameNumber, PVideoFrame& frame) const
+    {
+        auto entryLookupIterator = _entryLookup.find(frameNumber);
+        if (entryLookupIterator == _entryLookup.end())
+        {
+            return false;
+        }
+
+        frame = entryLookupIterator->second->Frame;
+        return true;
+    }
+
+    void DecodedFrameCache::AddFrame(const int frameNumber, const PVideoFrame& frame)
+    {
+        const size_t frameByteSize = GetFrameByteSize(frame);
+        if (frameByteSize > _byteCapacity)
+        {
+            return;
+        }
+
+        auto entryLookupIterator = _entryLookup.find(frameNumber);
+        if (entryLookupIterator != _entryLookup.end())
+        {
+            // Replace the existing entry.
+            _cachedByteCount -= entryLookupIterator->second->ByteSize;
+            _entries.erase(entryLookupIterator->second);
+            _entryLookup.erase(entryLookupIterator);
+        }
+
+        _entries.push_front({ frameNumber, frame, frameByteSize });
+        _entryLookup.emplace(frameNumber, _entries.begin());
+        _cachedByteCount += frameByteSize;
+
+        EvictToCapacity();
+    }
+
+    void DecodedFrameCache::SetByteCapacity(const size_t byteCapacity)
+    {
+        _byteCapacity = byteCapacity;
+
+        EvictToCapacity();
+    }
+
+    void DecodedFrameCache::Clear()
+    {
+        _entryLookup.clear();
+        _entries.clear();
+        _cachedByteCount = 0;
+    }
+
+    void DecodedFrameCache::ResetStatistics()
+    {
+        _hitCount = 0;
+        _missCount = 0;
+    }
+
+    DecodedFrameCacheStatistics DecodedFrameCache::GetStatistics() const
+    {
+        DecodedFrameCacheStatistics statistics;
+        statistics.HitCount = _hitCount;
+        statistics.MissCount = _missCount;
+        statistics.CachedFrameCount = _entries.size();
+        statistics.CachedByteCount = _cachedByteCount;
+        statistics.ByteCapacity = _byteCapacity;
+
+        return statistics;
+    }
+
+    void DecodedFrameCache::EvictToCapacity()
+    {
+        while (_cachedByteCount > _byteCapacity && !_entries.empty())
+        {
+            const CacheEntry& leastRecentlyUsedEntry = _entries.back();
+            _cachedByteCount -= leastRecentlyUsedEntry.ByteSize;
+            _entryLookup.erase(leastRecentlyUsedEntry.FrameNumber);
+            _entries.pop_back();
+        }
+    }
+
+    size_t DecodedFrameCache::GetFrameByteSize(const PVideoFrame& frame)
+    {
+        // Interleaved formats report a zero pitch for the U and V planes.
+        constexpr int planes[] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+
+        size_t frameByteSize = 0;
+        for (const int plane : planes)
+        {
+            frameByteSize += static_cast<size_t>(frame->GetPitch(plane)) * frame->GetHeight(plane);
+        }
+
+        return frameByteSize;
+    }
+}
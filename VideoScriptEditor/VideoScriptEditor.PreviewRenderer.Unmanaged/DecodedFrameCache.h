@@ -0,0 +1,118 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    /// <summary>
+    /// A memory-budgeted least recently used cache of decoded AviSynth video frames keyed by frame number.
+    /// </summary>
+    /// <remarks>Not thread safe - intended to be accessed only from the thread that drives rendering.</remarks>
+    class DecodedFrameCache
+    {
+    public:
+        /// <summary>
+        /// The default maximum number of bytes of frame data held in the cache.
+        /// </summary>
+        static constexpr size_t DefaultByteCapacity = 256 * 1024 * 1024;
+
+    private:
+        /// <summary>
+        /// A cached decoded video frame.
+        /// </summary>
+        struct CacheEntry
+        {
+            int FrameNumber;
+            PVideoFrame Frame;
+            size_t ByteSize;
+        };
+
+        /// <summary>
+        /// Cached frames ordered from most recently used (front) to least recently used (back).
+        /// </summary>
+        std::list<CacheEntry> _entries;
+
+        /// <summary>
+        /// Lookup of <see cref="_entries"/> list nodes by frame number.
+        /// </summary>
+        std::unordered_map<int, std::list<CacheEntry>::iterator> _entryLookup;
+
+        size_t _byteCapacity;
+        size_t _cachedByteCount;
+        uint64_t _hitCount;
+        uint64_t _missCount;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="DecodedFrameCache"/> class.
+        /// </summary>
+        /// <param name="byteCapacity">(IN) The maximum number of bytes of frame data to hold. Defaults to <see cref="DefaultByteCapacity"/>.</param>
+        DecodedFrameCache(const size_t byteCapacity = DefaultByteCapacity);
+
+        /// <summary>
+        /// Destructor for the <see cref="DecodedFrameCache"/> class.
+        /// Standard library containers automatically free resources via their destructors.
+        /// </summary>
+        ~DecodedFrameCache();
+
+        /// <summary>
+        /// Gets a cached frame, marking it as most recently used. Updates the hit and miss counters.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The number of the frame to get.</param>
+        /// <param name="frame">(OUT) The cached frame, if found.</param>
+        /// <returns>True if the frame was found in the cache, False otherwise.</returns>
+        bool TryGetFrame(const int frameNumber, PVideoFrame& frame);
+
+        /// <summary>
+        /// Gets a cached frame without marking it as most recently used or updating the hit and miss counters.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The number of the frame to get.</param>
+        /// <param name="frame">(OUT) The cached frame, if found.</param>
+        /// <returns>True if the frame was found in the cache, False otherwise.</returns>
+        bool TryPeekFrame(const int frameNumber, PVideoFrame& frame) const;
+
+        /// <summary>
+        /// Adds a decoded frame to the cache as the most recently used frame,
+        /// evicting least recently used frames until the cache is within its byte capacity.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The frame number.</param>
+        /// <param name="frame">(IN) The decoded frame.</param>
+        void AddFrame(const int frameNumber, const PVideoFrame& frame);
+
+        /// <summary>
+        /// Sets the maximum number of bytes of frame data to hold, evicting least recently used frames as required.
+        /// A capacity of zero disables caching.
+        /// </summary>
+        /// <param name="byteCapacity">(IN) The maximum number of bytes of frame data to hold.</param>
+        void SetByteCapacity(const size_t byteCapacity);
+
+        /// <summary>
+        /// Removes all cached frames. Typically done before the script environment that decoded them is reset.
+        /// </summary>
+        void Clear();
+
+        /// <summary>
+        /// Resets the hit and miss counters to zero.
+        /// </summary>
+        void ResetStatistics();
+
+        /// <summary>
+        /// Gets the cache usage statistics.
+        /// </summary>
+        /// <returns>A <see cref="DecodedFrameCacheStatistics"/> structure containing the statistics.</returns>
+        DecodedFrameCacheStatistics GetStatistics() const;
+
+    private:
+        /// <summary>
+        /// Evicts least recently used frames until the cache is within its byte capacity.
+        /// </summary>
+        void EvictToCapacity();
+
+        /// <summary>
+        /// Calculates the number of bytes of pixel data referenced by a decoded frame across all of its planes.
+        /// </summary>
+        /// <param name="frame">(IN) The decoded frame.</param>
+        /// <returns>The number of bytes of pixel data.</returns>
+        static size_t GetFrameByteSize(const PVideoFrame& frame);
+    };
+}
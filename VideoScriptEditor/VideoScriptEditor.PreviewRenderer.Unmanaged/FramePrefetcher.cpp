@@ -0,0 +1,249 @@
+#include "pch.h"
+#include "FramePrefetcher.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    using namespace std;
+
+    FramePrefetcher::FramePrefetcher(std::function<PVideoFrame(int)> decodeFrame, const int frameCount, const size_t readAheadFrameCount)
+        : _decodeFrame(std::move(decodeFrame)), _frameCount(frameCount), _readAheadFrameCount(readAheadFrameCount),
+        _lastRequestedFrameNumber(-1), _frameStep(1), _nextFrameNumberToDecode(-1), _inFlightFrameNumber(-1),
+        _predictionGeneration(0), _stopRequested(false)
+    {
+        _workerThread = thread(&FramePrefetcher::WorkerThreadProc, this);
+    }
+
+    FramePrefetcher::~FramePrefetcher()
+    {
+        {
+            lock_guard<mutex> stateLock(_stateMutex);
+            _stopRequested = true;
+            ++_predictionGeneration;
+        }
+
+        _workAvailableCondition.notify_all();
+        _frameReadyCondition.notify_all();
+
+        if (_workerThread.joinable())
+        {
+            _workerThread.join();
+        }
+    }
+
+    PVideoFrame FramePrefetcher::GetFrame(const int frameNumber)
+    {
+        PVideoFrame frame;
+        bool frameWasBuffered;
+        {
+            unique_lock<mutex> stateLock(_stateMutex);
+            frameWasBuffered = TryTakeBufferedFrame(stateLock, frameNumber, frame);
+            if (frameWasBuffered)
+            {
+                UpdatePrediction(frameNumber, true);
+            }
+            else
+            {
+                // Prefetch miss - stop prefetching until the requested frame is decoded,
+                // so that the background thread can't take the decode lock first and delay it by an extra decode.
+                ++_predictionGeneration;
+                _ringBuffer.clear();
+                _nextFrameNumberToDecode = -1;
+            }
+        }
+
+        if (!frameWasBuffered)
+        {
+            {
+                lock_guard<mutex> decodeLock(_decodeMutex);
+                frame = _decodeFrame(frameNumber);
+            }
+
+            // Only now predict and prefetch the frames after this one
+            lock_guard<mutex> stateLock(_stateMutex);
+            UpdatePrediction(frameNumber, false);
+        }
+
+        _workAvailableCondition.notify_one();
+
+        return frame;
+    }
+
+    void FramePrefetcher::NotifyFrameRequested(const int frameNumber)
+    {
+        {
+            lock_guard<mutex> stateLock(_stateMutex);
+
+            auto bufferedFrameIterator = find_if(_ringBuffer.begin(), _ringBuffer.end(), [frameNumber](const PrefetchedFrame& prefetchedFrame) {
+                return prefetchedFrame.FrameNumber == frameNumber;
+            });
+
+            const bool frameIsPredicted = (bufferedFrameIterator != _ringBuffer.end()) || _inFlightFrameNumber == frameNumber;
+            if (bufferedFrameIterator != _ringBuffer.end())
+            {
+                _ringBuffer.erase(_ringBuffer.begin(), bufferedFrameIterator + 1);
+            }
+
+            UpdatePrediction(frameNumber, frameIsPredicted);
+        }
+
+        _workAvailableCondition.notify_one();
+    }
+
+    int FramePrefetcher::GetPredictedNextFrameNumber()
+    {
+        lock_guard<mutex> stateLock(_stateMutex);
+
+        if (_lastRequestedFrameNumber < 0)
+        {
+            return -1;
+        }
+
+        const int predictedFrameNumber = _lastRequestedFrameNumber + _frameStep;
+        return (predictedFrameNumber >= 0 && predictedFrameNumber < _frameCount) ? predictedFrameNumber : -1;
+    }
+
+    bool FramePrefetcher::TryPeekFrame(const int frameNumber, PVideoFrame& frame)
+    {
+        lock_guard<mutex> stateLock(_stateMutex);
+
+        auto bufferedFrameIterator = find_if(_ringBuffer.begin(), _ringBuffer.end(), [frameNumber](const PrefetchedFrame& prefetchedFrame) {
+            return prefetchedFrame.FrameNumber == frameNumber;
+        });
+
+        if (bufferedFrameIterator == _ringBuffer.end())
+        {
+            return false;
+        }
+
+        frame = bufferedFrameIterator->Frame;
+        return true;
+    }
+
+    void FramePrefetcher::InvokeWithDecodeLock(const std::function<void()>& invoke)
+    {
+        lock_guard<mutex> decodeLock(_decodeMutex);
+        invoke();
+    }
+
+    void FramePrefetcher::UpdatePrediction(const int frameNumber, const bool frameWasBuffered)
+    {
+        const int frameDelta = frameNumber - _lastRequestedFrameNumber;
+        const bool isPlayback = _lastRequestedFrameNumber >= 0 && frameDelta != 0 && abs(frameDelta) <= MaxPlaybackFrameStep;
+
+        if (isPlayback)
+        {
+            if (frameDelta != _frameStep)
+            {
+                // Playback direction or speed changed - the buffered predictions no longer apply.
+                _frameStep = frameDelta;
+                ++_predictionGeneration;
+                _ringBuffer.clear();
+                _nextFrameNumberToDecode = frameNumber + _frameStep;
+            }
+            else if (!frameWasBuffered)
+            {
+                // Playback has overtaken the prefetched frames - skip ahead rather than decode frames that have already been displayed.
+                ++_predictionGeneration;
+                _ringBuffer.clear();
+                _nextFrameNumberToDecode = frameNumber + _frameStep;
+            }
+        }
+        else if (!frameWasBuffered)
+        {
+            // Seek - cancel in-flight prefetching and start predicting from the requested frame in the current direction.
+            ++_predictionGeneration;
+            _ringBuffer.clear();
+            _nextFrameNumberToDecode = frameNumber + _frameStep;
+        }
+
+        if (_nextFrameNumberToDecode < 0 || _nextFrameNumberToDecode >= _frameCount)
+        {
+            _nextFrameNumberToDecode = -1;
+        }
+
+        _lastRequestedFrameNumber = frameNumber;
+    }
+
+    bool FramePrefetcher::TryTakeBufferedFrame(std::unique_lock<std::mutex>& lock, const int frameNumber, PVideoFrame& frame)
+    {
+        // If the background thread is decoding the requested frame, wait for it rather than decoding it twice.
+        const uint64_t generation = _predictionGeneration;
+        _frameReadyCondition.wait(lock, [&]() {
+            return _stopRequested || _inFlightFrameNumber != frameNumber || _predictionGeneration != generation;
+        });
+
+        auto bufferedFrameIterator = find_if(_ringBuffer.begin(), _ringBuffer.end(), [frameNumber](const PrefetchedFrame& prefetchedFrame) {
+            return prefetchedFrame.FrameNumber == frameNumber;
+        });
+
+        if (bufferedFrameIterator == _ringBuffer.end())
+        {
+            return false;
+        }
+
+        frame = std::move(bufferedFrameIterator->Frame);
+
+        // Discard the taken frame along with any predicted frames that were skipped over.
+        _ringBuffer.erase(_ringBuffer.begin(), bufferedFrameIterator + 1);
+
+        return true;
+    }
+
+    void FramePrefetcher::WorkerThreadProc()
+    {
+        unique_lock<mutex> stateLock(_stateMutex);
+
+        while (!_stopRequested)
+        {
+            _workAvailableCondition.wait(stateLock, [this]() {
+                return _stopRequested || (_nextFrameNumberToDecode >= 0 && _ringBuffer.size() < _readAheadFrameCount);
+            });
+
+            if (_stopRequested)
+            {
+                break;
+            }
+
+            const int frameNumber = _nextFrameNumberToDecode;
+            const uint64_t generation = _predictionGeneration;
+            _inFlightFrameNumber = frameNumber;
+
+            stateLock.unlock();
+
+            PVideoFrame frame;
+            try
+            {
+                lock_guard<mutex> decodeLock(_decodeMutex);
+                frame = _decodeFrame(frameNumber);
+            }
+            catch (...)
+            {
+                // Leave the frame null and leave error reporting to the synchronous decode when the frame is actually requested.
+            }
+
+            stateLock.lock();
+
+            _inFlightFrameNumber = -1;
+
+            if (generation == _predictionGeneration)
+            {
+                if (frame)
+                {
+                    _ringBuffer.push_back({ frameNumber, std::move(frame) });
+
+                    const int nextFrameNumber = frameNumber + _frameStep;
+                    _nextFrameNumberToDecode = (nextFrameNumber >= 0 && nextFrameNumber < _frameCount) ? nextFrameNumber : -1;
+                }
+                else
+                {
+                    // Stop prefetching until the next frame request.
+                    _nextFrameNumberToDecode = -1;
+                }
+            }
+
+            _frameReadyCondition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    /// <summary>
+    /// Decodes video frames ahead of the playhead on a background thread into a ring buffer,
+    /// predicting upcoming frame numbers from the playback direction and speed of recent frame requests.
+    /// </summary>
+    /// <remarks>
+    /// All calls to the frame decoding function are serialized, since the AviSynth script environment
+    /// doesn't support concurrent frame requests from multiple threads.
+    /// </remarks>
+    class FramePrefetcher
+    {
+    public:
+        /// <summary>
+        /// The default maximum number of decoded frames held in the ring buffer.
+        /// </summary>
+        static constexpr size_t DefaultReadAheadFrameCount = 8;
+
+        /// <summary>
+        /// The maximum distance between consecutively requested frame numbers treated as playback rather than a seek.
+        /// </summary>
+        static constexpr int MaxPlaybackFrameStep = 8;
+
+    private:
+        /// <summary>
+        /// A decoded frame held in the ring buffer.
+        /// </summary>
+        struct PrefetchedFrame
+        {
+            int FrameNumber;
+            PVideoFrame Frame;
+        };
+
+        std::function<PVideoFrame(int)> _decodeFrame;
+        const int _frameCount;
+        const size_t _readAheadFrameCount;
+
+        /// <summary>
+        /// Decoded frames in predicted request order. Bounded by <see cref="_readAheadFrameCount"/>.
+        /// </summary>
+        std::deque<PrefetchedFrame> _ringBuffer;
+
+        /// <summary>
+        /// Serializes calls to <see cref="_decodeFrame"/>.
+        /// </summary>
+        std::mutex _decodeMutex;
+
+        /// <summary>
+        /// Guards the ring buffer and prediction state.
+        /// </summary>
+        std::mutex _stateMutex;
+        std::condition_variable _workAvailableCondition;
+        std::condition_variable _frameReadyCondition;
+
+        int _lastRequestedFrameNumber;
+        int _frameStep;
+        int _nextFrameNumberToDecode;
+        int _inFlightFrameNumber;
+
+        /// <summary>
+        /// Incremented on every seek so that in-flight decodes for a cancelled prediction are discarded.
+        /// </summary>
+        uint64_t _predictionGeneration;
+        bool _stopRequested;
+
+        std::thread _workerThread;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="FramePrefetcher"/> class. Starts the background decoding thread.
+        /// </summary>
+        /// <param name="decodeFrame">(IN) A function which decodes and returns the video frame for a frame number.</param>
+        /// <param name="frameCount">(IN) The total number of frames that can be decoded.</param>
+        /// <param name="readAheadFrameCount">(IN) The maximum number of decoded frames to hold in the ring buffer. Defaults to <see cref="DefaultReadAheadFrameCount"/>.</param>
+        FramePrefetcher(std::function<PVideoFrame(int)> decodeFrame, const int frameCount, const size_t readAheadFrameCount = DefaultReadAheadFrameCount);
+
+        /// <summary>
+        /// Destructor for the <see cref="FramePrefetcher"/> class. Cancels pending decoding and joins the background thread.
+        /// </summary>
+        ~FramePrefetcher();
+
+        FramePrefetcher(const FramePrefetcher&) = delete;
+        FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+        /// <summary>
+        /// Gets a decoded video frame, taking it from the ring buffer when it has already been prefetched
+        /// or decoding it synchronously otherwise. Schedules prefetching of the frames predicted to be requested next.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The number of the frame to get.</param>
+        /// <returns>The decoded video frame.</returns>
+        PVideoFrame GetFrame(const int frameNumber);
+
+        /// <summary>
+        /// Notifies the prefetcher of a frame request that was served without its involvement, such as from a cache,
+        /// so that the playback direction and speed prediction remains current.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The requested frame number.</param>
+        void NotifyFrameRequested(const int frameNumber);
+
+        /// <summary>
+        /// Gets the frame number predicted to be requested next from the playback direction and speed of recent frame requests.
+        /// </summary>
+        /// <returns>The predicted frame number, or -1 if there is no prediction or it is out of range.</returns>
+        int GetPredictedNextFrameNumber();
+
+        /// <summary>
+        /// Gets a prefetched frame from the ring buffer without waiting for it to be decoded
+        /// and without removing it or updating the prediction.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The number of the frame to get.</param>
+        /// <param name="frame">(OUT) The buffered frame, if found.</param>
+        /// <returns>True if the frame has already been prefetched, False otherwise.</returns>
+        bool TryPeekFrame(const int frameNumber, PVideoFrame& frame);
+
+        /// <summary>
+        /// Invokes a function serialized with frame decoding, for other calls into the AviSynth script environment
+        /// that mustn't run concurrently with the background decoding thread.
+        /// </summary>
+        /// <param name="invoke">(IN) The function to invoke while decoding is locked.</param>
+        void InvokeWithDecodeLock(const std::function<void()>& invoke);
+
+    private:
+        /// <summary>
+        /// Updates the playback direction and speed prediction for a frame request,
+        /// cancelling prefetching and discarding buffered frames when the request is a seek.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The requested frame number.</param>
+        /// <param name="frameWasBuffered">(IN) Whether the requested frame was taken from the ring buffer.</param>
+        void UpdatePrediction(const int frameNumber, const bool frameWasBuffered);
+
+        /// <summary>
+        /// Takes a requested frame from the ring buffer, discarding any older predicted frames that were skipped over.
+        /// Waits for the frame if it is currently being decoded by the background thread.
+        /// </summary>
+        /// <param name="lock">(IN) A lock held on <see cref="_stateMutex"/>.</param>
+        /// <param name="frameNumber">(IN) The requested frame number.</param>
+        /// <param name="frame">(OUT) The buffered frame, if found.</param>
+        /// <returns>True if the frame was taken from the ring buffer, False otherwise.</returns>
+        bool TryTakeBufferedFrame(std::unique_lock<std::mutex>& lock, const int frameNumber, PVideoFrame& frame);
+
+        /// <summary>
+        /// The background decoding thread procedure.
+        /// </summary>
+        void WorkerThreadProc();
+    };
+}
@@ -2,8 +2,13 @@
 #include "ScriptVideoController.h"
 #include "AviSynthEnvironment.h"
 #include "D2DPreviewRenderer.h"
+#include "CpuPreviewRenderer.h"
+#include "FramePrefetcher.h"
+#include "DecodedFrameCache.h"
+#include "SourceFrameUploader.h"
 #include <libyuv.h>
 #include <stdexcept>
+#include <algorithm>
 #include <cassert>
 
 namespace VideoScriptEditor::PreviewRenderer::Unmanaged
@@ -11,18 +16,153 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
     using namespace VideoScriptEditor::Unmanaged;
     using namespace std;
 
-    ScriptVideoController::ScriptVideoController()
-        : _aviSynthEnv(new AviSynthEnvironment()), _renderer(new D2DPreviewRenderer(_maskingPreviewItems, _croppingPreviewItems))
+    namespace
     {
+        // Proxy frames are a sixteenth of the size of source frames, so a small budget holds many of them.
+        constexpr size_t ProxyFrameCacheByteCapacity = 64 * 1024 * 1024;
+
+        /// <summary>
+        /// Gets the renderer source frame pixel format matching the pixel type of an AviSynth clip.
+        /// </summary>
+        /// <param name="vi">(IN) A reference to the AviSynth clip's <see cref="VideoInfo"/>.</param>
+        /// <param name="pixelFormat">(OUT) The matching <see cref="SourceFramePixelFormat"/>.</param>
+        /// <returns>True if the clip's frames can be uploaded without conversion, False otherwise.</returns>
+        bool TryGetSourceFramePixelFormat(const VideoInfo& vi, SourceFramePixelFormat& pixelFormat)
+        {
+            if (vi.IsYV12())
+            {
+                pixelFormat = SourceFramePixelFormat::Yuv420Planar;
+            }
+            else if (vi.IsYUY2())
+            {
+                pixelFormat = SourceFramePixelFormat::Yuy2;
+            }
+            else if (vi.IsRGB32())
+            {
+                pixelFormat = SourceFramePixelFormat::Bgra32;
+            }
+            else
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Maps the renderer's source frame textures for writing and describes the copies of a video frame's planes into them.
+        /// </summary>
+        /// <param name="renderer">(IN) A reference to the renderer owning the source frame textures.</param>
+        /// <param name="vi">(IN) A reference to the AviSynth clip's <see cref="VideoInfo"/>.</param>
+        /// <param name="videoFrame">(IN) A reference to a smart pointer to the AviSynth video frame to copy.</param>
+        /// <param name="copyToProxyTexture">(IN) Whether to map the proxy source frame textures rather than the back source frame textures.</param>
+        /// <returns>The <see cref="SourceFrameUploader::PlaneCopy"/> operations, one per mapped texture plane.</returns>
+        vector<SourceFrameUploader::PlaneCopy> MapRendererSourceFrameTextures(D2DPreviewRenderer& renderer, const VideoInfo& vi, const PVideoFrame& videoFrame, const bool copyToProxyTexture)
+        {
+            // Planes in the order of the renderer's source frame plane textures.
+            // Packed (YUY2 and RGB32) frames have a single default plane.
+            constexpr int planarPlanes[] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+            const bool isPlanar = copyToProxyTexture || vi.IsYV12();
+            const UINT planeCount = isPlanar ? ARRAYSIZE(planarPlanes) : 1;
+
+            // AviSynth RGB frames are stored bottom-up - a negative height flips the copy.
+            const bool flipVertically = !copyToProxyTexture && vi.IsRGB();
+
+            vector<SourceFrameUploader::PlaneCopy> planeCopies;
+            planeCopies.reserve(planeCount);
+
+            for (UINT planeIndex = 0; planeIndex < planeCount; ++planeIndex)
+            {
+                const int plane = isPlanar ? planarPlanes[planeIndex] : 0;
+
+                // Disable GPU access to the source texture data.
+                D3D11_MAPPED_SUBRESOURCE mappedPlaneTexture{};
+                HR::ThrowIfFailed(
+                    copyToProxyTexture ? renderer.MapProxySourceFrameTextureForWriting(planeIndex, mappedPlaneTexture)
+                                       : renderer.MapSourceFrameTextureForWriting(planeIndex, mappedPlaneTexture)
+                );
+
+                // Copy the plane rows as-is. Conversion to RGB happens when Direct2D samples the textures,
+                // so there's no need to interleave YV12 U and V planes into NV12 on the CPU.
+                const int planeHeight = videoFrame->GetHeight(plane);
+                planeCopies.push_back({ videoFrame->GetReadPtr(plane),
+                                        videoFrame->GetPitch(plane),
+                                        static_cast<uint8_t*>(mappedPlaneTexture.pData),
+                                        static_cast<int>(mappedPlaneTexture.RowPitch),
+                                        videoFrame->GetRowSize(plane),
+                                        flipVertically ? -planeHeight : planeHeight });
+            }
+
+            return planeCopies;
+        }
+
+        /// <summary>
+        /// Unmaps the renderer's source frame textures after copying to them, re-enabling GPU access.
+        /// </summary>
+        /// <param name="renderer">(IN) A reference to the renderer owning the source frame textures.</param>
+        /// <param name="planeCount">(IN) The number of mapped texture planes.</param>
+        /// <param name="copyToProxyTexture">(IN) Whether the proxy source frame textures were mapped rather than the back source frame textures.</param>
+        void UnmapRendererSourceFrameTextures(D2DPreviewRenderer& renderer, const UINT planeCount, const bool copyToProxyTexture)
+        {
+            for (UINT planeIndex = 0; planeIndex < planeCount; ++planeIndex)
+            {
+                if (copyToProxyTexture)
+                {
+                    renderer.UnmapProxySourceFrameTexture(planeIndex);
+                }
+                else
+                {
+                    renderer.UnmapSourceFrameTexture(planeIndex);
+                }
+            }
+
+            if (copyToProxyTexture)
+            {
+                renderer.CheckD2DProxySourceFrameImageSource();
+            }
+            else
+            {
+                renderer.CheckD2DSourceFrameImageSource();
+            }
+        }
+    }
+
+    ScriptVideoController::ScriptVideoController(const PreviewRendererBackend rendererBackend)
+        : _rendererBackend(rendererBackend), _aviSynthEnv(new AviSynthEnvironment()), _decodedFrameCache(new DecodedFrameCache()),
+        _proxyFrameCache(new DecodedFrameCache(ProxyFrameCacheByteCapacity)), _sourceFrameUploader(new SourceFrameUploader()), _proxyFrameWidth(0), _proxyFrameHeight(0), _isScrubbing(false),
+        _pipelineMode(RenderPipelineMode::LowLatency), _speculativelyUploadedFrameNumber(-1)
+    {
+        if (_rendererBackend == PreviewRendererBackend::Cpu)
+        {
+            _cpuRenderer = make_unique<CpuPreviewRenderer>(_maskingPreviewItems, _croppingPreviewItems);
+        }
+        else
+        {
+            _renderer = make_unique<D2DPreviewRenderer>(_maskingPreviewItems, _croppingPreviewItems);
+        }
     }
 
     ScriptVideoController::~ScriptVideoController()
     {
         // Smart pointers and standard library containers automatically free resources via their destructors.
+        // The frame prefetcher must be stopped and cached frames released before the script environment they belong to is destroyed.
+        // Destroying the source frame uploader waits for any background copy and releases the frame being copied.
+        _sourceFrameUploader.reset();
+        _framePrefetcher.reset();
+        _decodedFrameCache->Clear();
+        _proxyFrameCache->Clear();
     }
 
     void ScriptVideoController::ResetEnvironmentAndRenderer()
     {
+        // Stop decoding ahead and release cached frames before the script environment is reset.
+        CompletePendingSourceFrameUpload();
+        _framePrefetcher.reset();
+        _decodedFrameCache->Clear();
+        _proxyFrameCache->Clear();
+        _proxyFrameWidth = _proxyFrameHeight = 0;
+        _speculativelyUploadedFrameNumber = -1;
+
         _maskingPreviewItems.clear();
         _croppingPreviewItems.clear();
 
@@ -31,6 +171,11 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
             _renderer->ReleaseAndResetResources();
         }
 
+        if (_cpuRenderer != nullptr)
+        {
+            _cpuRenderer->ReleaseAndResetResources();
+        }
+
         if (_aviSynthEnv != nullptr)
         {
             _aviSynthEnv->ResetEnvironment();
@@ -39,11 +184,28 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
 
     LoadedScriptVideoInfo ScriptVideoController::LoadAviSynthScriptFromFile(const string& fileName)
     {
+        // Stop decoding ahead and release cached frames before the script environment is changed.
+        CompletePendingSourceFrameUpload();
+        _framePrefetcher.reset();
+        _decodedFrameCache->Clear();
+        _decodedFrameCache->ResetStatistics();
+        _proxyFrameCache->Clear();
+        _proxyFrameWidth = _proxyFrameHeight = 0;
+        _speculativelyUploadedFrameNumber = -1;
+
         if (_aviSynthEnv->get_HasLoadedScript())
         {
             _maskingPreviewItems.clear();
             _croppingPreviewItems.clear();
-            _renderer->ReleaseAndResetResources();
+
+            if (_cpuRenderer != nullptr)
+            {
+                _cpuRenderer->ReleaseAndResetResources();
+            }
+            else
+            {
+                _renderer->ReleaseAndResetResources();
+            }
         }
 
         LoadedScriptVideoInfo loadedScriptVideoInfo{};
@@ -53,7 +215,43 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
             const VideoInfo* vi = _aviSynthEnv->get_VideoInfo();
             assert(vi != nullptr);
 
-            _renderer->InitializeSourceFrameTexture(vi->width, vi->height);
+            if (_cpuRenderer != nullptr)
+            {
+                _cpuRenderer->InitializeSourceFrameBuffer(vi->width, vi->height);
+            }
+            else
+            {
+                // Unsupported pixel types fall back to the default format and are reported when a frame is rendered.
+                SourceFramePixelFormat sourceFramePixelFormat = SourceFramePixelFormat::Yuv420Planar;
+                TryGetSourceFramePixelFormat(*vi, sourceFramePixelFormat);
+
+                _renderer->InitializeSourceFrameTexture(vi->width, vi->height, sourceFramePixelFormat);
+            }
+
+            if (vi->HasVideo() && vi->IsYV12())
+            {
+                // Proxy frames are downscaled in YV12, so other pixel types are always rendered at full resolution.
+                // Keep proxy frame dimensions even to suit 4:2:0 chroma subsampling.
+                _proxyFrameWidth = max(2, (vi->width / ProxyFrameScaleDivisor) & ~1);
+                _proxyFrameHeight = max(2, (vi->height / ProxyFrameScaleDivisor) & ~1);
+
+                if (_cpuRenderer != nullptr)
+                {
+                    _cpuRenderer->InitializeProxySourceFrameBuffer(_proxyFrameWidth, _proxyFrameHeight);
+                }
+                else
+                {
+                    _renderer->InitializeProxySourceFrameTexture(_proxyFrameWidth, _proxyFrameHeight);
+                }
+            }
+
+            if (vi->HasVideo())
+            {
+                _framePrefetcher = make_unique<FramePrefetcher>(
+                    [aviSynthEnv = _aviSynthEnv.get()](int frameNumber) { return aviSynthEnv->GetVideoFrame(frameNumber); },
+                    vi->num_frames
+                );
+            }
 
             loadedScriptVideoInfo.HasVideo = vi->HasVideo();
             loadedScriptVideoInfo.PixelWidth = vi->width;
@@ -66,23 +264,65 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         return loadedScriptVideoInfo;
     }
 
+    const BgraFrameBuffer& ScriptVideoController::get_SourceFrameRenderBuffer() const
+    {
+        if (_cpuRenderer == nullptr)
+        {
+            throw std::logic_error("CPU render buffers are only available when using the CPU renderer backend.");
+        }
+
+        return _cpuRenderer->get_SourceFrameRenderTarget();
+    }
+
+    const BgraFrameBuffer& ScriptVideoController::get_PreviewFrameRenderBuffer() const
+    {
+        if (_cpuRenderer == nullptr)
+        {
+            throw std::logic_error("CPU render buffers are only available when using the CPU renderer backend.");
+        }
+
+        return _cpuRenderer->get_PreviewFrameRenderTarget();
+    }
+
     void ScriptVideoController::InitializePreviewRenderSurface(const VideoSizeInfo& sizeOptions)
     {
-        _renderer->InitializePreviewRenderSurface(sizeOptions);
+        if (_cpuRenderer != nullptr)
+        {
+            _cpuRenderer->InitializePreviewRenderSurface(sizeOptions);
+        }
+        else
+        {
+            _renderer->InitializePreviewRenderSurface(sizeOptions);
+        }
     }
 
     void ScriptVideoController::SetDirect3D9DeviceWindow(const HWND windowHandle)
     {
+        if (_renderer == nullptr)
+        {
+            throw std::logic_error("Direct3D9 render surfaces aren't supported by the CPU renderer backend.");
+        }
+
         _renderer->SetD3D9DeviceWindow(windowHandle);
     }
 
     void ScriptVideoController::GetSourceFrameDirect3D9RenderSurface(IDirect3DSurface9Ptr& d3d9SourceFrameSurface)
     {
+        if (_renderer == nullptr)
+        {
+            throw std::logic_error("Direct3D9 render surfaces aren't supported by the CPU renderer backend.");
+        }
+
         _renderer->GetSourceFrameD3D9RenderSurface(d3d9SourceFrameSurface);
     }
 
     void ScriptVideoController::GetPreviewFrameDirect3D9RenderSurface(IDirect3DSurface9Ptr& d3d9PreviewFrameSurface)
     {
+        if (_renderer == nullptr)
+        {
+            throw std::logic_error("Direct3D9 render surfaces aren't supported by the CPU renderer backend.");
+        }
+
         _renderer->GetPreviewFrameD3D9RenderSurface(d3d9PreviewFrameSurface);
     }
 
@@ -90,47 +330,257 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
     {
         CopyFrameToRendererSourceFrameSurface(frameNumber);
 
-        _renderer->RenderSourceFrameSurface(applyMaskingPreview);
+        if (_cpuRenderer != nullptr)
+        {
+            _cpuRenderer->RenderSourceFrameSurface(applyMaskingPreview);
+        }
+        else
+        {
+            _renderer->RenderSourceFrameSurface(applyMaskingPreview);
+
+            UploadPredictedFrameToBackBuffer();
+        }
     }
 
     void ScriptVideoController::RenderPreviewFrameSurface(const bool maskingPreviewAppliedToSource)
     {
-        _renderer->RenderPreviewFrameSurface(maskingPreviewAppliedToSource);
+        if (_cpuRenderer != nullptr)
+        {
+            _cpuRenderer->RenderPreviewFrameSurface(maskingPreviewAppliedToSource);
+        }
+        else
+        {
+            _renderer->RenderPreviewFrameSurface(maskingPreviewAppliedToSource);
+        }
     }
 
     void ScriptVideoController::RenderFrameSurfaces(const int frameNumber, const bool applyMaskingPreviewToSource)
     {
         CopyFrameToRendererSourceFrameSurface(frameNumber);
 
-        _renderer->RenderFrameSurfaces(applyMaskingPreviewToSource);
+        if (_cpuRenderer != nullptr)
+        {
+            _cpuRenderer->RenderFrameSurfaces(applyMaskingPreviewToSource);
+        }
+        else
+        {
+            _renderer->RenderFrameSurfaces(applyMaskingPreviewToSource);
+
+            UploadPredictedFrameToBackBuffer();
+        }
+    }
+
+    void ScriptVideoController::ReadRenderedFramePixels(BgraFrameBuffer& sourceFrameBuffer, BgraFrameBuffer& previewFrameBuffer)
+    {
+        if (_cpuRenderer != nullptr)
+        {
+            sourceFrameBuffer = _cpuRenderer->get_SourceFrameRenderTarget();
+            previewFrameBuffer = _cpuRenderer->get_PreviewFrameRenderTarget();
+        }
+        else
+        {
+            _renderer->ReadRenderTargetPixels(false, sourceFrameBuffer);
+            _renderer->ReadRenderTargetPixels(true, previewFrameBuffer);
+        }
     }
 
     void ScriptVideoController::UpdateMaskingGeometry(std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>& maskingDataGeometryPair)
     {
-        _renderer->UpdateMaskingGeometry(maskingDataGeometryPair);
+        // The CPU renderer rasterizes masking frame data directly, so has no geometry to update.
+        if (_renderer != nullptr)
+        {
+            _renderer->UpdateMaskingGeometry(maskingDataGeometryPair);
+        }
     }
 
     void ScriptVideoController::UpdateMaskingGeometryGroup()
     {
-        _renderer->UpdateMaskingGeometryGroup();
+        if (_cpuRenderer != nullptr)
+        {
+            _cpuRenderer->UpdateMaskingCoverage();
+        }
+        else
+        {
+            _renderer->UpdateMaskingGeometryGroup();
+        }
     }
 
     size_t ScriptVideoController::RemoveInactiveMaskingPreviewItems(const std::vector<int>& activePreviewItemKeys)
     {
-        return RemoveInactiveSegmentsFromMap(_maskingPreviewItems, activePreviewItemKeys);
+        return _maskingPreviewItems.RemoveInactive(activePreviewItemKeys, [this](const int, const auto& maskingPreviewItem) {
+            if (_renderer != nullptr)
+            {
+                // The areas masked by removed items need redrawing on the next preview render.
+                _renderer->InvalidateMaskingGeometryBounds(maskingPreviewItem.second);
+            }
+        });
     }
 
     size_t ScriptVideoController::RemoveInactiveCroppingPreviewItems(const std::vector<int>& activePreviewItemKeys)
     {
-        return RemoveInactiveSegmentsFromMap(_croppingPreviewItems, activePreviewItemKeys);
+        return _croppingPreviewItems.RemoveInactive(activePreviewItemKeys);
+    }
+
+    void ScriptVideoController::SetDecodedFrameCacheCapacity(const size_t byteCapacity)
+    {
+        _decodedFrameCache->SetByteCapacity(byteCapacity);
+    }
+
+    DecodedFrameCacheStatistics ScriptVideoController::GetDecodedFrameCacheStatistics() const
+    {
+        return _decodedFrameCache->GetStatistics();
+    }
+
+    void ScriptVideoController::SetScrubbing(const bool isScrubbing)
+    {
+        _isScrubbing = isScrubbing;
+    }
+
+    void ScriptVideoController::SetRenderPipelineMode(const RenderPipelineMode pipelineMode)
+    {
+        // The source frame textures may be recreated, so mustn't be left mapped.
+        CompletePendingSourceFrameUpload();
+
+        _pipelineMode = pipelineMode;
+        _speculativelyUploadedFrameNumber = -1;
+
+        if (_renderer != nullptr)
+        {
+            _renderer->SetPipelineMode(pipelineMode);
+        }
+    }
+
+    void ScriptVideoController::SetMaskingBlurStandardDeviation(const float standardDeviation)
+    {
+        if (_renderer != nullptr)
+        {
+            _renderer->SetBlurStandardDeviation(standardDeviation);
+        }
     }
 
     void ScriptVideoController::CopyFrameToRendererSourceFrameSurface(const int frameNumber)
     {
+        CompletePendingSourceFrameUpload();
+
+        const VideoInfo* vi = _aviSynthEnv->get_VideoInfo();
+        assert(vi != nullptr);
+
+        SourceFramePixelFormat sourceFramePixelFormat;
+        if (!TryGetSourceFramePixelFormat(*vi, sourceFramePixelFormat))
+        {
+            throw std::invalid_argument("Video formats other than YV12, YUY2 and RGB32 are not implemented.");
+        }
+
+        const bool copyProxyFrame = _isScrubbing && _proxyFrameWidth > 0;
+
         PVideoFrame sourceVideoFrame;
+        if (copyProxyFrame)
+        {
+            GetProxyVideoFrame(frameNumber, sourceVideoFrame);
+        }
+        else
+        {
+            GetSourceVideoFrame(frameNumber, sourceVideoFrame);
+        }
+
+        const int frameWidth = copyProxyFrame ? _proxyFrameWidth : vi->width;
+        const int frameHeight = copyProxyFrame ? _proxyFrameHeight : vi->height;
+
+        if (_cpuRenderer != nullptr)
+        {
+            // Convert to BGRA using the same full range BT.601 YCbCr color space that the Direct2D renderer's image source uses.
+            BgraFrameBuffer& sourceFrameBuffer = copyProxyFrame ? _cpuRenderer->get_ProxySourceFrameBuffer() : _cpuRenderer->get_SourceFrameBuffer();
+            int writeBgraResult;
+            if (copyProxyFrame || sourceFramePixelFormat == SourceFramePixelFormat::Yuv420Planar)
+            {
+                writeBgraResult = libyuv::J420ToARGB(sourceVideoFrame->GetReadPtr(PLANAR_Y),
+                                                     sourceVideoFrame->GetPitch(PLANAR_Y),
+                                                     sourceVideoFrame->GetReadPtr(PLANAR_U),
+                                                     sourceVideoFrame->GetPitch(PLANAR_U),
+                                                     sourceVideoFrame->GetReadPtr(PLANAR_V),
+                                                     sourceVideoFrame->GetPitch(PLANAR_V),
+                                                     sourceFrameBuffer.Pixels.data(),
+                                                     sourceFrameBuffer.Stride,
+                                                     frameWidth,
+                                                     frameHeight);
+            }
+            else if (sourceFramePixelFormat == SourceFramePixelFormat::Yuy2)
+            {
+                writeBgraResult = libyuv::YUY2ToARGBMatrix(sourceVideoFrame->GetReadPtr(),
+                                                           sourceVideoFrame->GetPitch(),
+                                                           sourceFrameBuffer.Pixels.data(),
+                                                           sourceFrameBuffer.Stride,
+                                                           &libyuv::kYuvJPEGConstants,
+                                                           frameWidth,
+                                                           frameHeight);
+            }
+            else
+            {
+                // AviSynth RGB32 frames are stored bottom-up - a negative height flips the copy.
+                writeBgraResult = libyuv::ARGBCopy(sourceVideoFrame->GetReadPtr(),
+                                                   sourceVideoFrame->GetPitch(),
+                                                   sourceFrameBuffer.Pixels.data(),
+                                                   sourceFrameBuffer.Stride,
+                                                   frameWidth,
+                                                   -frameHeight);
+            }
+
+            if (writeBgraResult == -1)
+            {
+                throw std::runtime_error("Failed to convert video frame content to BGRA and copy to the source frame buffer.");
+            }
+
+            if (copyProxyFrame)
+            {
+                _cpuRenderer->UpscaleProxySourceFrameBuffer();
+            }
+
+            return;
+        }
+
+        if (copyProxyFrame)
+        {
+            UploadVideoFrameToRendererSourceFrameTexture(sourceVideoFrame, true);
+        }
+        else
+        {
+            if (frameNumber != _speculativelyUploadedFrameNumber)
+            {
+                UploadVideoFrameToRendererSourceFrameTexture(sourceVideoFrame, false);
+            }
+
+            // Present the newly uploaded (or speculatively uploaded) back buffer.
+            _renderer->SwapSourceFrameBuffers();
+        }
+
+        _speculativelyUploadedFrameNumber = -1;
+
+        _renderer->set_RenderFromProxySourceFrame(copyProxyFrame);
+        _renderer->set_SourceFrameNumber(frameNumber);
+    }
+
+    void ScriptVideoController::GetSourceVideoFrame(const int frameNumber, PVideoFrame& sourceVideoFrame)
+    {
         try
         {
-            sourceVideoFrame = _aviSynthEnv->GetVideoFrame(frameNumber);
+            if (_decodedFrameCache->TryGetFrame(frameNumber, sourceVideoFrame))
+            {
+                if (_framePrefetcher != nullptr)
+                {
+                    _framePrefetcher->NotifyFrameRequested(frameNumber);
+                }
+            }
+            else
+            {
+                sourceVideoFrame = (_framePrefetcher != nullptr)
+                                   ? _framePrefetcher->GetFrame(frameNumber)
+                                   : _aviSynthEnv->GetVideoFrame(frameNumber);
+
+                if (sourceVideoFrame)
+                {
+                    _decodedFrameCache->AddFrame(frameNumber, sourceVideoFrame);
+                }
+            }
         }
         catch (const AvisynthError& aviSynthError)
         {
@@ -143,57 +593,134 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         {
             throw std::invalid_argument("Failed to get the requested video frame from AviSynth.");
         }
+    }
+
+    void ScriptVideoController::UploadVideoFrameToRendererSourceFrameTexture(const PVideoFrame& videoFrame, const bool copyToProxyTexture)
+    {
+        const VideoInfo* vi = _aviSynthEnv->get_VideoInfo();
+        assert(vi != nullptr);
+
+        const vector<SourceFrameUploader::PlaneCopy> planeCopies = MapRendererSourceFrameTextures(*_renderer, *vi, videoFrame, copyToProxyTexture);
+        SourceFrameUploader::CopyPlanes(planeCopies);
+        UnmapRendererSourceFrameTextures(*_renderer, static_cast<UINT>(planeCopies.size()), copyToProxyTexture);
+    }
+
+    void ScriptVideoController::UploadPredictedFrameToBackBuffer()
+    {
+        if (_pipelineMode != RenderPipelineMode::HighThroughput || _renderer == nullptr || _isScrubbing || _framePrefetcher == nullptr)
+        {
+            return;
+        }
+
+        const int predictedFrameNumber = _framePrefetcher->GetPredictedNextFrameNumber();
+        if (predictedFrameNumber < 0)
+        {
+            return;
+        }
+
+        // Only upload frames that are already decoded - blocking on decoding here would delay the next render instead.
+        PVideoFrame predictedVideoFrame;
+        if (!_decodedFrameCache->TryPeekFrame(predictedFrameNumber, predictedVideoFrame)
+            && !_framePrefetcher->TryPeekFrame(predictedFrameNumber, predictedVideoFrame))
+        {
+            return;
+        }
 
         const VideoInfo* vi = _aviSynthEnv->get_VideoInfo();
         assert(vi != nullptr);
 
-        if (!vi->IsYV12())
+        // The back buffer stays mapped while its planes are copied in the background,
+        // overlapping the copy with presentation of the frame just rendered from the front buffer.
+        _sourceFrameUploader->StartCopy(predictedVideoFrame, MapRendererSourceFrameTextures(*_renderer, *vi, predictedVideoFrame, false));
+        _speculativelyUploadedFrameNumber = predictedFrameNumber;
+    }
+
+    void ScriptVideoController::CompletePendingSourceFrameUpload()
+    {
+        if (_sourceFrameUploader == nullptr || !_sourceFrameUploader->get_IsPending())
+        {
+            return;
+        }
+
+        const UINT planeCount = static_cast<UINT>(_sourceFrameUploader->get_PendingPlaneCount());
+        try
+        {
+            _sourceFrameUploader->WaitForPendingCopy();
+        }
+        catch (const exception&)
         {
-            throw std::invalid_argument("Video formats other than YV12 are not implemented.");
+            // The upload was only speculative - the frame is uploaded again when it's requested.
+            _speculativelyUploadedFrameNumber = -1;
         }
 
-        // Disable GPU access to the source texture data.
-        D3D11_MAPPED_SUBRESOURCE mappedSourceFrameTexture{};
-        HR::ThrowIfFailed(
-            _renderer->MapSourceFrameTextureForWriting(mappedSourceFrameTexture)
-        );
+        UnmapRendererSourceFrameTextures(*_renderer, planeCount, false);
+    }
+
+    void ScriptVideoController::GetProxyVideoFrame(const int frameNumber, PVideoFrame& proxyVideoFrame)
+    {
+        if (_proxyFrameCache->TryGetFrame(frameNumber, proxyVideoFrame))
+        {
+            if (_framePrefetcher != nullptr)
+            {
+                _framePrefetcher->NotifyFrameRequested(frameNumber);
+            }
 
-        // Copy the video frame content to the Direct3D source texture
-        // by rearranging the (not supported by Direct3D) YV12 U and V planar bytes
-        // into (supported by Direct3D) NV12 interleaved UV bytes via libyuv.
-        // Lossless conversion since bytes are just being rearranged.
+            return;
+        }
 
-        const uint8_t* srcYPlaneReadPtr = sourceVideoFrame->GetReadPtr(PLANAR_Y);
-        const uint8_t* srcUPlaneReadPtr = sourceVideoFrame->GetReadPtr(PLANAR_U);
-        const uint8_t* srcVPlaneReadPtr = sourceVideoFrame->GetReadPtr(PLANAR_V);
-        const int srcYPlanePitch = sourceVideoFrame->GetPitch(PLANAR_Y);
-        const int srcUPlanePitch = sourceVideoFrame->GetPitch(PLANAR_U);
-        const int srcVPlanePitch = sourceVideoFrame->GetPitch(PLANAR_V);
-        uint8_t* dstWritePtr = static_cast<uint8_t*>(mappedSourceFrameTexture.pData);
-        int uvPlaneOffset = (mappedSourceFrameTexture.RowPitch * vi->height);
-        uint8_t* dstUVWritePtr = dstWritePtr + uvPlaneOffset;
+        PVideoFrame sourceVideoFrame;
+        GetSourceVideoFrame(frameNumber, sourceVideoFrame);
 
-        int writeNV12Result = libyuv::I420ToNV12(srcYPlaneReadPtr,
-                                                 srcYPlanePitch,
-                                                 srcUPlaneReadPtr,
-                                                 srcUPlanePitch,
-                                                 srcVPlaneReadPtr,
-                                                 srcVPlanePitch,
-                                                 dstWritePtr,
-                                                 mappedSourceFrameTexture.RowPitch,
-                                                 dstUVWritePtr,
-                                                 mappedSourceFrameTexture.RowPitch,
-                                                 vi->width,
-                                                 vi->height);
+        const VideoInfo* vi = _aviSynthEnv->get_VideoInfo();
+        assert(vi != nullptr);
 
-        // Re-enable GPU access to the source texture data.
-        _renderer->UnmapSourceFrameTexture();
+        VideoInfo proxyVideoInfo = *vi;
+        proxyVideoInfo.width = _proxyFrameWidth;
+        proxyVideoInfo.height = _proxyFrameHeight;
+
+        // The script environment isn't thread-safe, so allocation is serialized with the prefetcher's background decoding
+        auto allocateProxyVideoFrame = [&]() {
+            try
+            {
+                proxyVideoFrame = _aviSynthEnv->NewVideoFrame(proxyVideoInfo);
+            }
+            catch (const AvisynthError& aviSynthError)
+            {
+                throw std::runtime_error(aviSynthError.msg);
+            }
+        };
+
+        if (_framePrefetcher != nullptr)
+        {
+            _framePrefetcher->InvokeWithDecodeLock(allocateProxyVideoFrame);
+        }
+        else
+        {
+            allocateProxyVideoFrame();
+        }
 
-        if (writeNV12Result == -1)
+        int scaleResult = libyuv::I420Scale(sourceVideoFrame->GetReadPtr(PLANAR_Y),
+                                            sourceVideoFrame->GetPitch(PLANAR_Y),
+                                            sourceVideoFrame->GetReadPtr(PLANAR_U),
+                                            sourceVideoFrame->GetPitch(PLANAR_U),
+                                            sourceVideoFrame->GetReadPtr(PLANAR_V),
+                                            sourceVideoFrame->GetPitch(PLANAR_V),
+                                            vi->width,
+                                            vi->height,
+                                            proxyVideoFrame->GetWritePtr(PLANAR_Y),
+                                            proxyVideoFrame->GetPitch(PLANAR_Y),
+                                            proxyVideoFrame->GetWritePtr(PLANAR_U),
+                                            proxyVideoFrame->GetPitch(PLANAR_U),
+                                            proxyVideoFrame->GetWritePtr(PLANAR_V),
+                                            proxyVideoFrame->GetPitch(PLANAR_V),
+                                            _proxyFrameWidth,
+                                            _proxyFrameHeight,
+                                            libyuv::kFilterBox);
+        if (scaleResult == -1)
         {
-            throw std::runtime_error("Failed to convert YV12 video frame content to NV12 and copy to the Direct3D texture.");
+            throw std::runtime_error("Failed to downscale YV12 video frame content to a proxy frame.");
         }
 
-        _renderer->CheckD2DSourceFrameImageSource();
+        _proxyFrameCache->AddFrame(frameNumber, proxyVideoFrame);
     }
 }
\ No newline at end of file
@@ -1,53 +1,146 @@
 #pragma once
 
+// Forward declaration of the AviSynth video frame smart pointer class for private method signatures.
+class PVideoFrame;
+
 namespace VideoScriptEditor::PreviewRenderer::Unmanaged
 {
     // Forward class declarations rather than header includes
     // so that the C++/CLI compiler won't unnecessarily traverse and compile class headers into managed code
     class AviSynthEnvironment;
     class D2DPreviewRenderer;
+    class CpuPreviewRenderer;
+    class FramePrefetcher;
+    class DecodedFrameCache;
+    class SourceFrameUploader;
 
     /// <summary>
     /// Controller for managing the renderer and script environment
     /// </summary>
     class ScriptVideoController
     {
+    public:
+        /// <summary>
+        /// The factor by which the width and height of source frames are reduced to produce scrubbing proxy frames.
+        /// </summary>
+        static constexpr int ProxyFrameScaleDivisor = 4;
+
     private:
+        PreviewRendererBackend _rendererBackend;
         std::unique_ptr<AviSynthEnvironment> _aviSynthEnv;
         std::unique_ptr<D2DPreviewRenderer> _renderer;
+        std::unique_ptr<CpuPreviewRenderer> _cpuRenderer;
+
+        /// <summary>
+        /// Decodes frames ahead of the playhead on a background thread. Only valid while a script is loaded.
+        /// </summary>
+        std::unique_ptr<FramePrefetcher> _framePrefetcher;
+
+        /// <summary>
+        /// Least recently used cache of decoded frames so that repeat visits to recent frames skip decoding.
+        /// </summary>
+        std::unique_ptr<DecodedFrameCache> _decodedFrameCache;
+
+        /// <summary>
+        /// Least recently used cache of downscaled proxy frames rendered while scrubbing.
+        /// </summary>
+        std::unique_ptr<DecodedFrameCache> _proxyFrameCache;
+
+        /// <summary>
+        /// Copies predicted next frames to the renderer's back source frame buffer on a background thread.
+        /// </summary>
+        std::unique_ptr<SourceFrameUploader> _sourceFrameUploader;
+
+        /// <summary>
+        /// The dimensions of scrubbing proxy frames. Zero while no video is loaded.
+        /// </summary>
+        int _proxyFrameWidth;
+        int _proxyFrameHeight;
 
         /// <summary>
-        /// A masking preview items <see cref="std::map"/> keyed by masking segment track number
+        /// Whether source frames are currently rendered from low resolution proxy frames.
+        /// </summary>
+        bool _isScrubbing;
+
+        /// <summary>
+        /// Whether the renderer favours frame latency or throughput when uploading source frames.
+        /// </summary>
+        RenderPipelineMode _pipelineMode;
+
+        /// <summary>
+        /// The number of the predicted next frame uploaded, or being uploaded, to the renderer's back source frame buffer, or -1 if none.
+        /// </summary>
+        int _speculativelyUploadedFrameNumber;
+
+        /// <summary>
+        /// A masking preview items <see cref="TrackIndexedTable"/> indexed by masking segment track number
         /// which provides a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
         /// </summary>
-        std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>> _maskingPreviewItems;
+        VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>> _maskingPreviewItems;
 
         /// <summary>
-        /// A cropping segment preview frame data <see cref="std::map"/> keyed by the cropping segment's track number.
+        /// A cropping segment preview frame data <see cref="TrackIndexedTable"/> indexed by the cropping segment's track number.
         /// </summary>
-        std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem> _croppingPreviewItems;
+        VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem> _croppingPreviewItems;
 
     public:
         /* Properties */
 
         /// <summary>
-        /// Gets a reference to the masking preview items <see cref="std::map"/> which is keyed by masking segment track number
+        /// Gets a reference to the masking preview items <see cref="TrackIndexedTable"/> which is indexed by masking segment track number
         /// and provides a <see cref="std::pair"/> association between masking segment frame data and <see cref="ID2D1Geometry"/> objects.
         /// </summary>
-        /// <returns>A reference to the masking preview items <see cref="std::map"/>.</returns>
-        std::map<int, std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& get_MaskingPreviewItems() { return _maskingPreviewItems; }
+        /// <returns>A reference to the masking preview items <see cref="TrackIndexedTable"/>.</returns>
+        VideoScriptEditor::Unmanaged::TrackIndexedTable<std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>>& get_MaskingPreviewItems() { return _maskingPreviewItems; }
+
+        /// <summary>
+        /// Gets a reference to the cropping segment preview frame data <see cref="TrackIndexedTable"/> which is indexed by the cropping segment's track number.
+        /// </summary>
+        /// <returns>A reference to the cropping segment preview frame data <see cref="TrackIndexedTable"/>.</returns>
+        VideoScriptEditor::Unmanaged::TrackIndexedTable<VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& get_CroppingPreviewItems() { return _croppingPreviewItems; }
+
+        /// <summary>
+        /// Gets the backend used for rendering source and preview frames.
+        /// </summary>
+        /// <returns>The <see cref="PreviewRendererBackend"/> enum value specified at construction.</returns>
+        PreviewRendererBackend get_RendererBackend() const { return _rendererBackend; }
 
         /// <summary>
-        /// Gets a reference to the cropping segment preview frame data <see cref="std::map"/> which is keyed by the cropping segment's track number.
+        /// Gets whether source frames are currently rendered from low resolution proxy frames.
         /// </summary>
-        /// <returns>A reference to the cropping segment preview frame data <see cref="std::map"/>.</returns>
-        std::map<int, VideoScriptEditor::Unmanaged::CropSegmentFrameDataItem>& get_CroppingPreviewItems() { return _croppingPreviewItems; }
+        /// <returns>True while scrubbing, False otherwise.</returns>
+        bool get_IsScrubbing() const { return _isScrubbing; }
+
+        /// <summary>
+        /// Gets whether the renderer favours frame latency or throughput when uploading source frames.
+        /// </summary>
+        /// <returns>The current <see cref="RenderPipelineMode"/> enum value.</returns>
+        RenderPipelineMode get_RenderPipelineMode() const { return _pipelineMode; }
+
+        /// <summary>
+        /// Gets a reference to the CPU source frame render target buffer.
+        /// Only available when using the <see cref="PreviewRendererBackend::Cpu"/> backend.
+        /// </summary>
+        /// <returns>A const reference to the source frame render target <see cref="BgraFrameBuffer"/>.</returns>
+        const BgraFrameBuffer& get_SourceFrameRenderBuffer() const;
+
+        /// <summary>
+        /// Gets a reference to the CPU preview frame render target buffer.
+        /// Only available when using the <see cref="PreviewRendererBackend::Cpu"/> backend.
+        /// </summary>
+        /// <returns>A const reference to the preview frame render target <see cref="BgraFrameBuffer"/>.</returns>
+        const BgraFrameBuffer& get_PreviewFrameRenderBuffer() const;
 
     public:
         /// <summary>
         /// Constructor for the <see cref="ScriptVideoController"/> class.
         /// </summary>
-        ScriptVideoController();
+        /// <param name="rendererBackend">
+        /// (IN) The backend to use for rendering source and preview frames. Defaults to <see cref="PreviewRendererBackend::Direct2D"/>.
+        /// The <see cref="PreviewRendererBackend::Cpu"/> backend renders to CPU memory buffers without requiring Direct3D devices,
+        /// so doesn't support the Direct3D9 render surface methods.
+        /// </param>
+        ScriptVideoController(const PreviewRendererBackend rendererBackend = PreviewRendererBackend::Direct2D);
 
         /// <summary>
         /// Destructor for the <see cref="ScriptVideoController"/> class.
@@ -119,8 +212,17 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         /// <param name="applyMaskingPreviewToSource">(IN) Whether to apply a masking preview frame to the source frame render. Defaults to false.</param>
         void RenderFrameSurfaces(const int frameNumber, const bool applyMaskingPreviewToSource);
 
+        /// <summary>
+        /// Copies the last rendered source and preview frames into CPU memory, from either renderer backend.
+        /// Used for comparing rendered output.
+        /// </summary>
+        /// <param name="sourceFrameBuffer">(OUT) A reference to a <see cref="BgraFrameBuffer"/> which will contain the rendered source frame.</param>
+        /// <param name="previewFrameBuffer">(OUT) A reference to a <see cref="BgraFrameBuffer"/> which will contain the rendered preview frame.</param>
+        void ReadRenderedFramePixels(BgraFrameBuffer& sourceFrameBuffer, BgraFrameBuffer& previewFrameBuffer);
+
         /// <summary>
         /// Updates the <see cref="ID2D1Geometry"/> part of the <paramref name="maskingDataGeometryPair"/> using data from its associated <see cref="VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase"/> data part.
+        /// The old and new geometry bounds are tracked so that the next preview render only re-blurs the area that changed.
         /// </summary>
         /// <param name="maskingDataGeometryPair">(IN/OUT) A reference to a <see cref="std::pair"/> item which provides an association of masking segment frame data and <see cref="ID2D1Geometry"/> object.</param>
         void UpdateMaskingGeometry(std::pair<std::shared_ptr<VideoScriptEditor::Unmanaged::MaskSegmentFrameDataItemBase>, ID2D1GeometryPtr>& maskingDataGeometryPair);
@@ -131,31 +233,112 @@ namespace VideoScriptEditor::PreviewRenderer::Unmanaged
         void UpdateMaskingGeometryGroup();
 
         /// <summary>
-        /// Removes all inactive elements from the masking preview items <see cref="std::map"/>.
+        /// Removes all inactive elements from the masking preview items <see cref="TrackIndexedTable"/>.
+        /// The bounds of removed geometry are tracked so that the next preview render only re-blurs the area that changed.
         /// </summary>
         /// <param name="activePreviewItemKeys">
-        /// A <see cref="std::vector"/> of key values to compare with key values of elements in the masking preview items <see cref="std::map"/>.
-        /// Any <see cref="std::map"/> element whose key value isn't contained in this collection will be removed.
+        /// A <see cref="std::vector"/> of key values to compare with key values of elements in the masking preview items <see cref="TrackIndexedTable"/>.
+        /// Any item whose track number isn't contained in this collection will be removed.
         /// </param>
         /// <returns>The number of masking preview items that were removed.</returns>
         size_t RemoveInactiveMaskingPreviewItems(const std::vector<int>& activePreviewItemKeys);
 
         /// <summary>
-        /// Removes all inactive elements from the cropping preview items <see cref="std::map"/>.
+        /// Removes all inactive elements from the cropping preview items <see cref="TrackIndexedTable"/>.
         /// </summary>
         /// <param name="activePreviewItemKeys">
-        /// A <see cref="std::vector"/> of key values to compare with key values of elements in the cropping preview items <see cref="std::map"/>.
-        /// Any <see cref="std::map"/> element whose key value isn't contained in this collection will be removed.
+        /// A <see cref="std::vector"/> of key values to compare with key values of elements in the cropping preview items <see cref="TrackIndexedTable"/>.
+        /// Any item whose track number isn't contained in this collection will be removed.
         /// </param>
         /// <returns>The number of cropping preview items that were removed.</returns>
         size_t RemoveInactiveCroppingPreviewItems(const std::vector<int>& activePreviewItemKeys);
 
+        /// <summary>
+        /// Sets the maximum number of bytes of decoded frame data held in the decoded frame cache,
+        /// evicting least recently used frames as required. A capacity of zero disables caching.
+        /// </summary>
+        /// <param name="byteCapacity">(IN) The maximum number of bytes of decoded frame data to hold.</param>
+        void SetDecodedFrameCacheCapacity(const size_t byteCapacity);
+
+        /// <summary>
+        /// Gets the decoded frame cache usage statistics.
+        /// </summary>
+        /// <returns>A <see cref="DecodedFrameCacheStatistics"/> structure containing the hit and miss counters and memory usage.</returns>
+        DecodedFrameCacheStatistics GetDecodedFrameCacheStatistics() const;
+
+        /// <summary>
+        /// Sets whether source frames are rendered from cached low resolution proxy frames
+        /// (reduced by <see cref="ProxyFrameScaleDivisor"/>) for fast timeline scrubbing.
+        /// Proxy frames are scaled back up to the source frame size when drawn, so masking and cropping geometry is unaffected.
+        /// </summary>
+        /// <param name="isScrubbing">
+        /// (IN) True when the playhead starts being scrubbed.
+        /// False once the playhead settles, after which the current frame should be rendered again to restore full resolution.
+        /// </param>
+        void SetScrubbing(const bool isScrubbing);
+
+        /// <summary>
+        /// Sets whether the renderer favours frame latency or throughput when uploading source frames.
+        /// In <see cref="RenderPipelineMode::HighThroughput"/> mode, the predicted next frame is uploaded to a second source frame buffer
+        /// after each render when it has already been decoded, overlapping its upload with presentation of the current frame.
+        /// Ignored by the <see cref="PreviewRendererBackend::Cpu"/> backend.
+        /// </summary>
+        /// <param name="pipelineMode">(IN) The <see cref="RenderPipelineMode"/> to use. Defaults to <see cref="RenderPipelineMode::LowLatency"/>.</param>
+        void SetRenderPipelineMode(const RenderPipelineMode pipelineMode);
+
+        /// <summary>
+        /// Sets the standard deviation of the Gaussian blur applied to masked areas.
+        /// A blurred source frame cached under the previous standard deviation is blurred again on the next render.
+        /// Ignored by the <see cref="PreviewRendererBackend::Cpu"/> backend.
+        /// </summary>
+        /// <param name="standardDeviation">(IN) The blur standard deviation. Defaults to <see cref="D2DRendererBase::DefaultBlurStandardDeviation"/>.</param>
+        void SetMaskingBlurStandardDeviation(const float standardDeviation);
+
     private:
         /// <summary>
         /// Copies the content of an AviSynth video frame to the renderer's Direct3D source frame surface.
-        /// Performed by rearranging YV12 U and V planar bytes to NV12 interleaved UV bytes via libyuv.
+        /// The video frame is taken from the decoded frame cache or the read-ahead buffer when available.
+        /// While scrubbing a YV12 video, a low resolution proxy video frame is copied to the renderer's proxy source frame surface instead.
+        /// YV12, YUY2 and RGB32 frames are copied in their native layout and converted to RGB by the renderer,
+        /// or are converted to BGRA via libyuv when using the <see cref="PreviewRendererBackend::Cpu"/> backend.
         /// </summary>
         /// <param name="frameNumber">(IN) The frame number of the AviSynth video frame to copy to the renderer's Direct3D source frame surface.</param>
         void CopyFrameToRendererSourceFrameSurface(const int frameNumber);
+
+        /// <summary>
+        /// Gets a full resolution AviSynth video frame from the decoded frame cache, the read-ahead buffer or by decoding it.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The frame number of the AviSynth video frame to get.</param>
+        /// <param name="sourceVideoFrame">(OUT) A reference to a smart pointer which will contain the video frame.</param>
+        void GetSourceVideoFrame(const int frameNumber, PVideoFrame& sourceVideoFrame);
+
+        /// <summary>
+        /// Copies the content of an AviSynth video frame to the renderer's Direct3D back source frame textures or proxy source frame textures
+        /// plane by plane, without any repacking. RGB32 frames are flipped from AviSynth's bottom-up order while copying.
+        /// </summary>
+        /// <param name="videoFrame">(IN) A reference to a smart pointer to the AviSynth video frame to copy.</param>
+        /// <param name="copyToProxyTexture">(IN) Whether to copy to the proxy source frame textures rather than the back source frame textures.</param>
+        void UploadVideoFrameToRendererSourceFrameTexture(const PVideoFrame& videoFrame, const bool copyToProxyTexture);
+
+        /// <summary>
+        /// In <see cref="RenderPipelineMode::HighThroughput"/> mode, starts uploading the frame predicted to be requested next
+        /// to the renderer's back source frame texture when it has already been decoded, without blocking on decoding.
+        /// The texture is mapped on the calling thread and its planes are copied on a background thread.
+        /// </summary>
+        void UploadPredictedFrameToBackBuffer();
+
+        /// <summary>
+        /// Waits for a background upload started by <see cref="UploadPredictedFrameToBackBuffer"/> to complete
+        /// and unmaps the back source frame texture, so that it can be rendered from.
+        /// </summary>
+        void CompletePendingSourceFrameUpload();
+
+        /// <summary>
+        /// Gets a low resolution proxy video frame from the proxy frame cache,
+        /// or generates and caches one by downscaling the full resolution video frame via libyuv.
+        /// </summary>
+        /// <param name="frameNumber">(IN) The frame number of the proxy video frame to get.</param>
+        /// <param name="proxyVideoFrame">(OUT) A reference to a smart pointer which will contain the proxy video frame.</param>
+        void GetProxyVideoFrame(const int frameNumber, PVideoFrame& proxyVideoFrame);
     };
 }
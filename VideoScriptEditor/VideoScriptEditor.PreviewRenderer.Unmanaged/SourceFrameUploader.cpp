@@ -0,0 +1,58 @@
+#include "pch.h"
+#include "SourceFrameUploader.h"
+#include <libyuv.h>
+#include <cassert>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    using namespace std;
+
+    SourceFrameUploader::SourceFrameUploader()
+        : _pendingPlaneCount(0)
+    {
+    }
+
+    SourceFrameUploader::~SourceFrameUploader()
+    {
+        if (_pendingCopy.valid())
+        {
+            _pendingCopy.wait();
+        }
+    }
+
+    void SourceFrameUploader::CopyPlanes(const vector<PlaneCopy>& planeCopies)
+    {
+        for (const PlaneCopy& planeCopy : planeCopies)
+        {
+            libyuv::CopyPlane(planeCopy.Source,
+                              planeCopy.SourcePitch,
+                              planeCopy.Destination,
+                              planeCopy.DestinationPitch,
+                              planeCopy.RowSize,
+                              planeCopy.Height);
+        }
+    }
+
+    void SourceFrameUploader::StartCopy(const PVideoFrame& videoFrame, vector<PlaneCopy> planeCopies)
+    {
+        assert(!_pendingCopy.valid());
+
+        // The video frame is held here rather than by the background task,
+        // so that its reference is released on the rendering thread along with the rest of the script environment's frames.
+        _pendingVideoFrame = videoFrame;
+        _pendingPlaneCount = planeCopies.size();
+        _pendingCopy = async(launch::async, [planeCopies = move(planeCopies)]() { CopyPlanes(planeCopies); });
+    }
+
+    void SourceFrameUploader::WaitForPendingCopy()
+    {
+        assert(_pendingCopy.valid());
+
+        // Release the frame even if the copy failed; get() re-throws any exception from the background task.
+        future<void> pendingCopy = move(_pendingCopy);
+        pendingCopy.wait();
+        _pendingVideoFrame = nullptr;
+        _pendingPlaneCount = 0;
+        pendingCopy.get();
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <future>
+#include <vector>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    /// <summary>
+    /// Copies the planes of AviSynth video frames into mapped Direct3D source frame textures,
+    /// either immediately or on a background thread so that the copy overlaps with presentation of the current frame.
+    /// </summary>
+    /// <remarks>
+    /// Only the plane copies run in the background. Mapping and unmapping the textures stays on the thread that drives rendering,
+    /// as the Direct3D immediate device context isn't thread safe.
+    /// </remarks>
+    class SourceFrameUploader
+    {
+    public:
+        /// <summary>
+        /// A copy of a video frame plane to a mapped texture plane.
+        /// </summary>
+        struct PlaneCopy
+        {
+            const uint8_t* Source;
+            int SourcePitch;
+            uint8_t* Destination;
+            int DestinationPitch;
+            int RowSize;
+
+            /// <summary>
+            /// The number of rows to copy. Negative to flip the copy vertically.
+            /// </summary>
+            int Height;
+        };
+
+    private:
+        /// <summary>
+        /// The video frame being copied in the background, held until the copy completes.
+        /// </summary>
+        PVideoFrame _pendingVideoFrame;
+
+        /// <summary>
+        /// The background copy of <see cref="_pendingVideoFrame"/>. Only valid while a copy is pending.
+        /// </summary>
+        std::future<void> _pendingCopy;
+
+        /// <summary>
+        /// The number of planes copied by the pending copy.
+        /// </summary>
+        size_t _pendingPlaneCount;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="SourceFrameUploader"/> class.
+        /// </summary>
+        SourceFrameUploader();
+
+        /// <summary>
+        /// Destructor for the <see cref="SourceFrameUploader"/> class. Waits for any pending copy to complete.
+        /// </summary>
+        ~SourceFrameUploader();
+
+        SourceFrameUploader(const SourceFrameUploader&) = delete;
+        SourceFrameUploader& operator=(const SourceFrameUploader&) = delete;
+
+        /// <summary>
+        /// Gets whether a background copy has been started and not yet waited for.
+        /// </summary>
+        /// <returns>True while a copy is pending, False otherwise.</returns>
+        bool get_IsPending() const { return _pendingCopy.valid(); }
+
+        /// <summary>
+        /// Gets the number of planes copied by the pending background copy, which must stay mapped until it completes.
+        /// </summary>
+        /// <returns>The number of planes copied by the pending copy, or zero if none is pending.</returns>
+        size_t get_PendingPlaneCount() const { return _pendingPlaneCount; }
+
+        /// <summary>
+        /// Copies video frame planes to mapped texture planes on the calling thread.
+        /// </summary>
+        /// <param name="planeCopies">(IN) The <see cref="PlaneCopy"/> operations to perform.</param>
+        static void CopyPlanes(const std::vector<PlaneCopy>& planeCopies);
+
+        /// <summary>
+        /// Starts copying video frame planes to mapped texture planes on a background thread.
+        /// The texture planes must stay mapped until <see cref="WaitForPendingCopy"/> returns.
+        /// </summary>
+        /// <param name="videoFrame">(IN) A reference to a smart pointer to the AviSynth video frame the planes are copied from.</param>
+        /// <param name="planeCopies">(IN) The <see cref="PlaneCopy"/> operations to perform.</param>
+        void StartCopy(const PVideoFrame& videoFrame, std::vector<PlaneCopy> planeCopies);
+
+        /// <summary>
+        /// Waits for the pending background copy to complete and releases its video frame.
+        /// Re-throws any exception thrown by the copy.
+        /// </summary>
+        void WaitForPendingCopy();
+    };
+}
@@ -0,0 +1,377 @@
+#include "pch.h"
+#include "ThumbnailStripGenerator.h"
+#include "AviSynthEnvironment.h"
+#include <libyuv.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    using namespace std;
+
+    namespace
+    {
+        constexpr char CACHE_FILE_SIGNATURE[8] = { 'V', 'S', 'E', 'T', 'H', 'M', 'B', '1' };
+        constexpr int BGRA_BYTES_PER_PIXEL = 4;
+
+        /// <summary>
+        /// Rounds a dimension down to an even number of at least 2 to suit 4:2:0 chroma subsampling.
+        /// </summary>
+        constexpr int RoundDownToEvenDimension(const int dimension)
+        {
+            return max(2, dimension & ~1);
+        }
+
+        /// <summary>
+        /// Decodes a video frame and converts it to a downscaled BGRA thumbnail.
+        /// </summary>
+        void RenderThumbnail(AviSynthEnvironment& aviSynthEnv, const int frameNumber, BgraFrameBuffer& thumbnail)
+        {
+            PVideoFrame videoFrame = aviSynthEnv.GetVideoFrame(frameNumber);
+            if (!videoFrame)
+            {
+                throw std::invalid_argument("Failed to get the requested video frame from AviSynth.");
+            }
+
+            const VideoInfo* vi = aviSynthEnv.get_VideoInfo();
+
+            const int chromaWidth = (thumbnail.Width + 1) / 2;
+            const int chromaHeight = (thumbnail.Height + 1) / 2;
+            vector<uint8_t> scaledPlanes(static_cast<size_t>(thumbnail.Width) * thumbnail.Height + 2 * static_cast<size_t>(chromaWidth) * chromaHeight);
+            uint8_t* scaledYPlane = scaledPlanes.data();
+            uint8_t* scaledUPlane = scaledYPlane + static_cast<size_t>(thumbnail.Width) * thumbnail.Height;
+            uint8_t* scaledVPlane = scaledUPlane + static_cast<size_t>(chromaWidth) * chromaHeight;
+
+            int scaleResult = libyuv::I420Scale(videoFrame->GetReadPtr(PLANAR_Y),
+                                                videoFrame->GetPitch(PLANAR_Y),
+                                                videoFrame->GetReadPtr(PLANAR_U),
+                                                videoFrame->GetPitch(PLANAR_U),
+                                                videoFrame->GetReadPtr(PLANAR_V),
+                                                videoFrame->GetPitch(PLANAR_V),
+                                                vi->width,
+                                                vi->height,
+                                                scaledYPlane,
+                                                thumbnail.Width,
+                                                scaledUPlane,
+                                                chromaWidth,
+                                                scaledVPlane,
+                                                chromaWidth,
+                                                thumbnail.Width,
+                                                thumbnail.Height,
+                                                libyuv::kFilterBox);
+            if (scaleResult == -1)
+            {
+                throw std::runtime_error("Failed to downscale YV12 video frame content to thumbnail size.");
+            }
+
+            // Convert to BGRA using the same full range BT.601 YCbCr color space that the preview renderers use.
+            int writeBgraResult = libyuv::J420ToARGB(scaledYPlane,
+                                                     thumbnail.Width,
+                                                     scaledUPlane,
+                                                     chromaWidth,
+                                                     scaledVPlane,
+                                                     chromaWidth,
+                                                     thumbnail.Pixels.data(),
+                                                     thumbnail.Stride,
+                                                     thumbnail.Width,
+                                                     thumbnail.Height);
+            if (writeBgraResult == -1)
+            {
+                throw std::runtime_error("Failed to convert YV12 thumbnail content to BGRA.");
+            }
+        }
+    }
+
+    ThumbnailStripGenerator::ThumbnailStripGenerator(const std::string& cacheDirectory, const int workerCount)
+        : _cacheDirectory(cacheDirectory), _workerCount(max(1, workerCount))
+    {
+    }
+
+    ThumbnailStripGenerator::~ThumbnailStripGenerator()
+    {
+        // Standard library containers automatically free resources via their destructors.
+    }
+
+    ThumbnailStrip ThumbnailStripGenerator::GenerateThumbnailStrip(const std::string& scriptFileName, const int thumbnailCount, const int thumbnailHeight, const std::function<bool()>& isCancellationRequested)
+    {
+        if (thumbnailCount <= 0 || thumbnailHeight <= 0)
+        {
+            throw std::invalid_argument("Thumbnail count and height must be greater than zero.");
+        }
+
+        const uint64_t scriptHash = HashFileContent(scriptFileName);
+
+        // The first environment is loaded up front to find the frame count and dimensions, then reused by the first worker.
+        vector<unique_ptr<AviSynthEnvironment>> aviSynthEnvs;
+        aviSynthEnvs.push_back(make_unique<AviSynthEnvironment>());
+
+        try
+        {
+            if (!aviSynthEnvs.front()->LoadScriptFromFile(scriptFileName))
+            {
+                throw std::runtime_error("Failed to load the AviSynth script for thumbnail generation.");
+            }
+        }
+        catch (const AvisynthError& aviSynthError)
+        {
+            throw std::runtime_error(aviSynthError.msg);
+        }
+
+        const VideoInfo vi = *aviSynthEnvs.front()->get_VideoInfo();
+        if (!vi.HasVideo() || vi.num_frames <= 0)
+        {
+            return ThumbnailStrip();
+        }
+
+        if (!vi.IsYV12())
+        {
+            throw std::invalid_argument("Video formats other than YV12 are not implemented.");
+        }
+
+        const int stripThumbnailCount = min(thumbnailCount, vi.num_frames);
+        const string cacheFilePath = GetCacheFilePath(scriptHash, vi.num_frames, stripThumbnailCount, thumbnailHeight);
+
+        ThumbnailStrip thumbnailStrip;
+        if (TryReadCacheFile(cacheFilePath, thumbnailStrip))
+        {
+            return thumbnailStrip;
+        }
+
+        thumbnailStrip.ThumbnailHeight = RoundDownToEvenDimension(thumbnailHeight);
+        thumbnailStrip.ThumbnailWidth = RoundDownToEvenDimension(static_cast<int>(static_cast<int64_t>(thumbnailStrip.ThumbnailHeight) * vi.width / vi.height));
+
+        // Take each thumbnail from the middle of its evenly sized span of frames.
+        thumbnailStrip.FrameNumbers.resize(stripThumbnailCount);
+        thumbnailStrip.Thumbnails.resize(stripThumbnailCount);
+        for (int thumbnailIndex = 0; thumbnailIndex < stripThumbnailCount; ++thumbnailIndex)
+        {
+            thumbnailStrip.FrameNumbers[thumbnailIndex] = static_cast<int>((2 * static_cast<int64_t>(thumbnailIndex) + 1) * vi.num_frames / (2 * static_cast<int64_t>(stripThumbnailCount)));
+
+            BgraFrameBuffer& thumbnail = thumbnailStrip.Thumbnails[thumbnailIndex];
+            thumbnail.Width = thumbnailStrip.ThumbnailWidth;
+            thumbnail.Height = thumbnailStrip.ThumbnailHeight;
+            thumbnail.Stride = thumbnail.Width * BGRA_BYTES_PER_PIXEL;
+            thumbnail.Pixels.resize(static_cast<size_t>(thumbnail.Stride) * thumbnail.Height);
+        }
+
+        const int workerCount = min(_workerCount, stripThumbnailCount);
+        aviSynthEnvs.resize(workerCount);
+
+        // Workers claim thumbnails in order from a shared index so that faster environments take on more of the work.
+        atomic<int> nextThumbnailIndex = 0;
+        atomic<bool> stopRequested = false;
+        bool cancelled = false;
+        exception_ptr firstWorkerException;
+        mutex firstWorkerExceptionMutex;
+
+        auto workerProc = [&](const int workerIndex)
+        {
+            try
+            {
+                unique_ptr<AviSynthEnvironment>& aviSynthEnv = aviSynthEnvs[workerIndex];
+                if (aviSynthEnv == nullptr)
+                {
+                    aviSynthEnv = make_unique<AviSynthEnvironment>();
+                    if (!aviSynthEnv->LoadScriptFromFile(scriptFileName))
+                    {
+                        throw std::runtime_error("Failed to load the AviSynth script for thumbnail generation.");
+                    }
+                }
+
+                for (int thumbnailIndex = nextThumbnailIndex++; thumbnailIndex < stripThumbnailCount && !stopRequested; thumbnailIndex = nextThumbnailIndex++)
+                {
+                    RenderThumbnail(*aviSynthEnv, thumbnailStrip.FrameNumbers[thumbnailIndex], thumbnailStrip.Thumbnails[thumbnailIndex]);
+
+                    // Only the calling thread (worker 0) polls for cancellation, so the function needn't be thread safe.
+                    if (workerIndex == 0 && isCancellationRequested && isCancellationRequested())
+                    {
+                        cancelled = true;
+                        stopRequested = true;
+                    }
+                }
+
+                // Release the environment on the thread that used it.
+                aviSynthEnv.reset();
+            }
+            catch (const AvisynthError& aviSynthError)
+            {
+                lock_guard<mutex> firstWorkerExceptionLock(firstWorkerExceptionMutex);
+                if (!firstWorkerException)
+                {
+                    firstWorkerException = make_exception_ptr(std::runtime_error(aviSynthError.msg));
+                }
+                stopRequested = true;
+            }
+            catch (...)
+            {
+                lock_guard<mutex> firstWorkerExceptionLock(firstWorkerExceptionMutex);
+                if (!firstWorkerException)
+                {
+                    firstWorkerException = current_exception();
+                }
+                stopRequested = true;
+            }
+        };
+
+        vector<thread> workerThreads;
+        for (int workerIndex = 1; workerIndex < workerCount; ++workerIndex)
+        {
+            workerThreads.emplace_back(workerProc, workerIndex);
+        }
+
+        // The calling thread acts as the first worker.
+        workerProc(0);
+
+        for (thread& workerThread : workerThreads)
+        {
+            workerThread.join();
+        }
+
+        if (firstWorkerException)
+        {
+            rethrow_exception(firstWorkerException);
+        }
+
+        if (cancelled)
+        {
+            return ThumbnailStrip();
+        }
+
+        WriteCacheFile(cacheFilePath, thumbnailStrip);
+
+        return thumbnailStrip;
+    }
+
+    std::string ThumbnailStripGenerator::GetCacheFilePath(const uint64_t scriptHash, const int frameCount, const int thumbnailCount, const int thumbnailHeight) const
+    {
+        char cacheFileName[96];
+        snprintf(cacheFileName, sizeof(cacheFileName), "%016llx-%d-%dx%d.vsethumbs", static_cast<unsigned long long>(scriptHash), frameCount, thumbnailCount, thumbnailHeight);
+
+        return (filesystem::path(_cacheDirectory) / cacheFileName).string();
+    }
+
+    uint64_t ThumbnailStripGenerator::HashFileContent(const std::string& fileName)
+    {
+        ifstream fileStream(fileName, ios::binary);
+        if (!fileStream)
+        {
+            throw std::runtime_error("Failed to open the AviSynth script file for hashing.");
+        }
+
+        // 64-bit FNV-1a - see http://www.isthe.com/chongo/tech/comp/fnv/
+        uint64_t hash = 14695981039346656037ULL;
+
+        char readBuffer[4096];
+        while (fileStream.read(readBuffer, sizeof(readBuffer)) || fileStream.gcount() > 0)
+        {
+            const streamsize bytesRead = fileStream.gcount();
+            for (streamsize i = 0; i < bytesRead; ++i)
+            {
+                hash ^= static_cast<uint8_t>(readBuffer[i]);
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        return hash;
+    }
+
+    bool ThumbnailStripGenerator::TryReadCacheFile(const std::string& cacheFilePath, ThumbnailStrip& thumbnailStrip)
+    {
+        ifstream cacheFileStream(cacheFilePath, ios::binary);
+        if (!cacheFileStream)
+        {
+            return false;
+        }
+
+        char signature[sizeof(CACHE_FILE_SIGNATURE)];
+        int32_t thumbnailCount = 0, thumbnailWidth = 0, thumbnailHeight = 0;
+        cacheFileStream.read(signature, sizeof(signature));
+        cacheFileStream.read(reinterpret_cast<char*>(&thumbnailCount), sizeof(thumbnailCount));
+        cacheFileStream.read(reinterpret_cast<char*>(&thumbnailWidth), sizeof(thumbnailWidth));
+        cacheFileStream.read(reinterpret_cast<char*>(&thumbnailHeight), sizeof(thumbnailHeight));
+
+        if (!cacheFileStream || !equal(begin(signature), end(signature), begin(CACHE_FILE_SIGNATURE))
+            || thumbnailCount <= 0 || thumbnailWidth <= 0 || thumbnailHeight <= 0)
+        {
+            return false;
+        }
+
+        ThumbnailStrip cachedThumbnailStrip;
+        cachedThumbnailStrip.ThumbnailWidth = thumbnailWidth;
+        cachedThumbnailStrip.ThumbnailHeight = thumbnailHeight;
+        cachedThumbnailStrip.FrameNumbers.resize(thumbnailCount);
+        cacheFileStream.read(reinterpret_cast<char*>(cachedThumbnailStrip.FrameNumbers.data()), sizeof(int32_t) * thumbnailCount);
+
+        cachedThumbnailStrip.Thumbnails.resize(thumbnailCount);
+        for (BgraFrameBuffer& thumbnail : cachedThumbnailStrip.Thumbnails)
+        {
+            thumbnail.Width = thumbnailWidth;
+            thumbnail.Height = thumbnailHeight;
+            thumbnail.Stride = thumbnailWidth * BGRA_BYTES_PER_PIXEL;
+            thumbnail.Pixels.resize(static_cast<size_t>(thumbnail.Stride) * thumbnailHeight);
+            cacheFileStream.read(reinterpret_cast<char*>(thumbnail.Pixels.data()), thumbnail.Pixels.size());
+        }
+
+        if (!cacheFileStream)
+        {
+            // Truncated file
+            return false;
+        }
+
+        thumbnailStrip = std::move(cachedThumbnailStrip);
+        return true;
+    }
+
+    void ThumbnailStripGenerator::WriteCacheFile(const std::string& cacheFilePath, const ThumbnailStrip& thumbnailStrip)
+    {
+        error_code errorCode;
+        const filesystem::path cacheFile(cacheFilePath);
+        filesystem::create_directories(cacheFile.parent_path(), errorCode);
+
+        // Write to a temporary file first so that a partially written cache file is never read.
+        filesystem::path temporaryCacheFile = cacheFile;
+        temporaryCacheFile += ".tmp";
+
+        {
+            ofstream cacheFileStream(temporaryCacheFile, ios::binary | ios::trunc);
+            if (!cacheFileStream)
+            {
+                return;
+            }
+
+            const int32_t thumbnailCount = static_cast<int32_t>(thumbnailStrip.Thumbnails.size());
+            const int32_t thumbnailWidth = thumbnailStrip.ThumbnailWidth;
+            const int32_t thumbnailHeight = thumbnailStrip.ThumbnailHeight;
+            cacheFileStream.write(CACHE_FILE_SIGNATURE, sizeof(CACHE_FILE_SIGNATURE));
+            cacheFileStream.write(reinterpret_cast<const char*>(&thumbnailCount), sizeof(thumbnailCount));
+            cacheFileStream.write(reinterpret_cast<const char*>(&thumbnailWidth), sizeof(thumbnailWidth));
+            cacheFileStream.write(reinterpret_cast<const char*>(&thumbnailHeight), sizeof(thumbnailHeight));
+            cacheFileStream.write(reinterpret_cast<const char*>(thumbnailStrip.FrameNumbers.data()), sizeof(int32_t) * thumbnailCount);
+
+            for (const BgraFrameBuffer& thumbnail : thumbnailStrip.Thumbnails)
+            {
+                cacheFileStream.write(reinterpret_cast<const char*>(thumbnail.Pixels.data()), thumbnail.Pixels.size());
+            }
+
+            if (!cacheFileStream.flush())
+            {
+                cacheFileStream.close();
+                filesystem::remove(temporaryCacheFile, errorCode);
+                return;
+            }
+        }
+
+        filesystem::rename(temporaryCacheFile, cacheFile, errorCode);
+        if (errorCode)
+        {
+            filesystem::remove(temporaryCacheFile, errorCode);
+        }
+    }
+}
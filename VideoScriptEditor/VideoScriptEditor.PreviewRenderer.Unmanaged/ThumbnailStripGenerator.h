@@ -0,0 +1,86 @@
+#pragma once
+#include <functional>
+
+namespace VideoScriptEditor::PreviewRenderer::Unmanaged
+{
+    /// <summary>
+    /// Generates strips of evenly spaced video frame thumbnails for display along the timeline.
+    /// Frames are decoded in parallel by worker threads, each with its own AviSynth script environment,
+    /// so generation doesn't contend with the <see cref="ScriptVideoController"/> environment used for previewing.
+    /// Generated strips are persisted to an on-disk cache keyed by a hash of the script content and its frame count.
+    /// </summary>
+    class ThumbnailStripGenerator
+    {
+    public:
+        /// <summary>
+        /// The default number of worker threads (and AviSynth script environments) used for decoding.
+        /// </summary>
+        static constexpr int DefaultWorkerCount = 4;
+
+    private:
+        std::string _cacheDirectory;
+        const int _workerCount;
+
+    public:
+        /// <summary>
+        /// Constructor for the <see cref="ThumbnailStripGenerator"/> class.
+        /// </summary>
+        /// <param name="cacheDirectory">(IN) The absolute path of the directory to persist generated thumbnail strips to. Created on demand.</param>
+        /// <param name="workerCount">(IN) The number of worker threads (and AviSynth script environments) to decode with. Defaults to <see cref="DefaultWorkerCount"/>.</param>
+        ThumbnailStripGenerator(const std::string& cacheDirectory, const int workerCount = DefaultWorkerCount);
+
+        /// <summary>
+        /// Destructor for the <see cref="ThumbnailStripGenerator"/> class.
+        /// </summary>
+        ~ThumbnailStripGenerator();
+
+        /// <summary>
+        /// Gets a strip of evenly spaced thumbnails for an AviSynth script, loading it from the on-disk cache when available
+        /// or otherwise decoding and downscaling the frames in parallel and caching the result.
+        /// Blocks until the strip is complete, so should be called from a background thread.
+        /// </summary>
+        /// <param name="scriptFileName">(IN) A reference to a <see cref="std::string"/> containing the absolute AviSynth script file name.</param>
+        /// <param name="thumbnailCount">(IN) The number of thumbnails in the strip. Limited to the script's frame count.</param>
+        /// <param name="thumbnailHeight">(IN) The height of each thumbnail in pixels. The width is derived from the video aspect ratio.</param>
+        /// <param name="isCancellationRequested">(IN) An optional function which returns true when generation should be abandoned.</param>
+        /// <returns>
+        /// A <see cref="ThumbnailStrip"/> structure containing the thumbnails,
+        /// or containing no thumbnails if the script has no video or generation was cancelled.
+        /// </returns>
+        ThumbnailStrip GenerateThumbnailStrip(const std::string& scriptFileName, const int thumbnailCount, const int thumbnailHeight, const std::function<bool()>& isCancellationRequested = nullptr);
+
+    private:
+        /// <summary>
+        /// Gets the path of the on-disk cache file for a thumbnail strip.
+        /// </summary>
+        /// <param name="scriptHash">(IN) The hash of the script file content.</param>
+        /// <param name="frameCount">(IN) The number of frames in the script's video.</param>
+        /// <param name="thumbnailCount">(IN) The number of thumbnails in the strip.</param>
+        /// <param name="thumbnailHeight">(IN) The height of each thumbnail in pixels.</param>
+        /// <returns>The absolute cache file path.</returns>
+        std::string GetCacheFilePath(const uint64_t scriptHash, const int frameCount, const int thumbnailCount, const int thumbnailHeight) const;
+
+        /// <summary>
+        /// Calculates a 64-bit FNV-1a hash of the content of a file.
+        /// </summary>
+        /// <param name="fileName">(IN) The absolute file name.</param>
+        /// <returns>The hash value.</returns>
+        static uint64_t HashFileContent(const std::string& fileName);
+
+        /// <summary>
+        /// Reads a thumbnail strip from an on-disk cache file.
+        /// </summary>
+        /// <param name="cacheFilePath">(IN) The absolute cache file path.</param>
+        /// <param name="thumbnailStrip">(OUT) The thumbnail strip read from the cache file.</param>
+        /// <returns>True if the cache file exists and is valid, False otherwise.</returns>
+        static bool TryReadCacheFile(const std::string& cacheFilePath, ThumbnailStrip& thumbnailStrip);
+
+        /// <summary>
+        /// Writes a thumbnail strip to an on-disk cache file, replacing the file atomically.
+        /// Failures are ignored since the cache is only an optimization.
+        /// </summary>
+        /// <param name="cacheFilePath">(IN) The absolute cache file path.</param>
+        /// <param name="thumbnailStrip">(IN) The thumbnail strip to write.</param>
+        static void WriteCacheFile(const std::string& cacheFilePath, const ThumbnailStrip& thumbnailStrip);
+    };
+}
@@ -22,7 +22,7 @@
 #include "..\..\Shared\cpp\ComHelpers.h"
 #include "..\..\Shared\cpp\Primitives.h"
 #include "..\..\Shared\cpp\CommonDataStructs.h"
-#include "..\..\Shared\cpp\CommonFunctionTemplates.h"
+#include "..\..\Shared\cpp\TrackIndexedTable.h"
 #include "DataStructs.h"
 
 _COM_SMARTPTR_TYPEDEF(IDirect3DSurface9, __uuidof(IDirect3DSurface9));
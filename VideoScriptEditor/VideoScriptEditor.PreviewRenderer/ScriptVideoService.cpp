@@ -184,6 +184,11 @@ namespace VideoScriptEditor::Services::ScriptVideo
         OnSurfaceRendered(SurfaceRenderPipeline::OutputPreview);
     }
 
+    void ScriptVideoService::SetUnmanagedScrubbing(bool isScrubbing)
+    {
+        _nativeController->SetScrubbing(isScrubbing);
+    }
+
     void ScriptVideoService::SetUnmanagedMaskingPreviewItems(System::Collections::Generic::IEnumerable<SegmentKeyFrameLerpDataItem>^ maskingKeyFrameLerpDataItems)
     {
         auto& unmanagedMaskingPreviewItems = _nativeController->get_MaskingPreviewItems();
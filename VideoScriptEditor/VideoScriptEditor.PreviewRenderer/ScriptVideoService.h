@@ -104,6 +104,12 @@ namespace VideoScriptEditor::Services::ScriptVideo
         /// </summary>
         virtual void RenderUnmanagedPreviewFrameSurface() override;
 
+        /// <summary>
+        /// Begins or ends scrubbing in the unmanaged script video controller.
+        /// </summary>
+        /// <param name="isScrubbing">True to begin scrubbing, False to end scrubbing.</param>
+        virtual void SetUnmanagedScrubbing(bool isScrubbing) override;
+
         /// <summary>
         /// Sets the content of the unmanaged Direct2D renderer's masking preview items cache via interop to
         /// frame data interpolated from masking segment key frame models.
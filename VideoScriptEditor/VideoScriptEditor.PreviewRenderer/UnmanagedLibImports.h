@@ -28,6 +28,7 @@ _COM_SMARTPTR_TYPEDEF(ID2D1Geometry, __uuidof(ID2D1Geometry));
 
 #include "..\..\Shared\cpp\Primitives.h"
 #include "..\..\Shared\cpp\CommonDataStructs.h"
+#include "..\..\Shared\cpp\TrackIndexedTable.h"
 #include "..\VideoScriptEditor.PreviewRenderer.Unmanaged\DataStructs.h"
 #include "..\VideoScriptEditor.PreviewRenderer.Unmanaged\ScriptVideoController.h"
 
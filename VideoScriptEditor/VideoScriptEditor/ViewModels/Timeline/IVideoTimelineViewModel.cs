@@ -77,6 +77,12 @@ namespace VideoScriptEditor.ViewModels.Timeline
         /// <returns>True if the segment can be added to the track, otherwise False.</returns>
         bool CanAddTrackSegment(int targetTrackNumber, int targetStartFrameNumber, int segmentFrameDuration);
 
+        /// <summary>
+        /// Begins or ends scrubbing through video frames with the timeline slider.
+        /// </summary>
+        /// <param name="isScrubbing">True when the timeline slider thumb starts being dragged, False when dragging completes.</param>
+        void SetScrubbing(bool isScrubbing);
+
         /// <summary>
         /// Determines whether the end of the given segment can be expanded or contracted to the specified frame number
         /// without overlapping any existing segments on the track.
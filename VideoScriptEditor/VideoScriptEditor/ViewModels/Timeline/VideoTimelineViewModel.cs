@@ -613,6 +613,12 @@ namespace VideoScriptEditor.ViewModels.Timeline
             return !TimelineTrackCollection[targetTrackNumber].TrackSegments.Any(segmentVM => segmentVM.StartFrame <= targetEndFrameNumber && targetStartFrameNumber <= segmentVM.EndFrame);
         }
 
+        /// <inheritdoc/>
+        public void SetScrubbing(bool isScrubbing)
+        {
+            _scriptVideoService.SetScrubbing(isScrubbing);
+        }
+
         /// <inheritdoc/>
         public void AddTrackSegment(Enum segmentTypeDescriptor, int targetTrackNumber, int targetStartFrameNumber, int segmentFrameDuration)
         {
@@ -84,6 +84,25 @@ namespace VideoScriptEditor.Views.Timeline
             }
         }
 
+        /// <summary>
+        /// Handles the <see cref="Thumb.DragStarted"/> routed event for the <see cref="timelineSlider"/>'s thumb.
+        /// </summary>
+        /// <remarks>Frames are rendered at reduced resolution while the thumb is being dragged.</remarks>
+        /// <inheritdoc cref="DragStartedEventHandler"/>
+        private void OnSliderThumbDragStarted(object sender, DragStartedEventArgs e)
+        {
+            ViewModel.SetScrubbing(true);
+        }
+
+        /// <summary>
+        /// Handles the <see cref="Thumb.DragCompleted"/> routed event for the <see cref="timelineSlider"/>'s thumb.
+        /// </summary>
+        /// <inheritdoc cref="DragCompletedEventHandler"/>
+        private void OnSliderThumbDragCompleted(object sender, DragCompletedEventArgs e)
+        {
+            ViewModel.SetScrubbing(false);
+        }
+
         /// <summary>
         /// Handles the <see cref="UIElement.MouseLeftButtonDown"/> routed event for a <see cref="VideoTimelineSegment"/> element.
         /// </summary>